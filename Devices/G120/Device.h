@@ -50,7 +50,7 @@
 
 #define INCLUDE_CAN
 #define TOTAL_CAN_CONTROLLERS 2
-#define LPC17_CAN_BUFFER_DEFAULT_SIZE { 128, 128 }
+#define LPC17_CAN_BUFFER_DEFAULT_SIZE { 224, 224 }
 #define LPC17_CAN_PINS {/*          TX                     RX          */       \
                         /*CAN0*/{ { PIN(0, 1), PF(1) },  { PIN(0, 0), PF(1) } },\
                         /*CAN1*/{ { PIN(0, 5), PF(2) },  { PIN(0, 4), PF(2) } } \
@@ -54,7 +54,7 @@
 
 #define INCLUDE_CAN
 #define TOTAL_CAN_CONTROLLERS 2
-#define STM32F4_CAN_BUFFER_DEFAULT_SIZE { 128 , 128 }
+#define STM32F4_CAN_BUFFER_DEFAULT_SIZE { 224 , 224 }
 #define STM32F4_CAN_PINS {/*         TX                     RX                    */\
                           /*CAN0*/ { { PIN(D,  1), AF(9) }, { PIN(D,  0), AF(9) } },\
                           /*CAN1*/ { { PIN(B, 13), AF(9) }, { PIN(B, 12), AF(9) } },\
@@ -0,0 +1,164 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include "CanFilter.h"
+
+// 32-bit scale: STID[10:0] EXID[17:0] IDE RTR 0; 16-bit scale: STID[10:0] RTR IDE EXID[17:15]
+#define CAN_FILTER32_IDE (1 << 2)
+#define CAN_FILTER16_IDE (1 << 3)
+
+// Remote frames are accepted like data frames, RTR is never part of a mask.
+static bool CanFilter_AddBlock(CanFilter_Banks& banks, uint32_t id, uint32_t mask, bool extended) {
+    if (!extended && banks.HalfUsedBank < CAN_FILTER_BANKS_PER_CONTROLLER) {
+        banks.Bank[banks.HalfUsedBank].Fr2 = ((((mask << 5) | CAN_FILTER16_IDE) & 0xFFFF) << 16) | ((id << 5) & 0xFFFF);
+        banks.HalfUsedBank = CAN_FILTER_BANKS_PER_CONTROLLER;
+
+        return true;
+    }
+
+    if (banks.Used == CAN_FILTER_BANKS_PER_CONTROLLER)
+        return false;
+
+    auto& bank = banks.Bank[banks.Used];
+
+    if (extended) {
+        bank.Scale = CAN_FILTER_SCALE_32BIT;
+        bank.Fr1 = (id << 3) | CAN_FILTER32_IDE;
+        bank.Fr2 = (mask << 3) | CAN_FILTER32_IDE;
+    }
+    else {
+        // Second pair repeats the first until another standard block needs it
+        bank.Scale = CAN_FILTER_SCALE_16BIT;
+        bank.Fr1 = ((((mask << 5) | CAN_FILTER16_IDE) & 0xFFFF) << 16) | ((id << 5) & 0xFFFF);
+        bank.Fr2 = bank.Fr1;
+
+        banks.HalfUsedBank = banks.Used;
+    }
+
+    banks.Used++;
+
+    return true;
+}
+
+// Splits [lower, upper] into the fewest aligned power of two blocks, each matched exactly by one id/mask pair.
+static bool CanFilter_AddRange(CanFilter_Banks& banks, uint32_t lower, uint32_t upper, bool extended) {
+    uint32_t idMax = extended ? CAN_FILTER_EXTENDED_ID_MAX : CAN_FILTER_STANDARD_ID_MAX;
+
+    if (lower > idMax)
+        return true;
+
+    if (upper > idMax)
+        upper = idMax;
+
+    while (true) {
+        uint32_t size = lower == 0 ? idMax + 1 : (lower & (~lower + 1));
+
+        while (size - 1 > upper - lower)
+            size >>= 1;
+
+        if (!CanFilter_AddBlock(banks, lower, idMax & ~(size - 1), extended))
+            return false;
+
+        if (upper - lower == size - 1)
+            return true;
+
+        lower += size;
+    }
+}
+
+// Filters match on the identifier value alone, so a value up to 0x7FF is needed for both frame formats.
+static bool CanFilter_AddRange(CanFilter_Banks& banks, uint32_t lower, uint32_t upper) {
+    return CanFilter_AddRange(banks, lower, upper, false) && CanFilter_AddRange(banks, lower, upper, true);
+}
+
+bool CanFilter_CompileBanks(const uint32_t* matchFilters, size_t matchFiltersSize, const uint32_t* lowerBoundFilters, const uint32_t* upperBoundFilters, size_t groupFiltersSize, CanFilter_Banks& banks) {
+    banks.Used = 0;
+    banks.HalfUsedBank = CAN_FILTER_BANKS_PER_CONTROLLER;
+
+    // Explicit filters are sorted, consecutive identifiers share blocks
+    for (size_t i = 0; i < matchFiltersSize; ) {
+        auto lower = matchFilters[i];
+        auto upper = lower;
+
+        for (i++; i < matchFiltersSize && matchFilters[i] <= upper + 1; i++)
+            upper = matchFilters[i];
+
+        if (!CanFilter_AddRange(banks, lower, upper))
+            return false;
+    }
+
+    for (size_t i = 0; i < groupFiltersSize; i++)
+        if (!CanFilter_AddRange(banks, lowerBoundFilters[i], upperBoundFilters[i]))
+            return false;
+
+    return true;
+}
+
+void CanFilter_BuildStandardIdBitmap(uint32_t* bitmap, const uint32_t* matchFilters, size_t matchFiltersSize, const uint32_t* lowerBoundFilters, const uint32_t* upperBoundFilters, size_t groupFiltersSize) {
+    memset(bitmap, 0, CAN_FILTER_STANDARD_ID_COUNT / 8);
+
+    // Both filter arrays are sorted
+    for (size_t i = 0; i < matchFiltersSize && matchFilters[i] < CAN_FILTER_STANDARD_ID_COUNT; i++)
+        bitmap[matchFilters[i] / 32] |= 1UL << (matchFilters[i] % 32);
+
+    for (size_t i = 0; i < groupFiltersSize && lowerBoundFilters[i] < CAN_FILTER_STANDARD_ID_COUNT; i++)
+        for (auto id = lowerBoundFilters[i]; id <= upperBoundFilters[i] && id < CAN_FILTER_STANDARD_ID_COUNT; id++)
+            bitmap[id / 32] |= 1UL << (id % 32);
+}
+
+TinyCLR_Result CanFilter_BuildExtendedIdSet(const TinyCLR_Memory_Manager* memoryProvider, const uint32_t* matchFilters, size_t matchFiltersSize, uint32_t*& extendedIdSet, uint32_t& shift) {
+    size_t count = 0;
+
+    for (size_t i = 0; i < matchFiltersSize; i++)
+        if (matchFilters[i] >= CAN_FILTER_STANDARD_ID_COUNT && matchFilters[i] <= CAN_FILTER_EXTENDED_ID_MAX)
+            count++;
+
+    extendedIdSet = nullptr;
+    shift = 32;
+
+    if (count == 0)
+        return TinyCLR_Result::Success;
+
+    // At most half full so that probe sequences stay short
+    uint32_t bits = 3;
+
+    while ((1UL << bits) < count * 2)
+        bits++;
+
+    extendedIdSet = (uint32_t*)memoryProvider->Allocate(memoryProvider, (1UL << bits) * sizeof(uint32_t));
+
+    if (!extendedIdSet)
+        return TinyCLR_Result::OutOfMemory;
+
+    memset(extendedIdSet, 0xFF, (1UL << bits) * sizeof(uint32_t));
+
+    shift = 32 - bits;
+
+    for (size_t i = 0; i < matchFiltersSize; i++) {
+        auto id = matchFilters[i];
+
+        if (id < CAN_FILTER_STANDARD_ID_COUNT || id > CAN_FILTER_EXTENDED_ID_MAX || (i > 0 && matchFilters[i - 1] == id))
+            continue;
+
+        auto index = CanFilter_HashExtendedId(id, shift);
+
+        while (extendedIdSet[index] != CAN_FILTER_EXTENDED_ID_SET_EMPTY)
+            index = (index + 1) & ((1UL << bits) - 1);
+
+        extendedIdSet[index] = id;
+    }
+
+    return TinyCLR_Result::Success;
+}
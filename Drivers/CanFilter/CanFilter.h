@@ -0,0 +1,64 @@
+#pragma once
+
+#include <TinyCLR.h>
+
+#define CAN_FILTER_STANDARD_ID_MAX 0x7FF
+#define CAN_FILTER_STANDARD_ID_COUNT (CAN_FILTER_STANDARD_ID_MAX + 1)
+#define CAN_FILTER_EXTENDED_ID_MAX 0x1FFFFFFF
+#define CAN_FILTER_EXTENDED_ID_SET_EMPTY 0xFFFFFFFF
+
+// bxCAN has 28 filter banks shared by CAN1 and CAN2, split at the default CAN2SB of 14
+#define CAN_FILTER_BANKS_PER_CONTROLLER 14
+
+// Bank scales, the values of the FSCx bits
+#define CAN_FILTER_SCALE_16BIT 0
+#define CAN_FILTER_SCALE_32BIT 1
+
+// FR1 and FR2 register images of one bxCAN bank in identifier/mask mode. A 32-bit bank holds the identifier in FR1
+// and the mask in FR2. A 16-bit bank holds an identifier in the low half and its mask in the high half of each.
+struct CanFilter_Bank {
+    uint8_t Scale;
+    uint32_t Fr1;
+    uint32_t Fr2;
+};
+
+struct CanFilter_Banks {
+    CanFilter_Bank Bank[CAN_FILTER_BANKS_PER_CONTROLLER];
+
+    size_t Used;
+    size_t HalfUsedBank; // 16-bit bank with a free id/mask pair, CAN_FILTER_BANKS_PER_CONTROLLER if none
+};
+
+// Builds the banks that accept exactly the sorted explicit identifiers and the sorted, non overlapping identifier
+// ranges, in either frame format and for data and remote frames alike. Only the register images are built, the
+// peripheral is not touched. Returns false when they do not fit in the banks of one controller.
+bool CanFilter_CompileBanks(const uint32_t* matchFilters, size_t matchFiltersSize, const uint32_t* lowerBoundFilters, const uint32_t* upperBoundFilters, size_t groupFiltersSize, CanFilter_Banks& banks);
+
+// Filters compiled for a software acceptance test in the receive interrupt, a single bit test for identifiers up to
+// 0x7FF and a hash set lookup for explicit identifiers above that. Only extended identifiers that miss the set still
+// search the group filters. The bitmap has CAN_FILTER_STANDARD_ID_COUNT bits, either frame format, and the set is
+// allocated from the memory manager, nullptr when there are no explicit identifiers above 0x7FF.
+void CanFilter_BuildStandardIdBitmap(uint32_t* bitmap, const uint32_t* matchFilters, size_t matchFiltersSize, const uint32_t* lowerBoundFilters, const uint32_t* upperBoundFilters, size_t groupFiltersSize);
+TinyCLR_Result CanFilter_BuildExtendedIdSet(const TinyCLR_Memory_Manager* memoryProvider, const uint32_t* matchFilters, size_t matchFiltersSize, uint32_t*& extendedIdSet, uint32_t& shift);
+
+// Inline, the receive interrupt runs these for every frame
+static inline bool CanFilter_IsInStandardIdBitmap(const uint32_t* bitmap, uint32_t id) {
+    return (bitmap[id / 32] & (1UL << (id % 32))) != 0;
+}
+
+static inline uint32_t CanFilter_HashExtendedId(uint32_t id, uint32_t shift) {
+    return (id * 0x9E3779B1) >> shift;
+}
+
+static inline bool CanFilter_IsInExtendedIdSet(const uint32_t* extendedIdSet, uint32_t shift, uint32_t id) {
+    if (extendedIdSet == nullptr)
+        return false;
+
+    auto mask = 0xFFFFFFFF >> shift;
+
+    for (auto index = CanFilter_HashExtendedId(id, shift); extendedIdSet[index] != CAN_FILTER_EXTENDED_ID_SET_EMPTY; index = (index + 1) & mask)
+        if (extendedIdSet[index] == id)
+            return true;
+
+    return false;
+}
@@ -0,0 +1,340 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include <Device.h>
+#include "CanLogger.h"
+
+#define CAN_LOGGER_DRAIN_COUNT 16
+#define CAN_LOGGER_MAX_TIME_OFFSET 0xFFFFFFFF
+
+static void CanLogger_OpenBlock(CanLogger& logger, size_t index) {
+    auto& header = logger.header[index];
+
+    header.Magic = CAN_LOGGER_BLOCK_MAGIC;
+    header.Version = CAN_LOGGER_BLOCK_VERSION;
+    header.HeaderSize = sizeof(CanLogger_BlockHeader);
+    header.Sequence = logger.sequence++;
+    header.FrameCount = 0;
+    header.UsedSize = sizeof(CanLogger_BlockHeader);
+    header.DroppedFrames = static_cast<uint32_t>(logger.droppedFrames);
+    header.BaseTime = 0;
+}
+
+static TinyCLR_Result CanLogger_WriteBlock(CanLogger& logger, size_t index) {
+    auto& configuration = logger.configuration;
+    auto& header = logger.header[index];
+    auto block = logger.block[index];
+
+    memcpy(block, &header, sizeof(header));
+    memset(block + header.UsedSize, 0, logger.blockSize - header.UsedSize);
+
+    if (logger.nextAddress + logger.blockSize > configuration.RegionAddress + configuration.RegionSize) {
+        if (!configuration.Wrap) {
+            DISABLE_INTERRUPTS_SCOPED(irq);
+
+            logger.running = false;
+            logger.droppedFrames += header.FrameCount;
+
+            return TinyCLR_Result::OutOfMemory;
+        }
+
+        logger.nextAddress = configuration.RegionAddress;
+    }
+
+    auto count = logger.blockSize;
+    auto result = configuration.Storage->Write(configuration.Storage, logger.nextAddress, count, block, configuration.Timeout);
+
+    if (result != TinyCLR_Result::Success || count != logger.blockSize) {
+        DISABLE_INTERRUPTS_SCOPED(irq);
+
+        logger.writeErrors++;
+        logger.droppedFrames += header.FrameCount;
+
+        return result != TinyCLR_Result::Success ? result : TinyCLR_Result::InvalidOperation;
+    }
+
+    logger.nextAddress += logger.blockSize;
+    logger.writtenBlocks++;
+
+    return TinyCLR_Result::Success;
+}
+
+// The capture side never touches a pending block, so it is written with interrupts enabled and handed
+// back once it is on the storage.
+static TinyCLR_Result CanLogger_WritePending(CanLogger& logger) {
+    auto result = TinyCLR_Result::Success;
+
+    while (true) {
+        size_t index;
+
+        {
+            DISABLE_INTERRUPTS_SCOPED(irq);
+
+            if (logger.pending[0] && logger.pending[1])
+                index = logger.header[0].Sequence < logger.header[1].Sequence ? 0 : 1;
+            else if (logger.pending[0])
+                index = 0;
+            else if (logger.pending[1])
+                index = 1;
+            else
+                break;
+        }
+
+        auto status = CanLogger_WriteBlock(logger, index);
+
+        if (status != TinyCLR_Result::Success)
+            result = status;
+
+        DISABLE_INTERRUPTS_SCOPED(irq);
+
+        CanLogger_OpenBlock(logger, index);
+
+        logger.pending[index] = false;
+    }
+
+    return result;
+}
+
+static size_t CanLogger_Drain(CanLogger& logger) {
+    auto can = logger.configuration.Can;
+
+    if (can == nullptr || !logger.running)
+        return 0;
+
+    TinyCLR_Can_Message messages[CAN_LOGGER_DRAIN_COUNT];
+
+    size_t count = CAN_LOGGER_DRAIN_COUNT;
+
+    if (can->ReadMessage(can, messages, count) != TinyCLR_Result::Success)
+        return 0;
+
+    for (size_t i = 0; i < count; i++)
+        CanLogger_Capture(logger, messages[i], messages[i].Timestamp);
+
+    return count;
+}
+
+TinyCLR_Result CanLogger_Initialize(CanLogger& logger, const CanLogger_Configuration& configuration) {
+    if (configuration.Storage == nullptr || configuration.Buffer == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    auto blockSize = (configuration.BufferSize / 2) - ((configuration.BufferSize / 2) % CAN_LOGGER_SECTOR_SIZE);
+
+    if (blockSize > CAN_LOGGER_MAX_BLOCK_SIZE)
+        blockSize = CAN_LOGGER_MAX_BLOCK_SIZE;
+
+    if (blockSize == 0 || blockSize > configuration.RegionSize)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    if ((configuration.RegionAddress % CAN_LOGGER_SECTOR_SIZE) != 0 || (configuration.RegionSize % CAN_LOGGER_SECTOR_SIZE) != 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    memset(&logger, 0, sizeof(logger));
+
+    logger.configuration = configuration;
+    logger.blockSize = blockSize;
+    logger.block[0] = configuration.Buffer;
+    logger.block[1] = configuration.Buffer + blockSize;
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result CanLogger_Start(CanLogger& logger) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    if (logger.running)
+        return TinyCLR_Result::InvalidOperation;
+
+    logger.sequence = 0;
+    logger.nextAddress = logger.configuration.RegionAddress;
+
+    logger.capturedFrames = 0;
+    logger.droppedFrames = 0;
+    logger.writtenBlocks = 0;
+    logger.writeErrors = 0;
+
+    logger.fillIndex = 0;
+    logger.pending[0] = false;
+    logger.pending[1] = false;
+
+    CanLogger_OpenBlock(logger, 0);
+    CanLogger_OpenBlock(logger, 1);
+
+    logger.running = true;
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result CanLogger_Stop(CanLogger& logger) {
+    auto result = CanLogger_Process(logger);
+
+    {
+        DISABLE_INTERRUPTS_SCOPED(irq);
+
+        if (!logger.running)
+            return result;
+
+        logger.running = false;
+
+        // Flush the partly filled block
+        if (!logger.pending[logger.fillIndex] && logger.header[logger.fillIndex].FrameCount > 0)
+            logger.pending[logger.fillIndex] = true;
+    }
+
+    auto status = CanLogger_WritePending(logger);
+
+    return status != TinyCLR_Result::Success ? status : result;
+}
+
+void CanLogger_GetStatus(CanLogger& logger, CanLogger_Status& status) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    status.Running = logger.running;
+    status.CapturedFrames = logger.capturedFrames;
+    status.DroppedFrames = logger.droppedFrames;
+    status.WrittenBlocks = logger.writtenBlocks;
+    status.WriteErrors = logger.writeErrors;
+    status.NextAddress = logger.nextAddress;
+}
+
+bool CanLogger_Capture(CanLogger& logger, const TinyCLR_Can_Message& message, uint64_t timestamp) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    if (!logger.running)
+        return false;
+
+    auto header = &logger.header[logger.fillIndex];
+
+    // Close the block when the record may not fit or its time offset would not
+    if (!logger.pending[logger.fillIndex] && header->FrameCount > 0 && (header->UsedSize + CAN_LOGGER_RECORD_MAX_SIZE > logger.blockSize || timestamp - header->BaseTime > CAN_LOGGER_MAX_TIME_OFFSET)) {
+        logger.pending[logger.fillIndex] = true;
+        logger.fillIndex ^= 1;
+
+        header = &logger.header[logger.fillIndex];
+    }
+
+    // Both blocks are waiting for the storage
+    if (logger.pending[logger.fillIndex]) {
+        logger.droppedFrames++;
+
+        return false;
+    }
+
+    if (header->FrameCount == 0) {
+        header->BaseTime = timestamp;
+        header->DroppedFrames = static_cast<uint32_t>(logger.droppedFrames);
+    }
+
+    uint32_t timeOffset = static_cast<uint32_t>(timestamp - header->BaseTime);
+    uint32_t id = (message.ArbitrationId & CAN_LOGGER_RECORD_ID_MASK) | (message.IsExtendedId ? CAN_LOGGER_RECORD_EXTENDED_ID : 0) | (message.IsRemoteTransmissionRequest ? CAN_LOGGER_RECORD_REMOTE_TRANSMISSION_REQUEST : 0);
+    uint8_t length = message.Length > 8 ? 8 : message.Length;
+    size_t dataLength = message.IsRemoteTransmissionRequest ? 0 : length;
+
+    auto record = logger.block[logger.fillIndex] + header->UsedSize;
+
+    memcpy(record, &timeOffset, sizeof(timeOffset));
+    memcpy(record + 4, &id, sizeof(id));
+    record[8] = length;
+    memcpy(record + CAN_LOGGER_RECORD_HEADER_SIZE, message.Data, dataLength);
+
+    header->UsedSize += CAN_LOGGER_RECORD_HEADER_SIZE + dataLength;
+    header->FrameCount++;
+
+    logger.capturedFrames++;
+
+    return true;
+}
+
+bool CanLogger_FrameHandler(const TinyCLR_Can_Message& message, uint64_t timestamp, void* context) {
+    auto& logger = *reinterpret_cast<CanLogger*>(context);
+
+    CanLogger_Capture(logger, message, timestamp);
+
+    if (logger.configuration.NextHandler != nullptr)
+        return logger.configuration.NextHandler(message, timestamp, logger.configuration.NextContext);
+
+    return false;
+}
+
+TinyCLR_Result CanLogger_Process(CanLogger& logger) {
+    auto result = TinyCLR_Result::Success;
+
+    // Drains in batches so no more than one block fills between writes
+    while (true) {
+        auto drained = CanLogger_Drain(logger);
+        auto status = CanLogger_WritePending(logger);
+
+        if (status != TinyCLR_Result::Success)
+            result = status;
+
+        if (drained < CAN_LOGGER_DRAIN_COUNT)
+            break;
+    }
+
+    return result;
+}
+
+TinyCLR_Result CanLogger_DecodeBlock(const uint8_t* data, size_t size, CanLogger_BlockHeader& header, CanLogger_RecordHandler handler, void* context) {
+    if (data == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (size < sizeof(header))
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    memcpy(&header, data, sizeof(header));
+
+    if (header.Magic != CAN_LOGGER_BLOCK_MAGIC || header.Version != CAN_LOGGER_BLOCK_VERSION || header.HeaderSize != sizeof(header))
+        return TinyCLR_Result::ArgumentInvalid;
+
+    if (header.UsedSize < header.HeaderSize || header.UsedSize > size)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    size_t offset = header.HeaderSize;
+
+    for (uint32_t i = 0; i < header.FrameCount; i++) {
+        if (offset + CAN_LOGGER_RECORD_HEADER_SIZE > header.UsedSize)
+            return TinyCLR_Result::ArgumentInvalid;
+
+        uint32_t timeOffset;
+        uint32_t id;
+
+        memcpy(&timeOffset, data + offset, sizeof(timeOffset));
+        memcpy(&id, data + offset + 4, sizeof(id));
+
+        uint8_t length = data[offset + 8];
+        size_t dataLength = (id & CAN_LOGGER_RECORD_REMOTE_TRANSMISSION_REQUEST) ? 0 : length;
+
+        if (length > 8 || offset + CAN_LOGGER_RECORD_HEADER_SIZE + dataLength > header.UsedSize)
+            return TinyCLR_Result::ArgumentInvalid;
+
+        TinyCLR_Can_Message message;
+
+        message.ArbitrationId = id & CAN_LOGGER_RECORD_ID_MASK;
+        message.IsExtendedId = (id & CAN_LOGGER_RECORD_EXTENDED_ID) != 0;
+        message.IsRemoteTransmissionRequest = (id & CAN_LOGGER_RECORD_REMOTE_TRANSMISSION_REQUEST) != 0;
+        message.Length = length;
+        message.Timestamp = header.BaseTime + timeOffset;
+
+        memset(message.Data, 0, sizeof(message.Data));
+        memcpy(message.Data, data + offset + CAN_LOGGER_RECORD_HEADER_SIZE, dataLength);
+
+        if (handler != nullptr)
+            handler(message, context);
+
+        offset += CAN_LOGGER_RECORD_HEADER_SIZE + dataLength;
+    }
+
+    return offset == header.UsedSize ? TinyCLR_Result::Success : TinyCLR_Result::ArgumentInvalid;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <TinyCLR.h>
+
+#define CAN_LOGGER_SECTOR_SIZE 512
+#define CAN_LOGGER_MAX_BLOCK_SIZE (32 * 1024)
+
+#define CAN_LOGGER_BLOCK_MAGIC 0x474F4C43 // "CLOG"
+#define CAN_LOGGER_BLOCK_VERSION 1
+
+#define CAN_LOGGER_RECORD_HEADER_SIZE 9
+#define CAN_LOGGER_RECORD_MAX_SIZE (CAN_LOGGER_RECORD_HEADER_SIZE + 8)
+#define CAN_LOGGER_RECORD_EXTENDED_ID 0x80000000
+#define CAN_LOGGER_RECORD_REMOTE_TRANSMISSION_REQUEST 0x40000000
+#define CAN_LOGGER_RECORD_ID_MASK 0x1FFFFFFF
+
+// Every block starts with this header, followed by FrameCount records of
+// { uint32_t TimeOffset, uint32_t Id, uint8_t Length, uint8_t Data[Length] }, all little endian and unaligned.
+// TimeOffset is in system ticks (100ns) from BaseTime and Id carries the CAN_LOGGER_RECORD_ flags.
+// The block is zero from UsedSize to its end.
+struct CanLogger_BlockHeader {
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t HeaderSize;
+    uint32_t Sequence;
+    uint32_t FrameCount;
+    uint32_t UsedSize;
+    uint32_t DroppedFrames;     // Dropped since start, before the first frame of this block
+    uint64_t BaseTime;
+};
+
+typedef bool(*CanLogger_ChainedFrameHandler)(const TinyCLR_Can_Message& message, uint64_t timestamp, void* context);
+
+struct CanLogger_Configuration {
+    const TinyCLR_Storage_Controller* Storage;
+
+    // Byte address and size on the storage, multiples of CAN_LOGGER_SECTOR_SIZE. With Wrap the oldest blocks
+    // are overwritten when the region is full, otherwise logging stops.
+    uint64_t RegionAddress;
+    size_t RegionSize;
+    bool Wrap;
+
+    // Split into two blocks, one filled while the other is written
+    uint8_t* Buffer;
+    size_t BufferSize;
+
+    uint64_t Timeout;
+
+    // When set, CanLogger_Process drains this controller's read buffer. Leave it null when frames come from
+    // the receive interrupt through CanLogger_FrameHandler.
+    const TinyCLR_Can_Controller* Can;
+
+    // Called by CanLogger_FrameHandler after the frame is logged, so the receive hook can still be shared
+    CanLogger_ChainedFrameHandler NextHandler;
+    void* NextContext;
+};
+
+struct CanLogger_Status {
+    bool Running;
+
+    uint64_t CapturedFrames;
+    uint64_t DroppedFrames;
+    uint64_t WrittenBlocks;
+    uint64_t WriteErrors;
+
+    uint64_t NextAddress;
+};
+
+struct CanLogger {
+    CanLogger_Configuration configuration;
+
+    // Headers are kept here and copied into the block when it is written, the buffer need not be aligned
+    size_t blockSize;
+    uint8_t* block[2];
+    CanLogger_BlockHeader header[2];
+    bool pending[2];
+    size_t fillIndex;
+
+    bool running;
+    uint32_t sequence;
+    uint64_t nextAddress;
+
+    uint64_t capturedFrames;
+    uint64_t droppedFrames;
+    uint64_t writtenBlocks;
+    uint64_t writeErrors;
+};
+
+TinyCLR_Result CanLogger_Initialize(CanLogger& logger, const CanLogger_Configuration& configuration);
+TinyCLR_Result CanLogger_Start(CanLogger& logger);
+TinyCLR_Result CanLogger_Stop(CanLogger& logger);
+void CanLogger_GetStatus(CanLogger& logger, CanLogger_Status& status);
+
+// Safe to call from interrupt context, returns false when the frame was dropped
+bool CanLogger_Capture(CanLogger& logger, const TinyCLR_Can_Message& message, uint64_t timestamp);
+
+// Matches the targets' <Target>_Can_SetFrameHandler hook. The frame is only observed and still reaches the
+// read buffer unless NextHandler consumes it.
+bool CanLogger_FrameHandler(const TinyCLR_Can_Message& message, uint64_t timestamp, void* context);
+
+// Writes full blocks, called from thread context while running
+TinyCLR_Result CanLogger_Process(CanLogger& logger);
+
+typedef void(*CanLogger_RecordHandler)(const TinyCLR_Can_Message& message, void* context);
+
+// Validates a block read back from storage and reports its frames in order. Erased or foreign blocks
+// return ArgumentInvalid.
+TinyCLR_Result CanLogger_DecodeBlock(const uint8_t* data, size_t size, CanLogger_BlockHeader& header, CanLogger_RecordHandler handler, void* context);
@@ -0,0 +1,79 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include "CanStatistics.h"
+
+// Nominal frame length from start of frame through the interframe space. Stuff bits depend on the
+// data and are not counted, so the load reads slightly low on busy buses.
+static uint32_t CanStatistics_GetFrameBits(bool extendedId, bool remoteTransmissionRequest, uint32_t length) {
+    auto bits = extendedId ? 67 : 47;
+
+    if (!remoteTransmissionRequest)
+        bits += 8 * (length > 8 ? 8 : length);
+
+    return bits;
+}
+
+void CanStatistics_Reset(CanStatistics& statistics, uint64_t now) {
+    auto bitRate = statistics.BitRate;
+    auto errorState = statistics.ErrorState;
+
+    memset(&statistics, 0, sizeof(statistics));
+
+    statistics.BitRate = bitRate;
+    statistics.ErrorState = errorState;
+    statistics.WindowStart = now;
+}
+
+void CanStatistics_SetBitTiming(CanStatistics& statistics, uint32_t sourceClock, const TinyCLR_Can_BitTiming* timing) {
+    auto quanta = timing->BaudratePrescaler * (1 + timing->Propagation + timing->Phase1 + timing->Phase2);
+
+    statistics.BitRate = quanta > 0 ? sourceClock / quanta : 0;
+}
+
+void CanStatistics_Update(CanStatistics& statistics, uint64_t now) {
+    auto elapsed = now - statistics.WindowStart;
+
+    if (elapsed < CAN_STATISTICS_BUS_LOAD_WINDOW)
+        return;
+
+    if (statistics.BitRate > 0) {
+        auto load = (statistics.WindowBits * 100 * 10000000) / (elapsed * statistics.BitRate);
+
+        statistics.BusLoad = load > 100 ? 100 : static_cast<uint32_t>(load);
+    }
+
+    statistics.WindowStart = now;
+    statistics.WindowBits = 0;
+}
+
+void CanStatistics_AddFrame(CanStatistics& statistics, uint64_t now, bool extendedId, bool remoteTransmissionRequest, uint32_t length) {
+    CanStatistics_Update(statistics, now);
+
+    statistics.WindowBits += CanStatistics_GetFrameBits(extendedId, remoteTransmissionRequest, length);
+}
+
+void CanStatistics_SetErrorState(CanStatistics& statistics, uint64_t now, CanStatistics_ErrorState errorState) {
+    if (errorState == statistics.ErrorState)
+        return;
+
+    auto& transition = statistics.ErrorTransitions[statistics.ErrorTransitionCount % CAN_STATISTICS_ERROR_HISTORY_SIZE];
+
+    transition.Time = now;
+    transition.State = errorState;
+
+    statistics.ErrorTransitionCount++;
+    statistics.ErrorState = errorState;
+}
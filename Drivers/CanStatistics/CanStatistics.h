@@ -0,0 +1,49 @@
+#pragma once
+
+#include <TinyCLR.h>
+
+#define CAN_STATISTICS_ERROR_HISTORY_SIZE 8
+
+// Bus load is computed over windows of at least this many system ticks (100ns)
+#define CAN_STATISTICS_BUS_LOAD_WINDOW (1000 * 10000)
+
+enum class CanStatistics_ErrorState : uint32_t {
+    Active = 0,
+    Warning = 1,
+    Passive = 2,
+    BusOff = 3,
+};
+
+struct CanStatistics_ErrorTransition {
+    uint64_t Time;
+    CanStatistics_ErrorState State;
+};
+
+struct CanStatistics {
+    uint64_t ReceivedFrames;    // Every frame past the hardware filter banks, accepted by the software filter or not
+    uint64_t TransmittedFrames;
+    uint64_t FilteredFrames;    // Dropped by the software acceptance filter
+    uint64_t OverflowFrames;    // Received while the read buffer was full
+    uint64_t ArbitrationLost;
+
+    CanStatistics_ErrorState ErrorState;
+
+    // Ring of the latest transitions, the newest is at (ErrorTransitionCount - 1) % CAN_STATISTICS_ERROR_HISTORY_SIZE
+    size_t ErrorTransitionCount;
+    CanStatistics_ErrorTransition ErrorTransitions[CAN_STATISTICS_ERROR_HISTORY_SIZE];
+
+    // Percent of the last complete window taken by frames this node received from the controller or
+    // transmitted. Frames rejected by hardware filters are never seen, so with hardware filtering active
+    // this is the load of accepted + transmitted frames, not of the whole bus.
+    uint32_t BusLoad;
+    uint32_t BitRate;
+
+    uint64_t WindowStart;
+    uint64_t WindowBits;
+};
+
+void CanStatistics_Reset(CanStatistics& statistics, uint64_t now);
+void CanStatistics_SetBitTiming(CanStatistics& statistics, uint32_t sourceClock, const TinyCLR_Can_BitTiming* timing);
+void CanStatistics_AddFrame(CanStatistics& statistics, uint64_t now, bool extendedId, bool remoteTransmissionRequest, uint32_t length);
+void CanStatistics_SetErrorState(CanStatistics& statistics, uint64_t now, CanStatistics_ErrorState errorState);
+void CanStatistics_Update(CanStatistics& statistics, uint64_t now);
@@ -160,25 +160,32 @@ TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR
     return api->Disable(api);
 }
 
-TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR_Devices_Can_Provider_CanControllerApiWrapper::WriteMessages___I4__SZARRAY_GHIElectronicsTinyCLRDevicesCanCanMessage__I4__I4(const TinyCLR_Interop_MethodData md) {
-    uint8_t* data;
+static TinyCLR_Can_Message* TinyCLR_Can_AllocateMessages(int32_t count) {
+    extern const TinyCLR_Api_Manager* apiManager;
+
+    auto memoryManager = reinterpret_cast<const TinyCLR_Memory_Manager*>(apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager));
+
+    return reinterpret_cast<TinyCLR_Can_Message*>(memoryManager->Allocate(memoryManager, count * sizeof(TinyCLR_Can_Message)));
+}
+
+static void TinyCLR_Can_FreeMessages(TinyCLR_Can_Message* messages) {
+    extern const TinyCLR_Api_Manager* apiManager;
 
-    uint32_t arbID;
+    auto memoryManager = reinterpret_cast<const TinyCLR_Memory_Manager*>(apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager));
 
-    bool extendedId;
-    bool remoteTransmissionRequest;
+    memoryManager->Free(memoryManager, messages);
+}
 
-    size_t length;
+TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR_Devices_Can_Provider_CanControllerApiWrapper::WriteMessages___I4__SZARRAY_GHIElectronicsTinyCLRDevicesCanCanMessage__I4__I4(const TinyCLR_Interop_MethodData md) {
+    uint8_t* data;
 
     int32_t offset;
     int32_t count;
-    int32_t sent = 0;
 
     const TinyCLR_Interop_ClrObject* msgObj;
 
     TinyCLR_Interop_ClrValue managedValueMessages, managedValueOffset, managedValueCount, ret;
     TinyCLR_Interop_ClrValue fldData, fldarbID, fldLen, fldRtr, fldEid;
-    TinyCLR_Can_Message message;
 
     md.InteropManager->GetArgument(md.InteropManager, md.Stack, 0, managedValueMessages);
     md.InteropManager->GetArgument(md.InteropManager, md.Stack, 1, managedValueOffset);
@@ -189,19 +196,24 @@ TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR
     offset = managedValueOffset.Data.Numeric->I4;
     count = managedValueCount.Data.Numeric->I4;
 
-    auto msgArray = reinterpret_cast<TinyCLR_Interop_ClrObjectReference*>(managedValueMessages.Data.SzArray.Data);
+    ret.Data.Numeric->I4 = 0;
+
+    if (count <= 0)
+        return TinyCLR_Result::Success;
+
+    auto msgArray = reinterpret_cast<TinyCLR_Interop_ClrObjectReference*>(managedValueMessages.Data.SzArray.Data) + offset;
 
     auto api = reinterpret_cast<const TinyCLR_Can_Controller*>(TinyCLR_Interop_GetApi(md, FIELD___impl___I));
 
-    int i = 0;
+    auto messages = TinyCLR_Can_AllocateMessages(count);
 
-    while (i < offset) {
-        i++;
-        msgArray++;
-    }
+    if (messages == nullptr)
+        return TinyCLR_Result::OutOfMemory;
 
-    for (i = 0; i < count; i++) {
-        md.InteropManager->ExtractObjectFromReference(md.InteropManager, msgArray, msgObj);
+    for (auto i = 0; i < count; i++) {
+        auto& message = messages[i];
+
+        md.InteropManager->ExtractObjectFromReference(md.InteropManager, &msgArray[i], msgObj);
 
         md.InteropManager->GetField(md.InteropManager, msgObj, Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR_Devices_Can_CanMessage::FIELD___data___SZARRAY_U1, fldData);
         md.InteropManager->GetField(md.InteropManager, msgObj, Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR_Devices_Can_CanMessage::FIELD___ArbitrationId__BackingField___I4, fldarbID);
@@ -219,14 +231,14 @@ TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR
 
         for (auto j = 0; j < message.Length; j++)
             message.Data[j] = data[j];
+    }
 
-        size_t len = 1;
-        if (api->WriteMessage(api, &message, len) != TinyCLR_Result::Success || len != 1)
-            break;
+    size_t sent = count;
 
-        msgArray++;
-        sent++;
-    }
+    if (api->WriteMessage(api, messages, sent) != TinyCLR_Result::Success)
+        sent = 0;
+
+    TinyCLR_Can_FreeMessages(messages);
 
     ret.Data.Numeric->I4 = sent;
 
@@ -236,23 +248,13 @@ TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR
 TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR_Devices_Can_Provider_CanControllerApiWrapper::ReadMessages___I4__SZARRAY_GHIElectronicsTinyCLRDevicesCanCanMessage__I4__I4(const TinyCLR_Interop_MethodData md) {
     uint8_t* data;
 
-    uint32_t arbID;
-    size_t length;
-
-    bool extendedId;
-    bool remoteTransmissionRequest;
-
-    uint64_t ts;
-
     int32_t offset;
     int32_t count;
-    int32_t sent = 0;
 
     const TinyCLR_Interop_ClrObject* msgObj;
 
     TinyCLR_Interop_ClrValue managedValueMessages, managedValueOffset, managedValueCount, ret;
     TinyCLR_Interop_ClrValue fldData, fldarbID, fldLen, fldRtr, fldEid, fldts;
-    TinyCLR_Can_Message message;
 
     md.InteropManager->GetArgument(md.InteropManager, md.Stack, 0, managedValueMessages);
     md.InteropManager->GetArgument(md.InteropManager, md.Stack, 1, managedValueOffset);
@@ -263,26 +265,34 @@ TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR
     offset = managedValueOffset.Data.Numeric->I4;
     count = managedValueCount.Data.Numeric->I4;
 
-    auto msgArray = reinterpret_cast<TinyCLR_Interop_ClrObjectReference*>(managedValueMessages.Data.SzArray.Data);
+    ret.Data.Numeric->I4 = 0;
 
-    auto api = reinterpret_cast<const TinyCLR_Can_Controller*>(TinyCLR_Interop_GetApi(md, FIELD___impl___I));
+    auto msgArray = reinterpret_cast<TinyCLR_Interop_ClrObjectReference*>(managedValueMessages.Data.SzArray.Data) + offset;
 
-    auto availableMsgCount = api->GetMessagesToRead(api);
+    auto api = reinterpret_cast<const TinyCLR_Can_Controller*>(TinyCLR_Interop_GetApi(md, FIELD___impl___I));
 
-    int32_t read = 0;
+    int32_t availableMsgCount = api->GetMessagesToRead(api);
 
     if (availableMsgCount > count)
         availableMsgCount = count;
 
-    int i = 0;
+    if (availableMsgCount <= 0)
+        return TinyCLR_Result::Success;
 
-    while (i < offset) {
-        i++;
-        msgArray++;
-    }
+    auto messages = TinyCLR_Can_AllocateMessages(availableMsgCount);
 
-    for (i = 0; i < availableMsgCount; i++) {
-        md.InteropManager->ExtractObjectFromReference(md.InteropManager, msgArray, msgObj);
+    if (messages == nullptr)
+        return TinyCLR_Result::OutOfMemory;
+
+    size_t read = availableMsgCount;
+
+    if (api->ReadMessage(api, messages, read) != TinyCLR_Result::Success)
+        read = 0;
+
+    for (size_t i = 0; i < read; i++) {
+        auto& message = messages[i];
+
+        md.InteropManager->ExtractObjectFromReference(md.InteropManager, &msgArray[i], msgObj);
 
         md.InteropManager->GetField(md.InteropManager, msgObj, Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR_Devices_Can_CanMessage::FIELD___data___SZARRAY_U1, fldData);
         md.InteropManager->GetField(md.InteropManager, msgObj, Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR_Devices_Can_CanMessage::FIELD___ArbitrationId__BackingField___I4, fldarbID);
@@ -293,10 +303,6 @@ TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR
 
         data = reinterpret_cast<uint8_t*>(fldData.Data.SzArray.Data);
 
-        size_t len = 1;
-        if (api->ReadMessage(api, &message, len) != TinyCLR_Result::Success || len != 1)
-            break;
-
         for (auto j = 0; j < message.Length; j++)
             data[j] = message.Data[j];
 
@@ -305,11 +311,10 @@ TinyCLR_Result Interop_GHIElectronics_TinyCLR_Devices_Can_GHIElectronics_TinyCLR
         fldRtr.Data.Numeric->Boolean = message.IsRemoteTransmissionRequest;
         fldEid.Data.Numeric->Boolean = message.IsExtendedId;
         fldts.Data.Numeric->I8 = message.Timestamp;
-
-        read++;
-        msgArray++;
     }
 
+    TinyCLR_Can_FreeMessages(messages);
+
     ret.Data.Numeric->I4 = read;
 
     return TinyCLR_Result::Success;
@@ -0,0 +1,443 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <string.h>
+#include "DisplayBenchmark.h"
+
+#define DISPLAY_BENCHMARK_SHAPE_COUNT 5
+#define DISPLAY_BENCHMARK_FORMAT_COUNT 4
+#define DISPLAY_BENCHMARK_ORIENTATION_COUNT 4
+
+#define DISPLAY_BENCHMARK_FNV_OFFSET 0x811C9DC5
+#define DISPLAY_BENCHMARK_FNV_PRIME 0x01000193
+
+static bool DisplayBenchmark_IsRotated(DisplayRotation_Orientation orientation) {
+    return orientation == DisplayRotation_Orientation::Clockwise90 || orientation == DisplayRotation_Orientation::CounterClockwise90;
+}
+
+uint16_t DisplayBenchmark_GetPattern(uint32_t x, uint32_t y) {
+    auto value = x * 2654435761U ^ (y + 0x9E3779B9) * 40503U;
+
+    return static_cast<uint16_t>(value ^ (value >> 16));
+}
+
+static bool DisplayBenchmark_GetRectangle(DisplayBenchmark_Shape shape, uint32_t width, uint32_t height, uint32_t& x, uint32_t& y, uint32_t& rectangleWidth, uint32_t& rectangleHeight) {
+    switch (shape) {
+    case DisplayBenchmark_Shape::FullScreen:
+        x = 0;
+        y = 0;
+        rectangleWidth = width;
+        rectangleHeight = height;
+        break;
+
+    case DisplayBenchmark_Shape::Half:
+        x = width / 4;
+        y = height / 4;
+        rectangleWidth = width / 2;
+        rectangleHeight = height / 2;
+        break;
+
+    case DisplayBenchmark_Shape::Unaligned:
+        // Odd sizes at odd positions take the edge paths of the copy and rotation kernels
+        x = 3;
+        y = 5;
+        rectangleWidth = width > 40 ? 37 : width - 3;
+        rectangleHeight = height > 28 ? 23 : height - 5;
+        break;
+
+    case DisplayBenchmark_Shape::Row:
+        x = 0;
+        y = height / 2;
+        rectangleWidth = width;
+        rectangleHeight = 1;
+        break;
+
+    case DisplayBenchmark_Shape::Column:
+        x = width / 2;
+        y = 0;
+        rectangleWidth = 1;
+        rectangleHeight = height;
+        break;
+
+    default:
+        return false;
+    }
+
+    return x < width && y < height && rectangleWidth > 0 && rectangleHeight > 0 && rectangleWidth <= width - x && rectangleHeight <= height - y;
+}
+
+// Unrotated sources hold the rectangle alone, rotated ones a whole screen as the drivers expect
+static void DisplayBenchmark_FillSource(uint16_t* source, bool rotated, uint32_t width, uint32_t x, uint32_t y, uint32_t rectangleWidth, uint32_t rectangleHeight) {
+    for (auto row = y; row < y + rectangleHeight; row++) {
+        auto to = rotated ? source + row * width + x : source + (row - y) * rectangleWidth;
+
+        for (auto column = x; column < x + rectangleWidth; column++)
+            *to++ = DisplayBenchmark_GetPattern(column, row);
+    }
+}
+
+static TinyCLR_Result DisplayBenchmark_SetMode(const DisplayBenchmark_Configuration& configuration, DisplayRotation_Orientation orientation, DisplayFormat_PixelFormat format) {
+    auto display = configuration.Display;
+
+    if (configuration.SetPixelFormat != nullptr) {
+        auto result = display->Disable(display);
+
+        if (result == TinyCLR_Result::Success)
+            result = configuration.SetPixelFormat(configuration.Context, format);
+
+        if (result != TinyCLR_Result::Success)
+            return result;
+
+        result = display->Enable(display);
+
+        if (result != TinyCLR_Result::Success)
+            return result;
+    }
+
+    if (configuration.SetOrientation != nullptr)
+        return configuration.SetOrientation(configuration.Context, orientation);
+
+    return TinyCLR_Result::Success;
+}
+
+static void DisplayBenchmark_Check(const DisplayBenchmark_Configuration& configuration, DisplayBenchmark_Result& result) {
+    auto frameBuffer = configuration.GetFrameBuffer(configuration.Context);
+    auto bytesPerPixel = DisplayFormat_GetBytesPerPixel(result.Format);
+    auto rotated = DisplayBenchmark_IsRotated(result.Orientation);
+    auto width = rotated ? configuration.Height : configuration.Width;
+    auto height = rotated ? configuration.Width : configuration.Height;
+
+    // The rectangle and the line of pixels around it that must still be background
+    auto left = result.X > 0 ? result.X - 1 : 0;
+    auto top = result.Y > 0 ? result.Y - 1 : 0;
+    auto right = result.X + result.Width < width ? result.X + result.Width + 1 : width;
+    auto bottom = result.Y + result.Height < height ? result.Y + result.Height + 1 : height;
+
+    result.Mismatches = 0;
+
+    for (auto y = top; y < bottom; y++) {
+        for (auto x = left; x < right; x++) {
+            uint8_t expected[4];
+
+            if (x >= result.X && x < result.X + result.Width && y >= result.Y && y < result.Y + result.Height) {
+                auto pattern = DisplayBenchmark_GetPattern(x, y);
+                uint8_t source[2] = { static_cast<uint8_t>(pattern), static_cast<uint8_t>(pattern >> 8) };
+
+                DisplayFormat_WritePixel(expected, result.Format, DisplayFormat_ReadPixel(source, DisplayFormat_PixelFormat::Rgb565, nullptr));
+            }
+            else {
+                memset(expected, DISPLAY_BENCHMARK_BACKGROUND, sizeof(expected));
+            }
+
+            int32_t physicalX, physicalY;
+
+            DisplayRotation_GetPhysical(result.Orientation, configuration.Width, configuration.Height, x, y, physicalX, physicalY);
+
+            if (memcmp(frameBuffer + (physicalY * configuration.Width + physicalX) * bytesPerPixel, expected, bytesPerPixel) != 0)
+                result.Mismatches++;
+        }
+    }
+
+    auto checksum = static_cast<uint32_t>(DISPLAY_BENCHMARK_FNV_OFFSET);
+    auto size = static_cast<size_t>(configuration.Width) * configuration.Height * bytesPerPixel;
+
+    for (size_t i = 0; i < size; i++)
+        checksum = (checksum ^ frameBuffer[i]) * DISPLAY_BENCHMARK_FNV_PRIME;
+
+    result.Checksum = checksum;
+    result.Checked = true;
+}
+
+TinyCLR_Result DisplayBenchmark_Run(const DisplayBenchmark_Configuration& configuration, DisplayRotation_Orientation orientation, DisplayFormat_PixelFormat format, DisplayBenchmark_Shape shape, DisplayBenchmark_Result& result) {
+    auto display = configuration.Display;
+    auto time = configuration.Time;
+    auto bytesPerPixel = DisplayFormat_GetBytesPerPixel(format);
+
+    if (display == nullptr || time == nullptr || configuration.Buffer == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (configuration.Width == 0 || configuration.Height == 0 || configuration.Iterations == 0 || bytesPerPixel == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    if (configuration.BufferSize < static_cast<size_t>(configuration.Width) * configuration.Height * 2)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    if ((orientation != DisplayRotation_Orientation::Normal && configuration.SetOrientation == nullptr) || (format != DisplayFormat_PixelFormat::Rgb565 && configuration.SetPixelFormat == nullptr))
+        return TinyCLR_Result::NotSupported;
+
+    memset(&result, 0, sizeof(result));
+
+    result.Orientation = orientation;
+    result.Format = format;
+    result.Shape = shape;
+    result.Iterations = configuration.Iterations;
+
+    auto rotated = DisplayBenchmark_IsRotated(orientation);
+    auto width = rotated ? configuration.Height : configuration.Width;
+    auto height = rotated ? configuration.Width : configuration.Height;
+
+    if (!DisplayBenchmark_GetRectangle(shape, width, height, result.X, result.Y, result.Width, result.Height))
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    auto status = DisplayBenchmark_SetMode(configuration, orientation, format);
+
+    if (status != TinyCLR_Result::Success)
+        return status;
+
+    DisplayBenchmark_FillSource(reinterpret_cast<uint16_t*>(configuration.Buffer), orientation != DisplayRotation_Orientation::Normal, width, result.X, result.Y, result.Width, result.Height);
+
+    if (configuration.WaitForCompletion != nullptr)
+        configuration.WaitForCompletion(configuration.Context);
+
+    if (configuration.GetFrameBuffer != nullptr)
+        memset(configuration.GetFrameBuffer(configuration.Context), DISPLAY_BENCHMARK_BACKGROUND, static_cast<size_t>(configuration.Width) * configuration.Height * bytesPerPixel);
+
+    auto start = time->GetNativeTime(time);
+
+    for (size_t i = 0; i < configuration.Iterations; i++) {
+        status = display->DrawBuffer(display, result.X, result.Y, result.Width, result.Height, configuration.Buffer);
+
+        if (status != TinyCLR_Result::Success)
+            return status;
+    }
+
+    if (configuration.WaitForCompletion != nullptr)
+        configuration.WaitForCompletion(configuration.Context);
+
+    result.ElapsedTime = time->ConvertNativeTimeToSystemTime(time, time->GetNativeTime(time) - start);
+    result.Pixels = static_cast<uint64_t>(result.Width) * result.Height * configuration.Iterations;
+
+    // System ticks are 100ns
+    if (result.ElapsedTime > 0)
+        result.PixelsPerMicrosecond = static_cast<uint32_t>(result.Pixels * 10 * DISPLAY_BENCHMARK_RATE_SCALE / result.ElapsedTime);
+
+    if (configuration.GetFrameBuffer != nullptr)
+        DisplayBenchmark_Check(configuration, result);
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result DisplayBenchmark_RunSuite(const DisplayBenchmark_Configuration& configuration, DisplayBenchmark_ReportHandler handler, void* context) {
+    auto status = TinyCLR_Result::Success;
+
+    for (uint32_t orientation = 0; orientation < DISPLAY_BENCHMARK_ORIENTATION_COUNT && status == TinyCLR_Result::Success; orientation++) {
+        if (orientation != 0 && configuration.SetOrientation == nullptr)
+            break;
+
+        for (uint32_t format = 0; format < DISPLAY_BENCHMARK_FORMAT_COUNT && status == TinyCLR_Result::Success; format++) {
+            if (format != 0 && configuration.SetPixelFormat == nullptr)
+                break;
+
+            for (uint32_t shape = 0; shape < DISPLAY_BENCHMARK_SHAPE_COUNT; shape++) {
+                DisplayBenchmark_Result result;
+
+                status = DisplayBenchmark_Run(configuration, static_cast<DisplayRotation_Orientation>(orientation), static_cast<DisplayFormat_PixelFormat>(format), static_cast<DisplayBenchmark_Shape>(shape), result);
+
+                // Shapes that don't fit a small panel are left out
+                if (status == TinyCLR_Result::ArgumentOutOfRange) {
+                    status = TinyCLR_Result::Success;
+
+                    continue;
+                }
+
+                if (status != TinyCLR_Result::Success)
+                    break;
+
+                handler(result, context);
+            }
+        }
+    }
+
+    auto restore = DisplayBenchmark_SetMode(configuration, DisplayRotation_Orientation::Normal, DisplayFormat_PixelFormat::Rgb565);
+
+    return status != TinyCLR_Result::Success ? status : restore;
+}
+
+static DisplayBenchmark_Framebuffer* DisplayBenchmark_Framebuffer_Get(const TinyCLR_Display_Controller* self) {
+    return reinterpret_cast<DisplayBenchmark_Framebuffer*>(self->ApiInfo->State);
+}
+
+static uint8_t* DisplayBenchmark_Framebuffer_GetPixelAddress(DisplayBenchmark_Framebuffer* framebuffer, uint32_t x, uint32_t y) {
+    return framebuffer->memory + (y * framebuffer->width + x) * DisplayFormat_GetBytesPerPixel(framebuffer->format);
+}
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_Acquire(const TinyCLR_Display_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_Release(const TinyCLR_Display_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_Enable(const TinyCLR_Display_Controller* self) {
+    DisplayBenchmark_Framebuffer_Get(self)->enabled = true;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_Disable(const TinyCLR_Display_Controller* self) {
+    DisplayBenchmark_Framebuffer_Get(self)->enabled = false;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_SetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat dataFormat, uint32_t width, uint32_t height, const void* configuration) {
+    auto framebuffer = DisplayBenchmark_Framebuffer_Get(self);
+
+    if (dataFormat != TinyCLR_Display_DataFormat::Rgb565)
+        return TinyCLR_Result::NotSupported;
+
+    return width == framebuffer->width && height == framebuffer->height ? TinyCLR_Result::Success : TinyCLR_Result::ArgumentInvalid;
+}
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_GetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat& dataFormat, uint32_t& width, uint32_t& height, void* configuration) {
+    auto framebuffer = DisplayBenchmark_Framebuffer_Get(self);
+
+    dataFormat = TinyCLR_Display_DataFormat::Rgb565;
+    width = framebuffer->width;
+    height = framebuffer->height;
+
+    return TinyCLR_Result::Success;
+}
+
+static const TinyCLR_Display_DataFormat displayBenchmarkDataFormats[] = { TinyCLR_Display_DataFormat::Rgb565 };
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_GetCapabilities(const TinyCLR_Display_Controller* self, TinyCLR_Display_InterfaceType& type, const TinyCLR_Display_DataFormat*& supportedDataFormats, size_t& supportedDataFormatCount) {
+    type = TinyCLR_Display_InterfaceType::Parallel;
+    supportedDataFormats = displayBenchmarkDataFormats;
+    supportedDataFormatCount = sizeof(displayBenchmarkDataFormats) / sizeof(displayBenchmarkDataFormats[0]);
+
+    return TinyCLR_Result::Success;
+}
+
+// Takes the same paths as the drivers' BitBltEx and BitBltConvert, without DMA2D
+static TinyCLR_Result DisplayBenchmark_Framebuffer_DrawBuffer(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data) {
+    auto framebuffer = DisplayBenchmark_Framebuffer_Get(self);
+    auto orientation = framebuffer->orientation;
+    auto format = framebuffer->format;
+    auto screenWidth = framebuffer->width;
+    auto screenHeight = framebuffer->height;
+    auto logicalWidth = DisplayBenchmark_IsRotated(orientation) ? screenHeight : screenWidth;
+    auto logicalHeight = DisplayBenchmark_IsRotated(orientation) ? screenWidth : screenHeight;
+
+    if (!framebuffer->enabled)
+        return TinyCLR_Result::InvalidOperation;
+
+    if (x >= logicalWidth || y >= logicalHeight || width > logicalWidth - x || height > logicalHeight - y)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    if (format == DisplayFormat_PixelFormat::Rgb565)
+        DisplayRotation_Draw(orientation, reinterpret_cast<const uint16_t*>(data), reinterpret_cast<uint16_t*>(framebuffer->memory), screenWidth, screenHeight, x, y, width, height);
+    else if (orientation == DisplayRotation_Orientation::Normal)
+        DisplayFormat_Convert(data, DisplayFormat_PixelFormat::Rgb565, width * 2, DisplayBenchmark_Framebuffer_GetPixelAddress(framebuffer, x, y), format, screenWidth * DisplayFormat_GetBytesPerPixel(format), width, height, framebuffer->palette);
+    else
+        DisplayFormat_ConvertRotated(data, DisplayFormat_PixelFormat::Rgb565, framebuffer->memory, format, orientation, screenWidth, screenHeight, x, y, width, height, framebuffer->palette);
+
+    return TinyCLR_Result::Success;
+}
+
+// Frame buffer coordinates and a raw value, as on the targets
+static TinyCLR_Result DisplayBenchmark_Framebuffer_DrawPixel(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint64_t color) {
+    auto framebuffer = DisplayBenchmark_Framebuffer_Get(self);
+
+    if (!framebuffer->enabled || x >= framebuffer->width || y >= framebuffer->height)
+        return TinyCLR_Result::InvalidOperation;
+
+    DisplayFormat_StorePixel(DisplayBenchmark_Framebuffer_GetPixelAddress(framebuffer, x, y), framebuffer->format, static_cast<uint32_t>(color));
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_DrawString(const TinyCLR_Display_Controller* self, const char* data, size_t length) {
+    return TinyCLR_Result::NotSupported;
+}
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_SetOrientation(void* context, DisplayRotation_Orientation orientation) {
+    if (static_cast<uint32_t>(orientation) >= DISPLAY_BENCHMARK_ORIENTATION_COUNT)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    reinterpret_cast<DisplayBenchmark_Framebuffer*>(context)->orientation = orientation;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result DisplayBenchmark_Framebuffer_SetPixelFormat(void* context, DisplayFormat_PixelFormat format) {
+    auto framebuffer = reinterpret_cast<DisplayBenchmark_Framebuffer*>(context);
+
+    if (DisplayFormat_GetBytesPerPixel(format) == 0)
+        return TinyCLR_Result::NotSupported;
+
+    if (framebuffer->enabled)
+        return TinyCLR_Result::InvalidOperation;
+
+    framebuffer->format = format;
+
+    return TinyCLR_Result::Success;
+}
+
+static uint8_t* DisplayBenchmark_Framebuffer_GetFrameBuffer(void* context) {
+    return reinterpret_cast<DisplayBenchmark_Framebuffer*>(context)->memory;
+}
+
+TinyCLR_Result DisplayBenchmark_Framebuffer_Initialize(DisplayBenchmark_Framebuffer& framebuffer, uint8_t* memory, uint32_t width, uint32_t height) {
+    if (memory == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (width == 0 || height == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    memset(&framebuffer, 0, sizeof(framebuffer));
+
+    framebuffer.memory = memory;
+    framebuffer.width = width;
+    framebuffer.height = height;
+    framebuffer.orientation = DisplayRotation_Orientation::Normal;
+    framebuffer.format = DisplayFormat_PixelFormat::Rgb565;
+
+    DisplayFormat_GetDefaultPalette(framebuffer.palette);
+
+    framebuffer.controller.ApiInfo = &framebuffer.api;
+    framebuffer.controller.Acquire = &DisplayBenchmark_Framebuffer_Acquire;
+    framebuffer.controller.Release = &DisplayBenchmark_Framebuffer_Release;
+    framebuffer.controller.Enable = &DisplayBenchmark_Framebuffer_Enable;
+    framebuffer.controller.Disable = &DisplayBenchmark_Framebuffer_Disable;
+    framebuffer.controller.SetConfiguration = &DisplayBenchmark_Framebuffer_SetConfiguration;
+    framebuffer.controller.GetConfiguration = &DisplayBenchmark_Framebuffer_GetConfiguration;
+    framebuffer.controller.GetCapabilities = &DisplayBenchmark_Framebuffer_GetCapabilities;
+    framebuffer.controller.DrawBuffer = &DisplayBenchmark_Framebuffer_DrawBuffer;
+    framebuffer.controller.DrawPixel = &DisplayBenchmark_Framebuffer_DrawPixel;
+    framebuffer.controller.DrawString = &DisplayBenchmark_Framebuffer_DrawString;
+
+    framebuffer.api.Author = "GHI Electronics, LLC";
+    framebuffer.api.Name = "GHIElectronics.TinyCLR.NativeApis.DisplayBenchmark.FramebufferController";
+    framebuffer.api.Type = TinyCLR_Api_Type::DisplayController;
+    framebuffer.api.Version = 0;
+    framebuffer.api.Implementation = &framebuffer.controller;
+    framebuffer.api.State = &framebuffer;
+
+    return TinyCLR_Result::Success;
+}
+
+void DisplayBenchmark_Framebuffer_Attach(DisplayBenchmark_Framebuffer& framebuffer, DisplayBenchmark_Configuration& configuration) {
+    configuration.Display = &framebuffer.controller;
+    configuration.Width = framebuffer.width;
+    configuration.Height = framebuffer.height;
+
+    configuration.Context = &framebuffer;
+    configuration.SetOrientation = &DisplayBenchmark_Framebuffer_SetOrientation;
+    configuration.SetPixelFormat = &DisplayBenchmark_Framebuffer_SetPixelFormat;
+    configuration.GetFrameBuffer = &DisplayBenchmark_Framebuffer_GetFrameBuffer;
+    configuration.WaitForCompletion = nullptr;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <TinyCLR.h>
+#include "../DisplayRotation/DisplayRotation.h"
+#include "../DisplayFormat/DisplayFormat.h"
+
+// Rates are pixels per microsecond times this
+#define DISPLAY_BENCHMARK_RATE_SCALE 100
+
+// Written over the frame buffer before each case, so that pixels outside the drawn rectangle can be checked
+#define DISPLAY_BENCHMARK_BACKGROUND 0x5A
+
+enum class DisplayBenchmark_Shape : uint32_t {
+    FullScreen = 0,
+    Half = 1,
+    Unaligned = 2,
+    Row = 3,
+    Column = 4,
+};
+
+// Display is enabled and configured for Width x Height, the panel size. Buffer takes the source, Width * Height
+// Rgb565 pixels. The optional functions are the target's native display APIs, wrapped to take Context:
+// orientations other than Normal need SetOrientation, frame buffer formats other than Rgb565 need SetPixelFormat,
+// which is called with the display disabled, and the golden checks need GetFrameBuffer.
+struct DisplayBenchmark_Configuration {
+    const TinyCLR_Display_Controller* Display;
+    const TinyCLR_NativeTime_Controller* Time;
+
+    uint32_t Width;
+    uint32_t Height;
+
+    uint8_t* Buffer;
+    size_t BufferSize;
+
+    size_t Iterations;
+
+    void* Context;
+    TinyCLR_Result(*SetOrientation)(void* context, DisplayRotation_Orientation orientation);
+    TinyCLR_Result(*SetPixelFormat)(void* context, DisplayFormat_PixelFormat format);
+    uint8_t*(*GetFrameBuffer)(void* context);
+    void(*WaitForCompletion)(void* context);
+};
+
+// X, Y, Width and Height are the drawn rectangle in screen coordinates of the orientation. Times are in system
+// ticks (100ns). Checksum is FNV-1a over the frame buffer after the case, the same on every target for the same
+// case and panel size. Mismatches counts pixels that differ from the golden image, inside the rectangle and on
+// the line around it, and is only valid when Checked.
+struct DisplayBenchmark_Result {
+    DisplayRotation_Orientation Orientation;
+    DisplayFormat_PixelFormat Format;
+    DisplayBenchmark_Shape Shape;
+
+    uint32_t X;
+    uint32_t Y;
+    uint32_t Width;
+    uint32_t Height;
+
+    size_t Iterations;
+    uint64_t Pixels;
+    uint64_t ElapsedTime;
+    uint32_t PixelsPerMicrosecond;
+
+    bool Checked;
+    uint32_t Checksum;
+    uint32_t Mismatches;
+};
+
+typedef void(*DisplayBenchmark_ReportHandler)(const DisplayBenchmark_Result& result, void* context);
+
+// ArgumentOutOfRange when the shape doesn't fit the panel in that orientation
+TinyCLR_Result DisplayBenchmark_Run(const DisplayBenchmark_Configuration& configuration, DisplayRotation_Orientation orientation, DisplayFormat_PixelFormat format, DisplayBenchmark_Shape shape, DisplayBenchmark_Result& result);
+
+// Every shape in every orientation and format the configuration supports. Leaves the display in Normal and Rgb565.
+TinyCLR_Result DisplayBenchmark_RunSuite(const DisplayBenchmark_Configuration& configuration, DisplayBenchmark_ReportHandler handler, void* context);
+
+// The source pixel the benchmark draws at x, y in screen coordinates
+uint16_t DisplayBenchmark_GetPattern(uint32_t x, uint32_t y);
+
+// A display controller over a frame buffer in memory that draws through DisplayRotation_Draw,
+// DisplayFormat_Convert and DisplayFormat_ConvertRotated as the targets' drivers do when DMA2D isn't used, so the suite and its golden checks run on a host. Memory takes width * height pixels of the
+// largest format.
+struct DisplayBenchmark_Framebuffer {
+    TinyCLR_Display_Controller controller;
+    TinyCLR_Api_Info api;
+
+    uint8_t* memory;
+    uint32_t width;
+    uint32_t height;
+
+    DisplayRotation_Orientation orientation;
+    DisplayFormat_PixelFormat format;
+    uint32_t palette[DISPLAY_FORMAT_PALETTE_SIZE];
+
+    bool enabled;
+};
+
+TinyCLR_Result DisplayBenchmark_Framebuffer_Initialize(DisplayBenchmark_Framebuffer& framebuffer, uint8_t* memory, uint32_t width, uint32_t height);
+
+// Fills Display, Width, Height, Context and the native functions for the frame buffer
+void DisplayBenchmark_Framebuffer_Attach(DisplayBenchmark_Framebuffer& framebuffer, DisplayBenchmark_Configuration& configuration);
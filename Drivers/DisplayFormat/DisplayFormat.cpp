@@ -0,0 +1,306 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include "DisplayFormat.h"
+
+size_t DisplayFormat_GetBytesPerPixel(DisplayFormat_PixelFormat format) {
+    switch (format) {
+    case DisplayFormat_PixelFormat::Rgb565: return 2;
+    case DisplayFormat_PixelFormat::L8: return 1;
+    case DisplayFormat_PixelFormat::Rgb888: return 3;
+    case DisplayFormat_PixelFormat::Argb8888: return 4;
+    }
+
+    return 0;
+}
+
+static inline uint32_t DisplayFormat_Rgb565ToArgb8888(uint32_t color) {
+    auto r = (color >> 11) & 0x1F;
+    auto g = (color >> 5) & 0x3F;
+    auto b = color & 0x1F;
+
+    return 0xFF000000 | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+static inline uint32_t DisplayFormat_Argb8888ToRgb565(uint32_t color) {
+    return ((color >> 8) & 0xF800) | ((color >> 5) & 0x07E0) | ((color >> 3) & 0x001F);
+}
+
+static inline uint32_t DisplayFormat_Argb8888ToL8(uint32_t color) {
+    return ((color >> 16) & 0xE0) | ((color >> 11) & 0x1C) | ((color >> 6) & 0x03);
+}
+
+// Same as going through Argb8888, without the expansion
+static inline uint32_t DisplayFormat_Rgb565ToL8(uint32_t color) {
+    return ((color >> 8) & 0xE0) | ((color >> 6) & 0x1C) | ((color >> 3) & 0x03);
+}
+
+void DisplayFormat_GetDefaultPalette(uint32_t* palette) {
+    static const uint8_t levels3[8] = { 0x00, 0x24, 0x49, 0x6D, 0x92, 0xB6, 0xDB, 0xFF };
+    static const uint8_t levels2[4] = { 0x00, 0x55, 0xAA, 0xFF };
+
+    for (uint32_t i = 0; i < DISPLAY_FORMAT_PALETTE_SIZE; i++)
+        palette[i] = 0xFF000000 | (levels3[i >> 5] << 16) | (levels3[(i >> 2) & 0x07] << 8) | levels2[i & 0x03];
+}
+
+uint32_t DisplayFormat_ReadPixel(const uint8_t* pixel, DisplayFormat_PixelFormat format, const uint32_t* palette) {
+    switch (format) {
+    case DisplayFormat_PixelFormat::Rgb565: return DisplayFormat_Rgb565ToArgb8888(pixel[0] | (pixel[1] << 8));
+    case DisplayFormat_PixelFormat::L8: return palette[pixel[0]];
+    case DisplayFormat_PixelFormat::Rgb888: return 0xFF000000 | pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+    case DisplayFormat_PixelFormat::Argb8888: return pixel[0] | (pixel[1] << 8) | (pixel[2] << 16) | (static_cast<uint32_t>(pixel[3]) << 24);
+    }
+
+    return 0;
+}
+
+uint32_t DisplayFormat_FromArgb8888(DisplayFormat_PixelFormat format, uint32_t color) {
+    switch (format) {
+    case DisplayFormat_PixelFormat::Rgb565: return DisplayFormat_Argb8888ToRgb565(color);
+    case DisplayFormat_PixelFormat::L8: return DisplayFormat_Argb8888ToL8(color);
+    case DisplayFormat_PixelFormat::Rgb888: return color & 0x00FFFFFF;
+    case DisplayFormat_PixelFormat::Argb8888: return color;
+    }
+
+    return 0;
+}
+
+static inline void DisplayFormat_Store(uint8_t* pixel, size_t bytesPerPixel, uint32_t value) {
+    for (size_t i = 0; i < bytesPerPixel; i++) {
+        pixel[i] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+void DisplayFormat_WritePixel(uint8_t* pixel, DisplayFormat_PixelFormat format, uint32_t color) {
+    DisplayFormat_Store(pixel, DisplayFormat_GetBytesPerPixel(format), DisplayFormat_FromArgb8888(format, color));
+}
+
+void DisplayFormat_StorePixel(uint8_t* pixel, DisplayFormat_PixelFormat format, uint32_t value) {
+    DisplayFormat_Store(pixel, DisplayFormat_GetBytesPerPixel(format), value);
+}
+
+// The kernels for drawing Rgb565 data, the only format the managed side has, into the other frame buffers
+static void DisplayFormat_ConvertRgb565ToL8(const uint16_t* from, uint8_t* to, int32_t width) {
+    for (auto i = 0; i < width; i++)
+        to[i] = static_cast<uint8_t>(DisplayFormat_Rgb565ToL8(from[i]));
+}
+
+static void DisplayFormat_ConvertRgb565ToRgb888(const uint16_t* from, uint8_t* to, int32_t width) {
+    for (auto i = 0; i < width; i++) {
+        auto color = DisplayFormat_Rgb565ToArgb8888(from[i]);
+
+        to[0] = static_cast<uint8_t>(color);
+        to[1] = static_cast<uint8_t>(color >> 8);
+        to[2] = static_cast<uint8_t>(color >> 16);
+        to += 3;
+    }
+}
+
+static void DisplayFormat_ConvertRgb565ToArgb8888(const uint16_t* from, uint32_t* to, int32_t width) {
+    for (auto i = 0; i < width; i++)
+        to[i] = DisplayFormat_Rgb565ToArgb8888(from[i]);
+}
+
+static void DisplayFormat_ConvertL8(const uint8_t* from, uint8_t* to, DisplayFormat_PixelFormat toFormat, int32_t width, const uint32_t* palette) {
+    uint32_t lookup[DISPLAY_FORMAT_PALETTE_SIZE];
+    auto bytesPerPixel = DisplayFormat_GetBytesPerPixel(toFormat);
+
+    // Only worth it for long lines, the palette is converted once instead of per pixel
+    if (width > DISPLAY_FORMAT_PALETTE_SIZE) {
+        for (auto i = 0; i < DISPLAY_FORMAT_PALETTE_SIZE; i++)
+            lookup[i] = DisplayFormat_FromArgb8888(toFormat, palette[i]);
+
+        for (auto i = 0; i < width; i++) {
+            DisplayFormat_Store(to, bytesPerPixel, lookup[from[i]]);
+            to += bytesPerPixel;
+        }
+    }
+    else {
+        for (auto i = 0; i < width; i++) {
+            DisplayFormat_Store(to, bytesPerPixel, DisplayFormat_FromArgb8888(toFormat, palette[from[i]]));
+            to += bytesPerPixel;
+        }
+    }
+}
+
+void DisplayFormat_Convert(const uint8_t* from, DisplayFormat_PixelFormat fromFormat, size_t fromStride, uint8_t* to, DisplayFormat_PixelFormat toFormat, size_t toStride, int32_t width, int32_t height, const uint32_t* palette) {
+    auto fromBytesPerPixel = DisplayFormat_GetBytesPerPixel(fromFormat);
+    auto toBytesPerPixel = DisplayFormat_GetBytesPerPixel(toFormat);
+
+    if (width <= 0 || height <= 0 || fromBytesPerPixel == 0 || toBytesPerPixel == 0)
+        return;
+
+    // 16 and 32 bit sources are read a pixel at a time, which needs them aligned
+    auto aligned = (reinterpret_cast<uintptr_t>(from) & (fromBytesPerPixel == 3 ? 0 : fromBytesPerPixel - 1)) == 0 && (fromStride % fromBytesPerPixel) == 0;
+    auto toAligned = (reinterpret_cast<uintptr_t>(to) & 3) == 0 && (toStride & 3) == 0;
+
+    for (auto row = 0; row < height; row++) {
+        if (fromFormat == toFormat) {
+            memcpy(to, from, width * toBytesPerPixel);
+        }
+        else if (fromFormat == DisplayFormat_PixelFormat::Rgb565 && aligned && toFormat == DisplayFormat_PixelFormat::L8) {
+            DisplayFormat_ConvertRgb565ToL8(reinterpret_cast<const uint16_t*>(from), to, width);
+        }
+        else if (fromFormat == DisplayFormat_PixelFormat::Rgb565 && aligned && toFormat == DisplayFormat_PixelFormat::Rgb888) {
+            DisplayFormat_ConvertRgb565ToRgb888(reinterpret_cast<const uint16_t*>(from), to, width);
+        }
+        else if (fromFormat == DisplayFormat_PixelFormat::Rgb565 && aligned && toFormat == DisplayFormat_PixelFormat::Argb8888 && toAligned) {
+            DisplayFormat_ConvertRgb565ToArgb8888(reinterpret_cast<const uint16_t*>(from), reinterpret_cast<uint32_t*>(to), width);
+        }
+        else if (fromFormat == DisplayFormat_PixelFormat::L8) {
+            DisplayFormat_ConvertL8(from, to, toFormat, width, palette);
+        }
+        else {
+            auto source = from;
+            auto destination = to;
+
+            for (auto i = 0; i < width; i++) {
+                DisplayFormat_WritePixel(destination, toFormat, DisplayFormat_ReadPixel(source, fromFormat, palette));
+
+                source += fromBytesPerPixel;
+                destination += toBytesPerPixel;
+            }
+        }
+
+        from += fromStride;
+        to += toStride;
+    }
+}
+
+void DisplayFormat_ConvertRotated(const uint8_t* from, DisplayFormat_PixelFormat fromFormat, uint8_t* to, DisplayFormat_PixelFormat toFormat, DisplayRotation_Orientation orientation, int32_t screenWidth, int32_t screenHeight, int32_t x, int32_t y, int32_t width, int32_t height, const uint32_t* palette) {
+    auto fromBytesPerPixel = DisplayFormat_GetBytesPerPixel(fromFormat);
+    auto toBytesPerPixel = DisplayFormat_GetBytesPerPixel(toFormat);
+    auto rotated = orientation == DisplayRotation_Orientation::Clockwise90 || orientation == DisplayRotation_Orientation::CounterClockwise90;
+    auto logicalWidth = rotated ? screenHeight : screenWidth;
+
+    if (width <= 0 || height <= 0 || fromBytesPerPixel == 0 || toBytesPerPixel == 0)
+        return;
+
+    for (auto row = y; row < y + height; row++) {
+        auto source = from + (row * logicalWidth + x) * fromBytesPerPixel;
+
+        for (auto column = x; column < x + width; column++) {
+            int32_t toX, toY;
+
+            DisplayRotation_GetPhysical(orientation, screenWidth, screenHeight, column, row, toX, toY);
+
+            auto destination = to + (toY * screenWidth + toX) * toBytesPerPixel;
+
+            if (fromFormat == toFormat)
+                memcpy(destination, source, toBytesPerPixel);
+            else
+                DisplayFormat_WritePixel(destination, toFormat, DisplayFormat_ReadPixel(source, fromFormat, palette));
+
+            source += fromBytesPerPixel;
+        }
+    }
+}
+
+void DisplayFormat_Fill(uint8_t* to, DisplayFormat_PixelFormat format, size_t toStride, int32_t width, int32_t height, uint32_t value) {
+    auto bytesPerPixel = DisplayFormat_GetBytesPerPixel(format);
+
+    if (width <= 0 || height <= 0 || bytesPerPixel == 0)
+        return;
+
+    // The first line is built a pixel at a time and copied into the others
+    auto first = to;
+
+    for (auto i = 0; i < width; i++)
+        DisplayFormat_Store(to + i * bytesPerPixel, bytesPerPixel, value);
+
+    for (auto row = 1; row < height; row++) {
+        to += toStride;
+
+        memcpy(to, first, width * bytesPerPixel);
+    }
+}
+
+// x / 255 rounded, exact for x up to 255 * 255
+static inline uint32_t DisplayFormat_Divide255(uint32_t x) {
+    x += 128;
+
+    return (x + (x >> 8)) >> 8;
+}
+
+void DisplayFormat_BlendPixel(uint8_t* pixel, DisplayFormat_PixelFormat format, const uint32_t* palette, uint32_t color, uint32_t alpha) {
+    alpha = DisplayFormat_Divide255(alpha * (color >> 24));
+
+    if (alpha == 0)
+        return;
+
+    if (alpha == 255) {
+        DisplayFormat_WritePixel(pixel, format, color);
+
+        return;
+    }
+
+    auto background = DisplayFormat_ReadPixel(pixel, format, palette);
+    uint32_t result = DisplayFormat_Divide255(alpha * 255 + (background >> 24) * (255 - alpha)) << 24;
+
+    for (auto shift = 0; shift < 24; shift += 8) {
+        auto c = (color >> shift) & 0xFF;
+        auto b = (background >> shift) & 0xFF;
+
+        result |= DisplayFormat_Divide255(c * alpha + b * (255 - alpha)) << shift;
+    }
+
+    DisplayFormat_WritePixel(pixel, format, result);
+}
+
+// Red, green and blue are spread over a word with room above each to multiply by up to 32
+static void DisplayFormat_BlendMaskRgb565(uint16_t* to, const uint8_t* mask, int32_t width, uint32_t color, uint32_t alpha) {
+    auto spread = (color | (color << 16)) & 0x07E0F81F;
+
+    for (auto i = 0; i < width; i++) {
+        auto a = (mask[i] * alpha + 1024) >> 11;
+
+        if (a == 0)
+            continue;
+
+        if (a == 32) {
+            to[i] = static_cast<uint16_t>(color);
+
+            continue;
+        }
+
+        uint32_t background = to[i];
+
+        background = (background | (background << 16)) & 0x07E0F81F;
+        background = (background + (((spread - background) * a) >> 5)) & 0x07E0F81F;
+
+        to[i] = static_cast<uint16_t>(background | (background >> 16));
+    }
+}
+
+void DisplayFormat_BlendMask(uint8_t* to, DisplayFormat_PixelFormat format, size_t toStride, const uint8_t* mask, size_t maskStride, int32_t width, int32_t height, uint32_t color, const uint32_t* palette) {
+    auto bytesPerPixel = DisplayFormat_GetBytesPerPixel(format);
+
+    if (width <= 0 || height <= 0 || bytesPerPixel == 0)
+        return;
+
+    for (auto row = 0; row < height; row++) {
+        if (format == DisplayFormat_PixelFormat::Rgb565) {
+            DisplayFormat_BlendMaskRgb565(reinterpret_cast<uint16_t*>(to), mask, width, DisplayFormat_Argb8888ToRgb565(color), color >> 24);
+        }
+        else {
+            for (auto i = 0; i < width; i++)
+                DisplayFormat_BlendPixel(to + i * bytesPerPixel, format, palette, color, mask[i]);
+        }
+
+        to += toStride;
+        mask += maskStride;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <TinyCLR.h>
+#include "../DisplayRotation/DisplayRotation.h"
+
+#define DISPLAY_FORMAT_PALETTE_SIZE 256
+
+// Frame buffer layouts beyond TinyCLR_Display_DataFormat::Rgb565. Pixels are little endian, Rgb888 is stored as
+// B, G, R bytes and Argb8888 as 0xAARRGGBB. L8 is an index into a palette of Argb8888 colors.
+enum class DisplayFormat_PixelFormat : uint32_t {
+    Rgb565 = 0,
+    L8 = 1,
+    Rgb888 = 2,
+    Argb8888 = 3,
+};
+
+// 0 for an unknown format
+size_t DisplayFormat_GetBytesPerPixel(DisplayFormat_PixelFormat format);
+
+// Fills DISPLAY_FORMAT_PALETTE_SIZE entries with 3 bits of red, 3 of green and 2 of blue per index. Colors are
+// always converted to L8 this way, other palettes are for data that is drawn as L8 already.
+void DisplayFormat_GetDefaultPalette(uint32_t* palette);
+
+// Colors are Argb8888, palette is only used to read L8 pixels
+uint32_t DisplayFormat_ReadPixel(const uint8_t* pixel, DisplayFormat_PixelFormat format, const uint32_t* palette);
+void DisplayFormat_WritePixel(uint8_t* pixel, DisplayFormat_PixelFormat format, uint32_t color);
+
+// Writes a raw pixel value in the format, an index for L8
+void DisplayFormat_StorePixel(uint8_t* pixel, DisplayFormat_PixelFormat format, uint32_t value);
+
+// Converts an Argb8888 color to the raw pixel value of the format, an index for L8
+uint32_t DisplayFormat_FromArgb8888(DisplayFormat_PixelFormat format, uint32_t color);
+
+// Converts a width x height block, strides are in bytes. palette is used when from is L8 and to isn't.
+void DisplayFormat_Convert(const uint8_t* from, DisplayFormat_PixelFormat fromFormat, size_t fromStride, uint8_t* to, DisplayFormat_PixelFormat toFormat, size_t toStride, int32_t width, int32_t height, const uint32_t* palette);
+
+// The targets' BitBltConvert for rotated screens: draws a width x height rectangle at x, y in screen coordinates
+// of the orientation, a pixel at a time. from is a whole frame in the orientation, to a screenWidth x screenHeight
+// frame buffer.
+void DisplayFormat_ConvertRotated(const uint8_t* from, DisplayFormat_PixelFormat fromFormat, uint8_t* to, DisplayFormat_PixelFormat toFormat, DisplayRotation_Orientation orientation, int32_t screenWidth, int32_t screenHeight, int32_t x, int32_t y, int32_t width, int32_t height, const uint32_t* palette);
+
+// value is the raw pixel value in the format
+void DisplayFormat_Fill(uint8_t* to, DisplayFormat_PixelFormat format, size_t toStride, int32_t width, int32_t height, uint32_t value);
+
+// Draws color over the pixel with alpha times the color's own alpha, both 0 to 255. The result is written back
+// through the format, so L8 pixels are read through the palette and written with the default palette indexes.
+void DisplayFormat_BlendPixel(uint8_t* pixel, DisplayFormat_PixelFormat format, const uint32_t* palette, uint32_t color, uint32_t alpha);
+
+// Blends color into a width x height block through an 8 bit coverage mask such as a glyph, strides are in bytes
+void DisplayFormat_BlendMask(uint8_t* to, DisplayFormat_PixelFormat format, size_t toStride, const uint8_t* mask, size_t maskStride, int32_t width, int32_t height, uint32_t color, const uint32_t* palette);
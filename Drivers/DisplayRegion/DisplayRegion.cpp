@@ -0,0 +1,116 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "DisplayRegion.h"
+
+static uint32_t DisplayRegion_GetRectangleArea(const DisplayRegion_Rectangle& rectangle) {
+    return static_cast<uint32_t>(rectangle.Width) * static_cast<uint32_t>(rectangle.Height);
+}
+
+static DisplayRegion_Rectangle DisplayRegion_Union(const DisplayRegion_Rectangle& a, const DisplayRegion_Rectangle& b) {
+    auto left = a.X < b.X ? a.X : b.X;
+    auto top = a.Y < b.Y ? a.Y : b.Y;
+    auto right = (a.X + a.Width) > (b.X + b.Width) ? (a.X + a.Width) : (b.X + b.Width);
+    auto bottom = (a.Y + a.Height) > (b.Y + b.Height) ? (a.Y + a.Height) : (b.Y + b.Height);
+
+    return DisplayRegion_Rectangle{ left, top, right - left, bottom - top };
+}
+
+static bool DisplayRegion_Intersects(const DisplayRegion_Rectangle& a, const DisplayRegion_Rectangle& b) {
+    return a.X < b.X + b.Width && b.X < a.X + a.Width && a.Y < b.Y + b.Height && b.Y < a.Y + a.Height;
+}
+
+static void DisplayRegion_Remove(DisplayRegion& region, size_t index) {
+    region.rectangles[index] = region.rectangles[--region.count];
+}
+
+void DisplayRegion_Reset(DisplayRegion& region, int32_t width, int32_t height) {
+    region.width = width;
+    region.height = height;
+    region.count = 0;
+}
+
+void DisplayRegion_Add(DisplayRegion& region, int32_t x, int32_t y, int32_t width, int32_t height) {
+    if (x < 0) {
+        width += x;
+        x = 0;
+    }
+
+    if (y < 0) {
+        height += y;
+        y = 0;
+    }
+
+    if (x + width > region.width)
+        width = region.width - x;
+
+    if (y + height > region.height)
+        height = region.height - y;
+
+    if (width <= 0 || height <= 0)
+        return;
+
+    DisplayRegion_Rectangle rectangle = { x, y, width, height };
+
+    while (true) {
+        auto merged = false;
+
+        for (size_t i = 0; i < region.count; i++) {
+            auto& existing = region.rectangles[i];
+            auto bounds = DisplayRegion_Union(existing, rectangle);
+
+            if (DisplayRegion_Intersects(existing, rectangle) || DisplayRegion_GetRectangleArea(bounds) <= DisplayRegion_GetRectangleArea(existing) + DisplayRegion_GetRectangleArea(rectangle)) {
+                rectangle = bounds;
+                DisplayRegion_Remove(region, i);
+                merged = true;
+
+                break;
+            }
+        }
+
+        if (merged)
+            continue;
+
+        if (region.count < DISPLAY_REGION_MAX_RECTANGLES)
+            break;
+
+        // Full, take the rectangle whose bounds grow the least and check the result against the rest again
+        size_t best = 0;
+        uint32_t bestGrowth = 0xFFFFFFFF;
+
+        for (size_t i = 0; i < region.count; i++) {
+            auto& existing = region.rectangles[i];
+            auto growth = DisplayRegion_GetRectangleArea(DisplayRegion_Union(existing, rectangle)) - DisplayRegion_GetRectangleArea(existing);
+
+            if (growth < bestGrowth) {
+                best = i;
+                bestGrowth = growth;
+            }
+        }
+
+        rectangle = DisplayRegion_Union(region.rectangles[best], rectangle);
+        DisplayRegion_Remove(region, best);
+    }
+
+    region.rectangles[region.count++] = rectangle;
+}
+
+uint32_t DisplayRegion_GetArea(const DisplayRegion& region) {
+    uint32_t area = 0;
+
+    for (size_t i = 0; i < region.count; i++)
+        area += DisplayRegion_GetRectangleArea(region.rectangles[i]);
+
+    return area;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <TinyCLR.h>
+
+#define DISPLAY_REGION_MAX_RECTANGLES 16
+
+struct DisplayRegion_Rectangle {
+    int32_t X;
+    int32_t Y;
+    int32_t Width;
+    int32_t Height;
+};
+
+// Area to update in one flush. Rectangles are clipped to the screen and kept apart: overlapping ones, and ones
+// whose bounding box costs no more than copying both, are merged as they are added. When the list is full the
+// new rectangle is merged with the one it grows the least.
+struct DisplayRegion {
+    int32_t width;
+    int32_t height;
+
+    size_t count;
+    DisplayRegion_Rectangle rectangles[DISPLAY_REGION_MAX_RECTANGLES];
+};
+
+void DisplayRegion_Reset(DisplayRegion& region, int32_t width, int32_t height);
+void DisplayRegion_Add(DisplayRegion& region, int32_t x, int32_t y, int32_t width, int32_t height);
+uint32_t DisplayRegion_GetArea(const DisplayRegion& region);
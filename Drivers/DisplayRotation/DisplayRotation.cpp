@@ -0,0 +1,240 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include "DisplayRotation.h"
+
+static void DisplayRotation_TransposeSimple(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height) {
+    for (auto r = 0; r < width; r++)
+        for (auto c = 0; c < height; c++)
+            to[r * toStride + c] = from[c * fromStride + r];
+}
+
+// Both pointers word aligned, both strides, width and height even. Each step reads two pixels from two source lines
+// and writes them as two pixels on two destination lines, which the compiler turns into PKHBT/PKHTB on Cortex-M.
+static void DisplayRotation_TransposePairs(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height) {
+    for (auto r0 = 0; r0 < width; r0 += DISPLAY_ROTATION_TILE_SIZE) {
+        auto r1 = r0 + DISPLAY_ROTATION_TILE_SIZE < width ? r0 + DISPLAY_ROTATION_TILE_SIZE : width;
+
+        for (auto c0 = 0; c0 < height; c0 += DISPLAY_ROTATION_TILE_SIZE) {
+            auto c1 = c0 + DISPLAY_ROTATION_TILE_SIZE < height ? c0 + DISPLAY_ROTATION_TILE_SIZE : height;
+
+            for (auto r = r0; r < r1; r += 2) {
+                auto src = from + c0 * fromStride + r;
+                auto dst0 = reinterpret_cast<uint32_t*>(to + r * toStride + c0);
+                auto dst1 = reinterpret_cast<uint32_t*>(to + (r + 1) * toStride + c0);
+
+                for (auto c = c0; c < c1; c += 2) {
+                    auto a = *reinterpret_cast<const uint32_t*>(src);
+                    auto b = *reinterpret_cast<const uint32_t*>(src + fromStride);
+
+                    *dst0++ = (a & 0x0000FFFF) | (b << 16);
+                    *dst1++ = (a >> 16) | (b & 0xFFFF0000);
+
+                    src += 2 * fromStride;
+                }
+            }
+        }
+    }
+}
+
+// to[r * toStride + c] = from[c * fromStride + r] for r < width, c < height. Strides may be negative, which is how
+// both rotations are expressed as a transpose.
+static void DisplayRotation_Transpose(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height) {
+    if (width <= 0 || height <= 0)
+        return;
+
+    if ((fromStride & 1) != 0 || (toStride & 1) != 0) {
+        DisplayRotation_TransposeSimple(from, fromStride, to, toStride, width, height);
+
+        return;
+    }
+
+    // Peel the first source column or destination column off to reach word alignment
+    if ((reinterpret_cast<uintptr_t>(from) & 2) != 0) {
+        DisplayRotation_TransposeSimple(from, fromStride, to, toStride, 1, height);
+
+        from += 1;
+        to += toStride;
+        width--;
+    }
+
+    if ((reinterpret_cast<uintptr_t>(to) & 2) != 0) {
+        DisplayRotation_TransposeSimple(from, fromStride, to, toStride, width, 1);
+
+        from += fromStride;
+        to += 1;
+        height--;
+    }
+
+    auto evenWidth = width & ~1;
+    auto evenHeight = height & ~1;
+
+    DisplayRotation_TransposePairs(from, fromStride, to, toStride, evenWidth, evenHeight);
+
+    if (evenWidth != width)
+        DisplayRotation_TransposeSimple(from + evenWidth, fromStride, to + evenWidth * toStride, toStride, 1, height);
+
+    if (evenHeight != height)
+        DisplayRotation_TransposeSimple(from + evenHeight * fromStride, fromStride, to + evenHeight, toStride, evenWidth, 1);
+}
+
+// to[r][c] = from[height - 1 - c][r]
+void DisplayRotation_RotateClockwise(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height) {
+    DisplayRotation_Transpose(from + (height - 1) * fromStride, -fromStride, to, toStride, width, height);
+}
+
+// to[r][c] = from[c][width - 1 - r]
+void DisplayRotation_RotateCounterClockwise(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height) {
+    DisplayRotation_Transpose(from, fromStride, to + (width - 1) * toStride, -toStride, width, height);
+}
+
+void DisplayRotation_RotateClockwiseSimple(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height) {
+    for (auto r = 0; r < width; r++) {
+        auto src = from + (height - 1) * fromStride + r;
+
+        for (auto c = 0; c < height; c++) {
+            *to++ = *src;
+            src -= fromStride;
+        }
+
+        to += toStride - height;
+    }
+}
+
+void DisplayRotation_RotateCounterClockwiseSimple(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height) {
+    for (auto r = 0; r < width; r++) {
+        auto src = from + width - 1 - r;
+
+        for (auto c = 0; c < height; c++) {
+            *to++ = *src;
+            src += fromStride;
+        }
+
+        to += toStride - height;
+    }
+}
+
+void DisplayRotation_GetPhysical(DisplayRotation_Orientation orientation, int32_t screenWidth, int32_t screenHeight, int32_t x, int32_t y, int32_t& physicalX, int32_t& physicalY) {
+    switch (orientation) {
+    case DisplayRotation_Orientation::Clockwise90:
+        physicalX = screenWidth - 1 - y;
+        physicalY = x;
+        break;
+
+    case DisplayRotation_Orientation::Rotate180:
+        physicalX = screenWidth - 1 - x;
+        physicalY = screenHeight - 1 - y;
+        break;
+
+    case DisplayRotation_Orientation::CounterClockwise90:
+        physicalX = y;
+        physicalY = screenHeight - 1 - x;
+        break;
+
+    default:
+        physicalX = x;
+        physicalY = y;
+        break;
+    }
+}
+
+void DisplayRotation_Draw(DisplayRotation_Orientation orientation, const uint16_t* from, uint16_t* to, int32_t screenWidth, int32_t screenHeight, int32_t x, int32_t y, int32_t width, int32_t height) {
+    if (width <= 0 || height <= 0)
+        return;
+
+    switch (orientation) {
+    case DisplayRotation_Orientation::Normal:
+        if (x == 0 && y == 0 && width == screenWidth && height == screenHeight) {
+            memcpy(to, from, screenWidth * screenHeight * 2);
+        }
+        else {
+            for (auto row = y; row < y + height; row++) {
+                memcpy(to + row * screenWidth + x, from, width * 2);
+                from += width;
+            }
+        }
+
+        break;
+
+    case DisplayRotation_Orientation::CounterClockwise90:
+        DisplayRotation_RotateCounterClockwise(from + y * screenHeight + x, screenHeight, to + (screenHeight - x - width) * screenWidth + y, screenWidth, width, height);
+
+        break;
+
+    case DisplayRotation_Orientation::Clockwise90:
+        DisplayRotation_RotateClockwise(from + y * screenHeight + x, screenHeight, to + x * screenWidth + screenWidth - y - height, screenWidth, width, height);
+
+        break;
+
+    case DisplayRotation_Orientation::Rotate180: {
+        // Walks the source rectangle backwards while the destination goes forwards
+        auto toAddition = screenWidth - width;
+        auto fromIndex = (y + height - 1) * screenWidth + x + width;
+
+        to += (screenHeight - y - height) * screenWidth + screenWidth - x - width;
+
+        for (auto row = 0; row < height; row++) {
+            for (auto column = 0; column < width; column++)
+                *to++ = from[--fromIndex];
+
+            to += toAddition;
+            fromIndex -= toAddition;
+        }
+
+        break;
+    }
+    }
+}
+
+typedef void(*DisplayRotation_Kernel)(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height);
+
+static uint64_t DisplayRotation_Time(const TinyCLR_NativeTime_Controller* time, DisplayRotation_Kernel kernel, size_t iterations, const uint16_t* source, uint16_t* destination, int32_t width, int32_t height) {
+    auto start = time->GetNativeTime(time);
+
+    for (size_t i = 0; i < iterations; i++)
+        kernel(source, width, destination, height, width, height);
+
+    return time->ConvertNativeTimeToSystemTime(time, time->GetNativeTime(time) - start);
+}
+
+TinyCLR_Result DisplayRotation_Benchmark(const TinyCLR_NativeTime_Controller* time, int32_t width, int32_t height, size_t iterations, uint16_t* source, uint16_t* destination, uint16_t* reference, DisplayRotation_BenchmarkResult& result) {
+    if (time == nullptr || source == nullptr || destination == nullptr || reference == nullptr || width <= 0 || height <= 0 || iterations == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    auto size = static_cast<size_t>(width) * static_cast<size_t>(height);
+    uint32_t seed = 0x2545F491;
+
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1664525 + 1013904223;
+        source[i] = static_cast<uint16_t>(seed >> 16);
+    }
+
+    memset(&result, 0, sizeof(result));
+
+    result.Width = width;
+    result.Height = height;
+    result.Iterations = iterations;
+    result.Match = true;
+
+    result.ClockwiseSimpleTime = DisplayRotation_Time(time, &DisplayRotation_RotateClockwiseSimple, iterations, source, reference, width, height);
+    result.ClockwiseTime = DisplayRotation_Time(time, &DisplayRotation_RotateClockwise, iterations, source, destination, width, height);
+    result.Match &= memcmp(destination, reference, size * sizeof(uint16_t)) == 0;
+
+    result.CounterClockwiseSimpleTime = DisplayRotation_Time(time, &DisplayRotation_RotateCounterClockwiseSimple, iterations, source, reference, width, height);
+    result.CounterClockwiseTime = DisplayRotation_Time(time, &DisplayRotation_RotateCounterClockwise, iterations, source, destination, width, height);
+    result.Match &= memcmp(destination, reference, size * sizeof(uint16_t)) == 0;
+
+    return TinyCLR_Result::Success;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <TinyCLR.h>
+
+// Edge of the square blocks the kernels work through, sized so that the source lines of a block stay in cache
+#define DISPLAY_ROTATION_TILE_SIZE 16
+
+// Same values as the targets' <Target>_Display_SetOrientation
+enum class DisplayRotation_Orientation : uint32_t {
+    Normal = 0,
+    Clockwise90 = 1,
+    Rotate180 = 2,
+    CounterClockwise90 = 3,
+};
+
+// Where screen coordinates x, y of the orientation are in a screenWidth x screenHeight frame buffer
+void DisplayRotation_GetPhysical(DisplayRotation_Orientation orientation, int32_t screenWidth, int32_t screenHeight, int32_t x, int32_t y, int32_t& physicalX, int32_t& physicalY);
+
+// The targets' BitBltEx without DMA: draws a width x height rectangle at x, y in screen coordinates of the
+// orientation into a screenWidth x screenHeight frame buffer. An unrotated source holds the rectangle alone, a
+// rotated one a whole frame in the orientation.
+void DisplayRotation_Draw(DisplayRotation_Orientation orientation, const uint16_t* from, uint16_t* to, int32_t screenWidth, int32_t screenHeight, int32_t x, int32_t y, int32_t width, int32_t height);
+
+// Rotate a width x height block of 16 bit pixels into a height x width block. Strides are in pixels. Aligned blocks
+// are moved two pixels per 32 bit access, unaligned edges a pixel at a time.
+void DisplayRotation_RotateClockwise(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height);
+void DisplayRotation_RotateCounterClockwise(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height);
+
+// Straight pixel by pixel loops, the reference the kernels are checked and timed against
+void DisplayRotation_RotateClockwiseSimple(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height);
+void DisplayRotation_RotateCounterClockwiseSimple(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height);
+
+// Times are in system ticks (100ns).
+struct DisplayRotation_BenchmarkResult {
+    int32_t Width;
+    int32_t Height;
+    size_t Iterations;
+
+    uint64_t ClockwiseSimpleTime;
+    uint64_t ClockwiseTime;
+    uint64_t CounterClockwiseSimpleTime;
+    uint64_t CounterClockwiseTime;
+
+    bool Match;
+};
+
+// Rotates a whole width x height frame both ways with both implementations. Each buffer holds width * height pixels.
+TinyCLR_Result DisplayRotation_Benchmark(const TinyCLR_NativeTime_Controller* time, int32_t width, int32_t height, size_t iterations, uint16_t* source, uint16_t* destination, uint16_t* reference, DisplayRotation_BenchmarkResult& result);
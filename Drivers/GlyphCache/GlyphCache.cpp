@@ -0,0 +1,244 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <string.h>
+#include "GlyphCache.h"
+
+static size_t GlyphCache_GetBucket(uint32_t character) {
+    return (character ^ (character >> 6)) % GLYPH_CACHE_BUCKET_COUNT;
+}
+
+static void GlyphCache_Unlink(GlyphCache& cache, uint16_t index) {
+    auto& entry = cache.entries[index];
+
+    if (entry.previous != GLYPH_CACHE_NONE)
+        cache.entries[entry.previous].next = entry.next;
+    else
+        cache.head = entry.next;
+
+    if (entry.next != GLYPH_CACHE_NONE)
+        cache.entries[entry.next].previous = entry.previous;
+    else
+        cache.tail = entry.previous;
+}
+
+static void GlyphCache_LinkFirst(GlyphCache& cache, uint16_t index) {
+    auto& entry = cache.entries[index];
+
+    entry.previous = GLYPH_CACHE_NONE;
+    entry.next = cache.head;
+
+    if (cache.head != GLYPH_CACHE_NONE)
+        cache.entries[cache.head].previous = index;
+    else
+        cache.tail = index;
+
+    cache.head = index;
+}
+
+static void GlyphCache_RemoveFromBucket(GlyphCache& cache, uint16_t index) {
+    auto link = &cache.buckets[GlyphCache_GetBucket(cache.entries[index].glyph.Character)];
+
+    while (*link != index)
+        link = &cache.entries[*link].hashNext;
+
+    *link = cache.entries[index].hashNext;
+}
+
+void GlyphCache_Clear(GlyphCache& cache) {
+    for (auto i = 0; i < GLYPH_CACHE_BUCKET_COUNT; i++)
+        cache.buckets[i] = GLYPH_CACHE_NONE;
+
+    cache.head = GLYPH_CACHE_NONE;
+    cache.tail = GLYPH_CACHE_NONE;
+    cache.usedCount = 0;
+}
+
+TinyCLR_Result GlyphCache_Initialize(GlyphCache& cache, const GlyphCache_Font& font, uint8_t* buffer, size_t size) {
+    if (buffer == nullptr || font.GetMetrics == nullptr || font.Rasterize == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (font.MaxWidth == 0 || font.MaxHeight == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    auto slotSize = static_cast<size_t>(font.MaxWidth) * font.MaxHeight;
+    auto entryCount = size / slotSize;
+
+    if (entryCount < 2)
+        return TinyCLR_Result::OutOfMemory;
+
+    memset(&cache, 0, sizeof(cache));
+
+    cache.font = font;
+    cache.buffer = buffer;
+    cache.slotSize = slotSize;
+    cache.entryCount = entryCount < GLYPH_CACHE_MAX_ENTRIES ? entryCount : GLYPH_CACHE_MAX_ENTRIES;
+
+    GlyphCache_Clear(cache);
+
+    return TinyCLR_Result::Success;
+}
+
+const GlyphCache_Glyph* GlyphCache_Get(GlyphCache& cache, uint32_t character) {
+    auto bucket = GlyphCache_GetBucket(character);
+
+    for (auto index = cache.buckets[bucket]; index != GLYPH_CACHE_NONE; index = cache.entries[index].hashNext) {
+        if (cache.entries[index].glyph.Character == character) {
+            if (index != cache.head) {
+                GlyphCache_Unlink(cache, index);
+                GlyphCache_LinkFirst(cache, index);
+            }
+
+            cache.hits++;
+
+            return &cache.entries[index].glyph;
+        }
+    }
+
+    GlyphCache_Metrics metrics;
+
+    if (!cache.font.GetMetrics(cache.font.Context, character, metrics) || metrics.Width > cache.font.MaxWidth || metrics.Height > cache.font.MaxHeight)
+        return nullptr;
+
+    cache.misses++;
+
+    uint16_t index;
+
+    if (cache.usedCount < cache.entryCount) {
+        index = static_cast<uint16_t>(cache.usedCount++);
+    }
+    else {
+        index = cache.tail;
+
+        GlyphCache_Unlink(cache, index);
+        GlyphCache_RemoveFromBucket(cache, index);
+
+        cache.evictions++;
+    }
+
+    auto& entry = cache.entries[index];
+    auto alpha = cache.buffer + index * cache.slotSize;
+
+    entry.glyph.Character = character;
+    entry.glyph.Metrics = metrics;
+    entry.glyph.Alpha = alpha;
+
+    if (metrics.Width > 0 && metrics.Height > 0)
+        cache.font.Rasterize(cache.font.Context, character, alpha, metrics.Width);
+
+    entry.hashNext = cache.buckets[bucket];
+    cache.buckets[bucket] = index;
+
+    GlyphCache_LinkFirst(cache, index);
+
+    return &entry.glyph;
+}
+
+void GlyphCache_DrawString(GlyphCache& cache, const char* text, size_t length, int32_t& x, int32_t& y, GlyphCache_DrawGlyphHandler handler, void* context) {
+    auto left = x;
+
+    for (size_t i = 0; i < length; i++) {
+        auto character = static_cast<uint8_t>(text[i]);
+
+        if (character == '\n') {
+            x = left;
+            y += cache.font.LineHeight;
+
+            continue;
+        }
+
+        auto glyph = GlyphCache_Get(cache, character);
+
+        if (glyph == nullptr)
+            continue;
+
+        if (glyph->Metrics.Width > 0 && glyph->Metrics.Height > 0)
+            handler(*glyph, x + glyph->Metrics.OffsetX, y + glyph->Metrics.OffsetY, context);
+
+        x += glyph->Metrics.Advance;
+    }
+}
+
+void GlyphCache_MeasureString(GlyphCache& cache, const char* text, size_t length, uint32_t& width, uint32_t& height) {
+    int32_t line = 0;
+    int32_t widest = 0;
+
+    height = length > 0 ? cache.font.LineHeight : 0;
+
+    for (size_t i = 0; i < length; i++) {
+        auto character = static_cast<uint8_t>(text[i]);
+
+        if (character == '\n') {
+            line = 0;
+            height += cache.font.LineHeight;
+
+            continue;
+        }
+
+        GlyphCache_Metrics metrics;
+
+        if (cache.font.GetMetrics(cache.font.Context, character, metrics))
+            line += metrics.Advance;
+
+        if (line > widest)
+            widest = line;
+    }
+
+    width = static_cast<uint32_t>(widest);
+}
+
+static bool GlyphCache_BitmapFont_GetMetrics(void* context, uint32_t character, GlyphCache_Metrics& metrics) {
+    auto bitmapFont = reinterpret_cast<const GlyphCache_BitmapFont*>(context);
+
+    if (character < bitmapFont->FirstCharacter || character - bitmapFont->FirstCharacter >= bitmapFont->CharacterCount)
+        return false;
+
+    metrics.Width = bitmapFont->Width;
+    metrics.Height = bitmapFont->Height;
+    metrics.OffsetX = 0;
+    metrics.OffsetY = 0;
+    metrics.Advance = bitmapFont->Width + bitmapFont->Spacing;
+
+    return true;
+}
+
+static void GlyphCache_BitmapFont_Rasterize(void* context, uint32_t character, uint8_t* alpha, size_t stride) {
+    auto bitmapFont = reinterpret_cast<const GlyphCache_BitmapFont*>(context);
+    auto columns = bitmapFont->Data + (character - bitmapFont->FirstCharacter) * bitmapFont->Width;
+
+    for (uint32_t row = 0; row < bitmapFont->Height; row++) {
+        for (uint32_t column = 0; column < bitmapFont->Width; column++)
+            alpha[column] = (columns[column] & (1 << row)) != 0 ? 0xFF : 0x00;
+
+        alpha += stride;
+    }
+}
+
+TinyCLR_Result GlyphCache_BitmapFont_Initialize(GlyphCache_BitmapFont& bitmapFont, GlyphCache_Font& font) {
+    if (bitmapFont.Data == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (bitmapFont.Width == 0 || bitmapFont.Height == 0 || bitmapFont.Height > 8)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    font.Context = &bitmapFont;
+    font.LineHeight = bitmapFont.Height;
+    font.MaxWidth = bitmapFont.Width;
+    font.MaxHeight = bitmapFont.Height;
+    font.GetMetrics = &GlyphCache_BitmapFont_GetMetrics;
+    font.Rasterize = &GlyphCache_BitmapFont_Rasterize;
+
+    return TinyCLR_Result::Success;
+}
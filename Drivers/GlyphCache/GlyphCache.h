@@ -0,0 +1,101 @@
+#pragma once
+
+#include <TinyCLR.h>
+
+#define GLYPH_CACHE_MAX_ENTRIES 256
+#define GLYPH_CACHE_BUCKET_COUNT 64
+#define GLYPH_CACHE_NONE 0xFFFF
+
+struct GlyphCache_Metrics {
+    uint32_t Width;
+    uint32_t Height;
+
+    // From the pen position, which is at the top of the line, to the top left of the bitmap
+    int32_t OffsetX;
+    int32_t OffsetY;
+
+    // Moves the pen to the next character
+    int32_t Advance;
+};
+
+// A loaded font. GetMetrics returns false for characters the font doesn't have. Rasterize writes Width * Height
+// coverage values, 255 where the glyph is solid, with stride bytes between rows. No glyph may be larger than
+// MaxWidth x MaxHeight, which sizes the cache slots.
+struct GlyphCache_Font {
+    void* Context;
+
+    uint32_t LineHeight;
+    uint32_t MaxWidth;
+    uint32_t MaxHeight;
+
+    bool(*GetMetrics)(void* context, uint32_t character, GlyphCache_Metrics& metrics);
+    void(*Rasterize)(void* context, uint32_t character, uint8_t* alpha, size_t stride);
+};
+
+// Alpha holds Metrics.Width * Metrics.Height coverage values without padding
+struct GlyphCache_Glyph {
+    uint32_t Character;
+    GlyphCache_Metrics Metrics;
+    const uint8_t* Alpha;
+};
+
+struct GlyphCache_Entry {
+    GlyphCache_Glyph glyph;
+
+    uint16_t previous;
+    uint16_t next;
+    uint16_t hashNext;
+};
+
+// Rasterized glyphs are kept in fixed slots of the caller's buffer, the least recently used one is replaced when
+// they are all taken. The glyph returned last is never the one replaced by the next GlyphCache_Get, so a transfer
+// started from it may still be reading while the next glyph is looked up.
+struct GlyphCache {
+    GlyphCache_Font font;
+
+    uint8_t* buffer;
+    size_t slotSize;
+    size_t entryCount;
+    size_t usedCount;
+
+    GlyphCache_Entry entries[GLYPH_CACHE_MAX_ENTRIES];
+    uint16_t buckets[GLYPH_CACHE_BUCKET_COUNT];
+
+    // Most and least recently used
+    uint16_t head;
+    uint16_t tail;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+// The buffer needs room for two MaxWidth x MaxHeight glyphs at least
+TinyCLR_Result GlyphCache_Initialize(GlyphCache& cache, const GlyphCache_Font& font, uint8_t* buffer, size_t size);
+void GlyphCache_Clear(GlyphCache& cache);
+
+// nullptr when the font has no such character
+const GlyphCache_Glyph* GlyphCache_Get(GlyphCache& cache, uint32_t character);
+
+typedef void(*GlyphCache_DrawGlyphHandler)(const GlyphCache_Glyph& glyph, int32_t x, int32_t y, void* context);
+
+// Lays out a line of 8 bit characters from the pen at x, y and hands every glyph with its top left position to
+// handler. '\n' returns to x on the next line. Returns the pen position after the last character in x.
+void GlyphCache_DrawString(GlyphCache& cache, const char* text, size_t length, int32_t& x, int32_t& y, GlyphCache_DrawGlyphHandler handler, void* context);
+
+// Width of the widest line and height of all lines
+void GlyphCache_MeasureString(GlyphCache& cache, const char* text, size_t length, uint32_t& width, uint32_t& height);
+
+// Column coded 1 bit fonts like the targets' built in console font: Width bytes per character, bit n of a byte is
+// row n from the top, so Height is 8 at most.
+struct GlyphCache_BitmapFont {
+    const uint8_t* Data;
+    uint32_t FirstCharacter;
+    uint32_t CharacterCount;
+
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t Spacing;
+};
+
+TinyCLR_Result GlyphCache_BitmapFont_Initialize(GlyphCache_BitmapFont& bitmapFont, GlyphCache_Font& font);
@@ -0,0 +1,583 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include <Device.h>
+#include "IsoTp.h"
+
+#define ISOTP_PCI_SINGLE_FRAME 0x00
+#define ISOTP_PCI_FIRST_FRAME 0x10
+#define ISOTP_PCI_CONSECUTIVE_FRAME 0x20
+#define ISOTP_PCI_FLOW_CONTROL 0x30
+
+#define ISOTP_FLOW_STATUS_CONTINUE 0x00
+#define ISOTP_FLOW_STATUS_WAIT 0x01
+#define ISOTP_FLOW_STATUS_OVERFLOW 0x02
+
+#define ISOTP_SINGLE_FRAME_MAX_LENGTH (ISOTP_FRAME_SIZE - 1)
+#define ISOTP_FIRST_FRAME_DATA_LENGTH (ISOTP_FRAME_SIZE - 2)
+#define ISOTP_CONSECUTIVE_FRAME_DATA_LENGTH (ISOTP_FRAME_SIZE - 1)
+
+#define ISOTP_STANDARD_ID_MAX 0x7FF
+#define ISOTP_EXTENDED_ID_MAX 0x1FFFFFFF
+
+static uint64_t IsoTp_GetTime(const IsoTp_Channel& channel) {
+    auto time = channel.configuration.Time;
+
+    return time->ConvertNativeTimeToSystemTime(time, time->GetNativeTime(time));
+}
+
+// STmin is 0-127ms, or 100-900us for 0xF1-0xF9. Reserved values are treated as the longest separation.
+static uint64_t IsoTp_DecodeSeparationTime(uint8_t value) {
+    if (value <= 0x7F)
+        return value * 10000;
+
+    if (value >= 0xF1 && value <= 0xF9)
+        return (value - 0xF0) * 1000;
+
+    return 0x7F * 10000;
+}
+
+static bool IsoTp_WriteFrame(IsoTp_Channel& channel, const uint8_t* data, size_t length) {
+    auto& configuration = channel.configuration;
+
+    TinyCLR_Can_Message message;
+
+    message.ArbitrationId = configuration.TransmitId;
+    message.IsExtendedId = configuration.ExtendedId;
+    message.IsRemoteTransmissionRequest = false;
+    message.Length = configuration.Padding ? ISOTP_FRAME_SIZE : length;
+    message.Timestamp = 0;
+
+    memcpy(message.Data, data, length);
+
+    if (configuration.Padding)
+        memset(message.Data + length, configuration.PaddingValue, ISOTP_FRAME_SIZE - length);
+
+    size_t count = 1;
+
+    return configuration.Can->WriteMessage(configuration.Can, &message, count) == TinyCLR_Result::Success && count == 1;
+}
+
+// Called from the receive path. When the controller is full the frame is kept and IsoTp_Process retries it.
+static void IsoTp_WriteFlowControl(IsoTp_Channel& channel, uint8_t flowStatus) {
+    uint8_t frame[3];
+
+    frame[0] = ISOTP_PCI_FLOW_CONTROL | flowStatus;
+    frame[1] = channel.configuration.BlockSize;
+    frame[2] = channel.configuration.SeparationTime;
+
+    channel.rxFlowStatus = flowStatus;
+    channel.rxFlowControlPending = !IsoTp_WriteFrame(channel, frame, sizeof(frame));
+}
+
+static void IsoTp_TransmitComplete(IsoTp_Channel& channel, TinyCLR_Result result) {
+    channel.txState = IsoTp_State::Idle;
+
+    if (channel.transmittedHandler != nullptr)
+        channel.transmittedHandler(channel, result, channel.transmittedContext);
+}
+
+static void IsoTp_ReceiveComplete(IsoTp_Channel& channel) {
+    channel.rxState = IsoTp_State::Received;
+
+    if (channel.receivedHandler != nullptr)
+        channel.receivedHandler(channel, channel.rxLength, channel.receivedContext);
+}
+
+static uint64_t IsoTp_Run(IsoTp_Channel& channel, uint64_t now) {
+    if (channel.rxState == IsoTp_State::Receiving && now >= channel.rxDeadline)
+        channel.rxState = IsoTp_State::Idle;
+
+    // An overflow answer is still owed after the receiver went idle, a continue only while receiving
+    if (channel.rxFlowControlPending && (channel.rxState == IsoTp_State::Receiving || channel.rxFlowStatus == ISOTP_FLOW_STATUS_OVERFLOW))
+        IsoTp_WriteFlowControl(channel, channel.rxFlowStatus);
+    else
+        channel.rxFlowControlPending = false;
+
+    if ((channel.txState == IsoTp_State::WaitFlowControl || channel.txState == IsoTp_State::Sending) && now >= channel.txDeadline)
+        IsoTp_TransmitComplete(channel, TinyCLR_Result::TimedOut);
+
+    // With no separation time the whole block goes out at once, otherwise one frame per call
+    while (channel.txState == IsoTp_State::Sending && now >= channel.txNextTime) {
+        uint8_t frame[ISOTP_FRAME_SIZE];
+
+        auto remaining = channel.txLength - channel.txOffset;
+        auto length = remaining < ISOTP_CONSECUTIVE_FRAME_DATA_LENGTH ? remaining : ISOTP_CONSECUTIVE_FRAME_DATA_LENGTH;
+
+        frame[0] = ISOTP_PCI_CONSECUTIVE_FRAME | channel.txSequence;
+
+        memcpy(frame + 1, channel.txBuffer + channel.txOffset, length);
+
+        if (!IsoTp_WriteFrame(channel, frame, length + 1))
+            break; // Controller buffer is full, retried on the next call until txDeadline
+
+        channel.txOffset += length;
+        channel.txSequence = (channel.txSequence + 1) & 0x0F;
+        channel.txDeadline = now + channel.configuration.Timeout;
+        channel.txNextTime = now + channel.txSeparationTime;
+
+        if (channel.txOffset == channel.txLength) {
+            IsoTp_TransmitComplete(channel, TinyCLR_Result::Success);
+
+            break;
+        }
+
+        if (channel.txBlockSize > 0 && ++channel.txBlockCount == channel.txBlockSize) {
+            channel.txBlockCount = 0;
+            channel.txState = IsoTp_State::WaitFlowControl;
+
+            break;
+        }
+    }
+
+    uint64_t next = 0;
+
+    if (channel.rxFlowControlPending)
+        return now;
+
+    if (channel.rxState == IsoTp_State::Receiving)
+        next = channel.rxDeadline;
+
+    if (channel.txState != IsoTp_State::Idle) {
+        auto txNext = channel.txDeadline;
+
+        if (channel.txState == IsoTp_State::Sending && channel.txNextTime < txNext)
+            txNext = channel.txNextTime;
+
+        if (next == 0 || txNext < next)
+            next = txNext;
+    }
+
+    return next;
+}
+
+static void IsoTp_ReceiveSingleFrame(IsoTp_Channel& channel, const uint8_t* data, size_t length) {
+    size_t messageLength = data[0] & 0x0F;
+
+    if (messageLength == 0 || messageLength > ISOTP_SINGLE_FRAME_MAX_LENGTH || messageLength > length - 1)
+        return;
+
+    if (channel.rxState == IsoTp_State::Received)
+        return; // Previous message not read yet
+
+    memcpy(channel.rxBuffer, data + 1, messageLength);
+
+    channel.rxLength = messageLength;
+
+    IsoTp_ReceiveComplete(channel);
+}
+
+static void IsoTp_ReceiveFirstFrame(IsoTp_Channel& channel, const uint8_t* data, size_t length, uint64_t now) {
+    if (length < ISOTP_FRAME_SIZE)
+        return;
+
+    size_t messageLength = ((data[0] & 0x0F) << 8) | data[1];
+
+    // A length of 0 announces a message over 4095 bytes
+    if (channel.rxState == IsoTp_State::Received || messageLength == 0) {
+        IsoTp_WriteFlowControl(channel, ISOTP_FLOW_STATUS_OVERFLOW);
+
+        return;
+    }
+
+    if (messageLength <= ISOTP_SINGLE_FRAME_MAX_LENGTH)
+        return;
+
+    // A new first frame aborts a message in progress
+    memcpy(channel.rxBuffer, data + 2, ISOTP_FIRST_FRAME_DATA_LENGTH);
+
+    channel.rxLength = messageLength;
+    channel.rxOffset = ISOTP_FIRST_FRAME_DATA_LENGTH;
+    channel.rxSequence = 1;
+    channel.rxBlockCount = 0;
+    channel.rxDeadline = now + channel.configuration.Timeout;
+    channel.rxState = IsoTp_State::Receiving;
+
+    IsoTp_WriteFlowControl(channel, ISOTP_FLOW_STATUS_CONTINUE);
+}
+
+static void IsoTp_ReceiveConsecutiveFrame(IsoTp_Channel& channel, const uint8_t* data, size_t length, uint64_t now) {
+    if (channel.rxState != IsoTp_State::Receiving)
+        return;
+
+    auto remaining = channel.rxLength - channel.rxOffset;
+    auto expected = remaining < ISOTP_CONSECUTIVE_FRAME_DATA_LENGTH ? remaining : ISOTP_CONSECUTIVE_FRAME_DATA_LENGTH;
+
+    if ((data[0] & 0x0F) != channel.rxSequence || length - 1 < expected) {
+        channel.rxState = IsoTp_State::Idle;
+
+        return;
+    }
+
+    memcpy(channel.rxBuffer + channel.rxOffset, data + 1, expected);
+
+    channel.rxOffset += expected;
+    channel.rxSequence = (channel.rxSequence + 1) & 0x0F;
+    channel.rxDeadline = now + channel.configuration.Timeout;
+
+    if (channel.rxOffset == channel.rxLength) {
+        IsoTp_ReceiveComplete(channel);
+
+        return;
+    }
+
+    if (channel.configuration.BlockSize > 0 && ++channel.rxBlockCount == channel.configuration.BlockSize) {
+        channel.rxBlockCount = 0;
+
+        IsoTp_WriteFlowControl(channel, ISOTP_FLOW_STATUS_CONTINUE);
+    }
+}
+
+static void IsoTp_ReceiveFlowControl(IsoTp_Channel& channel, const uint8_t* data, size_t length, uint64_t now) {
+    if (channel.txState != IsoTp_State::WaitFlowControl || length < 3)
+        return;
+
+    switch (data[0] & 0x0F) {
+    case ISOTP_FLOW_STATUS_CONTINUE:
+        channel.txBlockSize = data[1];
+        channel.txBlockCount = 0;
+        channel.txSeparationTime = IsoTp_DecodeSeparationTime(data[2]);
+        channel.txNextTime = channel.txNextTime > now ? channel.txNextTime : now; // Separation also holds across blocks
+        channel.txDeadline = now + channel.configuration.Timeout;
+        channel.txState = IsoTp_State::Sending;
+        break;
+
+    case ISOTP_FLOW_STATUS_WAIT:
+        channel.txDeadline = now + channel.configuration.Timeout;
+        break;
+
+    case ISOTP_FLOW_STATUS_OVERFLOW:
+        IsoTp_TransmitComplete(channel, TinyCLR_Result::OutOfMemory);
+        break;
+
+    default:
+        IsoTp_TransmitComplete(channel, TinyCLR_Result::InvalidOperation);
+        break;
+    }
+}
+
+TinyCLR_Result IsoTp_Initialize(IsoTp_Channel& channel, const IsoTp_Configuration& configuration) {
+    if (configuration.Can == nullptr || configuration.Time == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    uint32_t idMax = configuration.ExtendedId ? ISOTP_EXTENDED_ID_MAX : ISOTP_STANDARD_ID_MAX;
+
+    if (configuration.TransmitId > idMax || configuration.ReceiveId > idMax)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    memset(&channel, 0, sizeof(channel));
+
+    channel.configuration = configuration;
+
+    if (channel.configuration.Timeout == 0)
+        channel.configuration.Timeout = ISOTP_DEFAULT_TIMEOUT;
+
+    channel.rxState = IsoTp_State::Idle;
+    channel.txState = IsoTp_State::Idle;
+
+    return TinyCLR_Result::Success;
+}
+
+void IsoTp_SetReceivedHandler(IsoTp_Channel& channel, IsoTp_ReceivedHandler handler, void* context) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    channel.receivedHandler = handler;
+    channel.receivedContext = context;
+}
+
+void IsoTp_SetTransmittedHandler(IsoTp_Channel& channel, IsoTp_TransmittedHandler handler, void* context) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    channel.transmittedHandler = handler;
+    channel.transmittedContext = context;
+}
+
+TinyCLR_Result IsoTp_Send(IsoTp_Channel& channel, const uint8_t* data, size_t length) {
+    if (data == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (length == 0 || length > ISOTP_MAX_MESSAGE_SIZE)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    if (channel.txState != IsoTp_State::Idle)
+        return TinyCLR_Result::Busy;
+
+    uint8_t frame[ISOTP_FRAME_SIZE];
+
+    if (length <= ISOTP_SINGLE_FRAME_MAX_LENGTH) {
+        frame[0] = ISOTP_PCI_SINGLE_FRAME | length;
+
+        memcpy(frame + 1, data, length);
+
+        if (!IsoTp_WriteFrame(channel, frame, length + 1))
+            return TinyCLR_Result::Busy;
+
+        IsoTp_TransmitComplete(channel, TinyCLR_Result::Success);
+
+        return TinyCLR_Result::Success;
+    }
+
+    frame[0] = ISOTP_PCI_FIRST_FRAME | (length >> 8);
+    frame[1] = length & 0xFF;
+
+    memcpy(frame + 2, data, ISOTP_FIRST_FRAME_DATA_LENGTH);
+
+    if (!IsoTp_WriteFrame(channel, frame, ISOTP_FRAME_SIZE))
+        return TinyCLR_Result::Busy;
+
+    memcpy(channel.txBuffer, data, length);
+
+    channel.txLength = length;
+    channel.txOffset = ISOTP_FIRST_FRAME_DATA_LENGTH;
+    channel.txSequence = 1;
+    channel.txDeadline = IsoTp_GetTime(channel) + channel.configuration.Timeout;
+    channel.txState = IsoTp_State::WaitFlowControl;
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result IsoTp_Read(IsoTp_Channel& channel, uint8_t* data, size_t& length) {
+    if (data == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    if (channel.rxState != IsoTp_State::Received)
+        return TinyCLR_Result::NotAvailable;
+
+    if (length < channel.rxLength)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    memcpy(data, channel.rxBuffer, channel.rxLength);
+
+    length = channel.rxLength;
+
+    channel.rxState = IsoTp_State::Idle;
+
+    return TinyCLR_Result::Success;
+}
+
+bool IsoTp_FrameHandler(const TinyCLR_Can_Message& message, uint64_t timestamp, void* context) {
+    auto& channel = *reinterpret_cast<IsoTp_Channel*>(context);
+    auto& configuration = channel.configuration;
+
+    if (message.ArbitrationId != configuration.ReceiveId || message.IsExtendedId != configuration.ExtendedId || message.IsRemoteTransmissionRequest)
+        return false;
+
+    size_t length = message.Length;
+
+    if (length == 0 || length > ISOTP_FRAME_SIZE)
+        return true;
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    auto data = message.Data;
+
+    switch (data[0] & 0xF0) {
+    case ISOTP_PCI_SINGLE_FRAME:
+        IsoTp_ReceiveSingleFrame(channel, data, length);
+        break;
+
+    case ISOTP_PCI_FIRST_FRAME:
+        IsoTp_ReceiveFirstFrame(channel, data, length, timestamp);
+        break;
+
+    case ISOTP_PCI_CONSECUTIVE_FRAME:
+        IsoTp_ReceiveConsecutiveFrame(channel, data, length, timestamp);
+        break;
+
+    case ISOTP_PCI_FLOW_CONTROL:
+        IsoTp_ReceiveFlowControl(channel, data, length, timestamp);
+        break;
+    }
+
+    // Sends the consecutive frames a flow control frame just released
+    IsoTp_Run(channel, timestamp);
+
+    return true;
+}
+
+uint64_t IsoTp_Process(IsoTp_Channel& channel) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    return IsoTp_Run(channel, IsoTp_GetTime(channel));
+}
+
+static IsoTp_Loopback* IsoTp_Loopback_Get(const TinyCLR_Api_Info* apiInfo) {
+    return reinterpret_cast<IsoTp_Loopback*>(apiInfo->State);
+}
+
+static uint64_t IsoTp_Loopback_GetFrameTime(const IsoTp_Loopback* loopback, const TinyCLR_Can_Message& message) {
+    uint64_t bits = (message.IsExtendedId ? 67 : 47) + (message.IsRemoteTransmissionRequest ? 0 : 8 * message.Length);
+
+    return (bits * 10000000) / loopback->bitRate;
+}
+
+static TinyCLR_Result IsoTp_Loopback_Acquire(const TinyCLR_Can_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result IsoTp_Loopback_Release(const TinyCLR_Can_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result IsoTp_Loopback_Enable(const TinyCLR_Can_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result IsoTp_Loopback_Disable(const TinyCLR_Can_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result IsoTp_Loopback_WriteMessage(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& length) {
+    auto loopback = IsoTp_Loopback_Get(self->ApiInfo);
+    auto side = self == &loopback->canController[0] ? 0 : 1;
+
+    auto requested = length;
+    size_t written = 0;
+
+    while (written < requested && loopback->queueCount < ISOTP_LOOPBACK_QUEUE_SIZE) {
+        loopback->queue[loopback->queueIn] = messages[written++];
+        loopback->queueSide[loopback->queueIn] = side;
+
+        loopback->queueIn = (loopback->queueIn + 1) % ISOTP_LOOPBACK_QUEUE_SIZE;
+        loopback->queueCount++;
+    }
+
+    length = written;
+
+    return (written > 0 || requested == 0) ? TinyCLR_Result::Success : TinyCLR_Result::Busy;
+}
+
+static TinyCLR_Result IsoTp_Loopback_InitializeTime(const TinyCLR_NativeTime_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result IsoTp_Loopback_UninitializeTime(const TinyCLR_NativeTime_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static uint64_t IsoTp_Loopback_GetNativeTime(const TinyCLR_NativeTime_Controller* self) {
+    return IsoTp_Loopback_Get(self->ApiInfo)->clock;
+}
+
+static uint64_t IsoTp_Loopback_ConvertTime(const TinyCLR_NativeTime_Controller* self, uint64_t time) {
+    return time;
+}
+
+static TinyCLR_Result IsoTp_Loopback_SetCallback(const TinyCLR_NativeTime_Controller* self, TinyCLR_NativeTime_Callback callback) {
+    return TinyCLR_Result::NotSupported;
+}
+
+static TinyCLR_Result IsoTp_Loopback_ScheduleCallback(const TinyCLR_NativeTime_Controller* self, uint64_t processorTicks) {
+    return TinyCLR_Result::NotSupported;
+}
+
+static void IsoTp_Loopback_Wait(const TinyCLR_NativeTime_Controller* self, uint64_t nativeTime) {
+    IsoTp_Loopback_Get(self->ApiInfo)->clock += nativeTime;
+}
+
+TinyCLR_Result IsoTp_Loopback_Initialize(IsoTp_Loopback& loopback, uint32_t bitRate) {
+    if (bitRate == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    memset(&loopback, 0, sizeof(loopback));
+
+    loopback.bitRate = bitRate;
+
+    for (auto i = 0; i < 2; i++) {
+        loopback.canController[i].ApiInfo = &loopback.canApi[i];
+        loopback.canController[i].Acquire = &IsoTp_Loopback_Acquire;
+        loopback.canController[i].Release = &IsoTp_Loopback_Release;
+        loopback.canController[i].Enable = &IsoTp_Loopback_Enable;
+        loopback.canController[i].Disable = &IsoTp_Loopback_Disable;
+        loopback.canController[i].WriteMessage = &IsoTp_Loopback_WriteMessage;
+
+        loopback.canApi[i].Author = "GHI Electronics, LLC";
+        loopback.canApi[i].Name = "GHIElectronics.TinyCLR.NativeApis.IsoTp.LoopbackCanController";
+        loopback.canApi[i].Type = TinyCLR_Api_Type::CanController;
+        loopback.canApi[i].Version = 0;
+        loopback.canApi[i].Implementation = &loopback.canController[i];
+        loopback.canApi[i].State = &loopback;
+    }
+
+    loopback.timeController.ApiInfo = &loopback.timeApi;
+    loopback.timeController.Initialize = &IsoTp_Loopback_InitializeTime;
+    loopback.timeController.Uninitialize = &IsoTp_Loopback_UninitializeTime;
+    loopback.timeController.GetNativeTime = &IsoTp_Loopback_GetNativeTime;
+    loopback.timeController.ConvertNativeTimeToSystemTime = &IsoTp_Loopback_ConvertTime;
+    loopback.timeController.ConvertSystemTimeToNativeTime = &IsoTp_Loopback_ConvertTime;
+    loopback.timeController.SetCallback = &IsoTp_Loopback_SetCallback;
+    loopback.timeController.ScheduleCallback = &IsoTp_Loopback_ScheduleCallback;
+    loopback.timeController.Wait = &IsoTp_Loopback_Wait;
+
+    loopback.timeApi.Author = "GHI Electronics, LLC";
+    loopback.timeApi.Name = "GHIElectronics.TinyCLR.NativeApis.IsoTp.LoopbackTimeController";
+    loopback.timeApi.Type = TinyCLR_Api_Type::NativeTimeController;
+    loopback.timeApi.Version = 0;
+    loopback.timeApi.Implementation = &loopback.timeController;
+    loopback.timeApi.State = &loopback;
+
+    return TinyCLR_Result::Success;
+}
+
+void IsoTp_Loopback_Attach(IsoTp_Loopback& loopback, size_t side, IsoTp_Channel* channel) {
+    loopback.channel[side] = channel;
+}
+
+// Delivers queued frames one at a time, advancing the clock by the time each takes on the bus, and jumps the
+// clock to the next channel deadline when the bus is idle. Returns when both channels are idle or on timeout.
+void IsoTp_Loopback_Run(IsoTp_Loopback& loopback, uint64_t timeout) {
+    auto end = loopback.clock + timeout;
+
+    while (loopback.clock < end) {
+        uint64_t next = 0;
+
+        for (auto side = 0; side < 2; side++) {
+            if (loopback.channel[side] == nullptr)
+                continue;
+
+            auto t = IsoTp_Process(*loopback.channel[side]);
+
+            if (t != 0 && (next == 0 || t < next))
+                next = t;
+        }
+
+        if (loopback.queueCount > 0) {
+            auto message = loopback.queue[loopback.queueOut];
+            auto destination = loopback.channel[1 - loopback.queueSide[loopback.queueOut]];
+
+            loopback.queueOut = (loopback.queueOut + 1) % ISOTP_LOOPBACK_QUEUE_SIZE;
+            loopback.queueCount--;
+
+            loopback.clock += IsoTp_Loopback_GetFrameTime(&loopback, message);
+            loopback.frameCount++;
+
+            message.Timestamp = loopback.clock;
+
+            if (destination != nullptr)
+                IsoTp_FrameHandler(message, loopback.clock, destination);
+
+            continue;
+        }
+
+        if (next == 0)
+            break;
+
+        loopback.clock = next > loopback.clock ? next : loopback.clock + 1;
+    }
+}
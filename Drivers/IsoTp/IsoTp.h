@@ -0,0 +1,122 @@
+#pragma once
+
+#include <TinyCLR.h>
+
+#define ISOTP_MAX_MESSAGE_SIZE 4095
+#define ISOTP_FRAME_SIZE 8
+
+// N_Bs and N_Cr, how long a sender waits for flow control and a receiver waits for the next consecutive frame
+#define ISOTP_DEFAULT_TIMEOUT (1000 * 10000)
+
+#define ISOTP_LOOPBACK_QUEUE_SIZE 64
+
+enum class IsoTp_State : uint32_t {
+    Idle = 0,
+    WaitFlowControl = 1,
+    Sending = 2,
+    Receiving = 3,
+    Received = 4,
+};
+
+// Normal addressing on classic CAN. Times are in system ticks (100ns).
+struct IsoTp_Configuration {
+    const TinyCLR_Can_Controller* Can;
+    const TinyCLR_NativeTime_Controller* Time;
+
+    uint32_t TransmitId;
+    uint32_t ReceiveId;
+    bool ExtendedId;
+
+    // Sent to the peer in our flow control frames, BlockSize 0 lets it send the whole message in one block
+    uint8_t BlockSize;
+    uint8_t SeparationTime;
+
+    // When set every frame is sent with 8 data bytes, the unused ones set to PaddingValue
+    bool Padding;
+    uint8_t PaddingValue;
+
+    uint64_t Timeout;
+};
+
+struct IsoTp_Channel;
+
+// Both are called from the context that completed the transfer, usually the CAN receive interrupt.
+// Frames are never waited for in that context: when the controller has no free transmit buffer the
+// flow control or consecutive frame is left pending and sent by the next IsoTp_Process call.
+typedef void(*IsoTp_ReceivedHandler)(IsoTp_Channel& channel, size_t length, void* context);
+typedef void(*IsoTp_TransmittedHandler)(IsoTp_Channel& channel, TinyCLR_Result result, void* context);
+
+struct IsoTp_Channel {
+    IsoTp_Configuration configuration;
+
+    IsoTp_ReceivedHandler receivedHandler;
+    void* receivedContext;
+
+    IsoTp_TransmittedHandler transmittedHandler;
+    void* transmittedContext;
+
+    IsoTp_State rxState;
+    size_t rxLength;
+    size_t rxOffset;
+    uint8_t rxSequence;
+    uint8_t rxBlockCount;
+    uint64_t rxDeadline;
+    bool rxFlowControlPending;
+    uint8_t rxFlowStatus;
+    uint8_t rxBuffer[ISOTP_MAX_MESSAGE_SIZE];
+
+    IsoTp_State txState;
+    size_t txLength;
+    size_t txOffset;
+    uint8_t txSequence;
+    uint8_t txBlockSize;
+    uint8_t txBlockCount;
+    uint64_t txSeparationTime;
+    uint64_t txNextTime;
+    uint64_t txDeadline;
+    uint8_t txBuffer[ISOTP_MAX_MESSAGE_SIZE];
+};
+
+TinyCLR_Result IsoTp_Initialize(IsoTp_Channel& channel, const IsoTp_Configuration& configuration);
+void IsoTp_SetReceivedHandler(IsoTp_Channel& channel, IsoTp_ReceivedHandler handler, void* context);
+void IsoTp_SetTransmittedHandler(IsoTp_Channel& channel, IsoTp_TransmittedHandler handler, void* context);
+
+TinyCLR_Result IsoTp_Send(IsoTp_Channel& channel, const uint8_t* data, size_t length);
+TinyCLR_Result IsoTp_Read(IsoTp_Channel& channel, uint8_t* data, size_t& length);
+
+// Feeds one received frame to the channel, returns false when the frame is not addressed to it. The signature
+// matches the targets' <Target>_Can_SetFrameHandler hook so a channel can be attached to the receive interrupt.
+bool IsoTp_FrameHandler(const TinyCLR_Can_Message& message, uint64_t timestamp, void* context);
+
+// Sends consecutive frames that were held back by the separation time or a full controller, retries a
+// flow control frame the receive path could not send, and expires timed out transfers. Returns the
+// system time at which it needs to be called again, 0 when no transfer is pending.
+uint64_t IsoTp_Process(IsoTp_Channel& channel);
+
+// Two CAN controllers wired back to back on a virtual clock, so that channels can be run against each other on
+// a host or on a device without a bus. A channel attached to a side is configured with that side's controller
+// and the loopback time controller.
+struct IsoTp_Loopback {
+    TinyCLR_Can_Controller canController[2];
+    TinyCLR_Api_Info canApi[2];
+
+    TinyCLR_NativeTime_Controller timeController;
+    TinyCLR_Api_Info timeApi;
+
+    IsoTp_Channel* channel[2];
+
+    TinyCLR_Can_Message queue[ISOTP_LOOPBACK_QUEUE_SIZE];
+    size_t queueSide[ISOTP_LOOPBACK_QUEUE_SIZE];
+    size_t queueIn;
+    size_t queueOut;
+    size_t queueCount;
+
+    uint32_t bitRate;
+    uint64_t clock;
+
+    uint64_t frameCount;
+};
+
+TinyCLR_Result IsoTp_Loopback_Initialize(IsoTp_Loopback& loopback, uint32_t bitRate);
+void IsoTp_Loopback_Attach(IsoTp_Loopback& loopback, size_t side, IsoTp_Channel* channel);
+void IsoTp_Loopback_Run(IsoTp_Loopback& loopback, uint64_t timeout);
@@ -0,0 +1,391 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <string.h>
+#include "SpiDisplay.h"
+
+#define SPI_DISPLAY_SWAP_BUFFER_SIZE 64
+#define SPI_DISPLAY_WAIT_STEP 10
+
+static SpiDisplay* SpiDisplay_Get(const TinyCLR_Display_Controller* self) {
+    return reinterpret_cast<SpiDisplay*>(self->ApiInfo->State);
+}
+
+static void SpiDisplay_Done(void* context, TinyCLR_Result result) {
+    auto display = reinterpret_cast<SpiDisplay*>(context);
+
+    display->transferResult = result;
+    display->busy = false;
+}
+
+// A transfer whose done never comes is given up on, so a stalled transport can't hang every later call
+TinyCLR_Result SpiDisplay_WaitForCompletion(SpiDisplay& display) {
+    auto& transport = display.transport;
+
+    for (uint64_t waited = 0; display.busy; waited += SPI_DISPLAY_WAIT_STEP) {
+        if (waited >= SPI_DISPLAY_TRANSFER_TIMEOUT) {
+            display.transferResult = TinyCLR_Result::TimedOut;
+            display.busy = false;
+
+            break;
+        }
+
+        transport.Delay(transport.Context, SPI_DISPLAY_WAIT_STEP);
+    }
+
+    auto result = display.transferResult;
+
+    display.transferResult = TinyCLR_Result::Success;
+
+    return result;
+}
+
+static TinyCLR_Result SpiDisplay_WriteCommand(SpiDisplay& display, uint8_t command, const uint8_t* parameters, size_t length) {
+    return display.transport.WriteCommand(display.transport.Context, command, parameters, length);
+}
+
+static TinyCLR_Result SpiDisplay_SetAddress(SpiDisplay& display, uint8_t command, uint32_t start, uint32_t end) {
+    uint8_t parameters[4] = { static_cast<uint8_t>(start >> 8), static_cast<uint8_t>(start), static_cast<uint8_t>(end >> 8), static_cast<uint8_t>(end) };
+
+    return SpiDisplay_WriteCommand(display, command, parameters, sizeof(parameters));
+}
+
+// The panel wraps to the next row of the window by itself, so one RAMWR carries the whole region
+static TinyCLR_Result SpiDisplay_WriteRegion(SpiDisplay& display, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint16_t* pixels) {
+    auto& configuration = display.configuration;
+
+    if (x >= configuration.Width || y >= configuration.Height || width > configuration.Width - x || height > configuration.Height - y)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    if (width == 0 || height == 0)
+        return TinyCLR_Result::Success;
+
+    x += configuration.ColumnOffset;
+    y += configuration.RowOffset;
+
+    auto result = SpiDisplay_SetAddress(display, SPI_DISPLAY_COMMAND_COLUMN_ADDRESS_SET, x, x + width - 1);
+
+    if (result == TinyCLR_Result::Success)
+        result = SpiDisplay_SetAddress(display, SPI_DISPLAY_COMMAND_ROW_ADDRESS_SET, y, y + height - 1);
+
+    if (result == TinyCLR_Result::Success)
+        result = SpiDisplay_WriteCommand(display, SPI_DISPLAY_COMMAND_MEMORY_WRITE, nullptr, 0);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    display.busy = true;
+
+    result = display.transport.WritePixels(display.transport.Context, pixels, static_cast<size_t>(width) * height, &SpiDisplay_Done, &display);
+
+    if (result != TinyCLR_Result::Success)
+        display.busy = false;
+
+    return result;
+}
+
+static TinyCLR_Result SpiDisplay_Acquire(const TinyCLR_Display_Controller* self) {
+    SpiDisplay_Get(self)->acquireCount++;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result SpiDisplay_Release(const TinyCLR_Display_Controller* self) {
+    auto display = SpiDisplay_Get(self);
+
+    if (display->acquireCount == 0)
+        return TinyCLR_Result::InvalidOperation;
+
+    SpiDisplay_WaitForCompletion(*display);
+
+    display->acquireCount--;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result SpiDisplay_Enable(const TinyCLR_Display_Controller* self) {
+    auto display = SpiDisplay_Get(self);
+    auto& transport = display->transport;
+
+    if (display->enabled)
+        return TinyCLR_Result::Success;
+
+    auto result = SpiDisplay_WaitForCompletion(*display);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    uint8_t pixelFormat = SPI_DISPLAY_PIXEL_FORMAT_16BIT;
+    uint8_t memoryAccessControl = display->configuration.MemoryAccessControl;
+
+    result = SpiDisplay_WriteCommand(*display, SPI_DISPLAY_COMMAND_SOFTWARE_RESET, nullptr, 0);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    transport.Delay(transport.Context, SPI_DISPLAY_RESET_DELAY);
+
+    result = SpiDisplay_WriteCommand(*display, SPI_DISPLAY_COMMAND_SLEEP_OUT, nullptr, 0);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    transport.Delay(transport.Context, SPI_DISPLAY_RESET_DELAY);
+
+    result = SpiDisplay_WriteCommand(*display, SPI_DISPLAY_COMMAND_PIXEL_FORMAT_SET, &pixelFormat, 1);
+
+    if (result == TinyCLR_Result::Success)
+        result = SpiDisplay_WriteCommand(*display, SPI_DISPLAY_COMMAND_MEMORY_ACCESS_CONTROL, &memoryAccessControl, 1);
+
+    if (result == TinyCLR_Result::Success)
+        result = SpiDisplay_WriteCommand(*display, SPI_DISPLAY_COMMAND_DISPLAY_ON, nullptr, 0);
+
+    if (result == TinyCLR_Result::Success)
+        display->enabled = true;
+
+    return result;
+}
+
+static TinyCLR_Result SpiDisplay_Disable(const TinyCLR_Display_Controller* self) {
+    auto display = SpiDisplay_Get(self);
+
+    if (!display->enabled)
+        return TinyCLR_Result::Success;
+
+    auto result = SpiDisplay_WaitForCompletion(*display);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    display->enabled = false;
+
+    return SpiDisplay_WriteCommand(*display, SPI_DISPLAY_COMMAND_DISPLAY_OFF, nullptr, 0);
+}
+
+static TinyCLR_Result SpiDisplay_SetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat dataFormat, uint32_t width, uint32_t height, const void* configuration) {
+    auto display = SpiDisplay_Get(self);
+
+    if (dataFormat != TinyCLR_Display_DataFormat::Rgb565)
+        return TinyCLR_Result::NotSupported;
+
+    if (width == 0 || height == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    if (display->enabled)
+        return TinyCLR_Result::InvalidOperation;
+
+    display->configuration.Width = width;
+    display->configuration.Height = height;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result SpiDisplay_GetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat& dataFormat, uint32_t& width, uint32_t& height, void* configuration) {
+    auto display = SpiDisplay_Get(self);
+
+    dataFormat = TinyCLR_Display_DataFormat::Rgb565;
+    width = display->configuration.Width;
+    height = display->configuration.Height;
+
+    return TinyCLR_Result::Success;
+}
+
+static const TinyCLR_Display_DataFormat spiDisplayDataFormats[] = { TinyCLR_Display_DataFormat::Rgb565 };
+
+static TinyCLR_Result SpiDisplay_GetCapabilities(const TinyCLR_Display_Controller* self, TinyCLR_Display_InterfaceType& type, const TinyCLR_Display_DataFormat*& supportedDataFormats, size_t& supportedDataFormatCount) {
+    type = TinyCLR_Display_InterfaceType::Spi;
+    supportedDataFormats = spiDisplayDataFormats;
+    supportedDataFormatCount = sizeof(spiDisplayDataFormats) / sizeof(spiDisplayDataFormats[0]);
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result SpiDisplay_DrawBuffer(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data) {
+    auto display = SpiDisplay_Get(self);
+
+    if (data == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (!display->enabled)
+        return TinyCLR_Result::InvalidOperation;
+
+    auto result = SpiDisplay_WaitForCompletion(*display);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    auto& configuration = display->configuration;
+    auto count = static_cast<size_t>(width) * height;
+
+    if (configuration.Buffer != nullptr && count <= configuration.BufferSize) {
+        memcpy(configuration.Buffer, data, count * sizeof(uint16_t));
+
+        return SpiDisplay_WriteRegion(*display, x, y, width, height, configuration.Buffer);
+    }
+
+    result = SpiDisplay_WriteRegion(*display, x, y, width, height, reinterpret_cast<const uint16_t*>(data));
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    return SpiDisplay_WaitForCompletion(*display);
+}
+
+// The pixel is sent from the controller so the caller has nothing to keep
+static TinyCLR_Result SpiDisplay_DrawPixel(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint64_t color) {
+    auto display = SpiDisplay_Get(self);
+
+    if (!display->enabled)
+        return TinyCLR_Result::InvalidOperation;
+
+    auto result = SpiDisplay_WaitForCompletion(*display);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    display->pixel = static_cast<uint16_t>(color);
+
+    return SpiDisplay_WriteRegion(*display, x, y, 1, 1, &display->pixel);
+}
+
+static TinyCLR_Result SpiDisplay_DrawString(const TinyCLR_Display_Controller* self, const char* data, size_t length) {
+    return TinyCLR_Result::NotSupported;
+}
+
+TinyCLR_Result SpiDisplay_Initialize(SpiDisplay& display, const SpiDisplay_Configuration& configuration, const SpiDisplay_Transport& transport) {
+    if (transport.WriteCommand == nullptr || transport.WritePixels == nullptr || transport.Delay == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (configuration.Width == 0 || configuration.Height == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    memset(&display, 0, sizeof(display));
+
+    display.configuration = configuration;
+    display.transport = transport;
+
+    display.controller.ApiInfo = &display.api;
+    display.controller.Acquire = &SpiDisplay_Acquire;
+    display.controller.Release = &SpiDisplay_Release;
+    display.controller.Enable = &SpiDisplay_Enable;
+    display.controller.Disable = &SpiDisplay_Disable;
+    display.controller.SetConfiguration = &SpiDisplay_SetConfiguration;
+    display.controller.GetConfiguration = &SpiDisplay_GetConfiguration;
+    display.controller.GetCapabilities = &SpiDisplay_GetCapabilities;
+    display.controller.DrawBuffer = &SpiDisplay_DrawBuffer;
+    display.controller.DrawPixel = &SpiDisplay_DrawPixel;
+    display.controller.DrawString = &SpiDisplay_DrawString;
+
+    display.api.Author = "GHI Electronics, LLC";
+    display.api.Name = "GHIElectronics.TinyCLR.NativeApis.SpiDisplay.DisplayController";
+    display.api.Type = TinyCLR_Api_Type::DisplayController;
+    display.api.Version = 0;
+    display.api.Implementation = &display.controller;
+    display.api.State = &display;
+
+    return TinyCLR_Result::Success;
+}
+
+// The name must be unique when more than one panel is added
+TinyCLR_Result SpiDisplay_AddApi(SpiDisplay& display, const TinyCLR_Api_Manager* apiManager, const char* name) {
+    if (name != nullptr)
+        display.api.Name = name;
+
+    return apiManager->Add(apiManager, &display.api);
+}
+
+static SpiDisplay_SpiTransport* SpiDisplay_SpiTransport_Get(void* context) {
+    return reinterpret_cast<SpiDisplay_SpiTransport*>(context);
+}
+
+static TinyCLR_Result SpiDisplay_SpiTransport_Write(SpiDisplay_SpiTransport* spiTransport, const uint8_t* data, size_t length) {
+    size_t readLength = 0;
+
+    return spiTransport->spi->WriteRead(spiTransport->spi, data, length, nullptr, readLength, true);
+}
+
+static TinyCLR_Result SpiDisplay_SpiTransport_WriteCommand(void* context, uint8_t command, const uint8_t* parameters, size_t length) {
+    auto spiTransport = SpiDisplay_SpiTransport_Get(context);
+    auto gpio = spiTransport->gpio;
+
+    gpio->Write(gpio, spiTransport->dataCommandPin, TinyCLR_Gpio_PinValue::Low);
+
+    auto result = SpiDisplay_SpiTransport_Write(spiTransport, &command, 1);
+
+    gpio->Write(gpio, spiTransport->dataCommandPin, TinyCLR_Gpio_PinValue::High);
+
+    if (result == TinyCLR_Result::Success && length > 0)
+        result = SpiDisplay_SpiTransport_Write(spiTransport, parameters, length);
+
+    return result;
+}
+
+static TinyCLR_Result SpiDisplay_SpiTransport_WritePixels(void* context, const uint16_t* pixels, size_t count, SpiDisplay_DoneHandler done, void* doneContext) {
+    auto spiTransport = SpiDisplay_SpiTransport_Get(context);
+
+    if (spiTransport->writeWords != nullptr)
+        return spiTransport->writeWords(spiTransport->spi, pixels, count, done, doneContext);
+
+    uint8_t buffer[SPI_DISPLAY_SWAP_BUFFER_SIZE];
+
+    while (count > 0) {
+        auto block = count < SPI_DISPLAY_SWAP_BUFFER_SIZE / 2 ? count : SPI_DISPLAY_SWAP_BUFFER_SIZE / 2;
+
+        for (size_t i = 0; i < block; i++) {
+            buffer[i * 2] = static_cast<uint8_t>(pixels[i] >> 8);
+            buffer[i * 2 + 1] = static_cast<uint8_t>(pixels[i]);
+        }
+
+        auto result = SpiDisplay_SpiTransport_Write(spiTransport, buffer, block * 2);
+
+        if (result != TinyCLR_Result::Success)
+            return result;
+
+        pixels += block;
+        count -= block;
+    }
+
+    done(doneContext, TinyCLR_Result::Success);
+
+    return TinyCLR_Result::Success;
+}
+
+static void SpiDisplay_SpiTransport_Delay(void* context, uint64_t microseconds) {
+    auto time = SpiDisplay_SpiTransport_Get(context)->time;
+    auto start = time->GetNativeTime(time);
+
+    while (time->ConvertNativeTimeToSystemTime(time, time->GetNativeTime(time) - start) < microseconds * 10);
+}
+
+TinyCLR_Result SpiDisplay_SpiTransport_Initialize(SpiDisplay_SpiTransport& spiTransport, SpiDisplay_Transport& transport) {
+    if (spiTransport.spi == nullptr || spiTransport.gpio == nullptr || spiTransport.time == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    auto gpio = spiTransport.gpio;
+    auto result = gpio->OpenPin(gpio, spiTransport.dataCommandPin);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    gpio->SetDriveMode(gpio, spiTransport.dataCommandPin, TinyCLR_Gpio_PinDriveMode::Output);
+    gpio->Write(gpio, spiTransport.dataCommandPin, TinyCLR_Gpio_PinValue::High);
+
+    transport.Context = &spiTransport;
+    transport.WriteCommand = &SpiDisplay_SpiTransport_WriteCommand;
+    transport.WritePixels = &SpiDisplay_SpiTransport_WritePixels;
+    transport.Delay = &SpiDisplay_SpiTransport_Delay;
+
+    return TinyCLR_Result::Success;
+}
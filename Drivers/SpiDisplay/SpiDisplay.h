@@ -0,0 +1,97 @@
+#pragma once
+
+#include <TinyCLR.h>
+
+// MIPI DCS commands understood by the ILI9341, ST7735 and ST7789 family of panels
+#define SPI_DISPLAY_COMMAND_SOFTWARE_RESET 0x01
+#define SPI_DISPLAY_COMMAND_SLEEP_OUT 0x11
+#define SPI_DISPLAY_COMMAND_DISPLAY_OFF 0x28
+#define SPI_DISPLAY_COMMAND_DISPLAY_ON 0x29
+#define SPI_DISPLAY_COMMAND_COLUMN_ADDRESS_SET 0x2A
+#define SPI_DISPLAY_COMMAND_ROW_ADDRESS_SET 0x2B
+#define SPI_DISPLAY_COMMAND_MEMORY_WRITE 0x2C
+#define SPI_DISPLAY_COMMAND_MEMORY_ACCESS_CONTROL 0x36
+#define SPI_DISPLAY_COMMAND_PIXEL_FORMAT_SET 0x3A
+
+#define SPI_DISPLAY_PIXEL_FORMAT_16BIT 0x55
+
+// Microseconds the panel needs after a reset or sleep out before it takes the next command
+#define SPI_DISPLAY_RESET_DELAY 120000
+
+// Microseconds a pixel transfer may take before the controller gives up waiting for it
+#ifndef SPI_DISPLAY_TRANSFER_TIMEOUT
+#define SPI_DISPLAY_TRANSFER_TIMEOUT (5 * 1000000)
+#endif
+
+typedef void(*SpiDisplay_DoneHandler)(void* context, TinyCLR_Result result);
+
+// How the controller reaches the panel. WriteCommand sends the command byte with D/C low and its parameters with
+// D/C high. WritePixels sends count Rgb565 pixels with D/C high, high byte first as the panel expects, and may
+// return before they are out; done is then called with the outcome once the transfer ends, possibly from an
+// interrupt.
+struct SpiDisplay_Transport {
+    void* Context;
+
+    TinyCLR_Result(*WriteCommand)(void* context, uint8_t command, const uint8_t* parameters, size_t length);
+    TinyCLR_Result(*WritePixels)(void* context, const uint16_t* pixels, size_t count, SpiDisplay_DoneHandler done, void* doneContext);
+    void(*Delay)(void* context, uint64_t microseconds);
+};
+
+struct SpiDisplay_Configuration {
+    uint32_t Width;
+    uint32_t Height;
+
+    // Where the visible area starts in the panel memory, some ST7735 modules are 2 or 3 pixels in
+    uint32_t ColumnOffset;
+    uint32_t RowOffset;
+
+    // MADCTL value, sets the scan direction and RGB/BGR order
+    uint8_t MemoryAccessControl;
+
+    // Optional, BufferSize pixels owned by the controller. Regions that fit are copied here and sent while
+    // DrawBuffer returns, larger ones are sent from the caller's data and waited for.
+    uint16_t* Buffer;
+    size_t BufferSize;
+};
+
+// A display controller for panels with their own memory. DrawBuffer sends the window for the region, then its
+// pixels. The caller's data, which the GC may move once DrawBuffer returns, is never read after that. Every call
+// into the controller waits for the previous transfer first, and fails with its result when it failed or timed
+// out. The call after that goes ahead again.
+struct SpiDisplay {
+    TinyCLR_Display_Controller controller;
+    TinyCLR_Api_Info api;
+
+    SpiDisplay_Configuration configuration;
+    SpiDisplay_Transport transport;
+
+    size_t acquireCount;
+    bool enabled;
+    volatile bool busy;
+    volatile TinyCLR_Result transferResult;
+
+    uint16_t pixel;
+};
+
+TinyCLR_Result SpiDisplay_Initialize(SpiDisplay& display, const SpiDisplay_Configuration& configuration, const SpiDisplay_Transport& transport);
+TinyCLR_Result SpiDisplay_AddApi(SpiDisplay& display, const TinyCLR_Api_Manager* apiManager, const char* name);
+
+// Returns the result of the last pixel transfer, or TimedOut when it did not end within SPI_DISPLAY_TRANSFER_TIMEOUT
+TinyCLR_Result SpiDisplay_WaitForCompletion(SpiDisplay& display);
+
+// Writes 16 bit words with the SPI controller's chip select handling and calls done when the last one is out or
+// the transfer failed, such as a target's DMA transfer. Words go out most significant byte first.
+typedef TinyCLR_Result(*SpiDisplay_WriteWordsHandler)(const TinyCLR_Spi_Controller* self, const uint16_t* words, size_t count, SpiDisplay_DoneHandler done, void* context);
+
+// Transport over a SPI controller and a D/C pin. The SPI controller must already be configured for the panel.
+// Without writeWords the pixels are swapped through a small buffer and written before WritePixels returns.
+struct SpiDisplay_SpiTransport {
+    const TinyCLR_Spi_Controller* spi;
+    const TinyCLR_Gpio_Controller* gpio;
+    const TinyCLR_NativeTime_Controller* time;
+    uint32_t dataCommandPin;
+
+    SpiDisplay_WriteWordsHandler writeWords;
+};
+
+TinyCLR_Result SpiDisplay_SpiTransport_Initialize(SpiDisplay_SpiTransport& spiTransport, SpiDisplay_Transport& transport);
@@ -0,0 +1,425 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+
+#include "StorageBenchmark.h"
+
+#define STORAGE_BENCHMARK_TICKS_PER_SECOND 10000000ULL
+#define STORAGE_BENCHMARK_RANDOM_SEED 0x2545F491
+
+#define SIMULATED_CARD_SECTOR_SIZE 512
+#define SIMULATED_CARD_COMMAND_CLOCKS (48 + 8 + 48)
+#define SIMULATED_CARD_CRC_CLOCKS (16 + 2)
+
+static uint32_t StorageBenchmark_NextRandom(uint32_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    return seed;
+}
+
+static void StorageBenchmark_SortSamples(uint64_t* samples, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        auto value = samples[i];
+        auto j = i;
+
+        while (j > 0 && samples[j - 1] > value) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+
+        samples[j] = value;
+    }
+}
+
+static uint64_t StorageBenchmark_Percentile(const uint64_t* sortedSamples, size_t count, uint32_t percent) {
+    if (count == 0)
+        return 0;
+
+    auto index = (count * percent + 99) / 100;
+
+    return sortedSamples[index > 0 ? index - 1 : 0];
+}
+
+TinyCLR_Result StorageBenchmark_Run(const StorageBenchmark_Configuration& configuration, StorageBenchmark_Pattern pattern, size_t blockSize, StorageBenchmark_Result& result) {
+    uint64_t samples[STORAGE_BENCHMARK_MAX_SAMPLES];
+
+    auto storage = configuration.Storage;
+    auto time = configuration.Time;
+
+    if (storage == nullptr || time == nullptr || configuration.Buffer == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (blockSize < STORAGE_BENCHMARK_MIN_BLOCK_SIZE || blockSize > STORAGE_BENCHMARK_MAX_BLOCK_SIZE || (blockSize % STORAGE_BENCHMARK_MIN_BLOCK_SIZE) != 0)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    if (blockSize > configuration.BufferSize || blockSize > configuration.RegionSize)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    auto slots = configuration.RegionSize / blockSize;
+    auto operations = configuration.Operations;
+
+    if (operations == 0 || operations > STORAGE_BENCHMARK_MAX_SAMPLES)
+        operations = STORAGE_BENCHMARK_MAX_SAMPLES;
+
+    memset(&result, 0, sizeof(result));
+
+    result.Pattern = pattern;
+    result.BlockSize = blockSize;
+
+    if (pattern == StorageBenchmark_Pattern::SequentialWrite || pattern == StorageBenchmark_Pattern::RandomWrite)
+        for (size_t i = 0; i < blockSize; i++)
+            configuration.Buffer[i] = static_cast<uint8_t>(i ^ (i >> 8));
+
+    uint32_t seed = STORAGE_BENCHMARK_RANDOM_SEED;
+    size_t sampleCount = 0;
+
+    for (size_t i = 0; i < operations; i++) {
+        auto slot = (pattern == StorageBenchmark_Pattern::RandomRead || pattern == StorageBenchmark_Pattern::RandomWrite) ? StorageBenchmark_NextRandom(seed) % slots : i % slots;
+        auto address = configuration.RegionAddress + static_cast<uint64_t>(slot) * blockSize;
+        auto count = blockSize;
+
+        TinyCLR_Result status;
+
+        auto start = time->GetNativeTime(time);
+
+        switch (pattern) {
+        case StorageBenchmark_Pattern::SequentialRead:
+        case StorageBenchmark_Pattern::RandomRead:
+            status = storage->Read(storage, address, count, configuration.Buffer, configuration.Timeout);
+            break;
+
+        case StorageBenchmark_Pattern::SequentialWrite:
+        case StorageBenchmark_Pattern::RandomWrite:
+            status = storage->Write(storage, address, count, configuration.Buffer, configuration.Timeout);
+            break;
+
+        case StorageBenchmark_Pattern::Erase:
+            status = storage->Erase(storage, address, count, configuration.Timeout);
+            break;
+
+        default:
+            return TinyCLR_Result::ArgumentInvalid;
+        }
+
+        auto latency = time->ConvertNativeTimeToSystemTime(time, time->GetNativeTime(time) - start);
+
+        result.ElapsedTime += latency;
+
+        if (status != TinyCLR_Result::Success) {
+            result.Failures++;
+
+            continue;
+        }
+
+        result.Operations++;
+        result.TotalBytes += blockSize;
+
+        samples[sampleCount++] = latency;
+    }
+
+    if (sampleCount > 0) {
+        StorageBenchmark_SortSamples(samples, sampleCount);
+
+        result.LatencyMin = samples[0];
+        result.LatencyP50 = StorageBenchmark_Percentile(samples, sampleCount, 50);
+        result.LatencyP95 = StorageBenchmark_Percentile(samples, sampleCount, 95);
+        result.LatencyP99 = StorageBenchmark_Percentile(samples, sampleCount, 99);
+        result.LatencyMax = samples[sampleCount - 1];
+    }
+
+    if (result.ElapsedTime > 0) {
+        result.KiloBytesPerSecond = static_cast<uint32_t>((result.TotalBytes * STORAGE_BENCHMARK_TICKS_PER_SECOND / result.ElapsedTime) / 1024);
+        result.OperationsPerSecond = static_cast<uint32_t>(result.Operations * STORAGE_BENCHMARK_TICKS_PER_SECOND / result.ElapsedTime);
+    }
+
+    return result.Failures == 0 ? TinyCLR_Result::Success : TinyCLR_Result::InvalidOperation;
+}
+
+TinyCLR_Result StorageBenchmark_RunSuite(const StorageBenchmark_Configuration& configuration, StorageBenchmark_ReportHandler handler, void* context) {
+    static const StorageBenchmark_Pattern patterns[] = {
+        StorageBenchmark_Pattern::SequentialRead,
+        StorageBenchmark_Pattern::SequentialWrite,
+        StorageBenchmark_Pattern::RandomRead,
+        StorageBenchmark_Pattern::RandomWrite,
+    };
+
+    StorageBenchmark_Result result;
+
+    auto status = TinyCLR_Result::Success;
+    size_t largestBlockSize = 0;
+
+    for (size_t blockSize = STORAGE_BENCHMARK_MIN_BLOCK_SIZE; blockSize <= STORAGE_BENCHMARK_MAX_BLOCK_SIZE; blockSize *= 2) {
+        if (blockSize > configuration.BufferSize || blockSize > configuration.RegionSize)
+            break;
+
+        largestBlockSize = blockSize;
+
+        for (auto pattern : patterns) {
+            if (StorageBenchmark_Run(configuration, pattern, blockSize, result) != TinyCLR_Result::Success)
+                status = TinyCLR_Result::InvalidOperation;
+
+            if (handler != nullptr)
+                handler(result, context);
+        }
+    }
+
+    if (largestBlockSize == 0)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    if (StorageBenchmark_Run(configuration, StorageBenchmark_Pattern::Erase, largestBlockSize, result) != TinyCLR_Result::Success)
+        status = TinyCLR_Result::InvalidOperation;
+
+    if (handler != nullptr)
+        handler(result, context);
+
+    return status;
+}
+
+static StorageBenchmark_SimulatedCard* StorageBenchmark_SimulatedCard_GetCard(const TinyCLR_Api_Info* apiInfo) {
+    return reinterpret_cast<StorageBenchmark_SimulatedCard*>(apiInfo->State);
+}
+
+static uint64_t StorageBenchmark_SimulatedCard_ClocksToTime(const StorageBenchmark_SimulatedCard* card, uint64_t clocks) {
+    return (clocks * STORAGE_BENCHMARK_TICKS_PER_SECOND + card->timing.BusClockHz - 1) / card->timing.BusClockHz;
+}
+
+static void StorageBenchmark_SimulatedCard_Command(StorageBenchmark_SimulatedCard* card) {
+    card->clock += StorageBenchmark_SimulatedCard_ClocksToTime(card, SIMULATED_CARD_COMMAND_CLOCKS);
+    card->commandCount++;
+}
+
+static void StorageBenchmark_SimulatedCard_DataBlock(StorageBenchmark_SimulatedCard* card) {
+    card->clock += StorageBenchmark_SimulatedCard_ClocksToTime(card, (SIMULATED_CARD_SECTOR_SIZE * 8) / card->timing.BusWidth + SIMULATED_CARD_CRC_CLOCKS);
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_Transfer(StorageBenchmark_SimulatedCard* card, uint64_t address, size_t count, bool write) {
+    if ((address % SIMULATED_CARD_SECTOR_SIZE) != 0 || (count % SIMULATED_CARD_SECTOR_SIZE) != 0 || count == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    auto sector = address / SIMULATED_CARD_SECTOR_SIZE;
+    auto sectors = count / SIMULATED_CARD_SECTOR_SIZE;
+
+    if (sector + sectors > card->sectorCount)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    if (sector != card->nextSector)
+        card->clock += card->timing.RandomAccessPenalty;
+
+    // CMD17/CMD24 or CMD18/CMD25
+    StorageBenchmark_SimulatedCard_Command(card);
+
+    for (size_t i = 0; i < sectors; i++) {
+        if (!write)
+            card->clock += card->timing.ReadAccessTime;
+
+        StorageBenchmark_SimulatedCard_DataBlock(card);
+
+        if (write)
+            card->clock += card->timing.WriteBusyTime;
+    }
+
+    // CMD12
+    if (sectors > 1)
+        StorageBenchmark_SimulatedCard_Command(card);
+
+    card->nextSector = sector + sectors;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_Acquire(const TinyCLR_Storage_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_Release(const TinyCLR_Storage_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_Open(const TinyCLR_Storage_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_Close(const TinyCLR_Storage_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_Read(const TinyCLR_Storage_Controller* self, uint64_t address, size_t& count, uint8_t* data, uint64_t timeout) {
+    auto card = StorageBenchmark_SimulatedCard_GetCard(self->ApiInfo);
+    auto result = StorageBenchmark_SimulatedCard_Transfer(card, address, count, false);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    if (card->memory != nullptr) {
+        memcpy(data, card->memory + address, count);
+    }
+    else {
+        for (size_t i = 0; i < count; i++)
+            data[i] = static_cast<uint8_t>((address + i) ^ ((address + i) >> 9));
+    }
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_Write(const TinyCLR_Storage_Controller* self, uint64_t address, size_t& count, const uint8_t* data, uint64_t timeout) {
+    auto card = StorageBenchmark_SimulatedCard_GetCard(self->ApiInfo);
+    auto result = StorageBenchmark_SimulatedCard_Transfer(card, address, count, true);
+
+    if (result != TinyCLR_Result::Success)
+        return result;
+
+    if (card->memory != nullptr)
+        memcpy(card->memory + address, data, count);
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_Erase(const TinyCLR_Storage_Controller* self, uint64_t address, size_t& count, uint64_t timeout) {
+    auto card = StorageBenchmark_SimulatedCard_GetCard(self->ApiInfo);
+
+    if ((address % SIMULATED_CARD_SECTOR_SIZE) != 0 || (count % SIMULATED_CARD_SECTOR_SIZE) != 0 || count == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    if ((address + count) / SIMULATED_CARD_SECTOR_SIZE > card->sectorCount)
+        return TinyCLR_Result::ArgumentOutOfRange;
+
+    // CMD32, CMD33, CMD38
+    StorageBenchmark_SimulatedCard_Command(card);
+    StorageBenchmark_SimulatedCard_Command(card);
+    StorageBenchmark_SimulatedCard_Command(card);
+
+    card->clock += card->timing.EraseBusyTime;
+
+    if (card->memory != nullptr)
+        memset(card->memory + address, 0xFF, count);
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_IsErased(const TinyCLR_Storage_Controller* self, uint64_t address, size_t count, bool& erased) {
+    erased = true;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_GetDescriptor(const TinyCLR_Storage_Controller* self, const TinyCLR_Storage_Descriptor*& descriptor) {
+    auto card = StorageBenchmark_SimulatedCard_GetCard(self->ApiInfo);
+
+    descriptor = &card->descriptor;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_InitializeTime(const TinyCLR_NativeTime_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_UninitializeTime(const TinyCLR_NativeTime_Controller* self) {
+    return TinyCLR_Result::Success;
+}
+
+static uint64_t StorageBenchmark_SimulatedCard_GetNativeTime(const TinyCLR_NativeTime_Controller* self) {
+    return StorageBenchmark_SimulatedCard_GetCard(self->ApiInfo)->clock;
+}
+
+static uint64_t StorageBenchmark_SimulatedCard_ConvertTime(const TinyCLR_NativeTime_Controller* self, uint64_t time) {
+    return time;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_SetCallback(const TinyCLR_NativeTime_Controller* self, TinyCLR_NativeTime_Callback callback) {
+    return TinyCLR_Result::NotSupported;
+}
+
+static TinyCLR_Result StorageBenchmark_SimulatedCard_ScheduleCallback(const TinyCLR_NativeTime_Controller* self, uint64_t processorTicks) {
+    return TinyCLR_Result::NotSupported;
+}
+
+static void StorageBenchmark_SimulatedCard_Wait(const TinyCLR_NativeTime_Controller* self, uint64_t nativeTime) {
+    StorageBenchmark_SimulatedCard_GetCard(self->ApiInfo)->clock += nativeTime;
+}
+
+void StorageBenchmark_SimulatedCard_GetDefaultTiming(StorageBenchmark_SimulatedCardTiming& timing) {
+    timing.BusClockHz = 25000000;
+    timing.BusWidth = 4;
+
+    timing.ReadAccessTime = 1000;       // 100us
+    timing.WriteBusyTime = 2500;        // 250us
+    timing.EraseBusyTime = 20000;       // 2ms
+    timing.RandomAccessPenalty = 5000;  // 500us
+}
+
+TinyCLR_Result StorageBenchmark_SimulatedCard_Initialize(StorageBenchmark_SimulatedCard& card, const StorageBenchmark_SimulatedCardTiming& timing, uint8_t* memory, size_t sectorCount) {
+    if (timing.BusClockHz == 0 || (timing.BusWidth != 1 && timing.BusWidth != 4) || sectorCount == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    memset(&card, 0, sizeof(card));
+
+    card.timing = timing;
+    card.memory = memory;
+    card.sectorCount = sectorCount;
+
+    card.storageController.ApiInfo = &card.storageApi;
+    card.storageController.Acquire = &StorageBenchmark_SimulatedCard_Acquire;
+    card.storageController.Release = &StorageBenchmark_SimulatedCard_Release;
+    card.storageController.Open = &StorageBenchmark_SimulatedCard_Open;
+    card.storageController.Close = &StorageBenchmark_SimulatedCard_Close;
+    card.storageController.Write = &StorageBenchmark_SimulatedCard_Write;
+    card.storageController.Read = &StorageBenchmark_SimulatedCard_Read;
+    card.storageController.Erase = &StorageBenchmark_SimulatedCard_Erase;
+    card.storageController.IsErased = &StorageBenchmark_SimulatedCard_IsErased;
+    card.storageController.GetDescriptor = &StorageBenchmark_SimulatedCard_GetDescriptor;
+
+    card.storageApi.Author = "GHI Electronics, LLC";
+    card.storageApi.Name = "GHIElectronics.TinyCLR.NativeApis.StorageBenchmark.SimulatedCardStorageController";
+    card.storageApi.Type = TinyCLR_Api_Type::StorageController;
+    card.storageApi.Version = 0;
+    card.storageApi.Implementation = &card.storageController;
+    card.storageApi.State = &card;
+
+    card.timeController.ApiInfo = &card.timeApi;
+    card.timeController.Initialize = &StorageBenchmark_SimulatedCard_InitializeTime;
+    card.timeController.Uninitialize = &StorageBenchmark_SimulatedCard_UninitializeTime;
+    card.timeController.GetNativeTime = &StorageBenchmark_SimulatedCard_GetNativeTime;
+    card.timeController.ConvertNativeTimeToSystemTime = &StorageBenchmark_SimulatedCard_ConvertTime;
+    card.timeController.ConvertSystemTimeToNativeTime = &StorageBenchmark_SimulatedCard_ConvertTime;
+    card.timeController.SetCallback = &StorageBenchmark_SimulatedCard_SetCallback;
+    card.timeController.ScheduleCallback = &StorageBenchmark_SimulatedCard_ScheduleCallback;
+    card.timeController.Wait = &StorageBenchmark_SimulatedCard_Wait;
+
+    card.timeApi.Author = "GHI Electronics, LLC";
+    card.timeApi.Name = "GHIElectronics.TinyCLR.NativeApis.StorageBenchmark.SimulatedCardTimeController";
+    card.timeApi.Type = TinyCLR_Api_Type::NativeTimeController;
+    card.timeApi.Version = 0;
+    card.timeApi.Implementation = &card.timeController;
+    card.timeApi.State = &card;
+
+    card.regionAddresses[0] = 0;
+    card.regionSizes[0] = SIMULATED_CARD_SECTOR_SIZE;
+
+    card.descriptor.CanReadDirect = false;
+    card.descriptor.CanWriteDirect = false;
+    card.descriptor.CanExecuteDirect = false;
+    card.descriptor.EraseBeforeWrite = false;
+    card.descriptor.Removable = true;
+    card.descriptor.RegionsContiguous = true;
+    card.descriptor.RegionsEqualSized = true;
+    card.descriptor.RegionCount = sectorCount;
+    card.descriptor.RegionAddresses = card.regionAddresses;
+    card.descriptor.RegionSizes = card.regionSizes;
+
+    return TinyCLR_Result::Success;
+}
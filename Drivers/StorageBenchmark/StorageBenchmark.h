@@ -0,0 +1,93 @@
+#pragma once
+
+#include <TinyCLR.h>
+
+#define STORAGE_BENCHMARK_MAX_SAMPLES 256
+#define STORAGE_BENCHMARK_MIN_BLOCK_SIZE 512
+#define STORAGE_BENCHMARK_MAX_BLOCK_SIZE (64 * 1024)
+
+enum class StorageBenchmark_Pattern : uint32_t {
+    SequentialRead = 0,
+    SequentialWrite = 1,
+    RandomRead = 2,
+    RandomWrite = 3,
+    Erase = 4,
+};
+
+// The region is overwritten by the write and erase patterns.
+struct StorageBenchmark_Configuration {
+    const TinyCLR_Storage_Controller* Storage;
+    const TinyCLR_NativeTime_Controller* Time;
+
+    uint64_t RegionAddress;
+    size_t RegionSize;
+
+    uint8_t* Buffer;
+    size_t BufferSize;
+
+    size_t Operations;
+    uint64_t Timeout;
+};
+
+// Times are in system ticks (100ns).
+struct StorageBenchmark_Result {
+    StorageBenchmark_Pattern Pattern;
+    size_t BlockSize;
+    size_t Operations;
+    size_t Failures;
+
+    uint64_t TotalBytes;
+    uint64_t ElapsedTime;
+
+    uint32_t KiloBytesPerSecond;
+    uint32_t OperationsPerSecond;
+
+    uint64_t LatencyMin;
+    uint64_t LatencyP50;
+    uint64_t LatencyP95;
+    uint64_t LatencyP99;
+    uint64_t LatencyMax;
+};
+
+typedef void(*StorageBenchmark_ReportHandler)(const StorageBenchmark_Result& result, void* context);
+
+TinyCLR_Result StorageBenchmark_Run(const StorageBenchmark_Configuration& configuration, StorageBenchmark_Pattern pattern, size_t blockSize, StorageBenchmark_Result& result);
+TinyCLR_Result StorageBenchmark_RunSuite(const StorageBenchmark_Configuration& configuration, StorageBenchmark_ReportHandler handler, void* context);
+
+// Simulated SD card: models the command, data and busy phases of CMD17/18/24/25/12/38 on a virtual clock
+// so that runs are reproducible on device and when built for a host.
+struct StorageBenchmark_SimulatedCardTiming {
+    uint32_t BusClockHz;
+    uint32_t BusWidth;
+
+    uint32_t ReadAccessTime;
+    uint32_t WriteBusyTime;
+    uint32_t EraseBusyTime;
+    uint32_t RandomAccessPenalty;
+};
+
+struct StorageBenchmark_SimulatedCard {
+    TinyCLR_Storage_Controller storageController;
+    TinyCLR_Api_Info storageApi;
+
+    TinyCLR_NativeTime_Controller timeController;
+    TinyCLR_Api_Info timeApi;
+
+    StorageBenchmark_SimulatedCardTiming timing;
+
+    uint8_t* memory;
+    size_t sectorCount;
+
+    uint64_t clock;
+    uint64_t nextSector;
+
+    uint64_t commandCount;
+
+    uint64_t regionAddresses[1];
+    size_t regionSizes[1];
+
+    TinyCLR_Storage_Descriptor descriptor;
+};
+
+void StorageBenchmark_SimulatedCard_GetDefaultTiming(StorageBenchmark_SimulatedCardTiming& timing);
+TinyCLR_Result StorageBenchmark_SimulatedCard_Initialize(StorageBenchmark_SimulatedCard& card, const StorageBenchmark_SimulatedCardTiming& timing, uint8_t* memory, size_t sectorCount);
@@ -682,10 +682,42 @@ uint8_t TinyCLR_UsbClient_ControlCallback(UsbClientState* usbClientState) {
     return USB_STATE_STALL;
 }
 
-USB_PACKET64* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx) {
-    USB_PACKET64* packet;
+// Every endpoint queue has one producer and one consumer, the USB interrupt on one side and ReadPipe or WritePipe
+// on the other. Only the producer moves fifoPacketIn and only the consumer moves fifoPacketOut, so the pipes copy
+// packets with interrupts enabled. The indexes run to twice maxFifoPacketCount to tell a full queue from an empty
+// one. The barrier keeps packet contents from being reordered past the index that hands them over.
+#ifdef __GNUC__
+#define USB_QUEUE_BARRIER() asm volatile("" ::: "memory")
+#else
+#define USB_QUEUE_BARRIER() __memory_changed()
+#endif
+
+uint32_t TinyCLR_UsbClient_GetQueuedPacketCount(UsbClientState* usbClientState, int32_t endpoint) {
+    USB_QUEUE_BARRIER();
+
+    uint32_t in = usbClientState->fifoPacketIn[endpoint];
+    uint32_t out = usbClientState->fifoPacketOut[endpoint];
+
+    return in >= out ? in - out : in + 2 * usbClientState->maxFifoPacketCount[endpoint] - out;
+}
+
+USB_PACKET* TinyCLR_UsbClient_GetQueuedPacket(UsbClientState* usbClientState, int32_t endpoint, uint32_t index) {
+    if (index >= usbClientState->maxFifoPacketCount[endpoint])
+        index -= usbClientState->maxFifoPacketCount[endpoint];
+
+    return &usbClientState->queues[endpoint][index];
+}
 
-    if (usbClientState->fifoPacketCount[endpoint] == usbClientState->maxFifoPacketCount[endpoint]) {
+uint16_t TinyCLR_UsbClient_GetNextQueueIndex(UsbClientState* usbClientState, int32_t endpoint, uint32_t index) {
+    return (index + 1 == 2 * usbClientState->maxFifoPacketCount[endpoint]) ? 0 : index + 1;
+}
+
+// The interrupt fills the packet after it is queued, the pipes can't see it before the interrupt returns. Targets
+// that call in from a thread do so with interrupts disabled.
+USB_PACKET* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx) {
+    USB_PACKET* packet;
+
+    if (TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint) == usbClientState->maxFifoPacketCount[endpoint]) {
         disableRx = true;
 
         return nullptr;
@@ -693,43 +725,93 @@ USB_PACKET64* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_
 
     disableRx = false;
 
-    packet = &usbClientState->queues[endpoint][usbClientState->fifoPacketIn[endpoint]];
+    packet = TinyCLR_UsbClient_GetQueuedPacket(usbClientState, endpoint, usbClientState->fifoPacketIn[endpoint]);
 
-    usbClientState->fifoPacketIn[endpoint]++;
-    usbClientState->fifoPacketCount[endpoint]++;
-
-    if (usbClientState->fifoPacketIn[endpoint] == usbClientState->maxFifoPacketCount[endpoint])
-        usbClientState->fifoPacketIn[endpoint] = 0;
+    usbClientState->fifoPacketIn[endpoint] = TinyCLR_UsbClient_GetNextQueueIndex(usbClientState, endpoint, usbClientState->fifoPacketIn[endpoint]);
 
     TinyCLR_UsbClient_SetEvent(usbClientState, 1 << endpoint);
 
     return packet;
 }
 
-USB_PACKET64* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint) {
-    USB_PACKET64* packet;
+USB_PACKET* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint) {
+    USB_PACKET* packet;
 
-    if (usbClientState->fifoPacketCount[endpoint] == 0) {
+    if (TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint) == 0) {
         return nullptr;
     }
 
-    packet = &usbClientState->queues[endpoint][usbClientState->fifoPacketOut[endpoint]];
+    USB_QUEUE_BARRIER();
 
-    usbClientState->fifoPacketCount[endpoint]--;
-    usbClientState->fifoPacketOut[endpoint]++;
+    packet = TinyCLR_UsbClient_GetQueuedPacket(usbClientState, endpoint, usbClientState->fifoPacketOut[endpoint]);
 
-    if (usbClientState->fifoPacketOut[endpoint] == usbClientState->maxFifoPacketCount[endpoint])
-        usbClientState->fifoPacketOut[endpoint] = 0;
+    usbClientState->fifoPacketOut[endpoint] = TinyCLR_UsbClient_GetNextQueueIndex(usbClientState, endpoint, usbClientState->fifoPacketOut[endpoint]);
 
     return packet;
 }
 
+// Drops the queued packets by moving fifoPacketOut up to fifoPacketIn, so a packet the producer is filling is still
+// queued in the right place
 void TinyCLR_UsbClient_ClearEndpoints(UsbClientState* usbClientState, int32_t endpoint) {
-    usbClientState->fifoPacketIn[endpoint] = usbClientState->fifoPacketOut[endpoint] = usbClientState->fifoPacketCount[endpoint] = 0;
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    usbClientState->fifoPacketOut[endpoint] = usbClientState->fifoPacketIn[endpoint];
+    usbClientState->currentPacketOffset[endpoint] = 0;
 }
 
 bool TinyCLR_UsbClient_CanReceivePackage(UsbClientState* usbClientState, int32_t endpoint) {
-    return usbClientState->fifoPacketCount[endpoint] < usbClientState->maxFifoPacketCount[endpoint];
+    return TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint) < usbClientState->maxFifoPacketCount[endpoint];
+}
+
+// The smallest of the configuration descriptor's wMaxPacketSize, what the controller supports and
+// USB_MAX_PACKET_SIZE. Endpoints the descriptor doesn't list, and endpoint 0, keep the controller's size.
+uint16_t TinyCLR_UsbClient_GetPacketSize(UsbClientState* usbClientState, int32_t endpoint) {
+    uint32_t size = __min(TinyCLR_UsbClient_GetEndpointSize(endpoint), USB_MAX_PACKET_SIZE);
+
+    if (endpoint == 0 || usbClientState->deviceDescriptor.Configurations == nullptr)
+        return size;
+
+    for (auto ifc = 0; ifc < usbClientState->deviceDescriptor.Configurations->InterfaceCount; ifc++) {
+        auto ifcx = (TinyCLR_UsbClient_InterfaceDescriptor*)&usbClientState->deviceDescriptor.Configurations->Interfaces[ifc];
+
+        for (auto i = 0; i < ifcx->EndpointCount; i++) {
+            auto ep = (TinyCLR_UsbClient_EndpointDescriptor*)&ifcx->Endpoints[i];
+
+            if ((ep->Address & 0x0F) == endpoint && ep->MaxPacketSize > 0)
+                return __min(size, ep->MaxPacketSize);
+        }
+    }
+
+    return size;
+}
+
+// One allocation per queue, the packet headers followed by their buffers. Each buffer is the endpoint's max packet
+// size rounded up to 4 bytes, as some controllers copy out of their FIFOs a word at a time. The queue starts out
+// empty, as its indexes depend on maxFifoPacketCount.
+USB_PACKET* TinyCLR_UsbClient_AllocateQueue(const TinyCLR_Memory_Manager* memoryManager, UsbClientState* usbClientState, int32_t endpoint) {
+    size_t count = usbClientState->maxFifoPacketCount[endpoint];
+    size_t bufferSize = (usbClientState->maxEndpointsPacketSize[endpoint] + 3) & ~3;
+
+    usbClientState->fifoPacketIn[endpoint] = 0;
+    usbClientState->fifoPacketOut[endpoint] = 0;
+    usbClientState->currentPacketOffset[endpoint] = 0;
+
+    auto queue = reinterpret_cast<USB_PACKET*>(memoryManager->Allocate(memoryManager, count * (sizeof(USB_PACKET) + bufferSize)));
+
+    if (queue == nullptr)
+        return nullptr;
+
+    memset(reinterpret_cast<uint8_t*>(queue), 0x00, count * (sizeof(USB_PACKET) + bufferSize));
+
+    auto buffer = reinterpret_cast<uint8_t*>(&queue[count]);
+
+    for (size_t i = 0; i < count; i++) {
+        queue[i].Buffer = buffer;
+
+        buffer += bufferSize;
+    }
+
+    return queue;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -817,13 +899,12 @@ TinyCLR_Result TinyCLR_UsbClient_Acquire(const TinyCLR_UsbClient_Controller* sel
         if (apiManager != nullptr) {
             auto memoryManager = reinterpret_cast<const TinyCLR_Memory_Manager*>(apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager));
 
-            usbClientState->queues = reinterpret_cast<USB_PACKET64**>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint32_t)));
-            usbClientState->currentPacketOffset = reinterpret_cast<uint8_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint8_t)));
+            usbClientState->queues = reinterpret_cast<USB_PACKET**>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint32_t)));
+            usbClientState->currentPacketOffset = reinterpret_cast<uint16_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint16_t)));
             usbClientState->isTxQueue = reinterpret_cast<bool*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(bool)));
 
-            usbClientState->fifoPacketIn = reinterpret_cast<uint8_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint8_t)));
-            usbClientState->fifoPacketOut = reinterpret_cast<uint8_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint8_t)));
-            usbClientState->fifoPacketCount = reinterpret_cast<uint8_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint8_t)));
+            usbClientState->fifoPacketIn = reinterpret_cast<uint16_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint16_t)));
+            usbClientState->fifoPacketOut = reinterpret_cast<uint16_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint16_t)));
             usbClientState->maxFifoPacketCount = reinterpret_cast<uint8_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint8_t)));
 
             usbClientState->pipes = reinterpret_cast<USB_PIPE_MAP*>(memoryManager->Allocate(memoryManager, usbClientState->totalPipesCount * sizeof(USB_PIPE_MAP)));
@@ -831,14 +912,13 @@ TinyCLR_Result TinyCLR_UsbClient_Acquire(const TinyCLR_UsbClient_Controller* sel
             usbClientState->controlEndpointBuffer = reinterpret_cast<uint8_t*>(memoryManager->Allocate(memoryManager, USB_ENDPOINT_CONTROL_BUFFER_SIZE));
 
             usbClientState->endpointStatus = reinterpret_cast<uint16_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint16_t)));
-            usbClientState->maxEndpointsPacketSize = reinterpret_cast<uint8_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint8_t)));
+            usbClientState->maxEndpointsPacketSize = reinterpret_cast<uint16_t*>(memoryManager->Allocate(memoryManager, usbClientState->totalEndpointsCount * sizeof(uint16_t)));
 
             if (usbClientState->queues == nullptr
                 || usbClientState->currentPacketOffset == nullptr
                 || usbClientState->isTxQueue == nullptr
                 || usbClientState->fifoPacketIn == nullptr
                 || usbClientState->fifoPacketOut == nullptr
-                || usbClientState->fifoPacketCount == nullptr
                 || usbClientState->maxFifoPacketCount == nullptr
                 || usbClientState->pipes == nullptr
                 || usbClientState->controlEndpointBuffer == nullptr
@@ -859,9 +939,6 @@ TinyCLR_Result TinyCLR_UsbClient_Acquire(const TinyCLR_UsbClient_Controller* sel
                 if (usbClientState->fifoPacketOut != nullptr)
                     memoryManager->Free(memoryManager, usbClientState->fifoPacketOut);
 
-                if (usbClientState->fifoPacketCount != nullptr)
-                    memoryManager->Free(memoryManager, usbClientState->fifoPacketCount);
-
                 if (usbClientState->maxFifoPacketCount != nullptr)
                     memoryManager->Free(memoryManager, usbClientState->maxFifoPacketCount);
 
@@ -882,11 +959,10 @@ TinyCLR_Result TinyCLR_UsbClient_Acquire(const TinyCLR_UsbClient_Controller* sel
 
             // Reset buffer, make sure no random value in RAM after soft reset
             memset(reinterpret_cast<uint8_t*>(usbClientState->queues), 0x00, usbClientState->totalEndpointsCount * sizeof(uint32_t));
-            memset(reinterpret_cast<uint8_t*>(usbClientState->currentPacketOffset), 0x00, usbClientState->totalEndpointsCount * sizeof(uint8_t));
+            memset(reinterpret_cast<uint8_t*>(usbClientState->currentPacketOffset), 0x00, usbClientState->totalEndpointsCount * sizeof(uint16_t));
 
-            memset(reinterpret_cast<uint8_t*>(usbClientState->fifoPacketIn), 0x00, usbClientState->totalEndpointsCount * sizeof(uint8_t));
-            memset(reinterpret_cast<uint8_t*>(usbClientState->fifoPacketOut), 0x00, usbClientState->totalEndpointsCount * sizeof(uint8_t));
-            memset(reinterpret_cast<uint8_t*>(usbClientState->fifoPacketCount), 0x00, usbClientState->totalEndpointsCount * sizeof(uint8_t));
+            memset(reinterpret_cast<uint8_t*>(usbClientState->fifoPacketIn), 0x00, usbClientState->totalEndpointsCount * sizeof(uint16_t));
+            memset(reinterpret_cast<uint8_t*>(usbClientState->fifoPacketOut), 0x00, usbClientState->totalEndpointsCount * sizeof(uint16_t));
             memset(reinterpret_cast<uint8_t*>(usbClientState->maxFifoPacketCount), 0x00, usbClientState->totalEndpointsCount * sizeof(uint8_t));
 
             for (auto i = 0; i < usbClientState->totalPipesCount; i++) {
@@ -895,7 +971,7 @@ TinyCLR_Result TinyCLR_UsbClient_Acquire(const TinyCLR_UsbClient_Controller* sel
             }
 
             for (auto i = 0; i < usbClientState->totalEndpointsCount; i++) {
-                usbClientState->maxEndpointsPacketSize[i] = TinyCLR_UsbClient_GetEndpointSize(i);
+                usbClientState->maxEndpointsPacketSize[i] = TinyCLR_UsbClient_GetPacketSize(usbClientState, i);
                 usbClientState->maxFifoPacketCount[i] = usbClientState->maxFifoPacketCountDefault;
             }
 
@@ -943,7 +1019,6 @@ TinyCLR_Result TinyCLR_UsbClient_Release(const TinyCLR_UsbClient_Controller* sel
 
                 memoryManager->Free(memoryManager, usbClientState->fifoPacketIn);
                 memoryManager->Free(memoryManager, usbClientState->fifoPacketOut);
-                memoryManager->Free(memoryManager, usbClientState->fifoPacketCount);
                 memoryManager->Free(memoryManager, usbClientState->maxFifoPacketCount);
 
                 memoryManager->Free(memoryManager, usbClientState->pipes);
@@ -976,9 +1051,7 @@ TinyCLR_Result TinyCLR_UsbClient_OpenPipe(const TinyCLR_UsbClient_Controller* se
             auto endpoint = (i == 0) ? writeEndpoint : readEndpoint;
 
             if (memoryManager != nullptr && endpoint < usbClientState->totalEndpointsCount) {
-                usbClientState->queues[endpoint] = (USB_PACKET64*)memoryManager->Allocate(memoryManager, usbClientState->maxFifoPacketCount[endpoint] * sizeof(USB_PACKET64));
-
-                memset(reinterpret_cast<uint8_t*>(usbClientState->queues[endpoint]), 0x00, usbClientState->maxFifoPacketCount[endpoint] * sizeof(USB_PACKET64));
+                usbClientState->queues[endpoint] = TinyCLR_UsbClient_AllocateQueue(memoryManager, usbClientState, endpoint);
 
                 TinyCLR_UsbClient_ClearEndpoints(usbClientState, endpoint);
             }
@@ -1056,7 +1129,14 @@ TinyCLR_Result TinyCLR_UsbClient_WritePipe(const TinyCLR_UsbClient_Controller* s
         return TinyCLR_Result::NotAvailable;
     }
 
-    DISABLE_INTERRUPTS_SCOPED(irq);
+    // The queue is only drained from the USB interrupt, a caller that has interrupts disabled can't wait for room
+    bool                interruptsDisabled;
+
+    {
+        DISABLE_INTERRUPTS_SCOPED(irq);
+
+        interruptsDisabled = irq.IsDisabled();
+    }
 
     const uint8_t*      ptr = data;
     uint32_t            count = length;
@@ -1071,19 +1151,13 @@ TinyCLR_Result TinyCLR_UsbClient_WritePipe(const TinyCLR_UsbClient_Controller* s
     // USB bulk-mode transfers.
     while (!Done) {
 
-        USB_PACKET64* Packet64 = nullptr;
-
-        if (usbClientState->fifoPacketCount[endpoint] < usbClientState->maxFifoPacketCount[endpoint]) {
-            Packet64 = &usbClientState->queues[endpoint][usbClientState->fifoPacketIn[endpoint]];
-
-            usbClientState->fifoPacketIn[endpoint]++;
-            usbClientState->fifoPacketCount[endpoint]++;
+        USB_PACKET* Packet = nullptr;
 
-            if (usbClientState->fifoPacketIn[endpoint] == usbClientState->maxFifoPacketCount[endpoint])
-                usbClientState->fifoPacketIn[endpoint] = 0;
+        if (TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint) < usbClientState->maxFifoPacketCount[endpoint]) {
+            Packet = TinyCLR_UsbClient_GetQueuedPacket(usbClientState, endpoint, usbClientState->fifoPacketIn[endpoint]);
         }
 
-        if (Packet64) {
+        if (Packet) {
             uint32_t max_move;
 
             if (count > usbClientState->maxEndpointsPacketSize[endpoint])
@@ -1092,7 +1166,7 @@ TinyCLR_Result TinyCLR_UsbClient_WritePipe(const TinyCLR_UsbClient_Controller* s
                 max_move = count;
 
             if (max_move) {
-                memcpy(Packet64->Buffer, ptr, max_move);
+                memcpy(Packet->Buffer, ptr, max_move);
             }
 
             // we are done when we send a non-full length packet
@@ -1100,7 +1174,13 @@ TinyCLR_Result TinyCLR_UsbClient_WritePipe(const TinyCLR_UsbClient_Controller* s
                 Done = true;
             }
 
-            Packet64->Size = max_move;
+            Packet->Size = max_move;
+
+            // queue the packet once it is filled
+            USB_QUEUE_BARRIER();
+
+            usbClientState->fifoPacketIn[endpoint] = TinyCLR_UsbClient_GetNextQueueIndex(usbClientState, endpoint, usbClientState->fifoPacketIn[endpoint]);
+
             count -= max_move;
             ptr += max_move;
 
@@ -1108,7 +1188,7 @@ TinyCLR_Result TinyCLR_UsbClient_WritePipe(const TinyCLR_UsbClient_Controller* s
 
             WaitLoopCnt = 0;
         }
-        if (Packet64 == nullptr) {
+        if (Packet == nullptr) {
             // a 64-byte USB packet takes less than 50uSec
             // according to the timing calculations of the USB Chief
             // this is way too short to bother with a call
@@ -1129,7 +1209,7 @@ TinyCLR_Result TinyCLR_UsbClient_WritePipe(const TinyCLR_UsbClient_Controller* s
                 goto done_write;
             }
 
-            if (irq.IsDisabled()) // @todo - this really needs more checks to be totally valid
+            if (interruptsDisabled) // @todo - this really needs more checks to be totally valid
             {
                 goto done_write;
             }
@@ -1140,15 +1220,10 @@ TinyCLR_Result TinyCLR_UsbClient_WritePipe(const TinyCLR_UsbClient_Controller* s
 
             TinyCLR_UsbClient_StartOutput(usbClientState, endpoint);
 
-            irq.Release();
-
             TinyCLR_UsbClient_Delay(50);
-
-            irq.Acquire();
         }
     }
 
-    // here we have a post-condition that IRQs are disabled for all paths through conditional block above
     if (usbClientState->deviceState == USB_DEVICE_STATE_CONFIGURED) {
         TinyCLR_UsbClient_StartOutput(usbClientState, endpoint);
     }
@@ -1173,49 +1248,62 @@ TinyCLR_Result TinyCLR_UsbClient_ReadPipe(const TinyCLR_UsbClient_Controller* se
         return TinyCLR_Result::NotAvailable;
     }
 
-    DISABLE_INTERRUPTS_SCOPED(irq);
-
-    USB_PACKET64* Packet64 = nullptr;
+    USB_PACKET* Packet = nullptr;
     uint8_t*        ptr = reinterpret_cast<uint8_t*>(data);
     uint32_t        count = 0;
     uint32_t        remain = length;
 
     while (count < length) {
         uint32_t max_move;
+        uint32_t offset;
+        uint32_t out;
+        bool     done = false;
 
-        if (usbClientState->fifoPacketCount[endpoint] > 0) {
-            Packet64 = &usbClientState->queues[endpoint][usbClientState->fifoPacketOut[endpoint]];
-
-            usbClientState->fifoPacketCount[endpoint]--;
-            usbClientState->fifoPacketOut[endpoint]++;
+        if (TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint) == 0) {
+            // a packet that arrives after the check sets the event again
+            TinyCLR_UsbClient_ClearEvent(usbClientState, 1 << endpoint);
 
-            if (usbClientState->fifoPacketOut[endpoint] == usbClientState->maxFifoPacketCount[endpoint]) {
-                usbClientState->fifoPacketOut[endpoint] = 0;
-            }
+            if (TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint) == 0)
+                break;
         }
 
-        if (!Packet64) {
-            TinyCLR_UsbClient_ClearEvent(usbClientState, 1 << endpoint);
-            break;
-        }
+        USB_QUEUE_BARRIER();
 
-        max_move = Packet64->Size - usbClientState->currentPacketOffset[endpoint];
+        // the packet stays queued until it is read to the end
+        out = usbClientState->fifoPacketOut[endpoint];
+        offset = usbClientState->currentPacketOffset[endpoint];
+        Packet = TinyCLR_UsbClient_GetQueuedPacket(usbClientState, endpoint, out);
+
+        max_move = Packet->Size - offset;
         if (remain < max_move) max_move = remain;
 
-        memcpy(ptr, &Packet64->Buffer[usbClientState->currentPacketOffset[endpoint]], max_move);
+        memcpy(ptr, &Packet->Buffer[offset], max_move);
 
-        usbClientState->currentPacketOffset[endpoint] += max_move;
         ptr += max_move;
         count += max_move;
         remain -= max_move;
 
-        /* if we're done with this packet, move onto the next */
-        if (usbClientState->currentPacketOffset[endpoint] == Packet64->Size) {
-            usbClientState->currentPacketOffset[endpoint] = 0;
-            Packet64 = nullptr;
+        {
+            // A bus reset clears the queue from the interrupt, which also moves fifoPacketOut. Nothing is left to
+            // update then, the packet that was read is gone.
+            DISABLE_INTERRUPTS_SCOPED(irq);
+
+            if (usbClientState->fifoPacketOut[endpoint] == out) {
+                /* if we're done with this packet, move onto the next */
+                if (offset + max_move == Packet->Size) {
+                    usbClientState->currentPacketOffset[endpoint] = 0;
+                    usbClientState->fifoPacketOut[endpoint] = TinyCLR_UsbClient_GetNextQueueIndex(usbClientState, endpoint, out);
 
-            TinyCLR_UsbClient_RxEnable(usbClientState, endpoint);
+                    done = true;
+                }
+                else {
+                    usbClientState->currentPacketOffset[endpoint] = offset + max_move;
+                }
+            }
         }
+
+        if (done)
+            TinyCLR_UsbClient_RxEnable(usbClientState, endpoint);
     }
 
     length = count;
@@ -1241,17 +1329,17 @@ TinyCLR_Result TinyCLR_UsbClient_FlushPipe(const TinyCLR_UsbClient_Controller* s
         return TinyCLR_Result::NotAvailable;
     }
 
-    queueCnt = usbClientState->fifoPacketCount[endpoint];
+    queueCnt = TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint);
 
     // interrupts were disabled or USB interrupt was disabled for whatever reason, so force the flush
-    while (usbClientState->fifoPacketCount[endpoint] > 0 && retries > 0) {
+    while (TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint) > 0 && retries > 0) {
         TinyCLR_UsbClient_StartOutput(usbClientState, endpoint);
 
-        TinyCLR_UsbClient_Delay(queueCnt == usbClientState->fifoPacketCount[endpoint] ? 100 : 0); // don't call Events_WaitForEventsXXX because it will turn off interrupts
+        TinyCLR_UsbClient_Delay(queueCnt == TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint) ? 100 : 0); // don't call Events_WaitForEventsXXX because it will turn off interrupts
 
-        retries = (queueCnt == usbClientState->fifoPacketCount[endpoint]) ? retries - 1 : USB_FLUSH_RETRY_COUNT;
+        retries = (queueCnt == TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint)) ? retries - 1 : USB_FLUSH_RETRY_COUNT;
 
-        queueCnt = usbClientState->fifoPacketCount[endpoint];
+        queueCnt = TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint);
     }
 
     if (retries <= 0)
@@ -1297,7 +1385,7 @@ size_t TinyCLR_UsbClient_GetBytesToWrite(const TinyCLR_UsbClient_Controller* sel
 
     int32_t endpoint = usbClientState->pipes[pipe].TxEP;
 
-    return usbClientState->fifoPacketCount[endpoint];
+    return TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint);
 #else
     return 0;
 #endif
@@ -1309,7 +1397,7 @@ size_t TinyCLR_UsbClient_GetBytesToRead(const TinyCLR_UsbClient_Controller* self
 
     int32_t endpoint = usbClientState->pipes[pipe].RxEP;
 
-    return usbClientState->fifoPacketCount[endpoint];
+    return TinyCLR_UsbClient_GetQueuedPacketCount(usbClientState, endpoint);
 #else
     return 0;
 #endif
@@ -1374,6 +1462,9 @@ TinyCLR_Result TinyCLR_UsbClient_SetWriteBufferSize(const TinyCLR_UsbClient_Cont
     int32_t endpoint = usbClientState->pipes[pipe].TxEP;
 
     if (usbClientState->maxFifoPacketCount[endpoint] != size) {
+        // The interrupt must not see the new count with the old queue or indexes, nor a freed queue
+        DISABLE_INTERRUPTS_SCOPED(irq);
+
         usbClientState->maxFifoPacketCount[endpoint] = size;
 
         if (apiManager != nullptr) {
@@ -1385,9 +1476,7 @@ TinyCLR_Result TinyCLR_UsbClient_SetWriteBufferSize(const TinyCLR_UsbClient_Cont
             }
 
             // relocated
-            usbClientState->queues[endpoint] = (USB_PACKET64*)memoryManager->Allocate(memoryManager, usbClientState->maxFifoPacketCount[endpoint] * sizeof(USB_PACKET64));
-
-            memset(reinterpret_cast<uint8_t*>(usbClientState->queues[endpoint]), 0x00, usbClientState->maxFifoPacketCount[endpoint] * sizeof(USB_PACKET64));
+            usbClientState->queues[endpoint] = TinyCLR_UsbClient_AllocateQueue(memoryManager, usbClientState, endpoint);
 
             TinyCLR_UsbClient_ClearEndpoints(usbClientState, endpoint);
         }
@@ -1406,6 +1495,9 @@ TinyCLR_Result TinyCLR_UsbClient_SetReadBufferSize(const TinyCLR_UsbClient_Contr
     int32_t endpoint = usbClientState->pipes[pipe].RxEP;
 
     if (usbClientState->maxFifoPacketCount[endpoint] != size) {
+        // The interrupt must not see the new count with the old queue or indexes, nor a freed queue
+        DISABLE_INTERRUPTS_SCOPED(irq);
+
         usbClientState->maxFifoPacketCount[endpoint] = size;
 
         if (apiManager != nullptr) {
@@ -1417,9 +1509,7 @@ TinyCLR_Result TinyCLR_UsbClient_SetReadBufferSize(const TinyCLR_UsbClient_Contr
             }
 
             // relocated
-            usbClientState->queues[endpoint] = (USB_PACKET64*)memoryManager->Allocate(memoryManager, usbClientState->maxFifoPacketCount[endpoint] * sizeof(USB_PACKET64));
-
-            memset(reinterpret_cast<uint8_t*>(usbClientState->queues[endpoint]), 0x00, usbClientState->maxFifoPacketCount[endpoint] * sizeof(USB_PACKET64));
+            usbClientState->queues[endpoint] = TinyCLR_UsbClient_AllocateQueue(memoryManager, usbClientState, endpoint);
 
             TinyCLR_UsbClient_ClearEndpoints(usbClientState, endpoint);
         }
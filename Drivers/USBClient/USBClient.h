@@ -115,9 +115,14 @@
 // This size must be large than WinUsb xproperty os size (0x8E)
 #define USB_ENDPOINT_CONTROL_BUFFER_SIZE 256
 
-struct USB_PACKET64 {
+// Largest max packet size an endpoint may use, that of high speed bulk endpoints. The controllers in this tree all
+// run at full speed and keep their _USB_ENDPOINT_SIZE at 64, so this only sizes the queues for a high speed port.
+#define USB_MAX_PACKET_SIZE 512
+
+// Buffer points into the queue's allocation and holds the endpoint's max packet size
+struct USB_PACKET {
     uint32_t Size;
-    uint8_t Buffer[64];
+    uint8_t* Buffer;
 };
 
 struct USB_PIPE_MAP {
@@ -134,8 +139,8 @@ struct UsbClientState {
     TinyCLR_UsbClient_DeviceDescriptor deviceDescriptor;
 
     /* queues & maxPacketSize must be initialized by the HAL */
-    USB_PACKET64** queues;
-    uint8_t* currentPacketOffset;
+    USB_PACKET** queues;
+    uint16_t* currentPacketOffset;
     bool* isTxQueue;
 
     /* Arbitrarily as many pipes as endpoints since that is the maximum number of pipes
@@ -150,7 +155,7 @@ struct UsbClientState {
     /* USB hardware information */
     uint8_t address;
     uint8_t deviceState;
-    uint8_t* maxEndpointsPacketSize;
+    uint16_t* maxEndpointsPacketSize;
     uint8_t configurationNum;
     uint32_t firstGetDescriptor;
 
@@ -170,9 +175,9 @@ struct UsbClientState {
     uint16_t residualCount;
     uint16_t expected;
 
-    uint8_t* fifoPacketIn;
-    uint8_t* fifoPacketOut;
-    uint8_t* fifoPacketCount;
+    /* queue indexes, from 0 to twice maxFifoPacketCount */
+    uint16_t* fifoPacketIn;
+    uint16_t* fifoPacketOut;
     uint8_t* maxFifoPacketCount;
     uint8_t maxFifoPacketCountDefault;
 
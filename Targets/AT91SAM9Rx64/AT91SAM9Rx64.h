@@ -1313,14 +1313,14 @@ void AT91SAM9Rx64_UsbDevice_AddApi(const TinyCLR_Api_Manager* apiManager);
 void AT91SAM9Rx64_UsbDevice_Reset();
 void AT91SAM9Rx64_UsbDevice_PinConfiguration();
 
-struct USB_PACKET64;
+struct USB_PACKET;
 struct UsbClientState;
 typedef void(*USB_NEXT_CALLBACK)(UsbClientState*);
 
 void TinyCLR_UsbClient_ClearEvent(UsbClientState *usbClientState, uint32_t event);
 void TinyCLR_UsbClient_ClearEndpoints(UsbClientState *usbClientState, int32_t endpoint);
-USB_PACKET64* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx);
-USB_PACKET64* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint);
+USB_PACKET* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx);
+USB_PACKET* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint);
 void TinyCLR_UsbClient_StateCallback(UsbClientState* usbClientState);
 uint8_t TinyCLR_UsbClient_ControlCallback(UsbClientState* usbClientState);
 bool TinyCLR_UsbClient_Initialize(UsbClientState* usbClientState);
@@ -592,6 +592,11 @@ TinyCLR_Result AT91SAM9X35_Can_ClearReadBuffer(const TinyCLR_Can_Controller* sel
 TinyCLR_Result AT91SAM9X35_Can_IsWritingAllowed(const TinyCLR_Can_Controller* self, bool& allowed);
 size_t AT91SAM9X35_Can_GetWriteErrorCount(const TinyCLR_Can_Controller* self);
 size_t AT91SAM9X35_Can_GetReadErrorCount(const TinyCLR_Can_Controller* self);
+struct CanStatistics;
+TinyCLR_Result AT91SAM9X35_Can_GetStatistics(const TinyCLR_Can_Controller* self, CanStatistics& statistics);
+TinyCLR_Result AT91SAM9X35_Can_ResetStatistics(const TinyCLR_Can_Controller* self);
+typedef bool(*AT91SAM9X35_Can_FrameHandler)(const TinyCLR_Can_Message& message, uint64_t timestamp, void* context);
+TinyCLR_Result AT91SAM9X35_Can_SetFrameHandler(const TinyCLR_Can_Controller* self, AT91SAM9X35_Can_FrameHandler handler, void* context);
 uint32_t AT91SAM9X35_Can_GetSourceClock(const TinyCLR_Can_Controller* self);
 TinyCLR_Result AT91SAM9X35_Can_SetReadBufferSize(const TinyCLR_Can_Controller* self, size_t size);
 size_t AT91SAM9X35_Can_GetReadBufferSize(const TinyCLR_Can_Controller* self);
@@ -1426,14 +1431,14 @@ void AT91SAM9X35_UsbDevice_AddApi(const TinyCLR_Api_Manager* apiManager);
 void AT91SAM9X35_UsbDevice_Reset();
 void AT91SAM9X35_UsbDevice_PinConfiguration();
 
-struct USB_PACKET64;
+struct USB_PACKET;
 struct UsbClientState;
 typedef void(*USB_NEXT_CALLBACK)(UsbClientState*);
 
 void TinyCLR_UsbClient_ClearEvent(UsbClientState *usbClientState, uint32_t event);
 void TinyCLR_UsbClient_ClearEndpoints(UsbClientState *usbClientState, int32_t endpoint);
-USB_PACKET64* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx);
-USB_PACKET64* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint);
+USB_PACKET* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx);
+USB_PACKET* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint);
 void TinyCLR_UsbClient_StateCallback(UsbClientState* usbClientState);
 uint8_t TinyCLR_UsbClient_ControlCallback(UsbClientState* usbClientState);
 bool TinyCLR_UsbClient_Initialize(UsbClientState* usbClientState);
@@ -1450,7 +1455,55 @@ TinyCLR_Result AT91SAM9X35_Display_GetCapabilities(const TinyCLR_Display_Control
 TinyCLR_Result AT91SAM9X35_Display_GetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat& dataFormat, uint32_t& width, uint32_t& height, void* configuration);
 TinyCLR_Result AT91SAM9X35_Display_SetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat dataFormat, uint32_t width, uint32_t height, const void* configuration);
 TinyCLR_Result AT91SAM9X35_Display_DrawBuffer(const TinyCLR_Display_Controller* self, int32_t x, int32_t y, int32_t width, int32_t height, const uint8_t* data);
+struct DisplayRegion_Rectangle;
+TinyCLR_Result AT91SAM9X35_Display_DrawBufferRegions(const TinyCLR_Display_Controller* self, const uint8_t* data, const DisplayRegion_Rectangle* rectangles, size_t count);
 TinyCLR_Result AT91SAM9X35_Display_DrawPixel(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint64_t color);
+TinyCLR_Result AT91SAM9X35_Display_SetOrientation(const TinyCLR_Display_Controller* self, uint32_t orientation);
+
+enum class DisplayFormat_PixelFormat : uint32_t;
+
+struct AT91SAM9X35_Display_OverlayConfiguration {
+    const uint8_t* Buffer;
+    DisplayFormat_PixelFormat Format;
+
+    int32_t X;
+    int32_t Y;
+    uint32_t Width;
+    uint32_t Height;
+
+    // 255 is opaque. ColorKey is Argb8888 with the alpha ignored, pixels that expand to it are transparent.
+    uint8_t Alpha;
+    bool ColorKeyEnable;
+    uint32_t ColorKey;
+
+    // The 256 Argb8888 colors of an L8 buffer
+    const uint32_t* Palette;
+};
+
+// At most 128 x 128 pixels. The hot spot is the pixel of the bitmap that is put at the cursor position.
+struct AT91SAM9X35_Display_CursorConfiguration {
+    const uint8_t* Buffer;
+    DisplayFormat_PixelFormat Format;
+
+    uint32_t Width;
+    uint32_t Height;
+    int32_t HotSpotX;
+    int32_t HotSpotY;
+
+    bool ColorKeyEnable;
+    uint32_t ColorKey;
+
+    const uint32_t* Palette;
+};
+
+TinyCLR_Result AT91SAM9X35_Display_SetOverlay(const TinyCLR_Display_Controller* self, const AT91SAM9X35_Display_OverlayConfiguration& configuration);
+TinyCLR_Result AT91SAM9X35_Display_MoveOverlay(const TinyCLR_Display_Controller* self, int32_t x, int32_t y);
+TinyCLR_Result AT91SAM9X35_Display_DisableOverlay(const TinyCLR_Display_Controller* self);
+TinyCLR_Result AT91SAM9X35_Display_SetCursor(const TinyCLR_Display_Controller* self, const AT91SAM9X35_Display_CursorConfiguration& configuration);
+TinyCLR_Result AT91SAM9X35_Display_MoveCursor(const TinyCLR_Display_Controller* self, int32_t x, int32_t y);
+TinyCLR_Result AT91SAM9X35_Display_DisableCursor(const TinyCLR_Display_Controller* self);
+int32_t AT91SAM9X35_Display_GetOrientation();
+uint32_t* AT91SAM9X35_Display_GetFrameBuffer();
 TinyCLR_Result AT91SAM9X35_Display_WriteString(const TinyCLR_Display_Controller* self, const char* buffer, size_t length);
 
 //WatchDog
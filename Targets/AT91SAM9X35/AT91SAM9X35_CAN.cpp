@@ -17,6 +17,8 @@
 #include <algorithm>
 #include <string.h>
 #include "AT91SAM9X35.h"
+#include "../../Drivers/CanStatistics/CanStatistics.h"
+#include "../../Drivers/CanFilter/CanFilter.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -31,6 +33,11 @@ static const uint32_t canDefaultBuffersSize[] = AT91SAM9X35_CAN_BUFFER_DEFAULT_S
 
 #define CAN_TRANSFER_TIMEOUT 0xFFFFFF
 
+// 0.8us resolution, about 214s from the buffer epoch
+#ifndef AT91SAM9X35_CAN_TIMESTAMP_SHIFT
+#define AT91SAM9X35_CAN_TIMESTAMP_SHIFT 3
+#endif
+
 #define CANMB_NUMBER 8
 #define CAN_NUM_MAILBOX     8
 
@@ -1011,23 +1018,29 @@ struct AT91SAM9X35_Can_Filter {
     uint32_t *upperBoundFilters;
     uint32_t groupFiltersSize;
 
+    uint32_t standardIdBitmap[CAN_FILTER_STANDARD_ID_COUNT / 32]; // Accepted identifiers up to 0x7FF, either frame format
+
+    uint32_t *extendedIdSet; // Open addressing hash set of the explicit identifiers above 0x7FF
+    uint32_t extendedIdSetShift;
 };
 
+// Receive buffer record, 16 bytes. msgId holds the identifier and the frame flags, timeStamp holds
+// the length and the time since the buffer epoch in units of 2^AT91SAM9X35_CAN_TIMESTAMP_SHIFT ticks.
 typedef struct {
-    uint32_t timeStampL;
-    uint32_t timeStampH;
-
     uint32_t msgId;
+    uint32_t timeStamp;
 
-    bool extendedId;
-    bool remoteTransmissionRequest;
+    uint32_t dataA;	// CAN Message Data Bytes 0-3
+    uint32_t dataB;	// CAN Message Data Bytes 4-7
 
-    uint32_t dataA;
-    uint32_t dataB;
+} AT91SAM9X35_Can_Message;
 
-    int32_t length;
+#define CAN_MESSAGE_ID_MASK 0x1FFFFFFF
+#define CAN_MESSAGE_EXTENDED_ID 0x20000000
+#define CAN_MESSAGE_REMOTE_TRANSMISSION_REQUEST 0x40000000
 
-} AT91SAM9X35_Can_Message;
+#define CAN_MESSAGE_TIMESTAMP_MASK 0x0FFFFFFF
+#define CAN_MESSAGE_LENGTH_SHIFT 28
 
 struct CanState {
     int32_t controllerIndex;
@@ -1042,6 +1055,13 @@ struct CanState {
     int32_t rxIn;
     int32_t rxOut;
 
+    uint64_t rxEpoch;
+
+    CanStatistics statistics;
+
+    AT91SAM9X35_Can_FrameHandler frameHandler;
+    void* frameHandlerContext;
+
     size_t rxBufferSize;
     size_t txBufferSize;
 
@@ -1076,6 +1096,20 @@ static const AT91SAM9X35_Gpio_Pin canPins[][2] = AT91SAM9X35_CAN_PINS;
 
 static CanState canStates[TOTAL_CAN_CONTROLLERS];
 
+// The epoch restarts whenever the receive buffer is empty. A frame left unread for longer than the
+// delta can express is given the largest delta.
+static uint32_t AT91SAM9X35_Can_RxTimeStamp(CanState* state, uint64_t t, uint32_t length) {
+    if (state->rxCount == 0)
+        state->rxEpoch = t;
+
+    auto delta = (t - state->rxEpoch) >> AT91SAM9X35_CAN_TIMESTAMP_SHIFT;
+
+    if (delta > CAN_MESSAGE_TIMESTAMP_MASK)
+        delta = CAN_MESSAGE_TIMESTAMP_MASK;
+
+    return (uint32_t)delta | ((length & 0x0F) << CAN_MESSAGE_LENGTH_SHIFT);
+}
+
 static TinyCLR_Can_Controller canControllers[TOTAL_CAN_CONTROLLERS];
 static TinyCLR_Api_Info canApi[TOTAL_CAN_CONTROLLERS];
 
@@ -1094,6 +1128,12 @@ void CAN_DisableExplicitFilters(int32_t controllerIndex) {
 
         state->canDataFilter.matchFiltersSize = 0;
     }
+
+    if (state->canDataFilter.extendedIdSet != nullptr) {
+        memoryProvider->Free(memoryProvider, state->canDataFilter.extendedIdSet);
+
+        state->canDataFilter.extendedIdSet = nullptr;
+    }
 }
 
 void CAN_DisableGroupFilters(int32_t controllerIndex) {
@@ -1207,6 +1247,17 @@ int32_t BinarySearch2(uint32_t *lowerBounds, uint32_t *upperBounds, int32_t firs
     return -1;    // failed to find key
 }
 
+// Filters are compiled when they are set, see CanFilter_BuildStandardIdBitmap
+static bool CAN_IsIdAccepted(const AT91SAM9X35_Can_Filter& filter, uint32_t id) {
+    if (id < CAN_FILTER_STANDARD_ID_COUNT)
+        return CanFilter_IsInStandardIdBitmap(filter.standardIdBitmap, id);
+
+    if (CanFilter_IsInExtendedIdSet(filter.extendedIdSet, filter.extendedIdSetShift, id))
+        return true;
+
+    return filter.groupFiltersSize && BinarySearch2(filter.lowerBoundFilters, filter.upperBoundFilters, 0, filter.groupFiltersSize - 1, id) >= 0;
+}
+
 const char* canApiNames[] = {
 #if TOTAL_CAN_CONTROLLERS > 0
 "GHIElectronics.TinyCLR.NativeApis.AT91SAM9X35.CanController\\0",
@@ -1286,7 +1337,6 @@ void CopyMessageFromMailBoxToBuffer(uint8_t controllerIndex, uint32_t dwMsr) {
 
     uint32_t msgid = 0;
     bool extendMode = 0;
-    char passed = 0;
 
     uint64_t t;
 
@@ -1303,31 +1353,49 @@ void CopyMessageFromMailBoxToBuffer(uint8_t controllerIndex, uint32_t dwMsr) {
         extendMode = false; // last bit in frame is extend mode flag 0: 11 bit, 1: 29 bit id
     }
 
+    auto rtrmode = ((dwMsr >> 20) & 0x01) != 0;
+
+    // timestamp
+    t = AT91SAM9X35_Time_GetSystemTime(nullptr);
+
+    state->statistics.ReceivedFrames++;
+
+    CanStatistics_AddFrame(state->statistics, t, extendMode, rtrmode, state->can_rx.bMsgLen);
+
     // filter
     if (state->canDataFilter.groupFiltersSize || state->canDataFilter.matchFiltersSize) {
-        //Added filter for AT91SAM9X35_CAN0
-        if (state->canDataFilter.groupFiltersSize || state->canDataFilter.matchFiltersSize) {
-            if (state->canDataFilter.groupFiltersSize) {
-                if (BinarySearch2(state->canDataFilter.lowerBoundFilters, state->canDataFilter.upperBoundFilters, 0, state->canDataFilter.groupFiltersSize - 1, msgid) >= 0)
-                    passed = 1;
-            }
-
-            if (!passed && state->canDataFilter.matchFiltersSize) {
-                if (BinarySearch(state->canDataFilter.matchFilters, 0, state->canDataFilter.matchFiltersSize - 1, msgid) >= 0)
-                    passed = 1;
-            }
+        if (!CAN_IsIdAccepted(state->canDataFilter, msgid)) {
+            state->statistics.FilteredFrames++;
 
-            if (!passed) {
-                return;
-            }
+            return;
         }
     }
 
-    // timestamp
-    t = AT91SAM9X35_Time_GetSystemTime(nullptr);
+    if (state->enable && state->frameHandler != nullptr) {
+        TinyCLR_Can_Message message;
+
+        uint32_t* data32 = (uint32_t*)message.Data;
+
+        message.ArbitrationId = msgid;
+        message.IsExtendedId = extendMode;
+        message.IsRemoteTransmissionRequest = rtrmode;
+        message.Length = state->can_rx.bMsgLen;
+        message.Timestamp = t;
+
+        data32[0] = state->can_rx.msgData[0];
+        data32[1] = state->can_rx.msgData[1];
+
+        if (state->frameHandler(message, t, state->frameHandlerContext))
+            return;
+    }
 
     if (state->rxCount == state->rxBufferSize) { // Raise error full
+        state->statistics.OverflowFrames++;
+
         state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::BufferFull;
+
+        // Drop the frame: the next slot is rxOut, which ReadMessage may be copying from
+        return;
     }
     else if (state->rxCount >= state->rxBufferSize - CAN_MINIMUM_MESSAGES_LEFT) { // Raise full event soon when internal buffer has only 3 availble msg left
         state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::BufferFull;
@@ -1339,18 +1407,11 @@ void CopyMessageFromMailBoxToBuffer(uint8_t controllerIndex, uint32_t dwMsr) {
         // initialize destination pointer
     can_msg = &state->canRxMessagesFifo[state->rxIn++];
 
-    can_msg->timeStampL = t & 0xFFFFFFFF;
-    can_msg->timeStampH = t >> 32;
+    can_msg->msgId = msgid | (extendMode ? CAN_MESSAGE_EXTENDED_ID : 0) | (rtrmode ? CAN_MESSAGE_REMOTE_TRANSMISSION_REQUEST : 0);
 
-    can_msg->length = (state->can_rx.bMsgLen) & 0x0F;
+    can_msg->timeStamp = AT91SAM9X35_Can_RxTimeStamp(state, t, state->can_rx.bMsgLen);
 
-    can_msg->extendedId = extendMode;
-
-    can_msg->remoteTransmissionRequest = ((dwMsr >> 20) & 0x01) ? true : false;
-
-    can_msg->msgId = msgid; // ID
-
-    if (can_msg->remoteTransmissionRequest) {
+    if (rtrmode) {
         can_msg->dataA = 0x00000000;
         can_msg->dataB = 0x00000000;
     }
@@ -1359,9 +1420,7 @@ void CopyMessageFromMailBoxToBuffer(uint8_t controllerIndex, uint32_t dwMsr) {
         can_msg->dataB = state->can_rx.msgData[1]; // Data B
     }
 
-    if (state->rxCount < state->rxBufferSize) {
-        state->rxCount++;        
-    }    
+    state->rxCount++;
 
     if (state->rxIn == state->rxBufferSize) {
         state->rxIn = 0;
@@ -1458,6 +1517,20 @@ bool CAN_ErrorHandler(sCand *pCand, uint32_t dwErrS, int32_t controllerIndex) {
 **
 ******************************************************************************/
 
+// Status register error flags are cleared on read, so the state is only sampled from the interrupt
+static CanStatistics_ErrorState AT91SAM9X35_Can_GetErrorState(uint32_t status) {
+    if (status & CAN_SR_BOFF)
+        return CanStatistics_ErrorState::BusOff;
+
+    if (status & CAN_SR_ERRP)
+        return CanStatistics_ErrorState::Passive;
+
+    if (status & CAN_SR_WARN)
+        return CanStatistics_ErrorState::Warning;
+
+    return CanStatistics_ErrorState::Active;
+}
+
 void AT91SAM9X35_Can_RxInterruptHandler(void *param) {
     DISABLE_INTERRUPTS_SCOPED(irq);
 
@@ -1469,7 +1542,11 @@ void AT91SAM9X35_Can_RxInterruptHandler(void *param) {
 
     sCand *pCand = &state->cand;
     Can *pHw = pCand->pHw;
-    uint32_t dwSr = (CAN_GetStatus(pHw) & CAN_GetItMask(pHw));
+    uint32_t status = CAN_GetStatus(pHw);
+    uint32_t dwSr = (status & CAN_GetItMask(pHw));
+
+    CanStatistics_SetErrorState(state->statistics, AT91SAM9X35_Time_GetSystemTime(nullptr), AT91SAM9X35_Can_GetErrorState(status));
+
     if (dwSr & CAN_ERRS) {
         CAN_DisableIt(pHw, (dwSr & CAN_ERRS));
         if (pCand->bState != CAND_STATE_DISABLED) {
@@ -1547,6 +1624,9 @@ TinyCLR_Result AT91SAM9X35_Can_Acquire(const TinyCLR_Can_Controller* self) {
         state->lastEventRxBufferCount = 0;
         state->errorEvent = 0;
 
+        CanStatistics_Reset(state->statistics, AT91SAM9X35_Time_GetSystemTime(nullptr));
+
+        state->frameHandler = nullptr;
         state->errorEventHandler = nullptr;
         state->messageReceivedEventHandler = nullptr;
 
@@ -1596,10 +1676,15 @@ TinyCLR_Result AT91SAM9X35_Can_Release(const TinyCLR_Can_Controller* self) {
     return TinyCLR_Result::Success;
 }
 
-TinyCLR_Result AT91SAM9X35_Can_WriteMessage(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& len) {
-    if (len != 1) return TinyCLR_Result::NotSupported;
+static void AT91SAM9X35_Can_CountTransmit(CanState* state, const TinyCLR_Can_Message& m) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
 
-    auto& m = messages[0];
+    state->statistics.TransmittedFrames++;
+
+    CanStatistics_AddFrame(state->statistics, AT91SAM9X35_Time_GetSystemTime(nullptr), m.IsExtendedId, m.IsRemoteTransmissionRequest, m.Length);
+}
+
+static TinyCLR_Result AT91SAM9X35_Can_WriteSingleMessage(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message& m) {
     uint32_t arbitrationId = m.ArbitrationId;
     bool isExtendedId = m.IsExtendedId;
     bool isRemoteTransmissionRequest = m.IsRemoteTransmissionRequest;
@@ -1622,8 +1707,19 @@ TinyCLR_Result AT91SAM9X35_Can_WriteMessage(const TinyCLR_Can_Controller* self,
 
     candCfg.bTxPriority = 1;
 
+    // With interrupts disabled, as in the receive interrupt frame handler hook, the mailbox interrupt that
+    // completes a transfer cannot run. Start the frame only if the mailbox is free and don't wait for it.
+    auto nonBlocking = AT91SAM9X35_Interrupt_IsDisabled();
+
     uint32_t timeout = CAN_TRANSFER_TIMEOUT;
 
+    if (nonBlocking) {
+        AT91SAM9X35_Can_IsWritingAllowed(self, readyToSend);
+
+        if (!readyToSend || !CAND_IsTransferDone(&state->can_tx))
+            return TinyCLR_Result::Busy;
+    }
+
     while (readyToSend == false && timeout-- > 0) {
         AT91SAM9X35_Can_IsWritingAllowed(self, readyToSend);
         AT91SAM9X35_Time_Delay(nullptr, 1);
@@ -1661,11 +1757,20 @@ TinyCLR_Result AT91SAM9X35_Can_WriteMessage(const TinyCLR_Can_Controller* self,
         CAND_Transfer(pCand, &state->can_tx);
     }
 
+    if (nonBlocking) {
+        AT91SAM9X35_Can_CountTransmit(state, m);
+
+        return TinyCLR_Result::Success;
+    }
+
     timeout = CAN_TRANSFER_TIMEOUT;
 
     while (timeout > 0) {
-        if (CAND_IsTransferDone(&state->can_tx))
+        if (CAND_IsTransferDone(&state->can_tx)) {
+            AT91SAM9X35_Can_CountTransmit(state, m);
+
             return TinyCLR_Result::Success;
+        }
 
         AT91SAM9X35_Time_Delay(nullptr, 1);
         timeout--;
@@ -1674,51 +1779,72 @@ TinyCLR_Result AT91SAM9X35_Can_WriteMessage(const TinyCLR_Can_Controller* self,
     return TinyCLR_Result::Busy;
 }
 
-TinyCLR_Result AT91SAM9X35_Can_ReadMessage(const TinyCLR_Can_Controller* self, TinyCLR_Can_Message* messages, size_t& len) {
-    if (len != 1) return TinyCLR_Result::NotSupported;
+TinyCLR_Result AT91SAM9X35_Can_WriteMessage(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& len) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
 
-    auto& m = messages[0];
-    uint32_t& arbitrationId = m.ArbitrationId;
-    bool& isExtendedId = m.IsExtendedId;
-    bool& isRemoteTransmissionRequest = m.IsRemoteTransmissionRequest;
-    uint8_t* data = m.Data;
-    size_t& length = m.Length;
-    uint64_t& timestamp = m.Timestamp;
+    if (!state->enable) return TinyCLR_Result::InvalidOperation;
 
-    AT91SAM9X35_Can_Message *can_msg;
+    auto result = TinyCLR_Result::Success;
+    size_t sent = 0;
 
-    uint32_t *data32 = (uint32_t*)data;
+    while (sent < len) {
+        result = AT91SAM9X35_Can_WriteSingleMessage(self, messages[sent]);
+
+        if (result != TinyCLR_Result::Success)
+            break;
 
+        sent++;
+    }
+
+    len = sent;
+
+    return sent > 0 ? TinyCLR_Result::Success : result;
+}
+
+TinyCLR_Result AT91SAM9X35_Can_ReadMessage(const TinyCLR_Can_Controller* self, TinyCLR_Can_Message* messages, size_t& len) {
     auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
 
     if (!state->enable) return TinyCLR_Result::InvalidOperation;
 
-    if (state->rxCount) {
+    AT91SAM9X35_Can_Message *can_msg;
+
+    // Only the rx interrupt moves rxIn and it drops frames instead of storing into a full buffer, so it
+    // never writes the slots counted here. They can be copied with interrupts enabled and handed back
+    // to the fifo with a single update of rxCount.
+    size_t available = state->rxCount;
+    size_t read = len < available ? len : available;
+
+    for (size_t i = 0; i < read; i++) {
+        auto& m = messages[i];
+
+        uint32_t* data32 = (uint32_t*)m.Data;
+
         can_msg = &state->canRxMessagesFifo[state->rxOut++];
 
         if (state->rxOut == state->rxBufferSize)
             state->rxOut = 0;
 
-        arbitrationId = can_msg->msgId;
-        isExtendedId = can_msg->extendedId;
-        isRemoteTransmissionRequest = can_msg->remoteTransmissionRequest;
+        m.ArbitrationId = can_msg->msgId & CAN_MESSAGE_ID_MASK;
+        m.IsExtendedId = (can_msg->msgId & CAN_MESSAGE_EXTENDED_ID) != 0;
+        m.IsRemoteTransmissionRequest = (can_msg->msgId & CAN_MESSAGE_REMOTE_TRANSMISSION_REQUEST) != 0;
+        m.Length = can_msg->timeStamp >> CAN_MESSAGE_LENGTH_SHIFT;
 
         data32[0] = can_msg->dataA;
         data32[1] = can_msg->dataB;
 
-        length = can_msg->length;
-
-        timestamp = ((uint64_t)can_msg->timeStampL) | ((uint64_t)can_msg->timeStampH << 32);
+        // The epoch only moves when the buffer is empty, so it is stable while these are unread
+        m.Timestamp = state->rxEpoch + ((uint64_t)(can_msg->timeStamp & CAN_MESSAGE_TIMESTAMP_MASK) << AT91SAM9X35_CAN_TIMESTAMP_SHIFT);
+    }
 
-        {
-            DISABLE_INTERRUPTS_SCOPED(irq);
+    if (read > 0) {
+        DISABLE_INTERRUPTS_SCOPED(irq);
 
-            state->rxCount--;
-        }
+        state->rxCount -= read;
     }
 
-    return TinyCLR_Result::Success;
+    len = read;
 
+    return TinyCLR_Result::Success;
 }
 
 TinyCLR_Result AT91SAM9X35_Can_SetBitTiming(const TinyCLR_Can_Controller* self, const TinyCLR_Can_BitTiming* timing) {
@@ -1741,6 +1867,8 @@ TinyCLR_Result AT91SAM9X35_Can_SetBitTiming(const TinyCLR_Can_Controller* self,
 
     state->cand.wBaudrate = state->baudrate;
 
+    CanStatistics_SetBitTiming(state->statistics, AT91SAM9X35_Can_GetSourceClock(self), timing);
+
     return TinyCLR_Result::Success;
 }
 
@@ -1866,6 +1994,19 @@ TinyCLR_Result AT91SAM9X35_Can_SetExplicitFilters(const TinyCLR_Can_Controller*
 
     std::sort(_matchFilters, _matchFilters + count);
 
+    uint32_t *extendedIdSet;
+    uint32_t extendedIdSetShift;
+
+    if (CanFilter_BuildExtendedIdSet(memoryProvider, _matchFilters, count, extendedIdSet, extendedIdSetShift) != TinyCLR_Result::Success) {
+        memoryProvider->Free(memoryProvider, _matchFilters);
+
+        return TinyCLR_Result::OutOfMemory;
+    }
+
+    uint32_t standardIdBitmap[CAN_FILTER_STANDARD_ID_COUNT / 32];
+
+    CanFilter_BuildStandardIdBitmap(standardIdBitmap, _matchFilters, count, state->canDataFilter.lowerBoundFilters, state->canDataFilter.upperBoundFilters, state->canDataFilter.groupFiltersSize);
+
     {
         DISABLE_INTERRUPTS_SCOPED(irq);
 
@@ -1873,6 +2014,11 @@ TinyCLR_Result AT91SAM9X35_Can_SetExplicitFilters(const TinyCLR_Can_Controller*
 
         state->canDataFilter.matchFiltersSize = count;
         state->canDataFilter.matchFilters = _matchFilters;
+
+        state->canDataFilter.extendedIdSet = extendedIdSet;
+        state->canDataFilter.extendedIdSetShift = extendedIdSetShift;
+
+        memcpy(state->canDataFilter.standardIdBitmap, standardIdBitmap, sizeof(standardIdBitmap));
     }
 
     return TinyCLR_Result::Success;
@@ -1913,6 +2059,10 @@ TinyCLR_Result AT91SAM9X35_Can_SetGroupFilters(const TinyCLR_Can_Controller* sel
         return TinyCLR_Result::ArgumentInvalid;
     }
 
+    uint32_t standardIdBitmap[CAN_FILTER_STANDARD_ID_COUNT / 32];
+
+    CanFilter_BuildStandardIdBitmap(standardIdBitmap, state->canDataFilter.matchFilters, state->canDataFilter.matchFiltersSize, _lowerBoundFilters, _upperBoundFilters, count);
+
     {
         DISABLE_INTERRUPTS_SCOPED(irq);
 
@@ -1921,6 +2071,8 @@ TinyCLR_Result AT91SAM9X35_Can_SetGroupFilters(const TinyCLR_Can_Controller* sel
         state->canDataFilter.groupFiltersSize = count;
         state->canDataFilter.lowerBoundFilters = _lowerBoundFilters;
         state->canDataFilter.upperBoundFilters = _upperBoundFilters;
+
+        memcpy(state->canDataFilter.standardIdBitmap, standardIdBitmap, sizeof(standardIdBitmap));
     }
 
     return TinyCLR_Result::Success;
@@ -1967,6 +2119,42 @@ size_t AT91SAM9X35_Can_GetWriteErrorCount(const TinyCLR_Can_Controller* self) {
     return CAN_GetTxErrorCount(state->cand.pHw);
 }
 
+TinyCLR_Result AT91SAM9X35_Can_GetStatistics(const TinyCLR_Can_Controller* self, CanStatistics& statistics) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    auto now = AT91SAM9X35_Time_GetSystemTime(nullptr);
+
+    CanStatistics_Update(state->statistics, now);
+
+    statistics = state->statistics;
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result AT91SAM9X35_Can_ResetStatistics(const TinyCLR_Can_Controller* self) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    CanStatistics_Reset(state->statistics, AT91SAM9X35_Time_GetSystemTime(nullptr));
+
+    return TinyCLR_Result::Success;
+}
+
+// Frames the handler accepts are consumed in the receive interrupt and never reach the read buffer
+TinyCLR_Result AT91SAM9X35_Can_SetFrameHandler(const TinyCLR_Can_Controller* self, AT91SAM9X35_Can_FrameHandler handler, void* context) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    state->frameHandler = handler;
+    state->frameHandlerContext = context;
+
+    return TinyCLR_Result::Success;
+}
+
 uint32_t AT91SAM9X35_Can_GetSourceClock(const TinyCLR_Can_Controller* self) {
     return AT91SAM9X35_SYSTEM_PERIPHERAL_CLOCK_HZ;
 }
@@ -14,6 +14,9 @@
 // limitations under the License.
 
 #include "AT91SAM9X35.h"
+#include "../../Drivers/DisplayRegion/DisplayRegion.h"
+#include "../../Drivers/DisplayRotation/DisplayRotation.h"
+#include "../../Drivers/DisplayFormat/DisplayFormat.h"
 
 #ifdef INCLUDE_DISPLAY
 
@@ -234,6 +237,25 @@ struct AT91SAM9X35_LCDC {
 #define LCDC_LCDSR_DISPSTS (0x1u << 2) /**< \brief (LCDC_LCDSR) LCD Controller DISP Signal Status */
 #define LCDC_LCDSR_PWMSTS (0x1u << 3) /**< \brief (LCDC_LCDSR) LCD Controller PWM Signal Status */
 #define LCDC_LCDSR_SIPSTS (0x1u << 4) /**< \brief (LCDC_LCDSR) Synchronization In Progress */
+/* -------- Overlay 1 and hardware cursor layers, same bits in LCDC_OVRxxx1 and LCDC_HCRxxx -------- */
+#define LCDC_LAYER_CHER_CHEN (0x1u << 0) /**< \brief (LCDC_OVRCHER1) Channel Enable */
+#define LCDC_LAYER_CHER_UPDATEEN (0x1u << 1) /**< \brief (LCDC_OVRCHER1) Update Overlay Attributes Enable */
+#define LCDC_LAYER_CHDR_CHDIS (0x1u << 0) /**< \brief (LCDC_OVRCHDR1) Channel Disable */
+#define LCDC_LAYER_CHSR_CHSR (0x1u << 0) /**< \brief (LCDC_OVRCHSR1) Channel Status */
+#define LCDC_LAYER_CTRL_DFETCH (0x1u << 0) /**< \brief (LCDC_OVRCTRL1) Transfer Descriptor Fetch Enable */
+#define LCDC_LAYER_CFG1_CLUTEN (0x1u << 0) /**< \brief (LCDC_OVRCFG1) Color Lookup Table Enable */
+#define   LCDC_LAYER_CFG1_RGBMODE_16BPP_RGB_565 (0x3u << 4) /**< \brief (LCDC_OVRCFG1) 16 bpp RGB 565 */
+#define   LCDC_LAYER_CFG1_RGBMODE_24BPP_RGB_888_PACKED (0xAu << 4) /**< \brief (LCDC_OVRCFG1) 24 bpp RGB 888 packed */
+#define   LCDC_LAYER_CFG1_RGBMODE_32BPP_ARGB_8888 (0xCu << 4) /**< \brief (LCDC_OVRCFG1) 32 bpp ARGB 8888 */
+#define   LCDC_LAYER_CFG1_CLUTMODE_CLUT_8BPP (0x3u << 8) /**< \brief (LCDC_OVRCFG1) 8 bpp through the color lookup table */
+#define LCDC_LAYER_CFG2_POS(x, y) ((((y) & 0x7FFu) << 16) | ((x) & 0x7FFu)) /**< \brief (LCDC_OVRCFG2) Window position */
+#define LCDC_LAYER_CFG3_SIZE(width, height) (((((height) - 1) & 0x7FFu) << 16) | (((width) - 1) & 0x7FFu)) /**< \brief (LCDC_OVRCFG3) Window size */
+#define LCDC_LAYER_CFG9_CRKEY (0x1u << 0) /**< \brief (LCDC_OVRCFG9) Blender Chroma Key Enable */
+#define LCDC_LAYER_CFG9_GAEN (0x1u << 5) /**< \brief (LCDC_OVRCFG9) Blender Global Alpha Enable */
+#define LCDC_LAYER_CFG9_LAEN (0x1u << 6) /**< \brief (LCDC_OVRCFG9) Blender Local Alpha Enable */
+#define LCDC_LAYER_CFG9_OVR (0x1u << 7) /**< \brief (LCDC_OVRCFG9) Blender Overlay Layer Enable */
+#define LCDC_LAYER_CFG9_DMA (0x1u << 8) /**< \brief (LCDC_OVRCFG9) Blender DMA Layer Enable */
+#define LCDC_LAYER_CFG9_GA(value) (((value) & 0xFFu) << 16) /**< \brief (LCDC_OVRCFG9) Blender Global Alpha */
 
 /** Frequency of the board main oscillator */
 #define BOARD_MAINOSC           12000000
@@ -685,6 +707,26 @@ typedef struct _LCDCDescriptor {
     uint32_t next;
 } LCDCDescriptor;
 
+// Overlay 1 and the hardware cursor have their registers in this order from LCDC_OVRCHER1 and LCDC_HCRCHER.
+// CFG[5] is the pixel stride on overlay 1 and reserved on the cursor.
+struct AT91SAM9X35_LCDC_Layer {
+    volatile uint32_t CHER;
+    volatile uint32_t CHDR;
+    volatile const uint32_t CHSR;
+    volatile uint32_t IER;
+    volatile uint32_t IDR;
+    volatile uint32_t IMR;
+    volatile const uint32_t ISR;
+    volatile uint32_t HEAD;
+    volatile uint32_t ADDR;
+    volatile uint32_t CTRL;
+    volatile uint32_t NEXT;
+    volatile uint32_t CFG[10];
+};
+
+// The hardware cursor is at most this size
+#define AT91SAM9X35_DISPLAY_CURSOR_MAX_SIZE 128
+
 /** CULT information */
 typedef struct _CLUTInfo {
     uint8_t bpp;
@@ -740,6 +782,14 @@ uint8_t m_AT91SAM9X35_Display_TextBuffer[LCD_MAX_COLUMN][LCD_MAX_ROW];
 
 AT91SAM9X35_LCD_Rotation m_AT91SAM9X35_Display_CurrentRotation = AT91SAM9X35_LCD_Rotation::rotateNormal_0;
 
+AT91SAM9X35_Display_OverlayConfiguration m_AT91SAM9X35_Display_Overlay;
+bool m_AT91SAM9X35_Display_OverlayEnable = false;
+
+AT91SAM9X35_Display_CursorConfiguration m_AT91SAM9X35_Display_Cursor;
+int32_t m_AT91SAM9X35_Display_CursorX = 0;
+int32_t m_AT91SAM9X35_Display_CursorY = 0;
+bool m_AT91SAM9X35_Display_CursorEnable = false;
+
 bool AT91SAM9X35_Display_Initialize();
 bool AT91SAM9X35_Display_Uninitialize();
 bool AT91SAM9X35_Display_SetPinConfiguration(int32_t controllerIndex, bool enable);
@@ -747,6 +797,7 @@ bool AT91SAM9X35_Display_SetPinConfiguration(int32_t controllerIndex, bool enabl
 void AT91SAM9X35_Display_WriteFormattedChar(uint8_t c);
 void AT91SAM9X35_Display_WriteChar(uint8_t c, int32_t row, int32_t col);
 void AT91SAM9X35_Display_BitBltEx(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t data[]);
+void AT91SAM9X35_Display_BitBltRegion(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t* data);
 void AT91SAM9X35_Display_PaintPixel(uint32_t x, uint32_t y, uint8_t c);
 void AT91SAM9X35_Display_Paint8HorizontalPixels(uint32_t x, uint32_t y, uint8_t p);
 void AT91SAM9X35_Display_TextEnterClearMode();
@@ -754,13 +805,14 @@ void AT91SAM9X35_Display_PrintChracter(uint32_t x, uint32_t y, uint8_t c);
 void AT91SAM9X35_Display_TextShiftColUp();
 void AT91SAM9X35_Display_Clear();
 void AT91SAM9X35_Display_GetRotatedDimensions(int32_t *screenWidth, int32_t *screenHeight);
+void AT91SAM9X35_Display_ConfigureLayer(AT91SAM9X35_LCDC_Layer* layer, LCDCDescriptor* descriptor, volatile uint32_t* clut, bool& disablePending, bool enable, const uint8_t* buffer, DisplayFormat_PixelFormat format, int32_t x, int32_t y, uint32_t width, uint32_t height, uint8_t alpha, bool colorKeyEnable, uint32_t colorKey, const uint32_t* palette);
+void AT91SAM9X35_Display_ConfigureOverlay(bool loadPalette);
+void AT91SAM9X35_Display_ConfigureCursor(bool loadPalette);
 
 int32_t AT91SAM9X35_Display_GetWidth();
 int32_t AT91SAM9X35_Display_GetHeight();
 int32_t AT91SAM9X35_Display_BitPerPixel();
 uint32_t AT91SAM9X35_Display_GetPixelClockDivider();
-int32_t AT91SAM9X35_Display_GetOrientation();
-uint32_t* AT91SAM9X35_Display_GetFrameBuffer();
 
 #define TOTAL_DISPLAY_CONTROLLERS 1
 
@@ -768,6 +820,15 @@ static TinyCLR_Display_Controller displayControllers[TOTAL_DISPLAY_CONTROLLERS];
 static TinyCLR_Api_Info displayApi[TOTAL_DISPLAY_CONTROLLERS];
 
 static Layer baseLayer;
+static LCDCDescriptor overlayDescriptor;
+static LCDCDescriptor cursorDescriptor;
+
+// CHDR stops a channel only at the end of the frame, CHSR stays set until then
+static bool overlayDisablePending;
+static bool cursorDisablePending;
+
+// System ticks to wait for a pending disable, several frames at the slowest pixel clocks
+#define AT91SAM9X35_DISPLAY_LAYER_DISABLE_TIMEOUT (100 * 10000)
 
 void AT91SAM9X35_Display_SetBaseLayerDMA() {
     AT91SAM9X35_LCDC *lcd = (AT91SAM9X35_LCDC*)AT91C_BASE_LCDC;
@@ -796,6 +857,129 @@ void AT91SAM9X35_Display_SetBaseLayerDMA() {
     lcd->LCDC_BASECHER = 0x3;
 }
 
+// Points the layer at buffer, width x height pixels shown at x, y on the panel. The window is clipped to the panel by
+// starting further into the buffer and skipping the rest of each line with the stride. Changes are picked up at the
+// start of the next frame, a disabled layer stops at the end of the current one.
+void AT91SAM9X35_Display_ConfigureLayer(AT91SAM9X35_LCDC_Layer* layer, LCDCDescriptor* descriptor, volatile uint32_t* clut, bool& disablePending, bool enable, const uint8_t* buffer, DisplayFormat_PixelFormat format, int32_t x, int32_t y, uint32_t width, uint32_t height, uint8_t alpha, bool colorKeyEnable, uint32_t colorKey, const uint32_t* palette) {
+    int32_t x0 = x;
+    int32_t y0 = y;
+    int32_t x1 = x + static_cast<int32_t>(width);
+    int32_t y1 = y + static_cast<int32_t>(height);
+
+    if (x0 < 0)
+        x0 = 0;
+
+    if (y0 < 0)
+        y0 = 0;
+
+    if (x1 > static_cast<int32_t>(m_AT91SAM9X35_DisplayWidth))
+        x1 = m_AT91SAM9X35_DisplayWidth;
+
+    if (y1 > static_cast<int32_t>(m_AT91SAM9X35_DisplayHeight))
+        y1 = m_AT91SAM9X35_DisplayHeight;
+
+    if (enable == false || x0 >= x1 || y0 >= y1) {
+        layer->CHDR = LCDC_LAYER_CHDR_CHDIS;
+
+        disablePending = true;
+
+        return;
+    }
+
+    // UPDATEEN can't cancel a disable that is still pending, the channel would stop at the end of this frame while
+    // it is thought to be on. Wait for it to stop so that it is started again below.
+    if (disablePending) {
+        auto start = AT91SAM9X35_Time_GetSystemTime(nullptr);
+
+        while ((layer->CHSR & LCDC_LAYER_CHSR_CHSR) && AT91SAM9X35_Time_GetSystemTime(nullptr) - start < AT91SAM9X35_DISPLAY_LAYER_DISABLE_TIMEOUT);
+
+        disablePending = false;
+    }
+
+    auto bytesPerPixel = DisplayFormat_GetBytesPerPixel(format);
+    uint32_t mode;
+
+    switch (format) {
+    case DisplayFormat_PixelFormat::L8:
+        mode = LCDC_LAYER_CFG1_CLUTEN | LCDC_LAYER_CFG1_CLUTMODE_CLUT_8BPP;
+
+        // CLUT entries are Argb8888 too. Moving the layer leaves them as they are.
+        if (palette != nullptr) {
+            for (auto i = 0; i < DISPLAY_FORMAT_PALETTE_SIZE; i++)
+                clut[i] = palette[i];
+        }
+
+        break;
+
+    case DisplayFormat_PixelFormat::Rgb888:
+        mode = LCDC_LAYER_CFG1_RGBMODE_24BPP_RGB_888_PACKED;
+        break;
+
+    case DisplayFormat_PixelFormat::Argb8888:
+        mode = LCDC_LAYER_CFG1_RGBMODE_32BPP_ARGB_8888;
+        break;
+
+    default:
+        mode = LCDC_LAYER_CFG1_RGBMODE_16BPP_RGB_565;
+        break;
+    }
+
+    auto visibleWidth = static_cast<uint32_t>(x1 - x0);
+
+    descriptor->addr = reinterpret_cast<uint32_t>(buffer + ((y0 - y) * width + (x0 - x)) * bytesPerPixel);
+    descriptor->ctrl = LCDC_LAYER_CTRL_DFETCH;
+    descriptor->next = reinterpret_cast<uint32_t>(descriptor);
+
+    // The controller fetches the descriptor from memory every frame
+    AT91SAM9X35_Cache_DrainWriteBuffers();
+
+    layer->CFG[1] = mode;
+    layer->CFG[2] = LCDC_LAYER_CFG2_POS(x0, y0);
+    layer->CFG[3] = LCDC_LAYER_CFG3_SIZE(visibleWidth, y1 - y0);
+    layer->CFG[4] = (width - visibleWidth) * bytesPerPixel;
+
+    // Argb8888 pixels carry their own alpha, scaled by the constant one
+    auto blend = LCDC_LAYER_CFG9_DMA | LCDC_LAYER_CFG9_OVR | LCDC_LAYER_CFG9_GAEN | LCDC_LAYER_CFG9_GA(alpha);
+
+    if (format == DisplayFormat_PixelFormat::Argb8888)
+        blend |= LCDC_LAYER_CFG9_LAEN;
+
+    if (colorKeyEnable) {
+        layer->CFG[7] = colorKey & 0x00FFFFFF;
+        layer->CFG[8] = 0x00FFFFFF;
+
+        blend |= LCDC_LAYER_CFG9_CRKEY;
+    }
+
+    layer->CFG[9] = blend;
+
+    // A running channel loops on the descriptor and picks up its new address by itself
+    if (layer->CHSR & LCDC_LAYER_CHSR_CHSR) {
+        layer->CHER = LCDC_LAYER_CHER_UPDATEEN;
+    }
+    else {
+        layer->ADDR = descriptor->addr;
+        layer->CTRL = descriptor->ctrl;
+        layer->NEXT = descriptor->next;
+        layer->CHER = LCDC_LAYER_CHER_CHEN | LCDC_LAYER_CHER_UPDATEEN;
+    }
+}
+
+void AT91SAM9X35_Display_ConfigureOverlay(bool loadPalette) {
+    AT91SAM9X35_LCDC *lcd = (AT91SAM9X35_LCDC*)AT91C_BASE_LCDC;
+    auto& overlay = m_AT91SAM9X35_Display_Overlay;
+
+    AT91SAM9X35_Display_ConfigureLayer(reinterpret_cast<AT91SAM9X35_LCDC_Layer*>(&lcd->LCDC_OVRCHER1), &overlayDescriptor, lcd->LCDC_OVR1CLUT, overlayDisablePending, m_AT91SAM9X35_Display_OverlayEnable, overlay.Buffer, overlay.Format, overlay.X, overlay.Y, overlay.Width, overlay.Height, overlay.Alpha, overlay.ColorKeyEnable, overlay.ColorKey, loadPalette ? overlay.Palette : nullptr);
+}
+
+// The cursor is opaque apart from its color key or, for Argb8888, its own alpha
+void AT91SAM9X35_Display_ConfigureCursor(bool loadPalette) {
+    AT91SAM9X35_LCDC *lcd = (AT91SAM9X35_LCDC*)AT91C_BASE_LCDC;
+    auto& cursor = m_AT91SAM9X35_Display_Cursor;
+
+    AT91SAM9X35_Display_ConfigureLayer(reinterpret_cast<AT91SAM9X35_LCDC_Layer*>(&lcd->LCDC_HCRCHER), &cursorDescriptor, lcd->LCDC_HCRCLUT, cursorDisablePending, m_AT91SAM9X35_Display_CursorEnable, cursor.Buffer, cursor.Format, m_AT91SAM9X35_Display_CursorX - cursor.HotSpotX, m_AT91SAM9X35_Display_CursorY - cursor.HotSpotY, cursor.Width, cursor.Height, 0xFF, cursor.ColorKeyEnable, cursor.ColorKey, loadPalette ? cursor.Palette : nullptr);
+}
+
 bool AT91SAM9X35_Display_Initialize() {
 
     AT91SAM9X35_LCDC *lcd = (AT91SAM9X35_LCDC*)AT91C_BASE_LCDC;
@@ -815,11 +999,9 @@ bool AT91SAM9X35_Display_Initialize() {
     lcd->LCDC_BASECFG0 = LCDC_BASECFG0_DLBO | LCDC_BASECFG0_BLEN_AHB_INCR16;
     lcd->LCDC_BASECFG1 = (3 << 4);
 
-    // Configure channels
+    // Configure channels, the rest of the overlay 1 and cursor setup is done by their Configure functions
     lcd->LCDC_OVRCFG0 = LCDC_BASECFG0_DLBO | LCDC_BASECFG0_BLEN_AHB_INCR16;
-    lcd->LCDC_OVRCFG1 = (3 << 4);
-    lcd->LCDC_OVRCFG2 = (100 << 16) | 100; //(LCD_GetHeight() << 16) | LCD_GetWidth();
-    lcd->LCDC_OVRCFG3 = (50 << 16) | 350; //(LCD_GetHeight() << 16) | LCD_GetWidth();
+    lcd->LCDC_HCRCFG0 = LCDC_BASECFG0_DLBO | LCDC_BASECFG0_BLEN_AHB_INCR16;
 
     // Configure channels
     lcd->LCDC_HEOCFG0 = LCDC_BASECFG0_DLBO | LCDC_BASECFG0_BLEN_AHB_INCR16;
@@ -877,6 +1059,8 @@ bool AT91SAM9X35_Display_Initialize() {
 
     AT91SAM9X35_Display_SetBaseLayerDMA();
 
+    AT91SAM9X35_Display_ConfigureOverlay(true);
+    AT91SAM9X35_Display_ConfigureCursor(true);
 
     AT91SAM9X35_Display_Clear();
 
@@ -1164,108 +1348,128 @@ int32_t AT91SAM9X35_Display_GetOrientation() {
     return m_AT91SAM9X35_Display_CurrentRotation;
 }
 
-void AT91SAM9X35_Display_BitBltEx(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t data[]) {
+// orientation is one of the AT91SAM9X35_LCD_Rotation values. The drawing functions take screen coordinates in the new
+// orientation from then on, the frame buffer keeps what is already drawn.
+TinyCLR_Result AT91SAM9X35_Display_SetOrientation(const TinyCLR_Display_Controller* self, uint32_t orientation) {
+    if (orientation > AT91SAM9X35_LCD_Rotation::rotateCCW_90)
+        return TinyCLR_Result::ArgumentOutOfRange;
 
-    int32_t xTo, yTo, xFrom, yFrom;
-    int32_t xOffset = x;
-    int32_t yOffset = y;
-    uint16_t *from = (uint16_t *)data;
-    uint16_t *to = (uint16_t *)m_AT91SAM9X35_Display_VituralRam;
+    m_AT91SAM9X35_Display_CurrentRotation = static_cast<AT91SAM9X35_LCD_Rotation>(orientation);
 
+    return TinyCLR_Result::Success;
+}
 
-    int32_t screenWidth = m_AT91SAM9X35_DisplayWidth;
-    int32_t screenHeight = m_AT91SAM9X35_DisplayHeight;
-    int32_t startPx, toAddition;
+// Shows buffer on top of the frame buffer from the next frame on, or moves and restyles an overlay already shown.
+// The buffer belongs to the caller and is scanned directly, drawing into it shows right away. Coordinates are on the
+// panel, unrotated, and may put part of the overlay off screen.
+TinyCLR_Result AT91SAM9X35_Display_SetOverlay(const TinyCLR_Display_Controller* self, const AT91SAM9X35_Display_OverlayConfiguration& configuration) {
+    if (configuration.Buffer == nullptr || configuration.Width == 0 || configuration.Height == 0 || DisplayFormat_GetBytesPerPixel(configuration.Format) == 0)
+        return TinyCLR_Result::ArgumentInvalid;
 
-    if (m_AT91SAM9X35_DisplayEnable == false)
-        return;
+    if (configuration.Format == DisplayFormat_PixelFormat::L8 && configuration.Palette == nullptr)
+        return TinyCLR_Result::ArgumentNull;
 
-    switch (m_AT91SAM9X35_Display_CurrentRotation) {
-    case AT91SAM9X35_LCD_Rotation::rotateNormal_0:
+    m_AT91SAM9X35_Display_Overlay = configuration;
+    m_AT91SAM9X35_Display_OverlayEnable = true;
 
-        if (xOffset == 0 && yOffset == 0 &&
-            width == screenWidth && height == screenHeight) {
-            memcpy(to, from, (screenWidth*screenHeight * 2));
-        }
-        else {
-            for (yTo = yOffset; yTo < (yOffset + height); yTo++) {
-                memcpy((void*)(to + yTo * screenWidth + xOffset), (void*)(from), (width * 2));
-                from += width;
-            }
-        }
+    if (m_AT91SAM9X35_DisplayEnable)
+        AT91SAM9X35_Display_ConfigureOverlay(true);
 
-        break;
+    return TinyCLR_Result::Success;
+}
 
-    case AT91SAM9X35_LCD_Rotation::rotateCCW_90:
+// Only the window changes, the frame buffer and the overlay buffer are not touched
+TinyCLR_Result AT91SAM9X35_Display_MoveOverlay(const TinyCLR_Display_Controller* self, int32_t x, int32_t y) {
+    if (m_AT91SAM9X35_Display_OverlayEnable == false)
+        return TinyCLR_Result::InvalidOperation;
 
-        startPx = yOffset * screenHeight;
-        xFrom = xOffset + width;
-        yTo = screenHeight - xOffset - width;
-        xTo = yOffset;
-        to += yTo * screenWidth + xTo;
-        toAddition = screenWidth - height;
+    m_AT91SAM9X35_Display_Overlay.X = x;
+    m_AT91SAM9X35_Display_Overlay.Y = y;
 
-        for (; yTo < (screenHeight - xOffset); yTo++) {
-            xFrom--;
-            yFrom = startPx + xFrom;
+    if (m_AT91SAM9X35_DisplayEnable)
+        AT91SAM9X35_Display_ConfigureOverlay(false);
 
-            for (xTo = yOffset; xTo < (yOffset + height); xTo++) {
-                *to++ = from[yFrom];
-                yFrom += screenHeight;
-            }
+    return TinyCLR_Result::Success;
+}
 
-            to += toAddition;
-        }
+// The buffer is no longer read once the current frame is out
+TinyCLR_Result AT91SAM9X35_Display_DisableOverlay(const TinyCLR_Display_Controller* self) {
+    m_AT91SAM9X35_Display_OverlayEnable = false;
 
-        break;
+    if (m_AT91SAM9X35_DisplayEnable)
+        AT91SAM9X35_Display_ConfigureOverlay(false);
 
-    case AT91SAM9X35_LCD_Rotation::rotateCW_90:
+    return TinyCLR_Result::Success;
+}
 
-        startPx = (yOffset + height - 1) * screenHeight;
-        xFrom = xOffset;
+// Shows the cursor bitmap with its hot spot at the last position given to MoveCursor, 0, 0 at first
+TinyCLR_Result AT91SAM9X35_Display_SetCursor(const TinyCLR_Display_Controller* self, const AT91SAM9X35_Display_CursorConfiguration& configuration) {
+    if (configuration.Buffer == nullptr || configuration.Width == 0 || configuration.Height == 0 || DisplayFormat_GetBytesPerPixel(configuration.Format) == 0)
+        return TinyCLR_Result::ArgumentInvalid;
 
-        yTo = xOffset;
-        xTo = screenWidth - yOffset - height;
-        to += yTo * screenWidth + xTo;
-        toAddition = screenWidth - height;
+    if (configuration.Width > AT91SAM9X35_DISPLAY_CURSOR_MAX_SIZE || configuration.Height > AT91SAM9X35_DISPLAY_CURSOR_MAX_SIZE)
+        return TinyCLR_Result::ArgumentOutOfRange;
 
-        for (; yTo < (xOffset + width); yTo++) {
-            yFrom = startPx + xFrom;
+    if (configuration.Format == DisplayFormat_PixelFormat::L8 && configuration.Palette == nullptr)
+        return TinyCLR_Result::ArgumentNull;
 
-            for (xTo = screenWidth - yOffset - height; xTo < (screenWidth - yOffset); xTo++) {
-                *to++ = from[yFrom];
-                yFrom -= screenHeight;
-            }
+    m_AT91SAM9X35_Display_Cursor = configuration;
+    m_AT91SAM9X35_Display_CursorEnable = true;
 
-            to += toAddition;
-            xFrom++;
-        }
+    if (m_AT91SAM9X35_DisplayEnable)
+        AT91SAM9X35_Display_ConfigureCursor(true);
 
-        break;
+    return TinyCLR_Result::Success;
+}
 
-    case AT91SAM9X35_LCD_Rotation::rotate_180:
+// x, y is where the hot spot goes, on the panel and unrotated. Kept while the cursor is disabled.
+TinyCLR_Result AT91SAM9X35_Display_MoveCursor(const TinyCLR_Display_Controller* self, int32_t x, int32_t y) {
+    m_AT91SAM9X35_Display_CursorX = x;
+    m_AT91SAM9X35_Display_CursorY = y;
 
-        xFrom = (yOffset + height - 1) * screenWidth + xOffset + width;
+    if (m_AT91SAM9X35_DisplayEnable && m_AT91SAM9X35_Display_CursorEnable)
+        AT91SAM9X35_Display_ConfigureCursor(false);
 
-        yTo = screenHeight - yOffset - height;
-        xTo = screenWidth - xOffset - width;
-        to += yTo * screenWidth + xTo;
-        toAddition = screenWidth - width;
+    return TinyCLR_Result::Success;
+}
 
-        for (; yTo < (screenHeight - yOffset); yTo++) {
+TinyCLR_Result AT91SAM9X35_Display_DisableCursor(const TinyCLR_Display_Controller* self) {
+    m_AT91SAM9X35_Display_CursorEnable = false;
 
-            for (xTo = screenWidth - xOffset - width; xTo < (screenWidth - xOffset); xTo++) {
-                xFrom--;
-                *to++ = from[xFrom];
-            }
+    if (m_AT91SAM9X35_DisplayEnable)
+        AT91SAM9X35_Display_ConfigureCursor(false);
 
-            to += toAddition;
-            xFrom -= toAddition;
-        }
+    return TinyCLR_Result::Success;
+}
 
-        break;
+void AT91SAM9X35_Display_BitBltEx(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t data[]) {
+    if (m_AT91SAM9X35_DisplayEnable == false)
+        return;
+
+    DisplayRotation_Draw(static_cast<DisplayRotation_Orientation>(m_AT91SAM9X35_Display_CurrentRotation), reinterpret_cast<const uint16_t*>(data), m_AT91SAM9X35_Display_VituralRam, m_AT91SAM9X35_DisplayWidth, m_AT91SAM9X35_DisplayHeight, x, y, width, height);
+}
+
+// Same as BitBltEx, except that an unrotated source is a whole frame as well, as the rotated ones already are
+void AT91SAM9X35_Display_BitBltRegion(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t* data) {
+    if (m_AT91SAM9X35_Display_CurrentRotation != AT91SAM9X35_LCD_Rotation::rotateNormal_0) {
+        AT91SAM9X35_Display_BitBltEx(x, y, width, height, (uint32_t*)data);
+
+        return;
     }
 
+    int32_t screenWidth = m_AT91SAM9X35_DisplayWidth;
+    const uint16_t* from = data + y * screenWidth + x;
+    uint16_t* to = m_AT91SAM9X35_Display_VituralRam + y * screenWidth + x;
+
+    if (m_AT91SAM9X35_DisplayEnable == false || width <= 0 || height <= 0)
+        return;
+
+    for (auto row = 0; row < height; row++) {
+        memcpy(to, from, width * 2);
+
+        from += screenWidth;
+        to += screenWidth;
+    }
 }
 
 void AT91SAM9X35_Display_WriteChar(uint8_t c, int32_t row, int32_t col) {
@@ -1319,6 +1523,8 @@ TinyCLR_Result AT91SAM9X35_Display_Release(const TinyCLR_Display_Controller* sel
         AT91SAM9X35_Display_SetPinConfiguration(controllerIndex, false);
 
         m_AT91SAM9X35_DisplayEnable = false;
+        m_AT91SAM9X35_Display_OverlayEnable = false;
+        m_AT91SAM9X35_Display_CursorEnable = false;
 
         if (m_AT91SAM9X35_Display_buffer != nullptr) {
             auto memoryProvider = (const TinyCLR_Memory_Manager*)apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager);
@@ -1454,6 +1660,31 @@ TinyCLR_Result AT91SAM9X35_Display_DrawBuffer(const TinyCLR_Display_Controller*
     return TinyCLR_Result::Success;
 }
 
+// data is a whole frame in the current orientation, only the given rectangles of it are copied
+TinyCLR_Result AT91SAM9X35_Display_DrawBufferRegions(const TinyCLR_Display_Controller* self, const uint8_t* data, const DisplayRegion_Rectangle* rectangles, size_t count) {
+    DisplayRegion region;
+    int32_t width = m_AT91SAM9X35_DisplayWidth;
+    int32_t height = m_AT91SAM9X35_DisplayHeight;
+
+    if (m_AT91SAM9X35_DisplayEnable == false)
+        return TinyCLR_Result::InvalidOperation;
+
+    AT91SAM9X35_Display_GetRotatedDimensions(&width, &height);
+
+    DisplayRegion_Reset(region, width, height);
+
+    for (size_t i = 0; i < count; i++)
+        DisplayRegion_Add(region, rectangles[i].X, rectangles[i].Y, rectangles[i].Width, rectangles[i].Height);
+
+    for (size_t i = 0; i < region.count; i++) {
+        auto& rectangle = region.rectangles[i];
+
+        AT91SAM9X35_Display_BitBltRegion(rectangle.X, rectangle.Y, rectangle.Width, rectangle.Height, reinterpret_cast<const uint16_t*>(data));
+    }
+
+    return TinyCLR_Result::Success;
+}
+
 TinyCLR_Result AT91SAM9X35_Display_DrawPixel(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint64_t color) {
     volatile uint16_t * loc;
 
@@ -1515,6 +1746,8 @@ void AT91SAM9X35_Display_AddApi(const TinyCLR_Api_Manager* apiManager) {
     displayInitializeCount = 0;
     m_AT91SAM9X35_Display_buffer = nullptr;
     m_AT91SAM9X35_DisplayEnable = false;
+    m_AT91SAM9X35_Display_OverlayEnable = false;
+    m_AT91SAM9X35_Display_CursorEnable = false;
 
     apiManager->SetDefaultName(apiManager, TinyCLR_Api_Type::DisplayController, displayApi[0].Name);
 }
@@ -1528,6 +1761,8 @@ void AT91SAM9X35_Display_Reset() {
     m_AT91SAM9X35_DisplayEnable = false;
     displayInitializeCount = 0;
     m_AT91SAM9X35_Display_buffer = nullptr;
+    m_AT91SAM9X35_Display_OverlayEnable = false;
+    m_AT91SAM9X35_Display_CursorEnable = false;
 
     m_AT91SAM9X35_Display_TextRow = 0;
     m_AT91SAM9X35_Display_TextColumn = 0;
@@ -151,8 +151,6 @@
 #define USB_BULK_WMAXPACKETSIZE_EP_WRITE                    64
 #define USB_BULK_WMAXPACKETSIZE_EP_READ                     64
 
-#define USB_MAX_DATA_PACKET_SIZE    64
-
 struct AT91SAM9X35_UDPHS_EPT {
     volatile uint32_t     UDPHS_EPTCFG;     // UDPHS Endpoint Config Register
     volatile uint32_t     UDPHS_EPTCTLENB;     // UDPHS Endpoint Control Enable Register
@@ -554,21 +552,21 @@ void AT91SAM9X35_UsbDevice_TxPacket(UsbClientState* usbClientState, int32_t endp
             return;
         }
     }
-    USB_PACKET64* Packet64;
+    USB_PACKET* Packet;
 
     for (;;) {
-        Packet64 = TinyCLR_UsbClient_TxDequeue(usbClientState, endpoint);
+        Packet = TinyCLR_UsbClient_TxDequeue(usbClientState, endpoint);
 
-        if (Packet64 == nullptr || Packet64->Size > 0) {
+        if (Packet == nullptr || Packet->Size > 0) {
             break;
         }
     }
 
-    if (Packet64) {
+    if (Packet) {
         int32_t i;
 
-        AT91SAM9X35_UsbDevice_WriteEndPoint(endpoint, Packet64->Buffer, Packet64->Size);
-        usbDeviceControllers[usbClientState->controllerIndex].txNeedZLPS[endpoint] = (Packet64->Size == USB_BULK_WMAXPACKETSIZE_EP_WRITE);
+        AT91SAM9X35_UsbDevice_WriteEndPoint(endpoint, Packet->Buffer, Packet->Size);
+        usbDeviceControllers[usbClientState->controllerIndex].txNeedZLPS[endpoint] = (Packet->Size == usbClientState->maxEndpointsPacketSize[endpoint]);
     }
     else {
         // send the zero leght packet since we landed on the FIFO boundary before
@@ -767,24 +765,25 @@ void AT91SAM9X35_UsbDevice_EndpointIsr(UsbClientState *usbClientState, uint32_t
 
             uint32_t len = ((Status & AT91C_UDPHS_BYTE_COUNT) >> 20) & 0x7FF;
             uint8_t *pDest = (uint8_t *)(pFifo->UDPHS_READEPT0 + 16384 * endpoint);
-            uint8_t block = len / USB_MAX_DATA_PACKET_SIZE;
-            uint8_t rest = len % USB_MAX_DATA_PACKET_SIZE;
+            uint32_t packetSize = usbClientState->maxEndpointsPacketSize[endpoint];
+            uint32_t block = len / packetSize;
+            uint32_t rest = len % packetSize;
             while (block > 0) {
-                USB_PACKET64* Packet64 = TinyCLR_UsbClient_RxEnqueue(usbClientState, endpoint, DisableRx);
+                USB_PACKET* Packet = TinyCLR_UsbClient_RxEnqueue(usbClientState, endpoint, DisableRx);
                 if (!DisableRx) {
 
-                    memcpy(&(Packet64->Buffer[0]), pDest, USB_MAX_DATA_PACKET_SIZE);
-                    Packet64->Size = USB_MAX_DATA_PACKET_SIZE;
-                    pDest += USB_MAX_DATA_PACKET_SIZE;
+                    memcpy(&(Packet->Buffer[0]), pDest, packetSize);
+                    Packet->Size = packetSize;
+                    pDest += packetSize;
                     block--;
                 }
             }
             if ((rest > 0) && (block == 0)) {
-                USB_PACKET64* Packet64 = TinyCLR_UsbClient_RxEnqueue(usbClientState, endpoint, DisableRx);
+                USB_PACKET* Packet = TinyCLR_UsbClient_RxEnqueue(usbClientState, endpoint, DisableRx);
                 if (!DisableRx) {
-                    memcpy(&(Packet64->Buffer[0]), pDest, rest);
+                    memcpy(&(Packet->Buffer[0]), pDest, rest);
                     pDest += rest;
-                    Packet64->Size = rest;
+                    Packet->Size = rest;
                 }
             }
 
@@ -858,6 +857,7 @@ bool AT91SAM9X35_UsbDevice_Initialize(UsbClientState *usbClientState) {
             idx = usbClientState->pipes[pipe].RxEP;
             AT91SAM9X35_UsbDevice_EndpointAttr[idx].Dir_Type = AT91C_UDPHS_EPT_TYPE_BUL_EPT;
             AT91SAM9X35_UsbDevice_EndpointAttr[idx].Dir_Type |= AT91C_UDPHS_EPT_DIR_OUT;
+            AT91SAM9X35_UsbDevice_EndpointAttr[idx].Payload = usbClientState->maxEndpointsPacketSize[idx];
             pUdp->UDPHS_IEN |= (AT91C_UDPHS_EPT_INT_0 << idx);
         }
 
@@ -865,6 +865,7 @@ bool AT91SAM9X35_UsbDevice_Initialize(UsbClientState *usbClientState) {
             idx = usbClientState->pipes[pipe].TxEP;
             AT91SAM9X35_UsbDevice_EndpointAttr[idx].Dir_Type = AT91C_UDPHS_EPT_TYPE_BUL_EPT;
             AT91SAM9X35_UsbDevice_EndpointAttr[idx].Dir_Type |= AT91C_UDPHS_EPT_DIR_IN;
+            AT91SAM9X35_UsbDevice_EndpointAttr[idx].Payload = usbClientState->maxEndpointsPacketSize[idx];
             pUdp->UDPHS_IEN |= (AT91C_UDPHS_EPT_INT_0 << idx);
         }
     }
@@ -972,6 +973,11 @@ void TinyCLR_UsbClient_InitializeConfiguration(UsbClientState *usbClientState) {
     AT91SAM9X35_UsbDevice_InitializeConfiguration(usbClientState);
 }
 
+// Bulk endpoints are limited to 64 bytes as the UDPHS is set to full speed
+#if AT91SAM9X35_USB_ENDPOINT_SIZE > 64
+#error "AT91SAM9X35_USB_ENDPOINT_SIZE can't be larger than 64 at full speed"
+#endif
+
 uint32_t TinyCLR_UsbClient_GetEndpointSize(int32_t endpoint) {
     return endpoint == 0 ? AT91SAM9X35_USB_ENDPOINT0_SIZE : AT91SAM9X35_USB_ENDPOINT_SIZE;
 }
@@ -61,6 +61,11 @@ TinyCLR_Result LPC17_Can_ClearReadBuffer(const TinyCLR_Can_Controller* self);
 TinyCLR_Result LPC17_Can_IsWritingAllowed(const TinyCLR_Can_Controller* self, bool& allowed);
 size_t LPC17_Can_GetWriteErrorCount(const TinyCLR_Can_Controller* self);
 size_t LPC17_Can_GetReadErrorCount(const TinyCLR_Can_Controller* self);
+struct CanStatistics;
+TinyCLR_Result LPC17_Can_GetStatistics(const TinyCLR_Can_Controller* self, CanStatistics& statistics);
+TinyCLR_Result LPC17_Can_ResetStatistics(const TinyCLR_Can_Controller* self);
+typedef bool(*LPC17_Can_FrameHandler)(const TinyCLR_Can_Message& message, uint64_t timestamp, void* context);
+TinyCLR_Result LPC17_Can_SetFrameHandler(const TinyCLR_Can_Controller* self, LPC17_Can_FrameHandler handler, void* context);
 uint32_t LPC17_Can_GetSourceClock(const TinyCLR_Can_Controller* self);
 TinyCLR_Result LPC17_Can_SetReadBufferSize(const TinyCLR_Can_Controller* self, size_t size);
 size_t LPC17_Can_GetReadBufferSize(const TinyCLR_Can_Controller* self);
@@ -401,14 +406,14 @@ const TinyCLR_Api_Info* LPC17_UsbDevice_GetRequiredApi();
 void LPC17_UsbDevice_AddApi(const TinyCLR_Api_Manager* apiManager);
 void LPC17_UsbDevice_Reset();
 
-struct USB_PACKET64;
+struct USB_PACKET;
 struct UsbClientState;
 typedef void(*USB_NEXT_CALLBACK)(UsbClientState*);
 
 void TinyCLR_UsbClient_ClearEvent(UsbClientState *usbClientState, uint32_t event);
 void TinyCLR_UsbClient_ClearEndpoints(UsbClientState *usbClientState, int32_t endpoint);
-USB_PACKET64* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx);
-USB_PACKET64* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint);
+USB_PACKET* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx);
+USB_PACKET* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint);
 void TinyCLR_UsbClient_StateCallback(UsbClientState* usbClientState);
 uint8_t TinyCLR_UsbClient_ControlCallback(UsbClientState* usbClientState);
 bool TinyCLR_UsbClient_Initialize(UsbClientState* usbClientState);
@@ -425,7 +430,17 @@ TinyCLR_Result LPC17_Display_GetCapabilities(const TinyCLR_Display_Controller* s
 TinyCLR_Result LPC17_Display_GetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat& dataFormat, uint32_t& width, uint32_t& height, void* configuration);
 TinyCLR_Result LPC17_Display_SetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat dataFormat, uint32_t width, uint32_t height, const void* configuration);
 TinyCLR_Result LPC17_Display_DrawBuffer(const TinyCLR_Display_Controller* self, int32_t x, int32_t y, int32_t width, int32_t height, const uint8_t* data);
+struct DisplayRegion_Rectangle;
+TinyCLR_Result LPC17_Display_DrawBufferRegions(const TinyCLR_Display_Controller* self, const uint8_t* data, const DisplayRegion_Rectangle* rectangles, size_t count);
+typedef void(*LPC17_Display_FlipHandler)(void* context);
+TinyCLR_Result LPC17_Display_SetDoubleBuffering(const TinyCLR_Display_Controller* self, bool enable);
+TinyCLR_Result LPC17_Display_Flip(const TinyCLR_Display_Controller* self);
+TinyCLR_Result LPC17_Display_SetFlipHandler(const TinyCLR_Display_Controller* self, LPC17_Display_FlipHandler handler, void* context);
 TinyCLR_Result LPC17_Display_DrawPixel(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint64_t color);
+TinyCLR_Result LPC17_Display_SetOrientation(const TinyCLR_Display_Controller* self, uint32_t orientation);
+int32_t LPC17_Display_GetOrientation();
+uint32_t* LPC17_Display_GetFrameBuffer();
+void LPC17_Display_WaitForCompletion();
 TinyCLR_Result LPC17_Display_WriteString(const TinyCLR_Display_Controller* self, const char* buffer, size_t length);
 
 //Startup
@@ -17,6 +17,8 @@
 #include <algorithm>
 #include <string.h>
 #include "LPC17.h"
+#include "../../Drivers/CanStatistics/CanStatistics.h"
+#include "../../Drivers/CanFilter/CanFilter.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -30,6 +32,11 @@ static const uint32_t canDefaultBuffersSize[] = LPC17_CAN_BUFFER_DEFAULT_SIZE;
 
 #define CAN_TRANSFER_TIMEOUT 0xFFFF
 
+// 0.8us resolution, about 214s from the buffer epoch
+#ifndef LPC17_CAN_TIMESTAMP_SHIFT
+#define LPC17_CAN_TIMESTAMP_SHIFT 3
+#endif
+
 #define CAN_MEM_BASE        0xE0038000
 
 /* Acceptance filter mode in AFMR register */
@@ -1988,23 +1995,30 @@ struct LPC17_Can_Filter {
     uint32_t *lowerBoundFilters;
     uint32_t *upperBoundFilters;
     uint32_t groupFiltersSize;
+
+    uint32_t standardIdBitmap[CAN_FILTER_STANDARD_ID_COUNT / 32]; // Accepted identifiers up to 0x7FF, either frame format
+
+    uint32_t *extendedIdSet; // Open addressing hash set of the explicit identifiers above 0x7FF
+    uint32_t extendedIdSetShift;
 };
 
+// Receive buffer record, 16 bytes. msgId holds the identifier and the frame flags, timeStamp holds
+// the length and the time since the buffer epoch in units of 2^LPC17_CAN_TIMESTAMP_SHIFT ticks.
 typedef struct {
-    uint32_t timeStampL;
-    uint32_t timeStampH;
-
     uint32_t msgId;
+    uint32_t timeStamp;
 
-    bool extendedId;
-    bool remoteTransmissionRequest;
+    uint32_t dataA;	// CAN Message Data Bytes 0-3
+    uint32_t dataB;	// CAN Message Data Bytes 4-7
 
-    uint32_t dataA;
-    uint32_t dataB;
+} LPC17_Can_Message;
 
-    int32_t length;
+#define CAN_MESSAGE_ID_MASK 0x1FFFFFFF
+#define CAN_MESSAGE_EXTENDED_ID 0x20000000
+#define CAN_MESSAGE_REMOTE_TRANSMISSION_REQUEST 0x40000000
 
-} LPC17_Can_Message;
+#define CAN_MESSAGE_TIMESTAMP_MASK 0x0FFFFFFF
+#define CAN_MESSAGE_LENGTH_SHIFT 28
 
 struct CanState {
     int32_t controllerIndex;
@@ -2020,6 +2034,13 @@ struct CanState {
     int32_t rxIn;
     int32_t rxOut;
 
+    uint64_t rxEpoch;
+
+    CanStatistics statistics;
+
+    LPC17_Can_FrameHandler frameHandler;
+    void* frameHandlerContext;
+
     size_t rxBufferSize;
     size_t txBufferSize;
 
@@ -2049,6 +2070,20 @@ static const LPC17_Gpio_Pin canPins[][2] = LPC17_CAN_PINS;
 
 static CanState canStates[TOTAL_CAN_CONTROLLERS];
 
+// The epoch restarts whenever the receive buffer is empty. A frame left unread for longer than the
+// delta can express is given the largest delta.
+static uint32_t LPC17_Can_RxTimeStamp(CanState* state, uint64_t t, uint32_t length) {
+    if (state->rxCount == 0)
+        state->rxEpoch = t;
+
+    auto delta = (t - state->rxEpoch) >> LPC17_CAN_TIMESTAMP_SHIFT;
+
+    if (delta > CAN_MESSAGE_TIMESTAMP_MASK)
+        delta = CAN_MESSAGE_TIMESTAMP_MASK;
+
+    return (uint32_t)delta | ((length & 0x0F) << CAN_MESSAGE_LENGTH_SHIFT);
+}
+
 static TinyCLR_Can_Controller canControllers[TOTAL_CAN_CONTROLLERS];
 static TinyCLR_Api_Info canApi[TOTAL_CAN_CONTROLLERS];
 
@@ -2067,6 +2102,12 @@ void CAN_DisableExplicitFilters(int32_t controllerIndex) {
 
         state->canDataFilter.matchFiltersSize = 0;
     }
+
+    if (state->canDataFilter.extendedIdSet != nullptr) {
+        memoryProvider->Free(memoryProvider, state->canDataFilter.extendedIdSet);
+
+        state->canDataFilter.extendedIdSet = nullptr;
+    }
 }
 
 void CAN_DisableGroupFilters(int32_t controllerIndex) {
@@ -2240,6 +2281,17 @@ int32_t BinarySearch2(uint32_t *lowerBounds, uint32_t *upperBounds, int32_t firs
     return -1;    // failed to find key
 }
 
+// Filters are compiled when they are set, see CanFilter_BuildStandardIdBitmap
+static bool CAN_IsIdAccepted(const LPC17_Can_Filter& filter, uint32_t id) {
+    if (id < CAN_FILTER_STANDARD_ID_COUNT)
+        return CanFilter_IsInStandardIdBitmap(filter.standardIdBitmap, id);
+
+    if (CanFilter_IsInExtendedIdSet(filter.extendedIdSet, filter.extendedIdSetShift, id))
+        return true;
+
+    return filter.groupFiltersSize && BinarySearch2(filter.lowerBoundFilters, filter.upperBoundFilters, 0, filter.groupFiltersSize - 1, id) >= 0;
+}
+
 const char* canApiNames[] = {
 #if TOTAL_CAN_CONTROLLERS > 0
 "GHIElectronics.TinyCLR.NativeApis.LPC17.CanController\\0",
@@ -2292,12 +2344,33 @@ void LPC17_Can_AddApi(const TinyCLR_Api_Manager* apiManager) {
 }
 
 
+static CanStatistics_ErrorState LPC17_Can_GetErrorState(int32_t controllerIndex) {
+    uint32_t status = (controllerIndex == 0) ? C1GSR : C2GSR;
+
+    if (status & (1 << 7))
+        return CanStatistics_ErrorState::BusOff;
+
+    if (((status >> 16) & 0xFF) > 127 || (status >> 24) > 127)
+        return CanStatistics_ErrorState::Passive;
+
+    if (status & (1 << 6))
+        return CanStatistics_ErrorState::Warning;
+
+    return CanStatistics_ErrorState::Active;
+}
+
 bool LPC17_Can_ErrorHandler(uint8_t controllerIndex) {
     auto state = &canStates[controllerIndex];
 
     bool error = false;
 
     uint32_t c = (controllerIndex == 0) ? CAN1ICR : CAN2ICR;
+
+    CanStatistics_SetErrorState(state->statistics, LPC17_Time_GetSystemTime(nullptr), LPC17_Can_GetErrorState(controllerIndex));
+
+    if (c & (1 << 6))
+        state->statistics.ArbitrationLost++;
+
     if (c & (1 << 3)) {
         state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::Overrun;
         error = true;
@@ -2334,41 +2407,66 @@ void CAN_ISR_Rx(int32_t controllerIndex) {
 
     bool error = LPC17_Can_ErrorHandler(controllerIndex);
 
+    // timestamp
+    t = LPC17_Time_GetSystemTime(nullptr);
+
+    uint32_t frameStatus = controllerIndex == 0 ? C1RFS : C2RFS;
+
+    state->statistics.ReceivedFrames++;
+
+    CanStatistics_AddFrame(state->statistics, t, (frameStatus & 0x80000000) != 0, (frameStatus & 0x40000000) != 0, (frameStatus >> 16) & 0x0F);
+
     // filter
     if (state->canDataFilter.groupFiltersSize || state->canDataFilter.matchFiltersSize) {
         uint32_t ID = controllerIndex == 0 ? C1RID : C2RID;
 
-        char passed = 0;
+        if (!CAN_IsIdAccepted(state->canDataFilter, ID)) {
+            state->statistics.FilteredFrames++;
 
-        if (state->canDataFilter.groupFiltersSize) {
-            if (BinarySearch2(state->canDataFilter.lowerBoundFilters, state->canDataFilter.upperBoundFilters, 0, state->canDataFilter.groupFiltersSize - 1, ID) >= 0)
-                passed = 1;
+            if (controllerIndex == 0)
+                C1CMR = 0x04; // release receive buffer
+            else
+                C2CMR = 0x04; // release receive buffer
+            return;
         }
+    }
 
-        if (!passed && state->canDataFilter.matchFiltersSize) {
-            if (BinarySearch(state->canDataFilter.matchFilters, 0, state->canDataFilter.matchFiltersSize - 1, ID) >= 0)
-                passed = 1;
-        }
+    if (state->enable && state->frameHandler != nullptr) {
+        TinyCLR_Can_Message message;
 
-        if (!passed) {
+        uint32_t* data32 = (uint32_t*)message.Data;
+
+        message.ArbitrationId = (controllerIndex == 0 ? C1RID : C2RID) & CAN_MESSAGE_ID_MASK;
+        message.IsExtendedId = (frameStatus & 0x80000000) != 0;
+        message.IsRemoteTransmissionRequest = (frameStatus & 0x40000000) != 0;
+        message.Length = (frameStatus >> 16) & 0x0F;
+        message.Timestamp = t;
+
+        data32[0] = controllerIndex == 0 ? C1RDA : C2RDA;
+        data32[1] = controllerIndex == 0 ? C1RDB : C2RDB;
+
+        if (state->frameHandler(message, t, state->frameHandlerContext)) {
             if (controllerIndex == 0)
                 C1CMR = 0x04; // release receive buffer
             else
                 C2CMR = 0x04; // release receive buffer
+
             return;
         }
     }
 
-    // timestamp
-    t = LPC17_Time_GetSystemTime(nullptr);
-
     if (state->rxCount == state->rxBufferSize) { // Return if internal buffer is full
+        state->statistics.OverflowFrames++;
+
         if (controllerIndex == 0)
             C1CMR = 0x04; // release receive buffer
         else
             C2CMR = 0x04; // release receive buffer
 
         state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::BufferFull;
+
+        // Drop the frame: the next slot is rxOut, which ReadMessage may be copying from
+        return;
     }
     else if (state->rxCount >= state->rxBufferSize - CAN_MINIMUM_MESSAGES_LEFT) { // Raise full event soon when internal buffer has only 3 availble msg left
         state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::BufferFull;
@@ -2384,9 +2482,6 @@ void CAN_ISR_Rx(int32_t controllerIndex) {
     // initialize destination pointer
     can_msg = &state->canRxMessagesFifo[state->rxIn++];
 
-    can_msg->timeStampL = t & 0xFFFFFFFF;
-    can_msg->timeStampH = t >> 32;
-
     uint32_t flag;
     uint32_t dataA;
     uint32_t dataB;
@@ -2407,15 +2502,11 @@ void CAN_ISR_Rx(int32_t controllerIndex) {
         C2CMR = 0x04; // release receive buffer
     }
 
-    can_msg->length = (flag >> 16) & 0x0F;
-
-    can_msg->extendedId = ((flag & 0x80000000) != 0) ? true : false;
+    can_msg->msgId = (msgId & CAN_MESSAGE_ID_MASK) | ((flag & 0x80000000) ? CAN_MESSAGE_EXTENDED_ID : 0) | ((flag & 0x40000000) ? CAN_MESSAGE_REMOTE_TRANSMISSION_REQUEST : 0);
 
-    can_msg->remoteTransmissionRequest = ((flag & 0x40000000) != 0) ? true : false;
+    can_msg->timeStamp = LPC17_Can_RxTimeStamp(state, t, (flag >> 16) & 0x0F);
 
-    can_msg->msgId = msgId; // ID
-
-    if (can_msg->remoteTransmissionRequest) {
+    if (flag & 0x40000000) {
         can_msg->dataA = 0x00000000;
         can_msg->dataB = 0x00000000;
     }
@@ -2424,9 +2515,7 @@ void CAN_ISR_Rx(int32_t controllerIndex) {
         can_msg->dataB = dataB; // Data B
     }
 
-    if (state->rxCount < state->rxBufferSize) {
-        state->rxCount++;        
-    }
+    state->rxCount++;
 
     if (state->rxIn == state->rxBufferSize) {
         state->rxIn = 0;
@@ -2451,13 +2540,20 @@ void LPC17_Can_RxInterruptHandler(void *param) {
 
     uint32_t status = CANRxSR;
 
+    // Error and arbitration lost interrupts can come without a frame, reading ICR acknowledges them
     if (status & (1 << 8)) {
         CAN_ISR_Rx(0);
     }
+    else if (canStates[0].enable) {
+        LPC17_Can_ErrorHandler(0);
+    }
 
     if (status & (1 << 9)) {
         CAN_ISR_Rx(1);
     }
+    else if (canStates[1].enable) {
+        LPC17_Can_ErrorHandler(1);
+    }
 }
 
 TinyCLR_Result LPC17_Can_Acquire(const TinyCLR_Can_Controller* self) {
@@ -2495,6 +2591,9 @@ TinyCLR_Result LPC17_Can_Acquire(const TinyCLR_Can_Controller* self) {
         state->lastEventRxBufferCount = 0;
         state->errorEvent = 0;
 
+        CanStatistics_Reset(state->statistics, LPC17_Time_GetSystemTime(nullptr));
+
+        state->frameHandler = nullptr;
         state->errorEventHandler = nullptr;
         state->messageReceivedEventHandler = nullptr;
 
@@ -2544,10 +2643,15 @@ TinyCLR_Result LPC17_Can_Release(const TinyCLR_Can_Controller* self) {
     return TinyCLR_Result::Success;
 }
 
-TinyCLR_Result LPC17_Can_WriteMessage(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& len) {
-    if (len != 1) return TinyCLR_Result::NotSupported;
+static void LPC17_Can_CountTransmit(CanState* state, const TinyCLR_Can_Message& m) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    state->statistics.TransmittedFrames++;
 
-    auto& m = messages[0];
+    CanStatistics_AddFrame(state->statistics, LPC17_Time_GetSystemTime(nullptr), m.IsExtendedId, m.IsRemoteTransmissionRequest, m.Length);
+}
+
+static TinyCLR_Result LPC17_Can_WriteSingleMessage(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message& m) {
     uint32_t arbitrationId = m.ArbitrationId;
     bool isExtendedId = m.IsExtendedId;
     bool isRemoteTransmissionRequest = m.IsRemoteTransmissionRequest;
@@ -2572,6 +2676,11 @@ TinyCLR_Result LPC17_Can_WriteMessage(const TinyCLR_Can_Controller* self, const
 
     flags |= (length & 0x0F) << 16;
 
+    // With interrupts disabled, as in the receive interrupt frame handler hook, waiting for the transmit
+    // buffer would hold every other interrupt for up to a frame time. Report Busy and let the caller retry.
+    if (LPC17_Interrupt_IsDisabled() && LPC17_Can_CanWriteMessage(self) == false)
+        return TinyCLR_Result::Busy;
+
     uint32_t timeout = CAN_TRANSFER_TIMEOUT;
 
     while (LPC17_Can_CanWriteMessage(self) == false && timeout-- > 0) {
@@ -2592,6 +2701,8 @@ TinyCLR_Result LPC17_Can_WriteMessage(const TinyCLR_Can_Controller* self, const
 
             C1CMR = 0x21;
 
+            LPC17_Can_CountTransmit(state, m);
+
             return TinyCLR_Result::Success;
         }
     }
@@ -2606,6 +2717,8 @@ TinyCLR_Result LPC17_Can_WriteMessage(const TinyCLR_Can_Controller* self, const
 
             C2CMR = 0x21;
 
+            LPC17_Can_CountTransmit(state, m);
+
             return TinyCLR_Result::Success;
         }
     }
@@ -2613,50 +2726,71 @@ TinyCLR_Result LPC17_Can_WriteMessage(const TinyCLR_Can_Controller* self, const
     return TinyCLR_Result::Busy;
 }
 
-TinyCLR_Result LPC17_Can_ReadMessage(const TinyCLR_Can_Controller* self, TinyCLR_Can_Message* messages, size_t& len) {
-    if (len != 1) return TinyCLR_Result::NotSupported;
+TinyCLR_Result LPC17_Can_WriteMessage(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& len) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
 
-    auto& m = messages[0];
-    uint32_t& arbitrationId = m.ArbitrationId;
-    bool& isExtendedId = m.IsExtendedId;
-    bool& isRemoteTransmissionRequest = m.IsRemoteTransmissionRequest;
-    uint8_t* data = m.Data;
-    size_t& length = m.Length;
-    uint64_t& timestamp = m.Timestamp;
+    if (!state->enable) return TinyCLR_Result::InvalidOperation;
 
-    LPC17_Can_Message *can_msg;
+    auto result = TinyCLR_Result::Success;
+    size_t sent = 0;
 
-    uint32_t *data32 = (uint32_t*)data;
+    while (sent < len) {
+        result = LPC17_Can_WriteSingleMessage(self, messages[sent]);
 
+        if (result != TinyCLR_Result::Success)
+            break;
+
+        sent++;
+    }
+
+    len = sent;
+
+    return sent > 0 ? TinyCLR_Result::Success : result;
+}
+
+TinyCLR_Result LPC17_Can_ReadMessage(const TinyCLR_Can_Controller* self, TinyCLR_Can_Message* messages, size_t& len) {
     auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
 
     if (!state->enable) return TinyCLR_Result::InvalidOperation;
 
-    if (state->rxCount) {
+    LPC17_Can_Message *can_msg;
+
+    // Only the rx interrupt moves rxIn and it drops frames instead of storing into a full buffer, so it
+    // never writes the slots counted here. They can be copied with interrupts enabled and handed back
+    // to the fifo with a single update of rxCount.
+    size_t available = state->rxCount;
+    size_t read = len < available ? len : available;
+
+    for (size_t i = 0; i < read; i++) {
+        auto& m = messages[i];
+
+        uint32_t* data32 = (uint32_t*)m.Data;
 
         can_msg = &state->canRxMessagesFifo[state->rxOut++];
 
         if (state->rxOut == state->rxBufferSize)
             state->rxOut = 0;
 
-        arbitrationId = can_msg->msgId;
-        isExtendedId = can_msg->extendedId;
-        isRemoteTransmissionRequest = can_msg->remoteTransmissionRequest;
+        m.ArbitrationId = can_msg->msgId & CAN_MESSAGE_ID_MASK;
+        m.IsExtendedId = (can_msg->msgId & CAN_MESSAGE_EXTENDED_ID) != 0;
+        m.IsRemoteTransmissionRequest = (can_msg->msgId & CAN_MESSAGE_REMOTE_TRANSMISSION_REQUEST) != 0;
+        m.Length = can_msg->timeStamp >> CAN_MESSAGE_LENGTH_SHIFT;
 
         data32[0] = can_msg->dataA;
         data32[1] = can_msg->dataB;
 
-        length = can_msg->length;
-
-        timestamp = ((uint64_t)can_msg->timeStampL) | ((uint64_t)can_msg->timeStampH << 32);
+        // The epoch only moves when the buffer is empty, so it is stable while these are unread
+        m.Timestamp = state->rxEpoch + ((uint64_t)(can_msg->timeStamp & CAN_MESSAGE_TIMESTAMP_MASK) << LPC17_CAN_TIMESTAMP_SHIFT);
+    }
 
-        {
-            DISABLE_INTERRUPTS_SCOPED(irq);
+    if (read > 0) {
+        DISABLE_INTERRUPTS_SCOPED(irq);
 
-            state->rxCount--;                        
-        }
+        state->rxCount -= read;
     }
 
+    len = read;
+
     return TinyCLR_Result::Success;
 }
 
@@ -2671,6 +2805,8 @@ TinyCLR_Result LPC17_Can_SetBitTiming(const TinyCLR_Can_Controller* self, const
 
     state->baudrate = (useMultiBitSampling << 23) | (phase2 << 20) | (phase1 << 16) | (synchronizationJumpWidth << 14) | (baudratePrescaler << 0);
 
+    CanStatistics_SetBitTiming(state->statistics, LPC17_Can_GetSourceClock(self), timing);
+
     return TinyCLR_Result::Success;
 }
 
@@ -2791,16 +2927,34 @@ TinyCLR_Result LPC17_Can_SetExplicitFilters(const TinyCLR_Can_Controller* self,
 
     std::sort(_matchFilters, _matchFilters + count);
 
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+    auto controllerIndex = state->controllerIndex;
+
+    uint32_t *extendedIdSet;
+    uint32_t extendedIdSetShift;
+
+    if (CanFilter_BuildExtendedIdSet(memoryProvider, _matchFilters, count, extendedIdSet, extendedIdSetShift) != TinyCLR_Result::Success) {
+        memoryProvider->Free(memoryProvider, _matchFilters);
+
+        return TinyCLR_Result::OutOfMemory;
+    }
+
+    uint32_t standardIdBitmap[CAN_FILTER_STANDARD_ID_COUNT / 32];
+
+    CanFilter_BuildStandardIdBitmap(standardIdBitmap, _matchFilters, count, state->canDataFilter.lowerBoundFilters, state->canDataFilter.upperBoundFilters, state->canDataFilter.groupFiltersSize);
+
     {
         DISABLE_INTERRUPTS_SCOPED(irq);
 
-        auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
-        auto controllerIndex = state->controllerIndex;
-
         CAN_DisableExplicitFilters(controllerIndex);
 
         state->canDataFilter.matchFiltersSize = count;
         state->canDataFilter.matchFilters = _matchFilters;
+
+        state->canDataFilter.extendedIdSet = extendedIdSet;
+        state->canDataFilter.extendedIdSetShift = extendedIdSetShift;
+
+        memcpy(state->canDataFilter.standardIdBitmap, standardIdBitmap, sizeof(standardIdBitmap));
     }
 
     return TinyCLR_Result::Success;
@@ -2837,17 +2991,23 @@ TinyCLR_Result LPC17_Can_SetGroupFilters(const TinyCLR_Can_Controller* self, con
         return TinyCLR_Result::ArgumentInvalid;
     }
 
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+    auto controllerIndex = state->controllerIndex;
+
+    uint32_t standardIdBitmap[CAN_FILTER_STANDARD_ID_COUNT / 32];
+
+    CanFilter_BuildStandardIdBitmap(standardIdBitmap, state->canDataFilter.matchFilters, state->canDataFilter.matchFiltersSize, _lowerBoundFilters, _upperBoundFilters, count);
+
     {
         DISABLE_INTERRUPTS_SCOPED(irq);
 
-        auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
-        auto controllerIndex = state->controllerIndex;
-
         CAN_DisableGroupFilters(controllerIndex);
 
         state->canDataFilter.groupFiltersSize = count;
         state->canDataFilter.lowerBoundFilters = _lowerBoundFilters;
         state->canDataFilter.upperBoundFilters = _upperBoundFilters;
+
+        memcpy(state->canDataFilter.standardIdBitmap, standardIdBitmap, sizeof(standardIdBitmap));
     }
 
     return TinyCLR_Result::Success;
@@ -2878,6 +3038,45 @@ size_t LPC17_Can_GetWriteErrorCount(const TinyCLR_Can_Controller* self) {
     return controllerIndex == 0 ? (C1GSR >> 24) : (C2GSR >> 24);
 }
 
+TinyCLR_Result LPC17_Can_GetStatistics(const TinyCLR_Can_Controller* self, CanStatistics& statistics) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    auto now = LPC17_Time_GetSystemTime(nullptr);
+
+    if (state->enable)
+        CanStatistics_SetErrorState(state->statistics, now, LPC17_Can_GetErrorState(state->controllerIndex));
+
+    CanStatistics_Update(state->statistics, now);
+
+    statistics = state->statistics;
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result LPC17_Can_ResetStatistics(const TinyCLR_Can_Controller* self) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    CanStatistics_Reset(state->statistics, LPC17_Time_GetSystemTime(nullptr));
+
+    return TinyCLR_Result::Success;
+}
+
+// Frames the handler accepts are consumed in the receive interrupt and never reach the read buffer
+TinyCLR_Result LPC17_Can_SetFrameHandler(const TinyCLR_Can_Controller* self, LPC17_Can_FrameHandler handler, void* context) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    state->frameHandler = handler;
+    state->frameHandlerContext = context;
+
+    return TinyCLR_Result::Success;
+}
+
 uint32_t LPC17_Can_GetSourceClock(const TinyCLR_Can_Controller* self) {
     return LPC17_AHB_CLOCK_HZ / 2;
 }
@@ -2969,7 +3168,7 @@ TinyCLR_Result LPC17_Can_Enable(const TinyCLR_Can_Controller* self) {
             C1GSR = 0;    // Reset error counter when CANxMOD is in reset
             C1BTR = state->baudrate;
             C1MOD = 0x4;    // CAN in normal operation mode
-            C1IER = 0x01 | (1 << 7) | (1 << 3) | (1 << 5);    // Enable receive interrupts
+            C1IER = 0x01 | (1 << 7) | (1 << 3) | (1 << 5) | (1 << 6);    // Enable receive, error and arbitration lost interrupts
         }
         else {
             SYSCON.PCLKSEL0 |= (1 << 28) | (1 << 30);//CAN1 CAN2 filter
@@ -2979,7 +3178,7 @@ TinyCLR_Result LPC17_Can_Enable(const TinyCLR_Can_Controller* self) {
             C2GSR = 0;    // Reset error counter when CANxMOD is in reset
             C2BTR = state->baudrate;
             C2MOD = 0x0;    // CAN in normal operation mode
-            C2IER = 0x01 | (1 << 3) | (1 << 5) | (1 << 7);        // Enable receive interrupts
+            C2IER = 0x01 | (1 << 3) | (1 << 5) | (1 << 7) | (1 << 6);        // Enable receive, error and arbitration lost interrupts
         }
 
         LPC17_InterruptInternal_Activate(CAN_IRQn, (uint32_t*)&LPC17_Can_RxInterruptHandler, 0);
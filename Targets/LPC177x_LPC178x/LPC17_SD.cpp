@@ -256,6 +256,17 @@ uint64_t sdTimeoutTicks = SDCARD_DEFAULT_TIMEOUT_IN_SYSTEM_TICKS;
 #define DMA_MCIFIFO        0x400C0080
 #define DMA_SIZE        BLOCK_LENGTH
 
+// Memory the GPDMA can reach directly: main SRAM, peripheral SRAM and EMC (external SDRAM/SRAM)
+#define DMA_MAIN_SRAM_START         0x10000000
+#define DMA_MAIN_SRAM_END           0x10010000
+#define DMA_PERIPHERAL_SRAM_START   0x20000000
+#define DMA_PERIPHERAL_SRAM_END     0x20008000
+#define DMA_EMC_START               0x80000000
+#define DMA_EMC_END                 0xE0000000
+
+// MCI data length register is 16 bits
+#define MCI_MAX_TRANSFER_BLOCKS     64
+
 /* DMA mode */
 #define M2M                0x00
 #define M2P                0x01
@@ -300,6 +311,29 @@ uint64_t sdTimeoutTicks = SDCARD_DEFAULT_TIMEOUT_IN_SYSTEM_TICKS;
 #define GPDMA_Control_Register_Channel(ChannelNumber)            (*(volatile unsigned long *)(DMA_BASE_ADDR + 0x10C + (ChannelNumber * 0x20)))
 #define GPDMA_Config_Register_Channel(ChannelNumber)            (*(volatile unsigned long *)(DMA_BASE_ADDR + 0x110 + (ChannelNumber * 0x20)))
 
+/******************************************************************************
+** Function name:        DMA_IsCapable
+**
+** Descriptions:        Check whether a buffer can be used as GPDMA memory
+**                        side directly: word aligned and entirely inside a
+**                        region the GPDMA master can access.
+**
+** parameters:            Buffer address, length in bytes
+** Returned value:        true or false
+**
+******************************************************************************/
+bool DMA_IsCapable(const uint8_t* buffer, uint32_t length) {
+    auto start = reinterpret_cast<uint32_t>(buffer);
+    auto end = start + length;
+
+    if ((start & 0x3) != 0 || end < start)
+        return false;
+
+    return (start >= DMA_MAIN_SRAM_START && end <= DMA_MAIN_SRAM_END)
+        || (start >= DMA_PERIPHERAL_SRAM_START && end <= DMA_PERIPHERAL_SRAM_END)
+        || (start >= DMA_EMC_START && end <= DMA_EMC_END);
+}
+
 /******************************************************************************
 ** Function name:        DMAHandler
 **
@@ -356,11 +390,11 @@ void DMA_Init(void) {
 **                        including mode, M2P or M2M, or P2M,
 **                        src and dest. address, control reg. etc.
 **
-** parameters:            Channel number, DMA mode
+** parameters:            Channel number, DMA mode, memory address for M2P/P2M
 ** Returned value:        true or false
 **
 ******************************************************************************/
-uint32_t DMA_Move(uint32_t ChannelNum, uint32_t DMAMode) {
+uint32_t DMA_Move(uint32_t ChannelNum, uint32_t DMAMode, uint32_t MemoryAddress) {
 
     GPDMA_INT_TCCLR = 0xFF;
     GPDMA_INT_ERR_CLR = 0xFF;
@@ -379,7 +413,7 @@ uint32_t DMA_Move(uint32_t ChannelNum, uint32_t DMAMode) {
             (DMA_SIZE & 0x0FFF);
     }
     else if (DMAMode == M2P) {
-        GPDMA_Source_Register_Channel(ChannelNum) = DMA_SRC;
+        GPDMA_Source_Register_Channel(ChannelNum) = MemoryAddress;
         GPDMA_Destination_Register_Channel(ChannelNum) = DMA_MCIFIFO;
 
         GPDMA_Control_Register_Channel(ChannelNum) = (0x80000000) |
@@ -400,7 +434,7 @@ uint32_t DMA_Move(uint32_t ChannelNum, uint32_t DMAMode) {
     else if (DMAMode == P2M) {
 
         GPDMA_Source_Register_Channel(ChannelNum) = DMA_MCIFIFO;
-        GPDMA_Destination_Register_Channel(ChannelNum) = DMA_DST;
+        GPDMA_Destination_Register_Channel(ChannelNum) = MemoryAddress;
 
         GPDMA_Control_Register_Channel(ChannelNum) = (0x80000000) |
             (0x01 << 27) |
@@ -451,7 +485,9 @@ uint32_t DMA_Move(uint32_t ChannelNum, uint32_t DMAMode) {
 #define SEND_STATUS            13        /* SEND_STATUS */
 #define SET_BLOCK_LEN        16        /* SET_BLOCK_LEN */
 #define READ_SINGLE_BLOCK    17        /* READ_SINGLE_BLOCK */
+#define READ_MULTIPLE_BLOCK    18        /* READ_MULTIPLE_BLOCK */
 #define WRITE_BLOCK            24        /* WRITE_BLOCK */
+#define WRITE_MULTIPLE_BLOCK    25        /* WRITE_MULTIPLE_BLOCK */
 #define SEND_APP_OP_COND    41        /* ACMD41 for SD card */
 #define APP_CMD                55        /* APP_CMD, the following will a ACMD */
 
@@ -559,13 +595,13 @@ extern bool MCI_Send_Stop(void);
 
 typedef void(*MCI_DATA_END_CALLBACK)();
 
-extern bool MCI_Write_Block(uint32_t blockNum, MCI_DATA_END_CALLBACK MCI_DATA_END_Callback);
-extern bool MCI_Read_Block(uint32_t blockNum, MCI_DATA_END_CALLBACK MCI_DATA_END_Callback);
+extern bool MCI_Write_Block(uint32_t blockNum, uint32_t blockCount, const uint8_t *buffer, MCI_DATA_END_CALLBACK MCI_DATA_END_Callback);
+extern bool MCI_Read_Block(uint32_t blockNum, uint32_t blockCount, uint8_t *buffer, MCI_DATA_END_CALLBACK MCI_DATA_END_Callback);
 
 bool MCI_And_Card_initialize();
 
-bool MCI_ReadSector(uint32_t sector, uint8_t *readbuffer);
-bool MCI_WriteSector(uint32_t sector, uint8_t *writebuffer);
+bool MCI_ReadSectors(uint32_t sector, uint32_t count, uint8_t *readbuffer);
+bool MCI_WriteSectors(uint32_t sector, uint32_t count, const uint8_t *writebuffer);
 
 uint64_t sdMediaSize = 0;
 uint32_t sdSectorsPerBlock = 0;
@@ -623,6 +659,7 @@ volatile uint32_t DataStartbitErrCount = 0;
 volatile uint32_t DataEndCount = 0;
 volatile uint32_t DataBlockEndCount = 0;
 volatile uint32_t MCI_Block_End_Flag = 0;
+volatile uint32_t MCI_Blocks_Remaining = 0;
 
 volatile uint32_t DataTxActiveCount = 0;
 volatile uint32_t DataRxActiveCount = 0;
@@ -836,6 +873,13 @@ void MCI_DATA_END_InterruptService(void) {
     if (MCIStatus &  MCI_DATA_BLK_END) {
         DataBlockEndCount++;
         MCI_CLEAR = MCI_DATA_BLK_END;
+
+        if (MCI_Blocks_Remaining > 1) {
+            MCI_Blocks_Remaining--;
+            return;
+        }
+
+        MCI_Blocks_Remaining = 0;
         MCI_TXDisable();
         if (MCI_DATA_END_Callback) {
             MCI_DATA_END_Callback_temp = MCI_DATA_END_Callback;
@@ -1759,17 +1803,19 @@ bool MCI_Send_Stop(void) {
 /******************************************************************************
 ** Function name:        MCI_Send_Write_Block
 **
-** Descriptions:        CMD24, WRITE_BLOCK, send this cmd in the TRANS state
-**                        to write a block of data to the card.
+** Descriptions:        CMD24, WRITE_BLOCK, or CMD25, WRITE_MULTIPLE_BLOCK,
+**                        send this cmd in the TRANS state to write one or
+**                        more blocks of data to the card.
 **
-** parameters:            block number
+** parameters:            block number, block count
 ** Returned value:        Response value
 **
 ******************************************************************************/
-uint32_t MCI_Send_Write_Block(uint32_t blockNum) {
+uint32_t MCI_Send_Write_Block(uint32_t blockNum, uint32_t blockCount) {
     uint32_t i, retryCount;
     uint32_t respStatus;
     uint32_t respValue[4];
+    uint32_t cmdIndex = blockCount > 1 ? WRITE_MULTIPLE_BLOCK : WRITE_BLOCK;
 
     if (!isSDHC)
         blockNum *= BLOCK_LENGTH;
@@ -1777,8 +1823,8 @@ uint32_t MCI_Send_Write_Block(uint32_t blockNum) {
     retryCount = 0x20;
     while (retryCount > 0) {
         MCI_CLEAR = 0x7FF;
-        MCI_SendCmd(WRITE_BLOCK, blockNum, EXPECT_SHORT_RESP, 0);
-        respStatus = MCI_GetCmdResp(WRITE_BLOCK, EXPECT_SHORT_RESP, (uint32_t *)&respValue[0]);
+        MCI_SendCmd(cmdIndex, blockNum, EXPECT_SHORT_RESP, 0);
+        respStatus = MCI_GetCmdResp(cmdIndex, EXPECT_SHORT_RESP, (uint32_t *)&respValue[0]);
         /* it should be in the transfer state, bit 9~12 is 0x0100 and bit 8 is 1 */
         if (!respStatus && ((respValue[0] & (0x0F << 8)) == 0x0900)) {
             return(true);
@@ -1794,17 +1840,19 @@ uint32_t MCI_Send_Write_Block(uint32_t blockNum) {
 /******************************************************************************
 ** Function name:        MCI_Send_Read_Block
 **
-** Descriptions:        CMD17, READ_SINGLE_BLOCK, send this cmd in the TRANS
-**                        state to read a block of data from the card.
+** Descriptions:        CMD17, READ_SINGLE_BLOCK, or CMD18, READ_MULTIPLE_BLOCK,
+**                        send this cmd in the TRANS state to read one or
+**                        more blocks of data from the card.
 **
-** parameters:            block number
+** parameters:            block number, block count
 ** Returned value:        Response value
 **
 ******************************************************************************/
-uint32_t MCI_Send_Read_Block(uint32_t blockNum) {
+uint32_t MCI_Send_Read_Block(uint32_t blockNum, uint32_t blockCount) {
     uint32_t i, retryCount;
     uint32_t respStatus;
     uint32_t respValue[4];
+    uint32_t cmdIndex = blockCount > 1 ? READ_MULTIPLE_BLOCK : READ_SINGLE_BLOCK;
 
     if (!isSDHC)
         blockNum *= BLOCK_LENGTH;
@@ -1813,8 +1861,8 @@ uint32_t MCI_Send_Read_Block(uint32_t blockNum) {
 
     while (retryCount > 0) {
         MCI_CLEAR = 0x7FF;
-        MCI_SendCmd(READ_SINGLE_BLOCK, blockNum, EXPECT_SHORT_RESP, 0);
-        respStatus = MCI_GetCmdResp(READ_SINGLE_BLOCK, EXPECT_SHORT_RESP, (uint32_t *)&respValue[0]);
+        MCI_SendCmd(cmdIndex, blockNum, EXPECT_SHORT_RESP, 0);
+        respStatus = MCI_GetCmdResp(cmdIndex, EXPECT_SHORT_RESP, (uint32_t *)&respValue[0]);
         /* it should be in the transfer state, bit 9~12 is 0x0100 and bit 8 is 1 */
         if (!respStatus && ((respValue[0] & (0x0F << 8)) == 0x0900)) {
             return(true);
@@ -1835,13 +1883,13 @@ uint32_t MCI_Send_Read_Block(uint32_t blockNum) {
 **                        interrupt will occurs, data can be written continuously
 **                        into the FIFO until the block data length is reached.
 **
-** parameters:            block number
+** parameters:            block number, block count, source buffer
 ** Returned value:        true or false, if cmd times out, return false and no
 **                        need to continue.
 **
 ******************************************************************************/
 
-bool MCI_Write_Block(uint32_t blockNum, MCI_DATA_END_CALLBACK Write_end_Callback) {
+bool MCI_Write_Block(uint32_t blockNum, uint32_t blockCount, const uint8_t *buffer, MCI_DATA_END_CALLBACK Write_end_Callback) {
     uint32_t i;
     uint32_t DataCtrl = 0;
 
@@ -1854,17 +1902,18 @@ bool MCI_Write_Block(uint32_t blockNum, MCI_DATA_END_CALLBACK Write_end_Callback
     }
 
     MCI_DATA_TMR = DATA_TIMER_VALUE;
-    MCI_DATA_LEN = BLOCK_LENGTH;
+    MCI_DATA_LEN = blockCount * BLOCK_LENGTH;
     MCI_Block_End_Flag = 1;
+    MCI_Blocks_Remaining = blockCount;
 
     MCI_DATA_END_Callback = Write_end_Callback;
 
     MCI_TXEnable();
-    if (MCI_Send_Write_Block(blockNum) == false) {
+    if (MCI_Send_Write_Block(blockNum, blockCount) == false) {
         return (false);
     }
 
-    DMA_Move(0, M2P);
+    DMA_Move(0, M2P, reinterpret_cast<uint32_t>(buffer));
 
     DataCtrl = ((1 << 0) | (1 << 3) | (DATA_BLOCK_LEN << 4));
 
@@ -1883,13 +1932,13 @@ bool MCI_Write_Block(uint32_t blockNum, MCI_DATA_END_CALLBACK Write_end_Callback
 **                        continuously into the FIFO until the block data
 **                        length is reached.
 **
-** parameters:            block number
+** parameters:            block number, block count, destination buffer
 ** Returned value:        true or false, if cmd times out, return false and no
 **                        need to continue.
 **
 **
 ******************************************************************************/
-bool MCI_Read_Block(uint32_t blockNum, MCI_DATA_END_CALLBACK read_end_Callback) {
+bool MCI_Read_Block(uint32_t blockNum, uint32_t blockCount, uint8_t *buffer, MCI_DATA_END_CALLBACK read_end_Callback) {
     uint32_t i;
     uint32_t DataCtrl = 0;
 
@@ -1904,16 +1953,17 @@ bool MCI_Read_Block(uint32_t blockNum, MCI_DATA_END_CALLBACK read_end_Callback)
     MCI_RXEnable();
 
     MCI_DATA_TMR = DATA_TIMER_VALUE;
-    MCI_DATA_LEN = BLOCK_LENGTH;
+    MCI_DATA_LEN = blockCount * BLOCK_LENGTH;
     MCI_Block_End_Flag = 1;
+    MCI_Blocks_Remaining = blockCount;
 
     MCI_DATA_END_Callback = read_end_Callback;
 
-    if (MCI_Send_Read_Block(blockNum) == false) {
+    if (MCI_Send_Read_Block(blockNum, blockCount) == false) {
         return (false);
     }
 
-    DMA_Move(0, P2M);
+    DMA_Move(0, P2M, reinterpret_cast<uint32_t>(buffer));
 
     DataCtrl = ((1 << 0) | (1 << 1) | (1 << 3) | (DATA_BLOCK_LEN << 4));
 
@@ -1990,10 +2040,15 @@ bool MCI_And_Card_initialize(void) {
 }
 
 /******************************************************************************
-** Function name:        MCI_ReadSector
+** Function name:        MCI_ReadSectors
+**
+** Descriptions:        Read one or more sectors. When the destination is
+**                        reachable by the GPDMA the sectors are moved straight
+**                        into it with a single multi block command, otherwise
+**                        each sector goes through the DMA staging buffer.
 **
-** parameters:            block number, Read Buffer
-** Returned value:        false if Succeeded
+** parameters:            block number, block count, Read Buffer
+** Returned value:        true if Succeeded
 **
 **
 ******************************************************************************/
@@ -2003,44 +2058,69 @@ void Read_end_Callback() {
     Read_Flag = 1;
 }
 
-bool MCI_ReadSector(
+static bool MCI_WaitTransferEnd(volatile uint8_t& flag, uint32_t timeout) {
+    uint32_t i = 0;
+    bool done = false;
+
+    while (i < timeout) {
+        if (flag == 1) {
+            done = true;
+            break;
+        }
+
+        i++;
+        LPC17_Time_Delay(nullptr, 1000); // timeout unit is ms;
+    }
+
+    flag = 0;
+
+    return done;
+}
+
+bool MCI_ReadSectors(
     uint32_t sector,
+    uint32_t count,
     uint8_t *buff) {
-    uint32_t i;
-    uint8_t temp;
 
-    ReadBlock = (uint8_t *)(DMA_DST);
+    if (!DMA_IsCapable(buff, count * BLOCK_LENGTH)) {
+        ReadBlock = (uint8_t *)(DMA_DST);
 
-    if (MCI_Read_Block(sector, Read_end_Callback) == false) {
-        return false; // Error
-    }
+        for (uint32_t i = 0; i < count; i++) {
+            if (MCI_Read_Block(sector + i, 1, ReadBlock, Read_end_Callback) == false)
+                return false; // Error
 
-    temp = 0;
-    i = 0;
-    while (i < READ_TIME_OUT) {
-        if (Read_Flag == 1) {
-            temp = 1;
-            break;
+            if (!MCI_WaitTransferEnd(Read_Flag, READ_TIME_OUT))
+                return false; // Error
+
+            memcpy(buff + i * BLOCK_LENGTH, ReadBlock, BLOCK_LENGTH);
         }
 
-        i++;
-        LPC17_Time_Delay(nullptr, 1000); // READ_TIME_OUT uint is ms;
+        return true;
     }
-    Read_Flag = 0;
 
-    if (temp == 0)
+    if (MCI_Read_Block(sector, count, buff, Read_end_Callback) == false) {
+        if (count > 1)
+            MCI_Send_Stop();
+
         return false; // Error
+    }
 
-    memcpy(buff, ReadBlock, BLOCK_LENGTH);
+    auto done = MCI_WaitTransferEnd(Read_Flag, READ_TIME_OUT * count);
+
+    if (count > 1 && MCI_Send_Stop() == false)
+        return false; // Error
 
-    return true;// No Error
+    return done;// No Error
 }
 
 /******************************************************************************
-** Function name:        MCI_WriteSector
+** Function name:        MCI_WriteSectors
 **
-** parameters:            block number, Write Buffer
-** Returned value:        false if Succeeded
+** Descriptions:        Write one or more sectors, taking the source straight
+**                        from the caller buffer when the GPDMA can reach it.
+**
+** parameters:            block number, block count, Write Buffer
+** Returned value:        true if Succeeded
 **
 **
 ******************************************************************************/
@@ -2051,40 +2131,41 @@ void Write_end_Callback() {
     Flag_write = 1;
 }
 
-bool MCI_WriteSector(
+bool MCI_WriteSectors(
     uint32_t sector,        /* Sector number (LBA) */
-    uint8_t *buff    /* Data to be written */) {
-    uint32_t i;
-    uint8_t temp;
+    uint32_t count,         /* Number of sectors */
+    const uint8_t *buff    /* Data to be written */) {
 
-    WriteBlock = (uint8_t *)(DMA_SRC);
-    memcpy(WriteBlock, buff, BLOCK_LENGTH);
+    if (!DMA_IsCapable(buff, count * BLOCK_LENGTH)) {
+        WriteBlock = (uint8_t *)(DMA_SRC);
 
+        for (uint32_t i = 0; i < count; i++) {
+            memcpy(WriteBlock, buff + i * BLOCK_LENGTH, BLOCK_LENGTH);
 
-    if (MCI_Write_Block(sector, Write_end_Callback) == false) {
-        /* Fatal error */
-        return false; // Error
-    }
+            if (MCI_Write_Block(sector + i, 1, WriteBlock, Write_end_Callback) == false)
+                return false; // Error
 
-    temp = 0;
-    i = 0;
-
-    while (i < WRITE_TIME_OUT) {
-        if (Flag_write == 1) {
-            temp = 1;
-            break;
+            if (!MCI_WaitTransferEnd(Flag_write, WRITE_TIME_OUT))
+                return false; // Error
         }
 
-        i++;
-        LPC17_Time_Delay(nullptr, 1000); // WRITE_TIME_OUT unit is ms = 1000*x;
+        return true;
     }
 
-    Flag_write = 0;
+    if (MCI_Write_Block(sector, count, buff, Write_end_Callback) == false) {
+        /* Fatal error */
+        if (count > 1)
+            MCI_Send_Stop();
 
-    if (temp == 0)
         return false; // Error
+    }
 
-    return true;// No Error
+    auto done = MCI_WaitTransferEnd(Flag_write, WRITE_TIME_OUT * count);
+
+    if (count > 1 && MCI_Send_Stop() == false)
+        return false; // Error
+
+    return done;// No Error
 }
 
 /************************************************************************//**
@@ -2313,13 +2394,13 @@ TinyCLR_Result LPC17_SdCard_Write(const TinyCLR_Storage_Controller* self, uint64
 
     uint64_t currentTime = LPC17_Time_GetCurrentProcessorTime();
 
-    uint8_t* pData = (uint8_t*)data;
-
     while (sectorCount) {
-        if (MCI_WriteSector(sectorNum, &pData[index]) == true) {
-            index += LPC17_SD_SECTOR_SIZE;
-            sectorNum++;
-            sectorCount--;
+        auto blocks = sectorCount > MCI_MAX_TRANSFER_BLOCKS ? MCI_MAX_TRANSFER_BLOCKS : sectorCount;
+
+        if (MCI_WriteSectors(sectorNum, blocks, &data[index]) == true) {
+            index += blocks * LPC17_SD_SECTOR_SIZE;
+            sectorNum += blocks;
+            sectorCount -= blocks;
 
             currentTime = LPC17_Time_GetCurrentProcessorTime();
         }
@@ -2345,10 +2426,12 @@ TinyCLR_Result LPC17_SdCard_Read(const TinyCLR_Storage_Controller* self, uint64_
     uint64_t currentTime = LPC17_Time_GetCurrentProcessorTime();
 
     while (sectorCount) {
-        if (MCI_ReadSector(sectorNum, &data[index]) == true) {
-            index += LPC17_SD_SECTOR_SIZE;
-            sectorNum++;
-            sectorCount--;
+        auto blocks = sectorCount > MCI_MAX_TRANSFER_BLOCKS ? MCI_MAX_TRANSFER_BLOCKS : sectorCount;
+
+        if (MCI_ReadSectors(sectorNum, blocks, &data[index]) == true) {
+            index += blocks * LPC17_SD_SECTOR_SIZE;
+            sectorNum += blocks;
+            sectorCount -= blocks;
 
             currentTime = LPC17_Time_GetCurrentProcessorTime();
         }
@@ -14,11 +14,15 @@
 // limitations under the License.
 
 #include "LPC24.h"
+#include "../../Drivers/DisplayRegion/DisplayRegion.h"
+#include "../../Drivers/DisplayRotation/DisplayRotation.h"
 
 #ifdef INCLUDE_DISPLAY
 
 #define VIDEO_RAM_SIZE              800*600*2
 
+#define LPC24_DISPLAY_BASE_UPDATE_INTERRUPT (1 << 2)
+
 #define LCD_MAX_ROW	                32
 #define LCD_MAX_COLUMN              70
 
@@ -401,6 +405,13 @@ uint16_t* m_LPC24_Display_VituralRam = nullptr;
 uint32_t* m_LPC24_Display_buffer = nullptr;
 
 size_t m_LPC24_DisplayBufferSize = 0;
+
+// With double buffering m_LPC24_Display_VituralRam is drawn into while m_LPC24_Display_ShownRam is scanned out
+uint32_t* m_LPC24_Display_SecondBuffer = nullptr;
+uint16_t* m_LPC24_Display_ShownRam = nullptr;
+volatile bool m_LPC24_Display_FlipPending = false;
+LPC24_Display_FlipHandler m_LPC24_Display_FlipHandler = nullptr;
+void* m_LPC24_Display_FlipHandlerContext = nullptr;
 uint8_t m_LPC24_Display_TextBuffer[LCD_MAX_COLUMN][LCD_MAX_ROW];
 
 LPC24xx_LCD_Rotation m_LPC24_Display_CurrentRotation = LPC24xx_LCD_Rotation::rotateNormal_0;
@@ -412,6 +423,8 @@ bool LPC24_Display_SetPinConfiguration(int32_t controllerIndex, bool enable);
 void LPC24_Display_WriteFormattedChar(uint8_t c);
 void LPC24_Display_WriteChar(uint8_t c, int32_t row, int32_t col);
 void LPC24_Display_BitBltEx(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t data[]);
+void LPC24_Display_BitBltRegion(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t* data);
+void LPC24_Display_InterruptHandler(void* param);
 void LPC24_Display_PaintPixel(uint32_t x, uint32_t y, uint8_t c);
 void LPC24_Display_Paint8HorizontalPixels(uint32_t x, uint32_t y, uint8_t p);
 void LPC24_Display_TextEnterClearMode();
@@ -424,8 +437,6 @@ int32_t LPC24_Display_GetWidth();
 int32_t LPC24_Display_GetHeight();
 int32_t LPC24_Display_BitPerPixel();
 uint32_t LPC24_Display_GetPixelClockDivider();
-int32_t LPC24_Display_GetOrientation();
-uint32_t* LPC24_Display_GetFrameBuffer();
 
 #define TOTAL_DISPLAY_CONTROLLERS 1
 
@@ -485,10 +496,12 @@ bool LPC24_Display_Initialize() {
 
     LPC24XX::SYSCON().LCD_CFG = (divider - 1); //config.PixelClockDivider - 1;
 
-    if (m_LPC24_Display_VituralRam == nullptr)
+    if (m_LPC24_Display_ShownRam == nullptr)
         return false;
 
-    LCDC.LCD_UPBASE = (uint32_t)&m_LPC24_Display_VituralRam[0];
+    LCDC.LCD_UPBASE = (uint32_t)&m_LPC24_Display_ShownRam[0];
+
+    LPC24_InterruptInternal_Activate(LPC24XX_VIC::c_IRQ_INDEX_EINT2_LCD, (uint32_t*)&LPC24_Display_InterruptHandler, 0);
 
     LPC24_Time_Delay(nullptr, 1000 * 10);
 
@@ -509,6 +522,13 @@ bool LPC24_Display_Uninitialize() {
     if (m_LPC24_DisplayEnable == false)
         return true;
 
+    LPC24_Display_WaitForCompletion();
+
+    LPC24_InterruptInternal_Deactivate(LPC24XX_VIC::c_IRQ_INDEX_EINT2_LCD);
+
+    LCDC.LCD_INTMSK &= ~LPC24_DISPLAY_BASE_UPDATE_INTERRUPT;
+    m_LPC24_Display_FlipPending = false;
+
     // powerdown
     LCDC.LCD_CTRL &= ~1;
     LPC24_Time_Delay(nullptr, 1000 * 10);
@@ -581,6 +601,8 @@ void LPC24_Display_PaintPixel(uint32_t x, uint32_t y, uint8_t c) {
     if (y >= m_LPC24_DisplayHeight)
         return;
 
+    LPC24_Display_WaitForCompletion();
+
     loc = m_LPC24_Display_VituralRam + (y *m_LPC24_DisplayWidth) + (x);
 
     if (c)
@@ -653,6 +675,8 @@ void LPC24_Display_Clear() {
     if (m_LPC24_DisplayEnable == false || m_LPC24_Display_VituralRam == nullptr)
         return;
 
+    LPC24_Display_WaitForCompletion();
+
     memset((uint32_t*)m_LPC24_Display_VituralRam, 0, m_LPC24_DisplayBufferSize);
 }
 
@@ -783,108 +807,88 @@ int32_t LPC24_Display_GetOrientation() {
     return m_LPC24_Display_CurrentRotation;
 }
 
-void LPC24_Display_BitBltEx(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t data[]) {
-
-    int32_t xTo, yTo, xFrom, yFrom;
-    int32_t xOffset = x;
-    int32_t yOffset = y;
-    uint16_t *from = (uint16_t *)data;
-    uint16_t *to = (uint16_t *)m_LPC24_Display_VituralRam;
+// orientation is one of the LPC24xx_LCD_Rotation values. The drawing functions take screen coordinates in the new
+// orientation from then on, the frame buffer keeps what is already drawn.
+TinyCLR_Result LPC24_Display_SetOrientation(const TinyCLR_Display_Controller* self, uint32_t orientation) {
+    if (orientation > LPC24xx_LCD_Rotation::rotateCCW_90)
+        return TinyCLR_Result::ArgumentOutOfRange;
 
+    LPC24_Display_WaitForCompletion();
 
-    int32_t screenWidth = m_LPC24_DisplayWidth;
-    int32_t screenHeight = m_LPC24_DisplayHeight;
-    int32_t startPx, toAddition;
-
-    if (m_LPC24_DisplayEnable == false)
-        return;
-
-    switch (m_LPC24_Display_CurrentRotation) {
-    case LPC24xx_LCD_Rotation::rotateNormal_0:
+    m_LPC24_Display_CurrentRotation = static_cast<LPC24xx_LCD_Rotation>(orientation);
 
-        if (xOffset == 0 && yOffset == 0 &&
-            width == screenWidth && height == screenHeight) {
-            memcpy(to, from, (screenWidth*screenHeight * 2));
-        }
-        else {
-            for (yTo = yOffset; yTo < (yOffset + height); yTo++) {
-                memcpy((void*)(to + yTo * screenWidth + xOffset), (void*)(from), (width * 2));
-                from += width;
-            }
-        }
+    return TinyCLR_Result::Success;
+}
 
-        break;
+// UPBASE is taken over at the start of each frame, until then the previous buffer is still scanned. Anything that
+// touches the frame buffer waits here first.
+void LPC24_Display_WaitForCompletion() {
+    LPC24XX_LCDC & LCDC = *(LPC24XX_LCDC *)LPC24XX_LCDC::c_LCDC_Base;
 
-    case LPC24xx_LCD_Rotation::rotateCCW_90:
+    while (m_LPC24_Display_FlipPending && (LCDC.LCD_INTRAW & LPC24_DISPLAY_BASE_UPDATE_INTERRUPT) == 0);
+}
 
-        startPx = yOffset * screenHeight;
-        xFrom = xOffset + width;
-        yTo = screenHeight - xOffset - width;
-        xTo = yOffset;
-        to += yTo * screenWidth + xTo;
-        toAddition = screenWidth - height;
+void LPC24_Display_InterruptHandler(void* param) {
+    LPC24XX_LCDC & LCDC = *(LPC24XX_LCDC *)LPC24XX_LCDC::c_LCDC_Base;
 
-        for (; yTo < (screenHeight - xOffset); yTo++) {
-            xFrom--;
-            yFrom = startPx + xFrom;
+    LCDC.LCD_INTCLR = LPC24_DISPLAY_BASE_UPDATE_INTERRUPT;
+    LCDC.LCD_INTMSK &= ~LPC24_DISPLAY_BASE_UPDATE_INTERRUPT;
 
-            for (xTo = yOffset; xTo < (yOffset + height); xTo++) {
-                *to++ = from[yFrom];
-                yFrom += screenHeight;
-            }
+    if (m_LPC24_Display_FlipPending) {
+        m_LPC24_Display_FlipPending = false;
 
-            to += toAddition;
-        }
+        if (m_LPC24_Display_FlipHandler != nullptr)
+            m_LPC24_Display_FlipHandler(m_LPC24_Display_FlipHandlerContext);
+    }
+}
 
-        break;
+void LPC24_Display_ShowBuffer(uint16_t* ram) {
+    LPC24XX_LCDC & LCDC = *(LPC24XX_LCDC *)LPC24XX_LCDC::c_LCDC_Base;
 
-    case LPC24xx_LCD_Rotation::rotateCW_90:
+    m_LPC24_Display_ShownRam = ram;
 
-        startPx = (yOffset + height - 1) * screenHeight;
-        xFrom = xOffset;
+    if (m_LPC24_DisplayEnable == false)
+        return;
 
-        yTo = xOffset;
-        xTo = screenWidth - yOffset - height;
-        to += yTo * screenWidth + xTo;
-        toAddition = screenWidth - height;
+    m_LPC24_Display_FlipPending = true;
 
-        for (; yTo < (xOffset + width); yTo++) {
-            yFrom = startPx + xFrom;
+    LCDC.LCD_UPBASE = reinterpret_cast<uint32_t>(ram);
+    LCDC.LCD_INTCLR = LPC24_DISPLAY_BASE_UPDATE_INTERRUPT;
+    LCDC.LCD_INTMSK |= LPC24_DISPLAY_BASE_UPDATE_INTERRUPT;
+}
 
-            for (xTo = screenWidth - yOffset - height; xTo < (screenWidth - yOffset); xTo++) {
-                *to++ = from[yFrom];
-                yFrom -= screenHeight;
-            }
+void LPC24_Display_BitBltEx(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t data[]) {
+    if (m_LPC24_DisplayEnable == false)
+        return;
 
-            to += toAddition;
-            xFrom++;
-        }
+    LPC24_Display_WaitForCompletion();
 
-        break;
+    DisplayRotation_Draw(static_cast<DisplayRotation_Orientation>(m_LPC24_Display_CurrentRotation), reinterpret_cast<const uint16_t*>(data), m_LPC24_Display_VituralRam, m_LPC24_DisplayWidth, m_LPC24_DisplayHeight, x, y, width, height);
+}
 
-    case LPC24xx_LCD_Rotation::rotate_180:
+// Same as BitBltEx, except that an unrotated source is a whole frame as well, as the rotated ones already are
+void LPC24_Display_BitBltRegion(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t* data) {
+    if (m_LPC24_Display_CurrentRotation != LPC24xx_LCD_Rotation::rotateNormal_0) {
+        LPC24_Display_BitBltEx(x, y, width, height, (uint32_t*)data);
 
-        xFrom = (yOffset + height - 1) * screenWidth + xOffset + width;
+        return;
+    }
 
-        yTo = screenHeight - yOffset - height;
-        xTo = screenWidth - xOffset - width;
-        to += yTo * screenWidth + xTo;
-        toAddition = screenWidth - width;
+    int32_t screenWidth = m_LPC24_DisplayWidth;
+    const uint16_t* from = data + y * screenWidth + x;
+    uint16_t* to = m_LPC24_Display_VituralRam + y * screenWidth + x;
 
-        for (; yTo < (screenHeight - yOffset); yTo++) {
+    if (m_LPC24_DisplayEnable == false || width <= 0 || height <= 0)
+        return;
 
-            for (xTo = screenWidth - xOffset - width; xTo < (screenWidth - xOffset); xTo++) {
-                xFrom--;
-                *to++ = from[xFrom];
-            }
+    LPC24_Display_WaitForCompletion();
 
-            to += toAddition;
-            xFrom -= toAddition;
-        }
+    for (auto row = 0; row < height; row++) {
+        memcpy(to, from, width * 2);
 
-        break;
+        from += screenWidth;
+        to += screenWidth;
     }
-
 }
 
 void LPC24_Display_WriteChar(uint8_t c, int32_t row, int32_t col) {
@@ -945,6 +949,17 @@ TinyCLR_Result LPC24_Display_Release(const TinyCLR_Display_Controller* self) {
 
             m_LPC24_Display_buffer = nullptr;
         }
+
+        if (m_LPC24_Display_SecondBuffer != nullptr) {
+            auto memoryProvider = (const TinyCLR_Memory_Manager*)apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager);
+
+            memoryProvider->Free(memoryProvider, m_LPC24_Display_SecondBuffer);
+
+            m_LPC24_Display_SecondBuffer = nullptr;
+        }
+
+        m_LPC24_Display_VituralRam = nullptr;
+        m_LPC24_Display_ShownRam = nullptr;
     }
     return TinyCLR_Result::Success;
 }
@@ -968,8 +983,12 @@ TinyCLR_Result LPC24_Display_Disable(const TinyCLR_Display_Controller* self) {
 }
 
 TinyCLR_Result LPC24_Display_SetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat dataFormat, uint32_t width, uint32_t height, const void* configuration) {
+    // Only Rgb565 is supported here. The L8, Rgb888 and Argb8888 frame buffers of the LTDC targets aren't available
+    // on this LCD controller: the palette (LCD_PAL) is only cleared and every drawing path writes 16 bit pixels.
     if (dataFormat != TinyCLR_Display_DataFormat::Rgb565) return TinyCLR_Result::NotSupported;
 
+    LPC24_Display_WaitForCompletion();
+
     if (configuration != nullptr) {
         auto& cfg = *(const TinyCLR_Display_ParallelConfiguration*)configuration;
 
@@ -1000,7 +1019,7 @@ TinyCLR_Result LPC24_Display_SetConfiguration(const TinyCLR_Display_Controller*
             break;
 
         default:
-            // TODO 8 - 24 - 32 bits
+            // Rejected above
             break;
         }
 
@@ -1012,6 +1031,12 @@ TinyCLR_Result LPC24_Display_SetConfiguration(const TinyCLR_Display_Controller*
             m_LPC24_Display_buffer = nullptr;
         }
 
+        if (m_LPC24_Display_SecondBuffer != nullptr) {
+            memoryProvider->Free(memoryProvider, m_LPC24_Display_SecondBuffer);
+
+            m_LPC24_Display_SecondBuffer = nullptr;
+        }
+
         m_LPC24_Display_buffer = (uint32_t*)memoryProvider->Allocate(memoryProvider, m_LPC24_DisplayBufferSize + 8);
 
         if (m_LPC24_Display_buffer == nullptr) {
@@ -1019,6 +1044,7 @@ TinyCLR_Result LPC24_Display_SetConfiguration(const TinyCLR_Display_Controller*
         }
 
         m_LPC24_Display_VituralRam = (uint16_t*)((((uint32_t)m_LPC24_Display_buffer) + (7)) & (~((uint32_t)(7))));
+        m_LPC24_Display_ShownRam = m_LPC24_Display_VituralRam;
 
         // Set displayEnablePin following m_LPC24_DisplayOutputEnableIsFixed
         if (displayEnablePin.number != PIN_NONE) {
@@ -1069,12 +1095,111 @@ TinyCLR_Result LPC24_Display_DrawBuffer(const TinyCLR_Display_Controller* self,
     return TinyCLR_Result::Success;
 }
 
+// data is a whole frame in the current orientation, only the given rectangles of it are copied
+TinyCLR_Result LPC24_Display_DrawBufferRegions(const TinyCLR_Display_Controller* self, const uint8_t* data, const DisplayRegion_Rectangle* rectangles, size_t count) {
+    DisplayRegion region;
+    int32_t width = m_LPC24_DisplayWidth;
+    int32_t height = m_LPC24_DisplayHeight;
+
+    if (m_LPC24_DisplayEnable == false)
+        return TinyCLR_Result::InvalidOperation;
+
+    LPC24_Display_GetRotatedDimensions(&width, &height);
+
+    DisplayRegion_Reset(region, width, height);
+
+    for (size_t i = 0; i < count; i++)
+        DisplayRegion_Add(region, rectangles[i].X, rectangles[i].Y, rectangles[i].Width, rectangles[i].Height);
+
+    for (size_t i = 0; i < region.count; i++) {
+        auto& rectangle = region.rectangles[i];
+
+        LPC24_Display_BitBltRegion(rectangle.X, rectangle.Y, rectangle.Width, rectangle.Height, reinterpret_cast<const uint16_t*>(data));
+    }
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result LPC24_Display_SetDoubleBuffering(const TinyCLR_Display_Controller* self, bool enable) {
+    auto memoryProvider = (const TinyCLR_Memory_Manager*)apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager);
+
+    if (m_LPC24_Display_buffer == nullptr)
+        return TinyCLR_Result::InvalidOperation;
+
+    LPC24_Display_WaitForCompletion();
+
+    if (enable) {
+        if (m_LPC24_Display_SecondBuffer != nullptr)
+            return TinyCLR_Result::Success;
+
+        m_LPC24_Display_SecondBuffer = (uint32_t*)memoryProvider->Allocate(memoryProvider, m_LPC24_DisplayBufferSize + 8);
+
+        if (m_LPC24_Display_SecondBuffer == nullptr)
+            return TinyCLR_Result::OutOfMemory;
+
+        // Start from what is shown so that partial draws stay consistent
+        m_LPC24_Display_VituralRam = (uint16_t*)((((uint32_t)m_LPC24_Display_SecondBuffer) + (7)) & (~((uint32_t)(7))));
+
+        memcpy(m_LPC24_Display_VituralRam, m_LPC24_Display_ShownRam, m_LPC24_DisplayBufferSize);
+    }
+    else {
+        if (m_LPC24_Display_SecondBuffer == nullptr)
+            return TinyCLR_Result::Success;
+
+        auto ram = (uint16_t*)((((uint32_t)m_LPC24_Display_buffer) + (7)) & (~((uint32_t)(7))));
+
+        if (m_LPC24_Display_ShownRam != ram) {
+            memcpy(ram, m_LPC24_Display_ShownRam, m_LPC24_DisplayBufferSize);
+
+            LPC24_Display_ShowBuffer(ram);
+            LPC24_Display_WaitForCompletion();
+        }
+
+        m_LPC24_Display_VituralRam = ram;
+
+        memoryProvider->Free(memoryProvider, m_LPC24_Display_SecondBuffer);
+
+        m_LPC24_Display_SecondBuffer = nullptr;
+    }
+
+    return TinyCLR_Result::Success;
+}
+
+// Shows the buffer drawn so far from the next vertical blanking on. The previously shown buffer is drawn into next
+// and still holds the frame before, draws wait until it is no longer scanned.
+TinyCLR_Result LPC24_Display_Flip(const TinyCLR_Display_Controller* self) {
+    if (m_LPC24_DisplayEnable == false || m_LPC24_Display_SecondBuffer == nullptr)
+        return TinyCLR_Result::InvalidOperation;
+
+    LPC24_Display_WaitForCompletion();
+
+    auto shown = m_LPC24_Display_ShownRam;
+
+    LPC24_Display_ShowBuffer(m_LPC24_Display_VituralRam);
+
+    m_LPC24_Display_VituralRam = shown;
+
+    return TinyCLR_Result::Success;
+}
+
+// Called from the vertical blanking interrupt once a flip is shown
+TinyCLR_Result LPC24_Display_SetFlipHandler(const TinyCLR_Display_Controller* self, LPC24_Display_FlipHandler handler, void* context) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    m_LPC24_Display_FlipHandler = handler;
+    m_LPC24_Display_FlipHandlerContext = context;
+
+    return TinyCLR_Result::Success;
+}
+
 TinyCLR_Result LPC24_Display_DrawPixel(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint64_t color) {
     volatile uint16_t * loc;
 
     if (m_LPC24_DisplayEnable == false || x >= m_LPC24_DisplayWidth || y >= m_LPC24_DisplayHeight)
         return TinyCLR_Result::InvalidOperation;
 
+    LPC24_Display_WaitForCompletion();
+
     loc = m_LPC24_Display_VituralRam + (y *m_LPC24_DisplayWidth) + (x);
 
     *loc = static_cast<uint16_t>(color & 0xFFFF);
@@ -1129,6 +1254,8 @@ void LPC24_Display_AddApi(const TinyCLR_Api_Manager* apiManager) {
 
     displayInitializeCount = 0;
     m_LPC24_Display_buffer = nullptr;
+    m_LPC24_Display_SecondBuffer = nullptr;
+    m_LPC24_Display_FlipHandler = nullptr;
     m_LPC24_DisplayEnable = false;
 
     apiManager->SetDefaultName(apiManager, TinyCLR_Api_Type::DisplayController, displayApi[0].Name);
@@ -1143,6 +1270,8 @@ void LPC24_Display_Reset() {
     m_LPC24_DisplayEnable = false;
     displayInitializeCount = 0;
     m_LPC24_Display_buffer = nullptr;
+    m_LPC24_Display_SecondBuffer = nullptr;
+    m_LPC24_Display_FlipHandler = nullptr;
 
     m_LPC24_Display_TextRow = 0;
     m_LPC24_Display_TextColumn = 0;
@@ -542,22 +542,22 @@ void LPC24_UsbDevice_TxPacket(UsbClientState* usbClientState, int32_t endpoint)
     DISABLE_INTERRUPTS_SCOPED(irq);
 
     // transmit a packet on UsbPortNum, if there are no more packets to transmit, then die
-    USB_PACKET64* Packet64;
+    USB_PACKET* Packet;
 
     for (;;) {
-        Packet64 = TinyCLR_UsbClient_TxDequeue(usbClientState, endpoint);
+        Packet = TinyCLR_UsbClient_TxDequeue(usbClientState, endpoint);
 
-        if (Packet64 == nullptr || Packet64->Size > 0) {
+        if (Packet == nullptr || Packet->Size > 0) {
             break;
         }
     }
 
-    if (Packet64) {
+    if (Packet) {
 
-        USB_WriteEP(endpoint, Packet64->Buffer, Packet64->Size);
+        USB_WriteEP(endpoint, Packet->Buffer, Packet->Size);
 
         usbDeviceControllers[usbClientState->controllerIndex].txNeedZLPS[endpoint] = false;
-        if (Packet64->Size == 64)
+        if (Packet->Size == usbClientState->maxEndpointsPacketSize[endpoint])
             usbDeviceControllers[usbClientState->controllerIndex].txNeedZLPS[endpoint] = true;
     }
     else {
@@ -772,17 +772,17 @@ void LPC24_UsbDevice_Enpoint_TxInterruptHandler(UsbClientState *usbClientState,
 
 void LPC24_UsbDevice_Enpoint_RxInterruptHandler(UsbClientState *usbClientState, uint32_t endpoint) {
     bool          DisableRx;
-    USB_PACKET64* Packet64 = TinyCLR_UsbClient_RxEnqueue(usbClientState, endpoint, DisableRx);
+    USB_PACKET* Packet = TinyCLR_UsbClient_RxEnqueue(usbClientState, endpoint, DisableRx);
 
-    /* copy packet in, making sure that Packet64->Buffer is never overflowed */
-    if (Packet64) {
-        uint8_t   len = 0;//USB.UDCBCRx[EPno] & LPC24xx_USB::UDCBCR_mask;
-        uint32_t* packetBuffer = (uint32_t*)Packet64->Buffer;
-        len = LPC24_UsbDevice_ReadEP(endpoint, Packet64->Buffer);
+    /* copy packet in, making sure that Packet->Buffer is never overflowed */
+    if (Packet) {
+        uint32_t  len = 0;//USB.UDCBCRx[EPno] & LPC24xx_USB::UDCBCR_mask;
+        uint32_t* packetBuffer = (uint32_t*)Packet->Buffer;
+        len = LPC24_UsbDevice_ReadEP(endpoint, Packet->Buffer);
 
         // clear packet status
         nacking_rx_OUT_data[endpoint] = 0;
-        Packet64->Size = len;
+        Packet->Size = len;
     }
     else {
         /* flow control should absolutely protect us from ever
@@ -882,6 +882,11 @@ void TinyCLR_UsbClient_InitializeConfiguration(UsbClientState *usbClientState) {
     LPC24_UsbDevice_InitializeConfiguration(usbClientState);
 }
 
+// Bulk endpoints are limited to 64 bytes as the controller runs at full speed
+#if LPC24_USB_ENDPOINT_SIZE > 64
+#error "LPC24_USB_ENDPOINT_SIZE can't be larger than 64 at full speed"
+#endif
+
 uint32_t TinyCLR_UsbClient_GetEndpointSize(int32_t endpoint) {
     return endpoint == 0 ? LPC24_USB_ENDPOINT0_SIZE : LPC24_USB_ENDPOINT_SIZE;
 }
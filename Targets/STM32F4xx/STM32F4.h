@@ -129,6 +129,11 @@ TinyCLR_Result STM32F4_Can_ClearReadBuffer(const TinyCLR_Can_Controller* self);
 TinyCLR_Result STM32F4_Can_IsWritingAllowed(const TinyCLR_Can_Controller* self, bool& allowed);
 size_t STM32F4_Can_GetWriteErrorCount(const TinyCLR_Can_Controller* self);
 size_t STM32F4_Can_GetReadErrorCount(const TinyCLR_Can_Controller* self);
+struct CanStatistics;
+TinyCLR_Result STM32F4_Can_GetStatistics(const TinyCLR_Can_Controller* self, CanStatistics& statistics);
+TinyCLR_Result STM32F4_Can_ResetStatistics(const TinyCLR_Can_Controller* self);
+typedef bool(*STM32F4_Can_FrameHandler)(const TinyCLR_Can_Message& message, uint64_t timestamp, void* context);
+TinyCLR_Result STM32F4_Can_SetFrameHandler(const TinyCLR_Can_Controller* self, STM32F4_Can_FrameHandler handler, void* context);
 uint32_t STM32F4_Can_GetSourceClock(const TinyCLR_Can_Controller* self);
 size_t STM32F4_Can_GetReadBufferSize(const TinyCLR_Can_Controller* self);
 TinyCLR_Result STM32F4_Can_SetReadBufferSize(const TinyCLR_Can_Controller* self, size_t size);
@@ -228,6 +233,12 @@ TinyCLR_Result STM32F4_SdCard_Erases(const TinyCLR_Storage_Controller* self, uin
 TinyCLR_Result STM32F4_SdCard_GetDescriptor(const TinyCLR_Storage_Controller* self, const TinyCLR_Storage_Descriptor*& descriptor);
 TinyCLR_Result STM32F4_SdCard_Open(const TinyCLR_Storage_Controller* self);
 TinyCLR_Result STM32F4_SdCard_Close(const TinyCLR_Storage_Controller* self);
+
+typedef void(*STM32F4_SdCard_AsyncCompletionHandler)(const TinyCLR_Storage_Controller* self, TinyCLR_Result result, size_t count, void* context);
+
+TinyCLR_Result STM32F4_SdCard_ReadAsync(const TinyCLR_Storage_Controller* self, uint64_t address, size_t count, uint8_t* data, uint64_t timeout, STM32F4_SdCard_AsyncCompletionHandler handler, void* context);
+TinyCLR_Result STM32F4_SdCard_WriteAsync(const TinyCLR_Storage_Controller* self, uint64_t address, size_t count, const uint8_t* data, uint64_t timeout, STM32F4_SdCard_AsyncCompletionHandler handler, void* context);
+size_t STM32F4_SdCard_GetPendingAsyncCount(const TinyCLR_Storage_Controller* self);
 TinyCLR_Result STM32F4_SdCard_Reset();
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -247,6 +258,10 @@ uint32_t STM32F4_Spi_GetMaxClockFrequency(const TinyCLR_Spi_Controller* self);
 TinyCLR_Result STM32F4_Spi_GetSupportedDataBitLengths(const TinyCLR_Spi_Controller* self, uint32_t* dataBitLengths, size_t& dataBitLengthsCount);
 void STM32F4_Spi_Reset();
 
+typedef void(*STM32F4_Spi_WriteCompleteHandler)(void* context, TinyCLR_Result result);
+
+TinyCLR_Result STM32F4_Spi_WriteWords(const TinyCLR_Spi_Controller* self, const uint16_t* words, size_t count, STM32F4_Spi_WriteCompleteHandler handler, void* context);
+
 ////////////////////////////////////////////////////////////////////////////////
 //UART
 ////////////////////////////////////////////////////////////////////////////////
@@ -283,14 +298,14 @@ void STM32F4_UsbDevice_AddApi(const TinyCLR_Api_Manager* apiManager);
 const TinyCLR_Api_Info* STM32F4_UsbDevice_GetRequiredApi();
 void STM32F4_UsbDevice_Reset();
 
-struct USB_PACKET64;
+struct USB_PACKET;
 struct UsbClientState;
 typedef void(*USB_NEXT_CALLBACK)(UsbClientState*);
 
 void TinyCLR_UsbClient_ClearEvent(UsbClientState *usbClientState, uint32_t event);
 void TinyCLR_UsbClient_ClearEndpoints(UsbClientState *usbClientState, int32_t endpoint);
-USB_PACKET64* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx);
-USB_PACKET64* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint);
+USB_PACKET* TinyCLR_UsbClient_RxEnqueue(UsbClientState* usbClientState, int32_t endpoint, bool& disableRx);
+USB_PACKET* TinyCLR_UsbClient_TxDequeue(UsbClientState* usbClientState, int32_t endpoint);
 void TinyCLR_UsbClient_StateCallback(UsbClientState* usbClientState);
 uint8_t TinyCLR_UsbClient_ControlCallback(UsbClientState* usbClientState);
 bool TinyCLR_UsbClient_CanReceivePackage(UsbClientState* usbClientState, int32_t endpoint);
@@ -417,7 +432,43 @@ TinyCLR_Result STM32F4_Display_GetCapabilities(const TinyCLR_Display_Controller*
 TinyCLR_Result STM32F4_Display_GetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat& dataFormat, uint32_t& width, uint32_t& height, void* configuration);
 TinyCLR_Result STM32F4_Display_SetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat dataFormat, uint32_t width, uint32_t height, const void* configuration);
 TinyCLR_Result STM32F4_Display_DrawBuffer(const TinyCLR_Display_Controller* self, int32_t x, int32_t y, int32_t width, int32_t height, const uint8_t* data);
+struct DisplayRegion_Rectangle;
+TinyCLR_Result STM32F4_Display_DrawBufferRegions(const TinyCLR_Display_Controller* self, const uint8_t* data, const DisplayRegion_Rectangle* rectangles, size_t count);
+typedef void(*STM32F4_Display_FlipHandler)(void* context);
+TinyCLR_Result STM32F4_Display_SetDoubleBuffering(const TinyCLR_Display_Controller* self, bool enable);
+TinyCLR_Result STM32F4_Display_Flip(const TinyCLR_Display_Controller* self);
+TinyCLR_Result STM32F4_Display_SetFlipHandler(const TinyCLR_Display_Controller* self, STM32F4_Display_FlipHandler handler, void* context);
 TinyCLR_Result STM32F4_Display_DrawPixel(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint64_t color);
+TinyCLR_Result STM32F4_Display_FillRectangle(const TinyCLR_Display_Controller* self, int32_t x, int32_t y, int32_t width, int32_t height, uint64_t color);
+enum class DisplayFormat_PixelFormat : uint32_t;
+TinyCLR_Result STM32F4_Display_DrawBufferFormat(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data, DisplayFormat_PixelFormat format);
+TinyCLR_Result STM32F4_Display_SetPixelFormat(const TinyCLR_Display_Controller* self, DisplayFormat_PixelFormat format);
+TinyCLR_Result STM32F4_Display_SetPalette(const TinyCLR_Display_Controller* self, uint32_t index, const uint32_t* colors, size_t count);
+struct GlyphCache;
+TinyCLR_Result STM32F4_Display_DrawText(const TinyCLR_Display_Controller* self, GlyphCache& cache, int32_t x, int32_t y, const char* text, size_t length, uint32_t color);
+
+struct STM32F4_Display_OverlayConfiguration {
+    const uint8_t* Buffer;
+    DisplayFormat_PixelFormat Format;
+
+    int32_t X;
+    int32_t Y;
+    uint32_t Width;
+    uint32_t Height;
+
+    // 255 is opaque. ColorKey is Argb8888 with the alpha ignored, pixels that expand to it are transparent.
+    uint8_t Alpha;
+    bool ColorKeyEnable;
+    uint32_t ColorKey;
+};
+
+TinyCLR_Result STM32F4_Display_SetOverlay(const TinyCLR_Display_Controller* self, const STM32F4_Display_OverlayConfiguration& configuration);
+TinyCLR_Result STM32F4_Display_MoveOverlay(const TinyCLR_Display_Controller* self, int32_t x, int32_t y);
+TinyCLR_Result STM32F4_Display_DisableOverlay(const TinyCLR_Display_Controller* self);
+TinyCLR_Result STM32F4_Display_SetOrientation(const TinyCLR_Display_Controller* self, uint32_t orientation);
+int32_t STM32F4_Display_GetOrientation();
+uint32_t* STM32F4_Display_GetFrameBuffer();
+void STM32F4_Display_WaitForCompletion();
 TinyCLR_Result STM32F4_Display_WriteString(const TinyCLR_Display_Controller* self, const char* buffer, size_t length);
 
 void STM32F4_Startup_OnSoftReset(const TinyCLR_Api_Manager* apiManager, const TinyCLR_Interop_Manager* interopManager);
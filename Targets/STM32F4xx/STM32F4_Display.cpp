@@ -16,11 +16,27 @@
 #include <stdio.h>
 #include <string.h>
 #include "STM32F4.h"
+#include "../../Drivers/DisplayRegion/DisplayRegion.h"
+#include "../../Drivers/DisplayRotation/DisplayRotation.h"
+#include "../../Drivers/DisplayFormat/DisplayFormat.h"
+#include "../../Drivers/GlyphCache/GlyphCache.h"
 
 #ifdef INCLUDE_DISPLAY
 
 #define MAX_LAYER  2
 
+#if defined(DMA2D)
+#define STM32F4_DISPLAY_DMA2D_MODE_MEMORY_TO_MEMORY 0x00000000
+#define STM32F4_DISPLAY_DMA2D_MODE_MEMORY_TO_MEMORY_PFC 0x00010000
+#define STM32F4_DISPLAY_DMA2D_MODE_MEMORY_TO_MEMORY_BLEND 0x00020000
+#define STM32F4_DISPLAY_DMA2D_MODE_REGISTER_TO_MEMORY 0x00030000
+#define STM32F4_DISPLAY_DMA2D_COLOR_MODE_ARGB8888 0x00000000
+#define STM32F4_DISPLAY_DMA2D_COLOR_MODE_RGB888 0x00000001
+#define STM32F4_DISPLAY_DMA2D_COLOR_MODE_RGB565 0x00000002
+#define STM32F4_DISPLAY_DMA2D_COLOR_MODE_A8 0x00000009
+#define STM32F4_DISPLAY_DMA2D_ALPHA_MODE_MULTIPLY 0x00020000
+#endif
+
 /**
   * @brief  LTDC color structure definition
   */
@@ -345,6 +361,21 @@ uint16_t* m_STM32F4_Display_VituralRam = nullptr;
 uint32_t* m_STM32F4_Display_buffer = nullptr;
 size_t m_STM32F4_DisplayBufferSize = 0;
 
+// With double buffering m_STM32F4_Display_VituralRam is drawn into while m_STM32F4_Display_ShownRam is scanned out
+uint32_t* m_STM32F4_Display_SecondBuffer = nullptr;
+uint16_t* m_STM32F4_Display_ShownRam = nullptr;
+volatile bool m_STM32F4_Display_FlipPending = false;
+STM32F4_Display_FlipHandler m_STM32F4_Display_FlipHandler = nullptr;
+void* m_STM32F4_Display_FlipHandlerContext = nullptr;
+
+// Managed code only knows Rgb565, the other formats are selected natively and its data is converted when drawn
+DisplayFormat_PixelFormat m_STM32F4_Display_PixelFormat = DisplayFormat_PixelFormat::Rgb565;
+uint32_t m_STM32F4_Display_Palette[DISPLAY_FORMAT_PALETTE_SIZE];
+
+// The frame buffer is on layer index 0 and the overlay on index 1, blended over it
+STM32F4_Display_OverlayConfiguration m_STM32F4_Display_Overlay;
+bool m_STM32F4_Display_OverlayEnable = false;
+
 uint8_t m_STM32F4_Display_TextBuffer[LCD_MAX_COLUMN][LCD_MAX_ROW];
 
 STM32F4xx_LCD_Rotation m_STM32F4_Display_CurrentRotation = STM32F4xx_LCD_Rotation::rotateNormal_0;
@@ -356,6 +387,16 @@ bool STM32F4_Display_SetPinConfiguration(int32_t controllerIndex, bool enable);
 void STM32F4_Display_WriteFormattedChar(uint8_t c);
 void STM32F4_Display_WriteChar(uint8_t c, int32_t row, int32_t col);
 void STM32F4_Display_BitBltEx(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t data[]);
+void STM32F4_Display_BitBltRegion(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t* data);
+void STM32F4_Display_BitBltConvert(int32_t x, int32_t y, int32_t width, int32_t height, const uint8_t* data, DisplayFormat_PixelFormat format);
+uint8_t* STM32F4_Display_GetPixelAddress(uint16_t* ram, int32_t x, int32_t y);
+void STM32F4_Display_LoadPalette(LTDC_Layer_TypeDef* layer, uint32_t index, size_t count);
+void STM32F4_Display_ConfigureOverlay();
+uint32_t STM32F4_Display_GetLtdcPixelFormat(DisplayFormat_PixelFormat format);
+void STM32F4_Display_InterruptHandler(void* param);
+bool STM32F4_Display_Dma2dFill(void* to, uint32_t toOffset, uint32_t width, uint32_t height, uint32_t color);
+bool STM32F4_Display_Dma2dBlend(const uint8_t* alpha, uint32_t alphaOffset, void* to, uint32_t toOffset, uint32_t width, uint32_t height, uint32_t color);
+void STM32F4_Display_DrawGlyph(const GlyphCache_Glyph& glyph, int32_t x, int32_t y, void* context);
 void STM32F4_Display_PaintPixel(uint32_t x, uint32_t y, uint8_t c);
 void STM32F4_Display_Paint8HorizontalPixels(uint32_t x, uint32_t y, uint8_t p);
 void STM32F4_Display_TextEnterClearMode();
@@ -368,14 +409,14 @@ int32_t STM32F4_Display_GetWidth();
 int32_t STM32F4_Display_GetHeight();
 int32_t STM32F4_Display_BitPerPixel();
 uint32_t STM32F4_Display_GetPixelClockDivider();
-int32_t STM32F4_Display_GetOrientation();
-uint32_t* STM32F4_Display_GetFrameBuffer();
 
 #define TOTAL_DISPLAY_CONTROLLERS 1
 
 static TinyCLR_Display_Controller displayControllers[TOTAL_DISPLAY_CONTROLLERS];
 static TinyCLR_Api_Info displayApi[TOTAL_DISPLAY_CONTROLLERS];
 
+static LTDC_HandleTypeDef hltdc_F;
+
 bool STM32F4_Ltdc_Initialize(LTDC_HandleTypeDef *hltdc) {
     uint32_t tmp = 0, tmp1 = 0;
 
@@ -508,7 +549,6 @@ void STM32F4_Ltdc_LayerConfiguration(LTDC_HandleTypeDef *hltdc, LTDC_LayerCfgTyp
 
 bool STM32F4_Display_Initialize() {
     // InitializeConfiguration
-    static LTDC_HandleTypeDef hltdc_F;
     LTDC_LayerCfgTypeDef      pLayerCfg;
 
     const uint32_t STM32F4_DISPLAY_CLOCKDIVS[4] = { 2, 4, 8, 16 };
@@ -569,6 +609,10 @@ bool STM32F4_Display_Initialize() {
 
     RCC->APB2ENR |= RCC_APB2ENR_LTDCEN;
 
+#if defined(DMA2D)
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2DEN;
+#endif
+
     //HorizontalSyncPolarity
     if (m_STM32F4_DisplayHorizontalSyncPolarity == false)
         hltdc_F.Init.HSPolarity = LTDC_HSPOLARITY_AL;
@@ -623,13 +667,13 @@ bool STM32F4_Display_Initialize() {
     hltdc_F.Instance = LTDC;
 
     /* Pixel Format configuration*/
-    pLayerCfg.PixelFormat = LTDC_PIXEL_FORMAT_RGB565;
+    pLayerCfg.PixelFormat = STM32F4_Display_GetLtdcPixelFormat(m_STM32F4_Display_PixelFormat);
 
     /* Start Address configuration : frame buffer is located at FLASH memory */
-    if (m_STM32F4_Display_VituralRam == nullptr)
+    if (m_STM32F4_Display_ShownRam == nullptr)
         return false;
 
-    pLayerCfg.FBStartAdress = (uint32_t)m_STM32F4_Display_VituralRam;
+    pLayerCfg.FBStartAdress = (uint32_t)m_STM32F4_Display_ShownRam;
 
     /* Alpha constant (255 == totally opaque) */
     pLayerCfg.Alpha = 255;
@@ -654,12 +698,39 @@ bool STM32F4_Display_Initialize() {
     }
 
     /* Configure the Layer*/
-    STM32F4_Ltdc_LayerConfiguration(&hltdc_F, &pLayerCfg, 1);
+    STM32F4_Ltdc_LayerConfiguration(&hltdc_F, &pLayerCfg, 0);
+
+    // L8 pixels go through the color lookup table, which is loaded before it is enabled
+    if (m_STM32F4_Display_PixelFormat == DisplayFormat_PixelFormat::L8) {
+        STM32F4_Display_LoadPalette(LTDC_Layer1, 0, DISPLAY_FORMAT_PALETTE_SIZE);
+
+        LTDC_Layer1->CR |= LTDC_LxCR_CLUTEN;
+    }
+    else {
+        LTDC_Layer1->CR &= ~LTDC_LxCR_CLUTEN;
+    }
+
+    STM32F4_Display_ConfigureOverlay();
+
+    LTDC->SRCR = LTDC_SRCR_IMR;
+
+    STM32F4_InterruptInternal_Activate(LTDC_IRQn, (uint32_t*)&STM32F4_Display_InterruptHandler, 0);
 
     return true;
 }
 
 bool STM32F4_Display_Uninitialize() {
+    STM32F4_Display_WaitForCompletion();
+
+    STM32F4_InterruptInternal_Deactivate(LTDC_IRQn);
+
+    LTDC->IER &= ~LTDC_IER_RRIE;
+    m_STM32F4_Display_FlipPending = false;
+
+#if defined(DMA2D)
+    RCC->AHB1ENR &= ~RCC_AHB1ENR_DMA2DEN;
+#endif
+
     RCC->APB2ENR &= ~RCC_APB2ENR_LTDCEN;
 
     return true;
@@ -718,7 +789,7 @@ void STM32F4_Display_WriteFormattedChar(uint8_t c) {
 }
 //=======================================================
 void STM32F4_Display_PaintPixel(uint32_t x, uint32_t y, uint8_t c) {
-    volatile uint16_t * loc;
+    uint8_t* loc;
 
     if (m_STM32F4_DisplayEnable == false)
         return;
@@ -728,12 +799,15 @@ void STM32F4_Display_PaintPixel(uint32_t x, uint32_t y, uint8_t c) {
     if (y >= m_STM32F4_DisplayHeight)
         return;
 
-    loc = m_STM32F4_Display_VituralRam + (y *m_STM32F4_DisplayWidth) + (x);
+    STM32F4_Display_WaitForCompletion();
+
+    loc = STM32F4_Display_GetPixelAddress(m_STM32F4_Display_VituralRam, x, y);
 
+    // 0x0FFF in Rgb565
     if (c)
-        *loc = 0x0fff;
+        DisplayFormat_WritePixel(loc, m_STM32F4_Display_PixelFormat, 0xFF08FFFF);
     else
-        *loc = 0;
+        DisplayFormat_WritePixel(loc, m_STM32F4_Display_PixelFormat, 0xFF000000);
 }
 //=======================================================
 void STM32F4_Display_Paint8HorizontalPixels(uint32_t x, uint32_t y, uint8_t p) {
@@ -800,7 +874,10 @@ void STM32F4_Display_Clear() {
     if (m_STM32F4_DisplayEnable == false || m_STM32F4_Display_VituralRam == nullptr)
         return;
 
-    memset((uint32_t*)m_STM32F4_Display_VituralRam, 0, m_STM32F4_DisplayBufferSize);
+    STM32F4_Display_WaitForCompletion();
+
+    if (!STM32F4_Display_Dma2dFill(m_STM32F4_Display_VituralRam, 0, m_STM32F4_DisplayWidth, m_STM32F4_DisplayHeight, 0))
+        memset((uint32_t*)m_STM32F4_Display_VituralRam, 0, m_STM32F4_DisplayBufferSize);
 }
 
 struct DisplayPins {
@@ -905,6 +982,109 @@ uint32_t* STM32F4_Display_GetFrameBuffer() {
     return (uint32_t*)m_STM32F4_Display_VituralRam;
 }
 
+uint8_t* STM32F4_Display_GetPixelAddress(uint16_t* ram, int32_t x, int32_t y) {
+    return reinterpret_cast<uint8_t*>(ram) + (y * m_STM32F4_DisplayWidth + x) * DisplayFormat_GetBytesPerPixel(m_STM32F4_Display_PixelFormat);
+}
+
+uint32_t STM32F4_Display_GetLtdcPixelFormat(DisplayFormat_PixelFormat format) {
+    switch (format) {
+    case DisplayFormat_PixelFormat::L8:
+        return LTDC_PIXEL_FORMAT_L8;
+
+    case DisplayFormat_PixelFormat::Rgb888:
+        return LTDC_PIXEL_FORMAT_RGB888;
+
+    case DisplayFormat_PixelFormat::Argb8888:
+        return LTDC_PIXEL_FORMAT_ARGB8888;
+
+    default:
+        return LTDC_PIXEL_FORMAT_RGB565;
+    }
+}
+
+// Entries take effect right away, so a frame may show some of them changed
+void STM32F4_Display_LoadPalette(LTDC_Layer_TypeDef* layer, uint32_t index, size_t count) {
+    for (auto i = index; i < index + count; i++)
+        layer->CLUTWR = (i << 24) | (m_STM32F4_Display_Palette[i] & 0x00FFFFFF);
+}
+
+// Programs layer index 1 from m_STM32F4_Display_Overlay, the caller reloads the shadow registers. The window is clipped
+// to the panel by starting the layer further into the buffer, its pitch stays the full overlay width.
+void STM32F4_Display_ConfigureOverlay() {
+    LTDC_LayerCfgTypeDef layerCfg;
+    auto& overlay = m_STM32F4_Display_Overlay;
+    int32_t x0 = overlay.X;
+    int32_t y0 = overlay.Y;
+    int32_t x1 = overlay.X + static_cast<int32_t>(overlay.Width);
+    int32_t y1 = overlay.Y + static_cast<int32_t>(overlay.Height);
+
+    if (x0 < 0)
+        x0 = 0;
+
+    if (y0 < 0)
+        y0 = 0;
+
+    if (x1 > static_cast<int32_t>(m_STM32F4_DisplayWidth))
+        x1 = m_STM32F4_DisplayWidth;
+
+    if (y1 > static_cast<int32_t>(m_STM32F4_DisplayHeight))
+        y1 = m_STM32F4_DisplayHeight;
+
+    if (m_STM32F4_Display_OverlayEnable == false || x0 >= x1 || y0 >= y1) {
+        LTDC_Layer2->CR &= ~LTDC_LxCR_LEN;
+
+        return;
+    }
+
+    auto bytesPerPixel = DisplayFormat_GetBytesPerPixel(overlay.Format);
+
+    layerCfg.WindowX0 = x0;
+    layerCfg.WindowX1 = x1;
+    layerCfg.WindowY0 = y0;
+    layerCfg.WindowY1 = y1;
+
+    layerCfg.PixelFormat = STM32F4_Display_GetLtdcPixelFormat(overlay.Format);
+    layerCfg.FBStartAdress = reinterpret_cast<uint32_t>(overlay.Buffer + ((y0 - overlay.Y) * overlay.Width + (x0 - overlay.X)) * bytesPerPixel);
+
+    layerCfg.Alpha = overlay.Alpha;
+    layerCfg.Alpha0 = 0;
+    layerCfg.Backcolor.Blue = 0;
+    layerCfg.Backcolor.Green = 0;
+    layerCfg.Backcolor.Red = 0;
+
+    // Argb8888 pixels carry their own alpha, scaled by the constant one
+    if (overlay.Format == DisplayFormat_PixelFormat::Argb8888) {
+        layerCfg.BlendingFactor1 = LTDC_BLENDING_FACTOR1_PAxCA;
+        layerCfg.BlendingFactor2 = LTDC_BLENDING_FACTOR2_PAxCA;
+    }
+    else {
+        layerCfg.BlendingFactor1 = LTDC_BLENDING_FACTOR1_CA;
+        layerCfg.BlendingFactor2 = LTDC_BLENDING_FACTOR2_CA;
+    }
+
+    layerCfg.ImageWidth = overlay.Width;
+    layerCfg.ImageHeight = y1 - y0;
+
+    STM32F4_Ltdc_SetConfiguration(&hltdc_F, &layerCfg, 1);
+
+    if (overlay.ColorKeyEnable) {
+        LTDC_Layer2->CKCR = overlay.ColorKey & 0x00FFFFFF;
+        LTDC_Layer2->CR |= LTDC_LxCR_COLKEN;
+    }
+    else {
+        LTDC_Layer2->CR &= ~LTDC_LxCR_COLKEN;
+    }
+
+    if (overlay.Format == DisplayFormat_PixelFormat::L8) {
+        STM32F4_Display_LoadPalette(LTDC_Layer2, 0, DISPLAY_FORMAT_PALETTE_SIZE);
+
+        LTDC_Layer2->CR |= LTDC_LxCR_CLUTEN;
+    }
+    else {
+        LTDC_Layer2->CR &= ~LTDC_LxCR_CLUTEN;
+    }
+}
+
 int32_t STM32F4_Display_GetWidth() {
     int32_t width = m_STM32F4_DisplayWidth;
     int32_t height = m_STM32F4_DisplayHeight;
@@ -930,107 +1110,239 @@ int32_t STM32F4_Display_GetOrientation() {
     return m_STM32F4_Display_CurrentRotation;
 }
 
-void STM32F4_Display_BitBltEx(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t data[]) {
-    int32_t xTo, yTo, xFrom, yFrom;
-    int32_t xOffset = x;
-    int32_t yOffset = y;
-    uint16_t *from = (uint16_t *)data;
-    uint16_t *to = (uint16_t *)m_STM32F4_Display_VituralRam;
+// orientation is one of the STM32F4xx_LCD_Rotation values. The drawing functions take screen coordinates in the new
+// orientation from then on, the frame buffer keeps what is already drawn.
+TinyCLR_Result STM32F4_Display_SetOrientation(const TinyCLR_Display_Controller* self, uint32_t orientation) {
+    if (orientation > STM32F4xx_LCD_Rotation::rotateCCW_90)
+        return TinyCLR_Result::ArgumentOutOfRange;
 
+    STM32F4_Display_WaitForCompletion();
 
-    int32_t screenWidth = m_STM32F4_DisplayWidth;
-    int32_t screenHeight = m_STM32F4_DisplayHeight;
-    int32_t startPx, toAddition;
+    m_STM32F4_Display_CurrentRotation = static_cast<STM32F4xx_LCD_Rotation>(orientation);
+
+    return TinyCLR_Result::Success;
+}
+
+static void STM32F4_Display_WaitForDma2d() {
+#if defined(DMA2D)
+    while ((DMA2D->CR & DMA2D_CR_START) != 0);
+#endif
+}
+
+// DMA2D fills and blends run while the CLR continues, and a flipped away buffer is scanned until the next
+// vertical blanking. Anything that touches the frame buffer waits here first.
+void STM32F4_Display_WaitForCompletion() {
+    STM32F4_Display_WaitForDma2d();
+
+    while (m_STM32F4_Display_FlipPending && (LTDC->SRCR & LTDC_SRCR_VBR) != 0);
+}
+
+void STM32F4_Display_InterruptHandler(void* param) {
+    LTDC->ICR = LTDC_ICR_CRRIF;
+
+    if (m_STM32F4_Display_FlipPending) {
+        m_STM32F4_Display_FlipPending = false;
+
+        if (m_STM32F4_Display_FlipHandler != nullptr)
+            m_STM32F4_Display_FlipHandler(m_STM32F4_Display_FlipHandlerContext);
+    }
+}
+
+// The layer reads its new address at the next vertical blanking
+void STM32F4_Display_ShowBuffer(uint16_t* ram) {
+    m_STM32F4_Display_ShownRam = ram;
 
     if (m_STM32F4_DisplayEnable == false)
         return;
 
-    switch (m_STM32F4_Display_CurrentRotation) {
-    case STM32F4xx_LCD_Rotation::rotateNormal_0:
+    m_STM32F4_Display_FlipPending = true;
 
-        if (xOffset == 0 && yOffset == 0 &&
-            width == screenWidth && height == screenHeight) {
-            memcpy(to, from, (screenWidth*screenHeight * 2));
-        }
-        else {
-            for (yTo = yOffset; yTo < (yOffset + height); yTo++) {
-                memcpy((void*)(to + yTo * screenWidth + xOffset), (void*)(from), (width * 2));
-                from += width;
-            }
-        }
+    // Layer index 0, the one STM32F4_Display_Initialize sets up for the frame buffer
+    LTDC_Layer1->CFBAR = reinterpret_cast<uint32_t>(ram);
+    LTDC->IER |= LTDC_IER_RRIE;
+    LTDC->SRCR = LTDC_SRCR_VBR;
+}
 
-        break;
+#if defined(DMA2D)
+bool STM32F4_Display_Dma2dIsReachable(const void* address) {
+#if defined(CCMDATARAM_BASE)
+    // The CCM data RAM is on the CPU data bus only
+    auto a = reinterpret_cast<uint32_t>(address);
 
-    case STM32F4xx_LCD_Rotation::rotateCCW_90:
+    if (a >= CCMDATARAM_BASE && a < CCMDATARAM_BASE + 0x10000)
+        return false;
+#endif
 
-        startPx = yOffset * screenHeight;
-        xFrom = xOffset + width;
-        yTo = screenHeight - xOffset - width;
-        xTo = yOffset;
-        to += yTo * screenWidth + xTo;
-        toAddition = screenWidth - height;
+    return true;
+}
 
-        for (; yTo < (screenHeight - xOffset); yTo++) {
-            xFrom--;
-            yFrom = startPx + xFrom;
+// DMA2D has no L8 output, callers check for it
+uint32_t STM32F4_Display_Dma2dColorMode(DisplayFormat_PixelFormat format) {
+    switch (format) {
+    case DisplayFormat_PixelFormat::Rgb888:
+        return STM32F4_DISPLAY_DMA2D_COLOR_MODE_RGB888;
 
-            for (xTo = yOffset; xTo < (yOffset + height); xTo++) {
-                *to++ = from[yFrom];
-                yFrom += screenHeight;
-            }
+    case DisplayFormat_PixelFormat::Argb8888:
+        return STM32F4_DISPLAY_DMA2D_COLOR_MODE_ARGB8888;
 
-            to += toAddition;
-        }
+    default:
+        return STM32F4_DISPLAY_DMA2D_COLOR_MODE_RGB565;
+    }
+}
 
-        break;
+// The output is always the frame buffer, in its format
+void STM32F4_Display_Dma2dStart(uint32_t mode, void* to, uint32_t toOffset, uint32_t width, uint32_t height) {
+    DMA2D->IFCR = DMA2D_IFCR_CTEIF | DMA2D_IFCR_CTCIF | DMA2D_IFCR_CCEIF;
 
-    case STM32F4xx_LCD_Rotation::rotateCW_90:
+    DMA2D->OPFCCR = STM32F4_Display_Dma2dColorMode(m_STM32F4_Display_PixelFormat);
+    DMA2D->OMAR = reinterpret_cast<uint32_t>(to);
+    DMA2D->OOR = toOffset;
+    DMA2D->NLR = (width << 16) | height;
 
-        startPx = (yOffset + height - 1) * screenHeight;
-        xFrom = xOffset;
+    DMA2D->CR = mode | DMA2D_CR_START;
+}
+#endif
 
-        yTo = xOffset;
-        xTo = screenWidth - yOffset - height;
-        to += yTo * screenWidth + xTo;
-        toAddition = screenWidth - height;
+// Offsets are the number of pixels skipped at the end of each line. These return false when DMA2D can't do the
+// transfer and the caller has to use the CPU. A copy converts from format to the frame buffer format.
+bool STM32F4_Display_Dma2dCopy(const void* from, DisplayFormat_PixelFormat format, uint32_t fromOffset, void* to, uint32_t toOffset, uint32_t width, uint32_t height) {
+#if defined(DMA2D)
+    if (!STM32F4_Display_Dma2dIsReachable(from) || format == DisplayFormat_PixelFormat::L8 || m_STM32F4_Display_PixelFormat == DisplayFormat_PixelFormat::L8)
+        return false;
 
-        for (; yTo < (xOffset + width); yTo++) {
-            yFrom = startPx + xFrom;
+    DMA2D->FGMAR = reinterpret_cast<uint32_t>(from);
+    DMA2D->FGOR = fromOffset;
+    DMA2D->FGPFCCR = STM32F4_Display_Dma2dColorMode(format);
 
-            for (xTo = screenWidth - yOffset - height; xTo < (screenWidth - yOffset); xTo++) {
-                *to++ = from[yFrom];
-                yFrom -= screenHeight;
-            }
+    STM32F4_Display_Dma2dStart(format == m_STM32F4_Display_PixelFormat ? STM32F4_DISPLAY_DMA2D_MODE_MEMORY_TO_MEMORY : STM32F4_DISPLAY_DMA2D_MODE_MEMORY_TO_MEMORY_PFC, to, toOffset, width, height);
 
-            to += toAddition;
-            xFrom++;
-        }
+    return true;
+#else
+    return false;
+#endif
+}
 
-        break;
+bool STM32F4_Display_Dma2dFill(void* to, uint32_t toOffset, uint32_t width, uint32_t height, uint32_t color) {
+#if defined(DMA2D)
+    if (m_STM32F4_Display_PixelFormat == DisplayFormat_PixelFormat::L8)
+        return false;
 
-    case STM32F4xx_LCD_Rotation::rotate_180:
+    DMA2D->OCOLR = color;
 
-        xFrom = (yOffset + height - 1) * screenWidth + xOffset + width;
+    STM32F4_Display_Dma2dStart(STM32F4_DISPLAY_DMA2D_MODE_REGISTER_TO_MEMORY, to, toOffset, width, height);
 
-        yTo = screenHeight - yOffset - height;
-        xTo = screenWidth - xOffset - width;
-        to += yTo * screenWidth + xTo;
-        toAddition = screenWidth - width;
+    return true;
+#else
+    return false;
+#endif
+}
 
-        for (; yTo < (screenHeight - yOffset); yTo++) {
+// alpha is an 8 bit coverage mask that color is blended into the frame buffer through, with color's own alpha
+// applied on top
+bool STM32F4_Display_Dma2dBlend(const uint8_t* alpha, uint32_t alphaOffset, void* to, uint32_t toOffset, uint32_t width, uint32_t height, uint32_t color) {
+#if defined(DMA2D)
+    if (!STM32F4_Display_Dma2dIsReachable(alpha) || m_STM32F4_Display_PixelFormat == DisplayFormat_PixelFormat::L8)
+        return false;
 
-            for (xTo = screenWidth - xOffset - width; xTo < (screenWidth - xOffset); xTo++) {
-                xFrom--;
-                *to++ = from[xFrom];
-            }
+    DMA2D->FGMAR = reinterpret_cast<uint32_t>(alpha);
+    DMA2D->FGOR = alphaOffset;
+    DMA2D->FGPFCCR = (color & 0xFF000000) | STM32F4_DISPLAY_DMA2D_ALPHA_MODE_MULTIPLY | STM32F4_DISPLAY_DMA2D_COLOR_MODE_A8;
+    DMA2D->FGCOLR = color & 0x00FFFFFF;
 
-            to += toAddition;
-            xFrom -= toAddition;
-        }
+    DMA2D->BGMAR = reinterpret_cast<uint32_t>(to);
+    DMA2D->BGOR = toOffset;
+    DMA2D->BGPFCCR = STM32F4_Display_Dma2dColorMode(m_STM32F4_Display_PixelFormat);
 
-        break;
+    STM32F4_Display_Dma2dStart(STM32F4_DISPLAY_DMA2D_MODE_MEMORY_TO_MEMORY_BLEND, to, toOffset, width, height);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void STM32F4_Display_BitBltEx(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t data[]) {
+    int32_t screenWidth = m_STM32F4_DisplayWidth;
+    int32_t screenHeight = m_STM32F4_DisplayHeight;
+    const uint16_t* from = reinterpret_cast<const uint16_t*>(data);
+    uint16_t* to = m_STM32F4_Display_VituralRam;
+
+    if (m_STM32F4_DisplayEnable == false || width <= 0 || height <= 0)
+        return;
+
+    if (m_STM32F4_Display_PixelFormat != DisplayFormat_PixelFormat::Rgb565) {
+        STM32F4_Display_BitBltConvert(x, y, width, height, reinterpret_cast<const uint8_t*>(data), DisplayFormat_PixelFormat::Rgb565);
+
+        return;
     }
 
+    STM32F4_Display_WaitForCompletion();
+
+    if (m_STM32F4_Display_CurrentRotation == STM32F4xx_LCD_Rotation::rotateNormal_0 && STM32F4_Display_Dma2dCopy(from, DisplayFormat_PixelFormat::Rgb565, 0, to + y * screenWidth + x, screenWidth - width, width, height))
+        return;
+
+    DisplayRotation_Draw(static_cast<DisplayRotation_Orientation>(m_STM32F4_Display_CurrentRotation), from, to, screenWidth, screenHeight, x, y, width, height);
+}
+
+// Same as BitBltEx, except that an unrotated source is a whole frame as well, as the rotated ones already are
+void STM32F4_Display_BitBltRegion(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t* data) {
+    if (m_STM32F4_Display_CurrentRotation != STM32F4xx_LCD_Rotation::rotateNormal_0) {
+        STM32F4_Display_BitBltEx(x, y, width, height, (uint32_t*)data);
+
+        return;
+    }
+
+    int32_t screenWidth = m_STM32F4_DisplayWidth;
+    auto bytesPerPixel = DisplayFormat_GetBytesPerPixel(m_STM32F4_Display_PixelFormat);
+    const uint16_t* from = data + y * screenWidth + x;
+    uint8_t* to = STM32F4_Display_GetPixelAddress(m_STM32F4_Display_VituralRam, x, y);
+
+    if (m_STM32F4_DisplayEnable == false || width <= 0 || height <= 0)
+        return;
+
+    STM32F4_Display_WaitForCompletion();
+
+    if (STM32F4_Display_Dma2dCopy(from, DisplayFormat_PixelFormat::Rgb565, screenWidth - width, to, screenWidth - width, width, height))
+        return;
+
+    if (m_STM32F4_Display_PixelFormat != DisplayFormat_PixelFormat::Rgb565) {
+        DisplayFormat_Convert(reinterpret_cast<const uint8_t*>(from), DisplayFormat_PixelFormat::Rgb565, screenWidth * 2, to, m_STM32F4_Display_PixelFormat, screenWidth * bytesPerPixel, width, height, m_STM32F4_Display_Palette);
+
+        return;
+    }
+
+    for (auto row = 0; row < height; row++) {
+        memcpy(to, from, width * 2);
+
+        from += screenWidth;
+        to += screenWidth * 2;
+    }
+}
+
+// Draws data of any format into a frame buffer of any format. As with BitBltEx the source is packed when unrotated
+// and a whole frame in the current orientation otherwise. The rotated paths go a pixel at a time.
+void STM32F4_Display_BitBltConvert(int32_t x, int32_t y, int32_t width, int32_t height, const uint8_t* data, DisplayFormat_PixelFormat format) {
+    int32_t screenWidth = m_STM32F4_DisplayWidth;
+    int32_t screenHeight = m_STM32F4_DisplayHeight;
+    auto fromBytesPerPixel = DisplayFormat_GetBytesPerPixel(format);
+    auto toBytesPerPixel = DisplayFormat_GetBytesPerPixel(m_STM32F4_Display_PixelFormat);
+
+    if (m_STM32F4_DisplayEnable == false || width <= 0 || height <= 0 || fromBytesPerPixel == 0)
+        return;
+
+    STM32F4_Display_WaitForCompletion();
+
+    if (m_STM32F4_Display_CurrentRotation == STM32F4xx_LCD_Rotation::rotateNormal_0) {
+        auto to = STM32F4_Display_GetPixelAddress(m_STM32F4_Display_VituralRam, x, y);
+
+        if (!STM32F4_Display_Dma2dCopy(data, format, 0, to, screenWidth - width, width, height))
+            DisplayFormat_Convert(data, format, width * fromBytesPerPixel, to, m_STM32F4_Display_PixelFormat, screenWidth * toBytesPerPixel, width, height, m_STM32F4_Display_Palette);
+
+        return;
+    }
+
+    DisplayFormat_ConvertRotated(data, format, reinterpret_cast<uint8_t*>(m_STM32F4_Display_VituralRam), m_STM32F4_Display_PixelFormat, static_cast<DisplayRotation_Orientation>(m_STM32F4_Display_CurrentRotation), screenWidth, screenHeight, x, y, width, height, m_STM32F4_Display_Palette);
 }
 
 void STM32F4_Display_WriteChar(uint8_t c, int32_t row, int32_t col) {
@@ -1092,6 +1404,18 @@ TinyCLR_Result STM32F4_Display_Release(const TinyCLR_Display_Controller* self) {
 
             m_STM32F4_Display_buffer = nullptr;
         }
+
+        if (m_STM32F4_Display_SecondBuffer != nullptr) {
+            auto memoryProvider = (const TinyCLR_Memory_Manager*)apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager);
+
+            memoryProvider->Free(memoryProvider, m_STM32F4_Display_SecondBuffer);
+
+            m_STM32F4_Display_SecondBuffer = nullptr;
+        }
+
+        m_STM32F4_Display_VituralRam = nullptr;
+        m_STM32F4_Display_ShownRam = nullptr;
+        m_STM32F4_Display_OverlayEnable = false;
     }
 
     return TinyCLR_Result::Success;
@@ -1115,9 +1439,42 @@ TinyCLR_Result STM32F4_Display_Disable(const TinyCLR_Display_Controller* self) {
     return TinyCLR_Result::Success;
 }
 
+// Replaces both buffers by a single one of m_STM32F4_DisplayBufferSize, whatever was drawn is lost
+TinyCLR_Result STM32F4_Display_AllocateBuffer() {
+    auto memoryProvider = (const TinyCLR_Memory_Manager*)apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager);
+
+    if (m_STM32F4_Display_buffer != nullptr) {
+        memoryProvider->Free(memoryProvider, m_STM32F4_Display_buffer);
+
+        m_STM32F4_Display_buffer = nullptr;
+    }
+
+    if (m_STM32F4_Display_SecondBuffer != nullptr) {
+        memoryProvider->Free(memoryProvider, m_STM32F4_Display_SecondBuffer);
+
+        m_STM32F4_Display_SecondBuffer = nullptr;
+    }
+
+    m_STM32F4_Display_buffer = (uint32_t*)memoryProvider->Allocate(memoryProvider, m_STM32F4_DisplayBufferSize + 8);
+
+    if (m_STM32F4_Display_buffer == nullptr) {
+        m_STM32F4_Display_VituralRam = nullptr;
+        m_STM32F4_Display_ShownRam = nullptr;
+
+        return TinyCLR_Result::OutOfMemory;
+    }
+
+    m_STM32F4_Display_VituralRam = (uint16_t*)((((uint32_t)m_STM32F4_Display_buffer) + (7)) & (~((uint32_t)(7))));
+    m_STM32F4_Display_ShownRam = m_STM32F4_Display_VituralRam;
+
+    return TinyCLR_Result::Success;
+}
+
 TinyCLR_Result STM32F4_Display_SetConfiguration(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat dataFormat, uint32_t width, uint32_t height, const void* configuration) {
     if (dataFormat != TinyCLR_Display_DataFormat::Rgb565) return TinyCLR_Result::NotSupported;
 
+    STM32F4_Display_WaitForCompletion();
+
     m_STM32F4_DisplayWidth = width;
     m_STM32F4_DisplayHeight = height;
 
@@ -1142,31 +1499,12 @@ TinyCLR_Result STM32F4_Display_SetConfiguration(const TinyCLR_Display_Controller
         m_STM32F4_DisplayVerticalFrontPorch = cfg.VerticalFrontPorch;
         m_STM32F4_DisplayVerticalBackPorch = cfg.VerticalBackPorch;
 
-        switch (dataFormat) {
-        case TinyCLR_Display_DataFormat::Rgb565:
-            m_STM32F4_DisplayBufferSize = width * height * 2;
-            break;
-
-        default:
-            // TODO 8 - 24 - 32 bits
-            break;
-        }
-
-        auto memoryProvider = (const TinyCLR_Memory_Manager*)apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager);
-
-        if (m_STM32F4_Display_buffer != nullptr) {
-            memoryProvider->Free(memoryProvider, m_STM32F4_Display_buffer);
-
-            m_STM32F4_Display_buffer = nullptr;
-        }
+        m_STM32F4_DisplayBufferSize = width * height * DisplayFormat_GetBytesPerPixel(m_STM32F4_Display_PixelFormat);
 
-        m_STM32F4_Display_buffer = (uint32_t*)memoryProvider->Allocate(memoryProvider, m_STM32F4_DisplayBufferSize + 8);
-
-        if (m_STM32F4_Display_buffer == nullptr) {
-            return TinyCLR_Result::OutOfMemory;
-        }
+        auto result = STM32F4_Display_AllocateBuffer();
 
-        m_STM32F4_Display_VituralRam = (uint16_t*)((((uint32_t)m_STM32F4_Display_buffer) + (7)) & (~((uint32_t)(7))));
+        if (result != TinyCLR_Result::Success)
+            return result;
 
         // Set displayPins.enable following m_STM32F4_DisplayOutputEnableIsFixed
         if (displayPins.enable.number != PIN_NONE) {
@@ -1215,20 +1553,401 @@ TinyCLR_Result STM32F4_Display_GetConfiguration(const TinyCLR_Display_Controller
     return TinyCLR_Result::InvalidOperation;
 }
 
+// The data usually lives in a managed buffer the GC may move or free once this returns, so a DMA2D copy out of it
+// is waited for here rather than left running.
 TinyCLR_Result STM32F4_Display_DrawBuffer(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data) {
     STM32F4_Display_BitBltEx(x, y, width, height, (uint32_t*)data);
+    STM32F4_Display_WaitForDma2d();
+
+    return TinyCLR_Result::Success;
+}
+
+// Same as DrawBuffer for data in any format, converted to the frame buffer format while drawn. L8 data is looked
+// up in the palette unless the frame buffer is L8 as well.
+TinyCLR_Result STM32F4_Display_DrawBufferFormat(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data, DisplayFormat_PixelFormat format) {
+    if (DisplayFormat_GetBytesPerPixel(format) == 0)
+        return TinyCLR_Result::NotSupported;
+
+    if (format == DisplayFormat_PixelFormat::Rgb565)
+        STM32F4_Display_BitBltEx(x, y, width, height, (uint32_t*)data);
+    else
+        STM32F4_Display_BitBltConvert(x, y, width, height, data, format);
+
+    STM32F4_Display_WaitForDma2d();
+
+    return TinyCLR_Result::Success;
+}
+
+// Takes effect at the next Enable, so the display must be disabled. A configured buffer is reallocated for the
+// new size, which also ends double buffering.
+TinyCLR_Result STM32F4_Display_SetPixelFormat(const TinyCLR_Display_Controller* self, DisplayFormat_PixelFormat format) {
+    if (DisplayFormat_GetBytesPerPixel(format) == 0)
+        return TinyCLR_Result::NotSupported;
+
+    if (m_STM32F4_DisplayEnable)
+        return TinyCLR_Result::InvalidOperation;
+
+    if (format == m_STM32F4_Display_PixelFormat)
+        return TinyCLR_Result::Success;
+
+    m_STM32F4_Display_PixelFormat = format;
+
+    if (m_STM32F4_Display_buffer == nullptr)
+        return TinyCLR_Result::Success;
+
+    m_STM32F4_DisplayBufferSize = m_STM32F4_DisplayWidth * m_STM32F4_DisplayHeight * DisplayFormat_GetBytesPerPixel(format);
+
+    return STM32F4_Display_AllocateBuffer();
+}
+
+// Colors are Argb8888 with the alpha ignored. They are looked up by an L8 frame buffer and by L8 data drawn into
+// other formats.
+TinyCLR_Result STM32F4_Display_SetPalette(const TinyCLR_Display_Controller* self, uint32_t index, const uint32_t* colors, size_t count) {
+    if (colors == nullptr || index >= DISPLAY_FORMAT_PALETTE_SIZE || count > DISPLAY_FORMAT_PALETTE_SIZE - index)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    memcpy(&m_STM32F4_Display_Palette[index], colors, count * sizeof(uint32_t));
+
+    if (m_STM32F4_DisplayEnable && m_STM32F4_Display_PixelFormat == DisplayFormat_PixelFormat::L8)
+        STM32F4_Display_LoadPalette(LTDC_Layer1, index, count);
+
+    if (m_STM32F4_DisplayEnable && m_STM32F4_Display_OverlayEnable && m_STM32F4_Display_Overlay.Format == DisplayFormat_PixelFormat::L8)
+        STM32F4_Display_LoadPalette(LTDC_Layer2, index, count);
+
+    return TinyCLR_Result::Success;
+}
+
+// Shows buffer on top of the frame buffer from the next vertical blanking on, or moves and restyles an overlay
+// already shown. The buffer belongs to the caller and is scanned directly, drawing into it shows right away.
+// Coordinates are on the panel, unrotated, and may put part of the overlay off screen.
+TinyCLR_Result STM32F4_Display_SetOverlay(const TinyCLR_Display_Controller* self, const STM32F4_Display_OverlayConfiguration& configuration) {
+    if (configuration.Buffer == nullptr || configuration.Width == 0 || configuration.Height == 0 || DisplayFormat_GetBytesPerPixel(configuration.Format) == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    m_STM32F4_Display_Overlay = configuration;
+    m_STM32F4_Display_OverlayEnable = true;
+
+    if (m_STM32F4_DisplayEnable) {
+        STM32F4_Display_ConfigureOverlay();
+
+        LTDC->SRCR = LTDC_SRCR_VBR;
+    }
+
+    return TinyCLR_Result::Success;
+}
+
+// Only the window changes, which is all a cursor needs per frame
+TinyCLR_Result STM32F4_Display_MoveOverlay(const TinyCLR_Display_Controller* self, int32_t x, int32_t y) {
+    if (m_STM32F4_Display_OverlayEnable == false)
+        return TinyCLR_Result::InvalidOperation;
+
+    m_STM32F4_Display_Overlay.X = x;
+    m_STM32F4_Display_Overlay.Y = y;
+
+    if (m_STM32F4_DisplayEnable) {
+        STM32F4_Display_ConfigureOverlay();
+
+        LTDC->SRCR = LTDC_SRCR_VBR;
+    }
+
     return TinyCLR_Result::Success;
 }
 
+// The buffer is no longer read once the next vertical blanking has passed
+TinyCLR_Result STM32F4_Display_DisableOverlay(const TinyCLR_Display_Controller* self) {
+    m_STM32F4_Display_OverlayEnable = false;
+
+    if (m_STM32F4_DisplayEnable) {
+        STM32F4_Display_ConfigureOverlay();
+
+        LTDC->SRCR = LTDC_SRCR_VBR;
+    }
+
+    return TinyCLR_Result::Success;
+}
+
+// data is a whole frame in the current orientation, only the given rectangles of it are copied
+TinyCLR_Result STM32F4_Display_DrawBufferRegions(const TinyCLR_Display_Controller* self, const uint8_t* data, const DisplayRegion_Rectangle* rectangles, size_t count) {
+    DisplayRegion region;
+    int32_t width = m_STM32F4_DisplayWidth;
+    int32_t height = m_STM32F4_DisplayHeight;
+
+    if (m_STM32F4_DisplayEnable == false)
+        return TinyCLR_Result::InvalidOperation;
+
+    STM32F4_Display_GetRotatedDimensions(&width, &height);
+
+    DisplayRegion_Reset(region, width, height);
+
+    for (size_t i = 0; i < count; i++)
+        DisplayRegion_Add(region, rectangles[i].X, rectangles[i].Y, rectangles[i].Width, rectangles[i].Height);
+
+    for (size_t i = 0; i < region.count; i++) {
+        auto& rectangle = region.rectangles[i];
+
+        STM32F4_Display_BitBltRegion(rectangle.X, rectangle.Y, rectangle.Width, rectangle.Height, reinterpret_cast<const uint16_t*>(data));
+    }
+
+    // As in DrawBuffer, the caller's data must not be read after this returns
+    STM32F4_Display_WaitForDma2d();
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result STM32F4_Display_SetDoubleBuffering(const TinyCLR_Display_Controller* self, bool enable) {
+    auto memoryProvider = (const TinyCLR_Memory_Manager*)apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager);
+
+    if (m_STM32F4_Display_buffer == nullptr)
+        return TinyCLR_Result::InvalidOperation;
+
+    STM32F4_Display_WaitForCompletion();
+
+    if (enable) {
+        if (m_STM32F4_Display_SecondBuffer != nullptr)
+            return TinyCLR_Result::Success;
+
+        m_STM32F4_Display_SecondBuffer = (uint32_t*)memoryProvider->Allocate(memoryProvider, m_STM32F4_DisplayBufferSize + 8);
+
+        if (m_STM32F4_Display_SecondBuffer == nullptr)
+            return TinyCLR_Result::OutOfMemory;
+
+        // Start from what is shown so that partial draws stay consistent
+        m_STM32F4_Display_VituralRam = (uint16_t*)((((uint32_t)m_STM32F4_Display_SecondBuffer) + (7)) & (~((uint32_t)(7))));
+
+        memcpy(m_STM32F4_Display_VituralRam, m_STM32F4_Display_ShownRam, m_STM32F4_DisplayBufferSize);
+    }
+    else {
+        if (m_STM32F4_Display_SecondBuffer == nullptr)
+            return TinyCLR_Result::Success;
+
+        auto ram = (uint16_t*)((((uint32_t)m_STM32F4_Display_buffer) + (7)) & (~((uint32_t)(7))));
+
+        if (m_STM32F4_Display_ShownRam != ram) {
+            memcpy(ram, m_STM32F4_Display_ShownRam, m_STM32F4_DisplayBufferSize);
+
+            STM32F4_Display_ShowBuffer(ram);
+            STM32F4_Display_WaitForCompletion();
+        }
+
+        m_STM32F4_Display_VituralRam = ram;
+
+        memoryProvider->Free(memoryProvider, m_STM32F4_Display_SecondBuffer);
+
+        m_STM32F4_Display_SecondBuffer = nullptr;
+    }
+
+    return TinyCLR_Result::Success;
+}
+
+// Shows the buffer drawn so far from the next vertical blanking on. The previously shown buffer is drawn into next
+// and still holds the frame before, draws wait until it is no longer scanned.
+TinyCLR_Result STM32F4_Display_Flip(const TinyCLR_Display_Controller* self) {
+    if (m_STM32F4_DisplayEnable == false || m_STM32F4_Display_SecondBuffer == nullptr)
+        return TinyCLR_Result::InvalidOperation;
+
+    STM32F4_Display_WaitForCompletion();
+
+    auto shown = m_STM32F4_Display_ShownRam;
+
+    STM32F4_Display_ShowBuffer(m_STM32F4_Display_VituralRam);
+
+    m_STM32F4_Display_VituralRam = shown;
+
+    return TinyCLR_Result::Success;
+}
+
+// Called from the vertical blanking interrupt once a flip is shown
+TinyCLR_Result STM32F4_Display_SetFlipHandler(const TinyCLR_Display_Controller* self, STM32F4_Display_FlipHandler handler, void* context) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    m_STM32F4_Display_FlipHandler = handler;
+    m_STM32F4_Display_FlipHandlerContext = context;
+
+    return TinyCLR_Result::Success;
+}
+
+// color is the raw pixel value in the frame buffer format
 TinyCLR_Result STM32F4_Display_DrawPixel(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint64_t color) {
-    volatile uint16_t * loc;
+    uint8_t* loc;
 
     if (m_STM32F4_DisplayEnable == false || x >= m_STM32F4_DisplayWidth || y >= m_STM32F4_DisplayHeight)
         return TinyCLR_Result::InvalidOperation;
 
-    loc = m_STM32F4_Display_VituralRam + (y *m_STM32F4_DisplayWidth) + (x);
+    STM32F4_Display_WaitForCompletion();
+
+    loc = STM32F4_Display_GetPixelAddress(m_STM32F4_Display_VituralRam, x, y);
 
-    *loc = static_cast<uint16_t>(color & 0xFFFF);
+    DisplayFormat_StorePixel(loc, m_STM32F4_Display_PixelFormat, static_cast<uint32_t>(color));
+
+    return TinyCLR_Result::Success;
+}
+
+// color is the raw pixel value in the frame buffer format
+TinyCLR_Result STM32F4_Display_FillRectangle(const TinyCLR_Display_Controller* self, int32_t x, int32_t y, int32_t width, int32_t height, uint64_t color) {
+    int32_t screenWidth = m_STM32F4_DisplayWidth;
+    int32_t screenHeight = m_STM32F4_DisplayHeight;
+    int32_t logicalWidth = screenWidth;
+    int32_t logicalHeight = screenHeight;
+
+    if (m_STM32F4_DisplayEnable == false)
+        return TinyCLR_Result::InvalidOperation;
+
+    STM32F4_Display_GetRotatedDimensions(&logicalWidth, &logicalHeight);
+
+    if (x < 0) {
+        width += x;
+        x = 0;
+    }
+
+    if (y < 0) {
+        height += y;
+        y = 0;
+    }
+
+    if (x + width > logicalWidth)
+        width = logicalWidth - x;
+
+    if (y + height > logicalHeight)
+        height = logicalHeight - y;
+
+    if (width <= 0 || height <= 0)
+        return TinyCLR_Result::Success;
+
+    int32_t toX = x;
+    int32_t toY = y;
+    int32_t toWidth = width;
+    int32_t toHeight = height;
+
+    switch (m_STM32F4_Display_CurrentRotation) {
+    case STM32F4xx_LCD_Rotation::rotateNormal_0:
+        break;
+
+    case STM32F4xx_LCD_Rotation::rotateCCW_90:
+        toX = y;
+        toY = screenHeight - x - width;
+        toWidth = height;
+        toHeight = width;
+        break;
+
+    case STM32F4xx_LCD_Rotation::rotateCW_90:
+        toX = screenWidth - y - height;
+        toY = x;
+        toWidth = height;
+        toHeight = width;
+        break;
+
+    case STM32F4xx_LCD_Rotation::rotate_180:
+        toX = screenWidth - x - width;
+        toY = screenHeight - y - height;
+        break;
+    }
+
+    auto to = STM32F4_Display_GetPixelAddress(m_STM32F4_Display_VituralRam, toX, toY);
+    auto toOffset = screenWidth - toWidth;
+
+    STM32F4_Display_WaitForCompletion();
+
+    if (!STM32F4_Display_Dma2dFill(to, toOffset, toWidth, toHeight, static_cast<uint32_t>(color)))
+        DisplayFormat_Fill(to, m_STM32F4_Display_PixelFormat, screenWidth * DisplayFormat_GetBytesPerPixel(m_STM32F4_Display_PixelFormat), toWidth, toHeight, static_cast<uint32_t>(color));
+
+    return TinyCLR_Result::Success;
+}
+
+// x and y are in screen coordinates and the glyph is clipped to the screen. An upright frame buffer is blended
+// into by DMA2D, a rotated one a pixel at a time.
+void STM32F4_Display_DrawGlyph(const GlyphCache_Glyph& glyph, int32_t x, int32_t y, void* context) {
+    auto color = *reinterpret_cast<const uint32_t*>(context);
+    auto alpha = glyph.Alpha;
+    auto alphaStride = static_cast<int32_t>(glyph.Metrics.Width);
+    int32_t width = glyph.Metrics.Width;
+    int32_t height = glyph.Metrics.Height;
+    int32_t screenWidth = m_STM32F4_DisplayWidth;
+    int32_t screenHeight = m_STM32F4_DisplayHeight;
+    int32_t logicalWidth = screenWidth;
+    int32_t logicalHeight = screenHeight;
+
+    STM32F4_Display_GetRotatedDimensions(&logicalWidth, &logicalHeight);
+
+    if (x < 0) {
+        alpha -= x;
+        width += x;
+        x = 0;
+    }
+
+    if (y < 0) {
+        alpha -= y * alphaStride;
+        height += y;
+        y = 0;
+    }
+
+    if (x + width > logicalWidth)
+        width = logicalWidth - x;
+
+    if (y + height > logicalHeight)
+        height = logicalHeight - y;
+
+    if (width <= 0 || height <= 0)
+        return;
+
+    auto bytesPerPixel = DisplayFormat_GetBytesPerPixel(m_STM32F4_Display_PixelFormat);
+
+    // One transfer at a time, and the previous one may still be blending from another glyph
+    STM32F4_Display_WaitForCompletion();
+
+    if (m_STM32F4_Display_CurrentRotation == STM32F4xx_LCD_Rotation::rotateNormal_0) {
+        auto to = STM32F4_Display_GetPixelAddress(m_STM32F4_Display_VituralRam, x, y);
+
+        if (!STM32F4_Display_Dma2dBlend(alpha, alphaStride - width, to, screenWidth - width, width, height, color))
+            DisplayFormat_BlendMask(to, m_STM32F4_Display_PixelFormat, screenWidth * bytesPerPixel, alpha, alphaStride, width, height, color, m_STM32F4_Display_Palette);
+
+        return;
+    }
+
+    for (auto row = 0; row < height; row++) {
+        for (auto column = 0; column < width; column++) {
+            auto a = alpha[row * alphaStride + column];
+
+            if (a == 0)
+                continue;
+
+            auto toX = x + column;
+            auto toY = y + row;
+
+            switch (m_STM32F4_Display_CurrentRotation) {
+            case STM32F4xx_LCD_Rotation::rotateCCW_90:
+                toX = y + row;
+                toY = screenHeight - 1 - (x + column);
+                break;
+
+            case STM32F4xx_LCD_Rotation::rotateCW_90:
+                toX = screenWidth - 1 - (y + row);
+                toY = x + column;
+                break;
+
+            case STM32F4xx_LCD_Rotation::rotate_180:
+                toX = screenWidth - 1 - (x + column);
+                toY = screenHeight - 1 - (y + row);
+                break;
+
+            default:
+                break;
+            }
+
+            DisplayFormat_BlendPixel(STM32F4_Display_GetPixelAddress(m_STM32F4_Display_VituralRam, toX, toY), m_STM32F4_Display_PixelFormat, m_STM32F4_Display_Palette, color, a);
+        }
+    }
+}
+
+// Draws text through the glyph cache from the top left of its first line at x, y in screen coordinates. color is
+// Argb8888, its alpha fades the whole text. The cache buffer may be read until STM32F4_Display_WaitForCompletion.
+TinyCLR_Result STM32F4_Display_DrawText(const TinyCLR_Display_Controller* self, GlyphCache& cache, int32_t x, int32_t y, const char* text, size_t length, uint32_t color) {
+    if (text == nullptr && length > 0)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (m_STM32F4_DisplayEnable == false)
+        return TinyCLR_Result::InvalidOperation;
+
+    GlyphCache_DrawString(cache, text, length, x, y, &STM32F4_Display_DrawGlyph, &color);
 
     return TinyCLR_Result::Success;
 }
@@ -1280,7 +1999,13 @@ void STM32F4_Display_AddApi(const TinyCLR_Api_Manager* apiManager) {
 
     displayInitializeCount = 0;
     m_STM32F4_Display_buffer = nullptr;
+    m_STM32F4_Display_SecondBuffer = nullptr;
+    m_STM32F4_Display_FlipHandler = nullptr;
     m_STM32F4_DisplayEnable = false;
+    m_STM32F4_Display_PixelFormat = DisplayFormat_PixelFormat::Rgb565;
+    m_STM32F4_Display_OverlayEnable = false;
+
+    DisplayFormat_GetDefaultPalette(m_STM32F4_Display_Palette);
 
     apiManager->SetDefaultName(apiManager, TinyCLR_Api_Type::DisplayController, displayApi[0].Name);
 }
@@ -1294,6 +2019,12 @@ void STM32F4_Display_Reset() {
     m_STM32F4_DisplayEnable = false;
     displayInitializeCount = 0;
     m_STM32F4_Display_buffer = nullptr;
+    m_STM32F4_Display_SecondBuffer = nullptr;
+    m_STM32F4_Display_FlipHandler = nullptr;
+    m_STM32F4_Display_PixelFormat = DisplayFormat_PixelFormat::Rgb565;
+    m_STM32F4_Display_OverlayEnable = false;
+
+    DisplayFormat_GetDefaultPalette(m_STM32F4_Display_Palette);
 
     m_STM32F4_Display_TextRow = 0;
     m_STM32F4_Display_TextColumn = 0;
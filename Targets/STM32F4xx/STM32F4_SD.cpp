@@ -1082,10 +1082,30 @@ SDTransferState SD_GetTransferState(void);
 SD_Error SD_StopTransfer(void);
 SD_Error SD_SendStatus(uint32_t *pcardstatus);
 SD_Error SD_SendSDStatus(uint32_t *psdstatus);
+SD_Error SD_EnableHighSpeed(void);
+void SD_SetBusClock(uint32_t clockHz);
+bool SD_LowerBusClock(void);
 
 #define SDIO_FIFO_ADDRESS                ((uint32_t)0x40012C80)
 #define SDIO_INIT_CLK_DIV                ((uint8_t)0x76)
 #define SDIO_TRANSFER_CLK_DIV            ((uint8_t)0x2)
+
+#ifndef STM32F4_SD_SDIO_CLOCK_HZ
+#define STM32F4_SD_SDIO_CLOCK_HZ         48000000 /*!< SDIOCLK, taken from the 48MHz PLL output */
+#endif
+
+#ifndef STM32F4_SD_MAX_BUS_CLOCK_HZ
+#define STM32F4_SD_MAX_BUS_CLOCK_HZ      48000000 /*!< Max. SDIO_CK allowed by the datasheet */
+#endif
+
+#define SD_DEFAULT_SPEED_CLOCK_HZ        25000000
+#define SD_HIGH_SPEED_CLOCK_HZ           50000000
+#define SD_MIN_TRANSFER_CLOCK_HZ         (STM32F4_SD_SDIO_CLOCK_HZ / (SDIO_TRANSFER_CLK_DIV + 2))
+#define SD_SWITCH_STATUS_LENGTH          64
+#define SD_SWITCH_CHECK_HIGH_SPEED       ((uint32_t)0x00FFFFF1)
+#define SD_SWITCH_SET_HIGH_SPEED         ((uint32_t)0x80FFFFF1)
+#define SD_CCCC_SWITCH                   ((uint32_t)0x00000400)
+
 #define SDIO_STATIC_FLAGS               ((uint32_t)0x000005FF)
 #define SDIO_CMD0TIMEOUT                ((uint32_t)0x00010000)
 
@@ -1148,6 +1168,8 @@ uint32_t StopCondition = 0;
 SD_Error TransferError = SD_OK;
 uint32_t TransferEnd = 0, DMAEndOfTransfer = 0;
 SD_CardInfo SDCardInfo;
+static uint32_t sdBusWide = SDIO_BusWide_1b;
+static uint32_t sdBusClockHz = 0;
 
 static SD_Error CmdError(void);
 static SD_Error CmdResp1Error(uint8_t cmd);
@@ -1157,6 +1179,7 @@ static SD_Error CmdResp2Error(void);
 static SD_Error CmdResp6Error(uint8_t cmd, uint16_t *prca);
 static SD_Error SDEnWideBus(FunctionalState NewState);
 static SD_Error FindSCR(uint16_t rca, uint32_t *pscr);
+static SD_Error SD_SwitchFunction(uint32_t argument, uint8_t *pstatus);
 
 /** @defgroup STM324xG_EVAL_SDIO_SD_Private_Functions
   * @{
@@ -1214,6 +1237,11 @@ SD_Error SD_Init(void) {
         errorstatus = SD_EnableWideBusOperation(SDIO_BusWide_4b);
     }
 
+    if (errorstatus == SD_OK) {
+        /*!< High speed is optional, stay at default speed if the card refuses the switch */
+        SD_SetBusClock(SD_EnableHighSpeed() == SD_OK ? SD_HIGH_SPEED_CLOCK_HZ : SD_DEFAULT_SPEED_CLOCK_HZ);
+    }
+
     return(errorstatus);
 }
 
@@ -1289,6 +1317,9 @@ SD_Error SD_PowerON(void) {
     /*!< SDIO_CK = SDIOCLK / (SDIO_INIT_CLK_DIV + 2) */
     /*!< on STM32F4xx devices, SDIOCLK is fixed to 48MHz */
     /*!< SDIO_CK for initialization should not exceed 400 KHz */
+    sdBusWide = SDIO_BusWide_1b;
+    sdBusClockHz = 0;
+
     SDIO_Init(SDIO_INIT_CLK_DIV, SDIO_ClockPowerSave_Disable, SDIO_ClockBypass_Disable, SDIO_ClockEdge_Rising, SDIO_BusWide_1b, SDIO_HardwareFlowControl_Disable);
 
     /*!< Set Power State to ON */
@@ -1768,6 +1799,8 @@ SD_Error SD_EnableWideBusOperation(uint32_t WideMode) {
                 errorstatus = SDEnWideBus(ENABLE);
 
                 if (SD_OK == errorstatus) {
+                    sdBusWide = SDIO_BusWide_4b;
+
                     /*!< Configure the SDIO peripheral */
                     SDIO_Init(SDIO_TRANSFER_CLK_DIV, SDIO_ClockPowerSave_Disable, SDIO_ClockBypass_Disable, SDIO_ClockEdge_Rising, SDIO_BusWide_4b, SDIO_HardwareFlowControl_Disable);
                 }
@@ -1781,6 +1814,8 @@ SD_Error SD_EnableWideBusOperation(uint32_t WideMode) {
                 errorstatus = SDEnWideBus(DISABLE);
 
                 if (SD_OK == errorstatus) {
+                    sdBusWide = SDIO_BusWide_1b;
+
                     /*!< Configure the SDIO peripheral */
                     SDIO_Init(SDIO_TRANSFER_CLK_DIV, SDIO_ClockPowerSave_Disable, SDIO_ClockBypass_Disable, SDIO_ClockEdge_Rising, SDIO_BusWide_1b, SDIO_HardwareFlowControl_Disable);
                 }
@@ -2654,11 +2689,208 @@ static SD_Error FindSCR(uint16_t rca, uint32_t *pscr) {
     return(errorstatus);
 }
 
+/**
+  * @brief  Switches the card to High Speed timing (CMD6, function group 1).
+  * @note   The SDIO clock is not changed here, see SD_SetBusClock().
+  * @param  None
+  * @retval SD_Error: SD Card Error code.
+  */
+SD_Error SD_EnableHighSpeed(void) {
+    SD_Error errorstatus = SD_OK;
+    uint32_t scr[2] = { 0, 0 };
+    uint32_t switchstatus[SD_SWITCH_STATUS_LENGTH / 4];
+    uint8_t *pstatus = (uint8_t *)switchstatus;
+
+    if ((SDIO_STD_CAPACITY_SD_CARD_V1_1 != CardType) && (SDIO_STD_CAPACITY_SD_CARD_V2_0 != CardType) && (SDIO_HIGH_CAPACITY_SD_CARD != CardType)) {
+        return(SD_UNSUPPORTED_FEATURE);
+    }
+
+    /*!< Card must implement command class 10 (switch) */
+    if ((SDCardInfo.SD_csd.CardComdClasses & SD_CCCC_SWITCH) == SD_ALLZERO) {
+        return(SD_UNSUPPORTED_FEATURE);
+    }
+
+    errorstatus = FindSCR(RCA, scr);
+
+    if (errorstatus != SD_OK) {
+        return(errorstatus);
+    }
+
+    /*!< CMD6 exists from SD physical layer specification 1.10 (SD_SPEC >= 1) */
+    if (((scr[1] >> 24) & 0x0F) == 0) {
+        return(SD_UNSUPPORTED_FEATURE);
+    }
+
+    /*!< Check mode: is function 1 (High Speed) of group 1 supported? */
+    errorstatus = SD_SwitchFunction(SD_SWITCH_CHECK_HIGH_SPEED, pstatus);
+
+    if (errorstatus != SD_OK) {
+        return(errorstatus);
+    }
+
+    if ((pstatus[13] & 0x02) == 0) {
+        return(SD_UNSUPPORTED_FEATURE);
+    }
+
+    /*!< Set mode */
+    errorstatus = SD_SwitchFunction(SD_SWITCH_SET_HIGH_SPEED, pstatus);
+
+    if (errorstatus != SD_OK) {
+        return(errorstatus);
+    }
+
+    if ((pstatus[16] & 0x0F) != 0x01) {
+        return(SD_SWITCH_ERROR);
+    }
+
+    return(errorstatus);
+}
+
+/**
+  * @brief  Programs the SDIO_CK divider for the requested card clock.
+  * @note   The result is clamped to the limit of the peripheral and rounded
+  *         down, the card is never clocked above clockHz.
+  * @param  clockHz: requested card clock in Hz.
+  * @retval None
+  */
+void SD_SetBusClock(uint32_t clockHz) {
+    uint32_t clockDiv = 0;
+    uint32_t clockBypass = SDIO_ClockBypass_Disable;
+
+    if (clockHz > STM32F4_SD_MAX_BUS_CLOCK_HZ)
+        clockHz = STM32F4_SD_MAX_BUS_CLOCK_HZ;
+
+    if (clockHz >= STM32F4_SD_SDIO_CLOCK_HZ) {
+        /*!< SDIO_CK = SDIOCLK */
+        clockBypass = SDIO_ClockBypass_Enable;
+
+        sdBusClockHz = STM32F4_SD_SDIO_CLOCK_HZ;
+    }
+    else {
+        /*!< SDIO_CK = SDIOCLK / (CLKDIV + 2) */
+        clockDiv = (STM32F4_SD_SDIO_CLOCK_HZ + clockHz - 1) / clockHz;
+        clockDiv = clockDiv > 2 ? clockDiv - 2 : 0;
+
+        if (clockDiv > 0xFF)
+            clockDiv = 0xFF;
+
+        sdBusClockHz = STM32F4_SD_SDIO_CLOCK_HZ / (clockDiv + 2);
+    }
+
+    SDIO_Init(clockDiv, SDIO_ClockPowerSave_Disable, clockBypass, SDIO_ClockEdge_Rising, sdBusWide, SDIO_HardwareFlowControl_Disable);
+}
+
+/**
+  * @brief  Halves the card clock after a data CRC error.
+  * @param  None
+  * @retval false if the clock is already at the slowest transfer rate.
+  */
+bool SD_LowerBusClock(void) {
+    if (sdBusClockHz <= SD_MIN_TRANSFER_CLOCK_HZ)
+        return false;
+
+    SD_SetBusClock(sdBusClockHz / 2 > SD_MIN_TRANSFER_CLOCK_HZ ? sdBusClockHz / 2 : SD_MIN_TRANSFER_CLOCK_HZ);
+
+    return true;
+}
+
+/**
+  * @brief  Sends CMD6 SWITCH_FUNC and reads the 512 bits switch status.
+  * @param  argument: CMD6 argument (mode and function per group).
+  * @param  pstatus: pointer to a 64 bytes buffer, 32 bits aligned.
+  * @retval SD_Error: SD Card Error code.
+  */
+static SD_Error SD_SwitchFunction(uint32_t argument, uint8_t *pstatus) {
+    uint32_t index = 0;
+    SD_Error errorstatus = SD_OK;
+    uint32_t *tempbuff = (uint32_t *)pstatus;
+
+    /*!< Set Block Size To 64 Bytes */
+    SDIO_SendCommand(SD_SWITCH_STATUS_LENGTH, SD_CMD_SET_BLOCKLEN, SDIO_Response_Short);
+
+    errorstatus = CmdResp1Error(SD_CMD_SET_BLOCKLEN);
+
+    if (errorstatus != SD_OK) {
+        return(errorstatus);
+    }
+
+    SDIO_DataConfig(SD_SWITCH_STATUS_LENGTH, SDIO_DataBlockSize_64b, SDIO_TransferDir_ToSDIO);
+
+    /*!< Send CMD6 SWITCH_FUNC */
+    SDIO_SendCommand(argument, SD_CMD_HS_SWITCH, SDIO_Response_Short);
+
+    errorstatus = CmdResp1Error(SD_CMD_HS_SWITCH);
+
+    if (errorstatus != SD_OK) {
+        return(errorstatus);
+    }
+
+    uint64_t currentTime = STM32F4_Time_GetCurrentProcessorTime();
+
+    while (!(SDIO->STA & (SDIO_FLAG_RXOVERR | SDIO_FLAG_DCRCFAIL | SDIO_FLAG_DTIMEOUT | SDIO_FLAG_DBCKEND | SDIO_FLAG_STBITERR))) {
+        if (SDIO_GetFlagStatus(SDIO_FLAG_RXDAVL) != RESET && index < SD_SWITCH_STATUS_LENGTH / 4) {
+            *(tempbuff + index) = SDIO_ReadData();
+            index++;
+        }
+
+        if (STM32F4_Time_GetCurrentProcessorTime() - currentTime > sdTimeoutTicks)
+            return(SD_DATA_TIMEOUT);
+    }
+
+    if (SDIO_GetFlagStatus(SDIO_FLAG_DTIMEOUT) != RESET) {
+        SDIO_ClearFlag(SDIO_FLAG_DTIMEOUT);
+        return(SD_DATA_TIMEOUT);
+    }
+    else if (SDIO_GetFlagStatus(SDIO_FLAG_DCRCFAIL) != RESET) {
+        SDIO_ClearFlag(SDIO_FLAG_DCRCFAIL);
+        return(SD_DATA_CRC_FAIL);
+    }
+    else if (SDIO_GetFlagStatus(SDIO_FLAG_RXOVERR) != RESET) {
+        SDIO_ClearFlag(SDIO_FLAG_RXOVERR);
+        return(SD_RX_OVERRUN);
+    }
+    else if (SDIO_GetFlagStatus(SDIO_FLAG_STBITERR) != RESET) {
+        SDIO_ClearFlag(SDIO_FLAG_STBITERR);
+        return(SD_START_BIT_ERR);
+    }
+
+    while ((SDIO_GetFlagStatus(SDIO_FLAG_RXDAVL) != RESET) && (index < SD_SWITCH_STATUS_LENGTH / 4)) {
+        *(tempbuff + index) = SDIO_ReadData();
+        index++;
+    }
+
+    /*!< Clear all the static flags */
+    SDIO_ClearFlag(SDIO_STATIC_FLAGS);
+
+    return(errorstatus);
+}
+
 // stm32f4
 
 #define STM32F4_SD_SECTOR_SIZE 512
+
+#ifndef STM32F4_SD_ASYNC_QUEUE_SIZE
+#define STM32F4_SD_ASYNC_QUEUE_SIZE 4
+#endif
+
+#define SDCARD_ASYNC_SECTORS_PER_SLICE 8 // Sectors moved before the task yields back to the CLR
+#define SDCARD_ASYNC_POLL_TICKS (1 * 10000) // 1ms between polls while the card is busy
+
 #define TOTAL_SDCARD_CONTROLLERS 1
 
+struct SdCardAsyncRequest {
+    uint64_t address;
+    uint8_t* data;
+    size_t count;
+    size_t transferred;
+    uint64_t timeout;
+    uint64_t lastProgressTime;
+    bool write;
+
+    STM32F4_SdCard_AsyncCompletionHandler handler;
+    void* context;
+};
+
 struct SdCardState {
     int32_t controllerIndex;
 
@@ -2668,6 +2900,15 @@ struct SdCardState {
     TinyCLR_Storage_Descriptor descriptor;
 
     uint16_t initializeCount;
+
+    SdCardAsyncRequest asyncRequests[STM32F4_SD_ASYNC_QUEUE_SIZE];
+    size_t asyncIn;
+    size_t asyncOut;
+    size_t asyncCount;
+
+    TinyCLR_Task_Reference asyncTaskReference;
+
+    const TinyCLR_Task_Manager* taskManager;
 };
 
 static SdCardState sdCardStates[TOTAL_SDCARD_CONTROLLERS];
@@ -2683,6 +2924,8 @@ static TinyCLR_Api_Info sdCardApi[TOTAL_SDCARD_CONTROLLERS];
 
 static const STM32F4_Gpio_Pin sdCardPins[][6] = STM32F4_SD_PINS;
 
+void STM32F4_SdCard_AsyncCallback(const TinyCLR_Task_Manager* self, const TinyCLR_Api_Manager* apiManager, TinyCLR_Task_Reference task, void* arg);
+
 const char* sdCardApiNames[TOTAL_SDCARD_CONTROLLERS] = {
     "GHIElectronics.TinyCLR.NativeApis.STM32F4.SdCardStorageController\\0"
 };
@@ -2711,6 +2954,11 @@ void STM32F4_SdCard_AddApi(const TinyCLR_Api_Manager* apiManager) {
         sdCardStates[i].initializeCount = 0;
         sdCardStates[i].regionSizes = nullptr;
         sdCardStates[i].regionAddresses = nullptr;
+        sdCardStates[i].asyncIn = 0;
+        sdCardStates[i].asyncOut = 0;
+        sdCardStates[i].asyncCount = 0;
+        sdCardStates[i].asyncTaskReference = nullptr;
+        sdCardStates[i].taskManager = nullptr;
         sdTimeoutTicks = SDCARD_DEFAULT_TIMEOUT_IN_SYSTEM_TICKS;
 
         apiManager->Add(apiManager, &sdCardApi[i]);
@@ -2783,6 +3031,24 @@ TinyCLR_Result STM32F4_SdCard_Release(const TinyCLR_Storage_Controller* self) {
         if (state->regionAddresses != nullptr)
             memoryProvider->Free(memoryProvider, state->regionAddresses);
 
+        if (state->taskManager != nullptr && state->asyncTaskReference != nullptr)
+            state->taskManager->Free(state->taskManager, state->asyncTaskReference);
+
+        state->asyncTaskReference = nullptr;
+
+        // The task is gone, so anything still queued will never run. Fail it with InvalidOperation so callers don't wait forever.
+        while (state->asyncCount > 0) {
+            auto& request = state->asyncRequests[state->asyncOut];
+
+            state->asyncOut = (state->asyncOut + 1) % STM32F4_SD_ASYNC_QUEUE_SIZE;
+            state->asyncCount--;
+
+            request.handler(self, TinyCLR_Result::InvalidOperation, request.transferred, request.context);
+        }
+
+        state->asyncIn = 0;
+        state->asyncOut = 0;
+
         for (auto i = 0; i < 6; i++) {
             STM32F4_GpioInternal_ClosePin(sdCardPins[controllerIndex][i].number);
         }
@@ -2792,8 +3058,13 @@ TinyCLR_Result STM32F4_SdCard_Release(const TinyCLR_Storage_Controller* self) {
 }
 
 TinyCLR_Result STM32F4_SdCard_Write(const TinyCLR_Storage_Controller* self, uint64_t address, size_t& count, const uint8_t* data, uint64_t timeout) {
+    auto state = reinterpret_cast<SdCardState*>(self->ApiInfo->State);
+
     int32_t index = 0;
 
+    if (state->asyncCount > 0)
+        return TinyCLR_Result::Busy;
+
     sdTimeoutTicks = timeout;
 
     auto sectorCount = count / STM32F4_SD_SECTOR_SIZE;
@@ -2807,7 +3078,9 @@ TinyCLR_Result STM32F4_SdCard_Write(const TinyCLR_Storage_Controller* self, uint
 
     while (sectorCount) {
         if (SD_GetStatus() == SD_TRANSFER_OK) {
-            if (SD_WriteBlock(&pData[index], sectorNum * STM32F4_SD_SECTOR_SIZE, STM32F4_SD_SECTOR_SIZE) == SD_OK) {
+            auto errorstatus = SD_WriteBlock(&pData[index], sectorNum * STM32F4_SD_SECTOR_SIZE, STM32F4_SD_SECTOR_SIZE);
+
+            if (errorstatus == SD_OK) {
                 index += STM32F4_SD_SECTOR_SIZE;
                 sectorNum++;
                 sectorCount--;
@@ -2816,6 +3089,10 @@ TinyCLR_Result STM32F4_SdCard_Write(const TinyCLR_Storage_Controller* self, uint
             }
             else {
                 SD_StopTransfer();
+
+                // Bad signal integrity at the current clock, retry the sector slower
+                if (errorstatus == SD_DATA_CRC_FAIL)
+                    SD_LowerBusClock();
             }
         }
 
@@ -2827,8 +3104,13 @@ TinyCLR_Result STM32F4_SdCard_Write(const TinyCLR_Storage_Controller* self, uint
 }
 
 TinyCLR_Result STM32F4_SdCard_Read(const TinyCLR_Storage_Controller* self, uint64_t address, size_t& count, uint8_t* data, uint64_t timeout) {
+    auto state = reinterpret_cast<SdCardState*>(self->ApiInfo->State);
+
     int32_t index = 0;
 
+    if (state->asyncCount > 0)
+        return TinyCLR_Result::Busy;
+
     sdTimeoutTicks = timeout;
 
     auto sectorCount = count / STM32F4_SD_SECTOR_SIZE;
@@ -2840,7 +3122,9 @@ TinyCLR_Result STM32F4_SdCard_Read(const TinyCLR_Storage_Controller* self, uint6
 
     while (sectorCount) {
         if (SD_GetStatus() == SD_TRANSFER_OK) {
-            if (SD_ReadBlock(&data[index], sectorNum * STM32F4_SD_SECTOR_SIZE, STM32F4_SD_SECTOR_SIZE) == SD_OK) {
+            auto errorstatus = SD_ReadBlock(&data[index], sectorNum * STM32F4_SD_SECTOR_SIZE, STM32F4_SD_SECTOR_SIZE);
+
+            if (errorstatus == SD_OK) {
                 index += STM32F4_SD_SECTOR_SIZE;
                 sectorNum++;
                 sectorCount--;
@@ -2849,6 +3133,10 @@ TinyCLR_Result STM32F4_SdCard_Read(const TinyCLR_Storage_Controller* self, uint6
             }
             else {
                 SD_StopTransfer();
+
+                // Bad signal integrity at the current clock, retry the sector slower
+                if (errorstatus == SD_DATA_CRC_FAIL)
+                    SD_LowerBusClock();
             }
         }
 
@@ -2859,6 +3147,136 @@ TinyCLR_Result STM32F4_SdCard_Read(const TinyCLR_Storage_Controller* self, uint6
     return TinyCLR_Result::Success;
 }
 
+static TinyCLR_Result STM32F4_SdCard_ProcessAsyncRequest(SdCardAsyncRequest& request) {
+    sdTimeoutTicks = request.timeout;
+
+    for (auto i = 0; i < SDCARD_ASYNC_SECTORS_PER_SLICE && request.transferred < request.count; ) {
+        if (SD_GetStatus() != SD_TRANSFER_OK) {
+            // Card still programming, let the CLR run and poll again later
+            if (STM32F4_Time_GetCurrentProcessorTime() - request.lastProgressTime > request.timeout)
+                return TinyCLR_Result::TimedOut;
+
+            return TinyCLR_Result::Busy;
+        }
+
+        auto errorstatus = request.write ? SD_WriteBlock(&request.data[request.transferred], request.address + request.transferred, STM32F4_SD_SECTOR_SIZE) : SD_ReadBlock(&request.data[request.transferred], request.address + request.transferred, STM32F4_SD_SECTOR_SIZE);
+
+        if (errorstatus == SD_OK) {
+            request.transferred += STM32F4_SD_SECTOR_SIZE;
+            request.lastProgressTime = STM32F4_Time_GetCurrentProcessorTime();
+
+            i++;
+        }
+        else {
+            SD_StopTransfer();
+
+            if (errorstatus == SD_DATA_CRC_FAIL)
+                SD_LowerBusClock();
+
+            if (STM32F4_Time_GetCurrentProcessorTime() - request.lastProgressTime > request.timeout)
+                return TinyCLR_Result::TimedOut;
+
+            return TinyCLR_Result::Busy;
+        }
+    }
+
+    return request.transferred < request.count ? TinyCLR_Result::Busy : TinyCLR_Result::Success;
+}
+
+void STM32F4_SdCard_AsyncCallback(const TinyCLR_Task_Manager* self, const TinyCLR_Api_Manager* apiManager, TinyCLR_Task_Reference task, void* arg) {
+    auto state = reinterpret_cast<SdCardState*>(arg);
+
+    if (state->asyncCount == 0)
+        return;
+
+    auto& request = state->asyncRequests[state->asyncOut];
+    auto previousTransferred = request.transferred;
+
+    auto result = STM32F4_SdCard_ProcessAsyncRequest(request);
+
+    if (result == TinyCLR_Result::Busy) {
+        // Continue right away after a full slice, back off while the card is busy
+        state->taskManager->Enqueue(state->taskManager, task, request.transferred != previousTransferred ? 0 : STM32F4_Time_GetProcessorTicksForTime(nullptr, SDCARD_ASYNC_POLL_TICKS));
+
+        return;
+    }
+
+    auto handler = request.handler;
+    auto context = request.context;
+    auto transferred = request.transferred;
+
+    {
+        DISABLE_INTERRUPTS_SCOPED(irq);
+
+        state->asyncOut = (state->asyncOut + 1) % STM32F4_SD_ASYNC_QUEUE_SIZE;
+        state->asyncCount--;
+    }
+
+    if (state->asyncCount > 0)
+        state->taskManager->Enqueue(state->taskManager, task, 0);
+
+    handler(&sdCardControllers[state->controllerIndex], result, transferred, context);
+}
+
+static TinyCLR_Result STM32F4_SdCard_SubmitAsync(const TinyCLR_Storage_Controller* self, uint64_t address, size_t count, uint8_t* data, uint64_t timeout, bool write, STM32F4_SdCard_AsyncCompletionHandler handler, void* context) {
+    auto state = reinterpret_cast<SdCardState*>(self->ApiInfo->State);
+
+    if (data == nullptr || handler == nullptr) return TinyCLR_Result::ArgumentNull;
+    if (state->initializeCount == 0) return TinyCLR_Result::InvalidOperation;
+    if ((address % STM32F4_SD_SECTOR_SIZE) != 0 || (count % STM32F4_SD_SECTOR_SIZE) != 0) return TinyCLR_Result::ArgumentInvalid;
+
+    if (state->asyncTaskReference == nullptr) {
+        state->taskManager = (const TinyCLR_Task_Manager*)apiManager->FindDefault(apiManager, TinyCLR_Api_Type::TaskManager);
+        state->taskManager->Create(state->taskManager, STM32F4_SdCard_AsyncCallback, (void*)state, false, state->asyncTaskReference);
+
+        if (state->asyncTaskReference == nullptr)
+            return TinyCLR_Result::OutOfMemory;
+    }
+
+    {
+        DISABLE_INTERRUPTS_SCOPED(irq);
+
+        if (state->asyncCount == STM32F4_SD_ASYNC_QUEUE_SIZE)
+            return TinyCLR_Result::Busy;
+
+        auto& request = state->asyncRequests[state->asyncIn];
+
+        request.address = address;
+        request.data = data;
+        request.count = count;
+        request.transferred = 0;
+        request.timeout = timeout;
+        request.lastProgressTime = STM32F4_Time_GetCurrentProcessorTime();
+        request.write = write;
+        request.handler = handler;
+        request.context = context;
+
+        state->asyncIn = (state->asyncIn + 1) % STM32F4_SD_ASYNC_QUEUE_SIZE;
+        state->asyncCount++;
+
+        if (state->asyncCount > 1)
+            return TinyCLR_Result::Success;
+    }
+
+    state->taskManager->Enqueue(state->taskManager, state->asyncTaskReference, 0);
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result STM32F4_SdCard_ReadAsync(const TinyCLR_Storage_Controller* self, uint64_t address, size_t count, uint8_t* data, uint64_t timeout, STM32F4_SdCard_AsyncCompletionHandler handler, void* context) {
+    return STM32F4_SdCard_SubmitAsync(self, address, count, data, timeout, false, handler, context);
+}
+
+TinyCLR_Result STM32F4_SdCard_WriteAsync(const TinyCLR_Storage_Controller* self, uint64_t address, size_t count, const uint8_t* data, uint64_t timeout, STM32F4_SdCard_AsyncCompletionHandler handler, void* context) {
+    return STM32F4_SdCard_SubmitAsync(self, address, count, const_cast<uint8_t*>(data), timeout, true, handler, context);
+}
+
+size_t STM32F4_SdCard_GetPendingAsyncCount(const TinyCLR_Storage_Controller* self) {
+    auto state = reinterpret_cast<SdCardState*>(self->ApiInfo->State);
+
+    return state->asyncCount;
+}
+
 TinyCLR_Result STM32F4_SdCard_IsErased(const TinyCLR_Storage_Controller* self, uint64_t address, size_t count, bool& erased) {
     erased = true;
 
@@ -2918,6 +3336,10 @@ TinyCLR_Result STM32F4_SdCard_Reset() {
         sdCardStates[i].initializeCount = 0;
         sdCardStates[i].regionSizes = nullptr;
         sdCardStates[i].regionAddresses = nullptr;
+        sdCardStates[i].asyncIn = 0;
+        sdCardStates[i].asyncOut = 0;
+        sdCardStates[i].asyncCount = 0;
+        sdCardStates[i].asyncTaskReference = nullptr;
     }
 
     return TinyCLR_Result::Success;
@@ -74,6 +74,11 @@ struct SpiState {
     TinyCLR_Spi_Mode spiMode;
 
     uint16_t initializeCount;
+
+    const uint16_t* dmaWords;
+    size_t dmaCount;
+    STM32F4_Spi_WriteCompleteHandler dmaHandler;
+    void* dmaContext;
 };
 
 static SpiState spiStates[TOTAL_SPI_CONTROLLERS];
@@ -236,6 +241,9 @@ TinyCLR_Result STM32F4_Spi_WriteRead(const TinyCLR_Spi_Controller* self, const u
 
     auto controllerIndex = state->controllerIndex;
 
+    if (state->dmaHandler != nullptr)
+        return TinyCLR_Result::Busy;
+
     if (!STM32F4_Spi_Transaction_Start(controllerIndex))
         return TinyCLR_Result::InvalidOperation;
 
@@ -258,6 +266,9 @@ TinyCLR_Result STM32F4_Spi_Read(const TinyCLR_Spi_Controller* self, uint8_t* buf
 
     auto controllerIndex = state->controllerIndex;
 
+    if (state->dmaHandler != nullptr)
+        return TinyCLR_Result::Busy;
+
     if (!STM32F4_Spi_Transaction_Start(controllerIndex))
         return TinyCLR_Result::InvalidOperation;
 
@@ -280,6 +291,9 @@ TinyCLR_Result STM32F4_Spi_Write(const TinyCLR_Spi_Controller* self, const uint8
 
     auto controllerIndex = state->controllerIndex;
 
+    if (state->dmaHandler != nullptr)
+        return TinyCLR_Result::Busy;
+
     if (!STM32F4_Spi_Transaction_Start(controllerIndex))
         return TinyCLR_Result::InvalidOperation;
 
@@ -297,6 +311,208 @@ TinyCLR_Result STM32F4_Spi_Write(const TinyCLR_Spi_Controller* self, const uint8
     return TinyCLR_Result::Success;
 }
 
+// DMA streams are fixed per SPI peripheral, these are the transmit requests from the reference manual's mapping tables
+struct SpiDmaStream {
+    DMA_TypeDef* dma;
+    DMA_Stream_TypeDef* stream;
+    uint32_t streamIndex;
+    uint32_t channel;
+    IRQn_Type irq;
+    uint32_t clockEnable;
+};
+
+#define STM32F4_SPI_DMA_MAX_COUNT 0xFFFF
+
+// Stream flags once shifted down to bit 0: FEIF, DMEIF, TEIF, HTIF, TCIF
+#define STM32F4_SPI_DMA_FLAGS 0x3D
+#define STM32F4_SPI_DMA_ERROR_FLAGS 0x0C
+
+static const uint32_t spiDmaFlagShift[4] = { 0, 6, 16, 22 };
+
+void STM32F4_Spi_DmaInterruptHandler0(void* param);
+void STM32F4_Spi_DmaInterruptHandler1(void* param);
+void STM32F4_Spi_DmaInterruptHandler2(void* param);
+void STM32F4_Spi_DmaInterruptHandler3(void* param);
+void STM32F4_Spi_DmaInterruptHandler4(void* param);
+void STM32F4_Spi_DmaInterruptHandler5(void* param);
+
+static const SpiDmaStream spiTxDmaStreams[] = {
+    { DMA2, DMA2_Stream3, 3, 3, DMA2_Stream3_IRQn, RCC_AHB1ENR_DMA2EN },
+    { DMA1, DMA1_Stream4, 4, 0, DMA1_Stream4_IRQn, RCC_AHB1ENR_DMA1EN },
+    { DMA1, DMA1_Stream5, 5, 0, DMA1_Stream5_IRQn, RCC_AHB1ENR_DMA1EN },
+    { DMA2, DMA2_Stream1, 1, 4, DMA2_Stream1_IRQn, RCC_AHB1ENR_DMA2EN },
+    { DMA2, DMA2_Stream4, 4, 2, DMA2_Stream4_IRQn, RCC_AHB1ENR_DMA2EN },
+    { DMA2, DMA2_Stream5, 5, 1, DMA2_Stream5_IRQn, RCC_AHB1ENR_DMA2EN },
+};
+
+static void(*const spiDmaInterruptHandlers[])(void*) = {
+    &STM32F4_Spi_DmaInterruptHandler0,
+    &STM32F4_Spi_DmaInterruptHandler1,
+    &STM32F4_Spi_DmaInterruptHandler2,
+    &STM32F4_Spi_DmaInterruptHandler3,
+    &STM32F4_Spi_DmaInterruptHandler4,
+    &STM32F4_Spi_DmaInterruptHandler5,
+};
+
+static uint32_t STM32F4_Spi_DmaGetFlags(const SpiDmaStream& dma) {
+    auto status = dma.streamIndex < 4 ? dma.dma->LISR : dma.dma->HISR;
+
+    return (status >> spiDmaFlagShift[dma.streamIndex & 3]) & STM32F4_SPI_DMA_FLAGS;
+}
+
+static void STM32F4_Spi_DmaClearFlags(const SpiDmaStream& dma) {
+    auto flags = STM32F4_SPI_DMA_FLAGS << spiDmaFlagShift[dma.streamIndex & 3];
+
+    if (dma.streamIndex < 4)
+        dma.dma->LIFCR = flags;
+    else
+        dma.dma->HIFCR = flags;
+}
+
+// Sends the next chunk, a stream counts at most 65535 items
+static void STM32F4_Spi_DmaStart(int32_t controllerIndex) {
+    auto state = &spiStates[controllerIndex];
+    auto& dma = spiTxDmaStreams[controllerIndex];
+    auto count = state->dmaCount < STM32F4_SPI_DMA_MAX_COUNT ? state->dmaCount : STM32F4_SPI_DMA_MAX_COUNT;
+
+    STM32F4_Spi_DmaClearFlags(dma);
+
+    dma.stream->PAR = reinterpret_cast<uint32_t>(&spiPortRegs[controllerIndex]->DR);
+    dma.stream->M0AR = reinterpret_cast<uint32_t>(state->dmaWords);
+    dma.stream->NDTR = count;
+    dma.stream->CR = (dma.channel << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC | DMA_SxCR_DIR_0 | DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE | DMA_SxCR_EN;
+
+    state->dmaWords += count;
+    state->dmaCount -= count;
+}
+
+static void STM32F4_Spi_DmaStop(int32_t controllerIndex) {
+    auto& dma = spiTxDmaStreams[controllerIndex];
+    auto spi = spiPortRegs[controllerIndex];
+
+    dma.stream->CR &= ~DMA_SxCR_EN;
+
+    while ((dma.stream->CR & DMA_SxCR_EN) != 0);
+
+    STM32F4_Spi_DmaClearFlags(dma);
+    STM32F4_InterruptInternal_Deactivate(dma.irq);
+
+    spi->CR2 &= ~SPI_CR2_TXDMAEN;
+
+    while ((spi->SR & SPI_SR_TXE) == 0);
+    while ((spi->SR & SPI_SR_BSY) != 0);
+
+    // Nothing was read while sending, drop the last byte and the overrun it caused
+    (void)spi->DR;
+    (void)spi->SR;
+
+    spi->CR1 &= ~SPI_CR1_SPE;
+    spi->CR1 &= ~SPI_CR1_DFF;
+    spi->CR1 |= SPI_CR1_SPE;
+}
+
+// A transfer or direct mode error disables the stream, the rest of the words are dropped and the handler is told
+void STM32F4_Spi_DmaInterruptHandler(int32_t controllerIndex) {
+    INTERRUPT_STARTED_SCOPED(isr);
+
+    auto state = &spiStates[controllerIndex];
+    auto& dma = spiTxDmaStreams[controllerIndex];
+    auto error = (STM32F4_Spi_DmaGetFlags(dma) & STM32F4_SPI_DMA_ERROR_FLAGS) != 0;
+
+    STM32F4_Spi_DmaClearFlags(dma);
+
+    if (!error && state->dmaCount > 0) {
+        STM32F4_Spi_DmaStart(controllerIndex);
+
+        return;
+    }
+
+    STM32F4_Spi_DmaStop(controllerIndex);
+    STM32F4_Spi_Transaction_Stop(controllerIndex);
+
+    auto handler = state->dmaHandler;
+
+    state->dmaHandler = nullptr;
+    state->dmaCount = 0;
+
+    handler(state->dmaContext, error ? TinyCLR_Result::InvalidOperation : TinyCLR_Result::Success);
+}
+
+void STM32F4_Spi_DmaInterruptHandler0(void* param) {
+    STM32F4_Spi_DmaInterruptHandler(0);
+}
+
+void STM32F4_Spi_DmaInterruptHandler1(void* param) {
+    STM32F4_Spi_DmaInterruptHandler(1);
+}
+
+void STM32F4_Spi_DmaInterruptHandler2(void* param) {
+    STM32F4_Spi_DmaInterruptHandler(2);
+}
+
+void STM32F4_Spi_DmaInterruptHandler3(void* param) {
+    STM32F4_Spi_DmaInterruptHandler(3);
+}
+
+void STM32F4_Spi_DmaInterruptHandler4(void* param) {
+    STM32F4_Spi_DmaInterruptHandler(4);
+}
+
+void STM32F4_Spi_DmaInterruptHandler5(void* param) {
+    STM32F4_Spi_DmaInterruptHandler(5);
+}
+
+// Sends 16 bit words, most significant byte first, from DMA and returns once the transfer is started. The handler
+// is called from the interrupt when the last word is out and chip select is released, or with InvalidOperation
+// when the stream reports an error, and the words must be left alone until then. Other transfers on the
+// controller are refused meanwhile.
+TinyCLR_Result STM32F4_Spi_WriteWords(const TinyCLR_Spi_Controller* self, const uint16_t* words, size_t count, STM32F4_Spi_WriteCompleteHandler handler, void* context) {
+    auto state = reinterpret_cast<SpiState*>(self->ApiInfo->State);
+
+    auto controllerIndex = state->controllerIndex;
+
+    if (words == nullptr || handler == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (state->initializeCount == 0)
+        return TinyCLR_Result::InvalidOperation;
+
+    if (state->dmaHandler != nullptr)
+        return TinyCLR_Result::Busy;
+
+    if (count == 0) {
+        handler(context, TinyCLR_Result::Success);
+
+        return TinyCLR_Result::Success;
+    }
+
+    auto& dma = spiTxDmaStreams[controllerIndex];
+    auto spi = spiPortRegs[controllerIndex];
+
+    if (!STM32F4_Spi_Transaction_Start(controllerIndex))
+        return TinyCLR_Result::InvalidOperation;
+
+    RCC->AHB1ENR |= dma.clockEnable;
+
+    // The frame size only changes while the peripheral is disabled
+    spi->CR1 &= ~SPI_CR1_SPE;
+    spi->CR1 |= SPI_CR1_DFF;
+    spi->CR1 |= SPI_CR1_SPE;
+
+    state->dmaWords = words;
+    state->dmaCount = count;
+    state->dmaHandler = handler;
+    state->dmaContext = context;
+
+    STM32F4_InterruptInternal_Activate(dma.irq, (uint32_t*)spiDmaInterruptHandlers[controllerIndex], 0);
+
+    STM32F4_Spi_DmaStart(controllerIndex);
+
+    spi->CR2 |= SPI_CR2_TXDMAEN;
+
+    return TinyCLR_Result::Success;
+}
+
 TinyCLR_Result STM32F4_Spi_SetActiveSettings(const TinyCLR_Spi_Controller* self, const TinyCLR_Spi_Settings* settings) {
     uint32_t chipSelectLine = settings->ChipSelectLine;
     TinyCLR_Spi_ChipSelectType chipSelectType = settings->ChipSelectType;
@@ -478,6 +694,19 @@ TinyCLR_Result STM32F4_Spi_Release(const TinyCLR_Spi_Controller* self) {
     if (state->initializeCount == 0) {
         auto controllerIndex = state->controllerIndex;
 
+        if (state->dmaHandler != nullptr) {
+            auto handler = state->dmaHandler;
+
+            STM32F4_Spi_DmaStop(controllerIndex);
+            STM32F4_Spi_Transaction_Stop(controllerIndex);
+
+            state->dmaHandler = nullptr;
+            state->dmaCount = 0;
+
+            // The transfer is cut short, so the words it still had to send are lost
+            handler(state->dmaContext, TinyCLR_Result::InvalidOperation);
+        }
+
         switch (controllerIndex) {
 #ifdef SPI1
         case 0:
@@ -15,6 +15,8 @@
 #include <algorithm>
 #include <string.h>
 #include "STM32F7.h"
+#include "../../Drivers/CanStatistics/CanStatistics.h"
+#include "../../Drivers/CanFilter/CanFilter.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -26,6 +28,15 @@
 
 #define CAN_TRANSFER_TIMEOUT 0xFFFF
 
+// 0.8us resolution, about 214s from the buffer epoch
+#ifndef STM32F7_CAN_TIMESTAMP_SHIFT
+#define STM32F7_CAN_TIMESTAMP_SHIFT 3
+#endif
+
+#ifndef STM32F7_CAN_TX_BUFFER_DEFAULT_SIZE
+#define STM32F7_CAN_TX_BUFFER_DEFAULT_SIZE 16
+#endif
+
 #define CAN_Mode_Normal             ((uint8_t)0x00)  /*!< normal mode */
 #define CAN_Mode_LoopBack           ((uint8_t)0x01)  /*!< loopback mode */
 #define CAN_Mode_Silent             ((uint8_t)0x02)  /*!< silent mode */
@@ -286,31 +297,42 @@ struct STM32F7_Can_Filter {
     uint32_t* upperBoundFilters;
     uint32_t groupFiltersSize;
 
+    bool hardwareFiltered; // Filter banks match exactly, software search not needed
 };
 
 
+// Receive buffer record, 16 bytes. MsgID holds the identifier and the frame flags, TimeStamp holds
+// the length and the time since the buffer epoch in units of 2^STM32F7_CAN_TIMESTAMP_SHIFT ticks.
 typedef struct {
-    uint32_t TimeStampL;
-    uint32_t TimeStampH;
-
-    uint32_t MsgID;	// CAN Message ID (11-bit or 29-bit)
-
-    bool extendedId;
-    bool remoteTransmissionRequest;
+    uint32_t MsgID;
+    uint32_t TimeStamp;
 
     uint32_t DataA;	// CAN Message Data Bytes 0-3
     uint32_t DataB;	// CAN Message Data Bytes 4-7
 
-    int32_t length;
-
 } STM32F7_Can_Message;
 
+#define CAN_MESSAGE_ID_MASK 0x1FFFFFFF
+#define CAN_MESSAGE_EXTENDED_ID 0x20000000
+#define CAN_MESSAGE_REMOTE_TRANSMISSION_REQUEST 0x40000000
+
+#define CAN_MESSAGE_TIMESTAMP_MASK 0x0FFFFFFF
+#define CAN_MESSAGE_LENGTH_SHIFT 28
+
+typedef struct {
+    uint32_t priority; // Lower value wins bus arbitration
+
+    STM32F7_Can_TxMessage message;
+
+} STM32F7_Can_TxQueueEntry;
+
 struct CanState {
     int32_t controllerIndex;
 
     const TinyCLR_Can_Controller* controller;
 
     STM32F7_Can_Message *canRxMessagesFifo;
+    STM32F7_Can_TxQueueEntry *canTxMessagesQueue;
 
     STM32F7_Can_InitTypeDef initTypeDef;
     STM32F7_Can_FilterInitTypeDef filterInitTypeDef;
@@ -322,6 +344,16 @@ struct CanState {
     int32_t rxIn;
     int32_t rxOut;
 
+    uint64_t rxEpoch;
+
+    CanStatistics statistics;
+
+    STM32F7_Can_FrameHandler frameHandler;
+    void* frameHandlerContext;
+
+    int32_t txCount;
+    uint32_t txArbitrationLost; // Mailboxes whose pending request is already counted in ArbitrationLost
+
     size_t rxBufferSize;
     size_t txBufferSize;
 
@@ -352,6 +384,20 @@ static const uint32_t canDefaultBuffersSize[] = STM32F7_CAN_BUFFER_DEFAULT_SIZE;
 
 static CanState canStates[TOTAL_CAN_CONTROLLERS];
 
+// The epoch restarts whenever the receive buffer is empty. A frame left unread for longer than the
+// delta can express is given the largest delta.
+static uint32_t STM32F7_Can_RxTimeStamp(CanState* state, uint64_t t, uint32_t length) {
+    if (state->rxCount == 0)
+        state->rxEpoch = t;
+
+    auto delta = (t - state->rxEpoch) >> STM32F7_CAN_TIMESTAMP_SHIFT;
+
+    if (delta > CAN_MESSAGE_TIMESTAMP_MASK)
+        delta = CAN_MESSAGE_TIMESTAMP_MASK;
+
+    return (uint32_t)delta | ((length & 0x0F) << CAN_MESSAGE_LENGTH_SHIFT);
+}
+
 static TinyCLR_Can_Controller canControllers[TOTAL_CAN_CONTROLLERS];
 static TinyCLR_Api_Info canApi[TOTAL_CAN_CONTROLLERS];
 
@@ -610,6 +656,72 @@ void CAN_FilterInit(STM32F7_Can_FilterInitTypeDef* CAN_FilterInitStruct) {
     CAN1->FMR &= ~FMR_FINIT;
 }
 
+// Programs the compiled filters into the banks of the controller, alternating banks between the two
+// receive FIFOs to double the hardware buffering. Frames of one identifier can land in either FIFO,
+// so the receive interrupt merges the two by their time triggered mode stamps to keep bus order.
+// When the filters do not fit, the banks accept everything and the receive interrupt falls back to
+// searching the filter arrays.
+static void STM32F7_Can_ApplyFilters(int32_t controllerIndex) {
+    auto state = &canStates[controllerIndex];
+
+    auto& filter = state->canDataFilter;
+
+    CanFilter_Banks banks;
+
+    auto exact = (filter.matchFiltersSize || filter.groupFiltersSize) && CanFilter_CompileBanks(filter.matchFilters, filter.matchFiltersSize, filter.lowerBoundFilters, filter.upperBoundFilters, filter.groupFiltersSize, banks);
+
+    if (!exact) {
+        {
+            DISABLE_INTERRUPTS_SCOPED(irq);
+
+            state->canDataFilter.hardwareFiltered = false;
+        }
+
+        // Accept everything, split on the lowest standard identifier bit to share the load between the FIFOs
+        banks.Bank[0].Scale = CAN_FilterScale_32bit;
+        banks.Bank[0].Fr1 = 0;
+        banks.Bank[0].Fr2 = 1 << 21;
+        banks.Bank[1].Scale = CAN_FilterScale_32bit;
+        banks.Bank[1].Fr1 = 1 << 21;
+        banks.Bank[1].Fr2 = 1 << 21;
+        banks.Used = 2;
+    }
+
+    auto& filterInit = state->filterInitTypeDef;
+
+    filterInit.CAN_FilterMode = CAN_FilterMode_IdMask;
+
+    for (size_t i = 0; i < CAN_FILTER_BANKS_PER_CONTROLLER; i++) {
+        auto& bank = banks.Bank[i < banks.Used ? i : 0];
+
+        filterInit.CAN_FilterNumber = (controllerIndex == 0 ? 0 : CAN_FILTER_BANKS_PER_CONTROLLER) + i;
+        filterInit.CAN_FilterScale = bank.Scale;
+        filterInit.CAN_FilterFIFOAssignment = (i % 2 == 0) ? CAN_Filter_FIFO0 : CAN_Filter_FIFO1;
+        filterInit.CAN_FilterActivation = i < banks.Used ? ENABLE : DISABLE;
+
+        if (bank.Scale == CAN_FilterScale_32bit) {
+            filterInit.CAN_FilterIdHigh = bank.Fr1 >> 16;
+            filterInit.CAN_FilterIdLow = bank.Fr1 & 0xFFFF;
+            filterInit.CAN_FilterMaskIdHigh = bank.Fr2 >> 16;
+            filterInit.CAN_FilterMaskIdLow = bank.Fr2 & 0xFFFF;
+        }
+        else {
+            filterInit.CAN_FilterIdLow = bank.Fr1 & 0xFFFF;
+            filterInit.CAN_FilterMaskIdLow = bank.Fr1 >> 16;
+            filterInit.CAN_FilterIdHigh = bank.Fr2 & 0xFFFF;
+            filterInit.CAN_FilterMaskIdHigh = bank.Fr2 >> 16;
+        }
+
+        CAN_FilterInit(&filterInit);
+    }
+
+    if (exact) {
+        DISABLE_INTERRUPTS_SCOPED(irq);
+
+        state->canDataFilter.hardwareFiltered = true;
+    }
+}
+
 /**
   * @brief  Receives a correct CAN frame.
   * @param  CANx: where x can be 1 or 2 to select the CAN peripheral.
@@ -1004,6 +1116,23 @@ ITStatus CAN_GetITStatus(CAN_TypeDef* CANx, uint32_t CAN_IT) {
 }
 
 
+static CanStatistics_ErrorState STM32F7_Can_GetErrorState(int32_t controllerIndex) {
+    CAN_TypeDef* CANx = ((controllerIndex == 0) ? CAN1 : CAN2);
+
+    auto esr = CANx->ESR;
+
+    if (esr & CAN_ESR_BOFF)
+        return CanStatistics_ErrorState::BusOff;
+
+    if (esr & CAN_ESR_EPVF)
+        return CanStatistics_ErrorState::Passive;
+
+    if (esr & CAN_ESR_EWGF)
+        return CanStatistics_ErrorState::Warning;
+
+    return CanStatistics_ErrorState::Active;
+}
+
 bool CAN_ErrorHandler(uint8_t controllerIndex) {
     DISABLE_INTERRUPTS_SCOPED(irq);
 
@@ -1011,6 +1140,8 @@ bool CAN_ErrorHandler(uint8_t controllerIndex) {
 
     CAN_TypeDef* CANx = ((controllerIndex == 0) ? CAN1 : CAN2);
 
+    CanStatistics_SetErrorState(state->statistics, STM32F7_Time_GetSystemTime(nullptr), STM32F7_Can_GetErrorState(controllerIndex));
+
     if (CAN_GetITStatus(CANx, CAN_IT_FF0)) {
         CAN_ClearITPendingBit(CANx, CAN_IT_FF0);
         state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::BufferFull;
@@ -1023,6 +1154,18 @@ bool CAN_ErrorHandler(uint8_t controllerIndex) {
 
         return true;
     }
+    else if (CAN_GetITStatus(CANx, CAN_IT_FF1)) {
+        CAN_ClearITPendingBit(CANx, CAN_IT_FF1);
+        state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::BufferFull;
+
+        return true;
+    }
+    else if (CAN_GetITStatus(CANx, CAN_IT_FOV1)) {
+        CAN_ClearITPendingBit(CANx, CAN_IT_FOV1);
+        state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::Overrun;
+
+        return true;
+    }
     else if (CAN_GetITStatus(CANx, CAN_IT_BOF)) {
         CAN_ClearITPendingBit(CANx, CAN_IT_BOF);
         state->errorEvent = 1 << (uint8_t)(uint8_t)TinyCLR_Can_Error::BusOff;
@@ -1099,6 +1242,7 @@ void STM32F7_Can_AddApi(const TinyCLR_Api_Manager* apiManager) {
         canStates[i].controllerIndex = i;
         canStates[i].initializeCount = 0;
         canStates[i].canRxMessagesFifo = nullptr;
+        canStates[i].canTxMessagesQueue = nullptr;
 
         apiManager->Add(apiManager, &canApi[i]);
     }
@@ -1178,49 +1322,180 @@ TinyCLR_Result STM32F7_Can_SetReadBufferSize(const TinyCLR_Can_Controller* self,
 }
 
 size_t STM32F7_Can_GetWriteBufferSize(const TinyCLR_Can_Controller* self) {
-    return 1;
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    return state->txBufferSize == 0 ? STM32F7_CAN_TX_BUFFER_DEFAULT_SIZE : state->txBufferSize;
 }
 
 TinyCLR_Result STM32F7_Can_SetWriteBufferSize(const TinyCLR_Can_Controller* self, size_t size) {
     auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
 
-    state->txBufferSize = 1;
+    if (size == 0)
+        return TinyCLR_Result::ArgumentInvalid;
 
-    return size == 1 ? TinyCLR_Result::Success : TinyCLR_Result::NotSupported;
-}
+    auto memoryProvider = (const TinyCLR_Memory_Manager*)apiManager->FindDefault(apiManager, TinyCLR_Api_Type::MemoryManager);
 
-void STM32F7_Can_RxInterruptHandler(int32_t controllerIndex) {
-    DISABLE_INTERRUPTS_SCOPED(irq);
+    auto queue = (STM32F7_Can_TxQueueEntry*)memoryProvider->Allocate(memoryProvider, size * sizeof(STM32F7_Can_TxQueueEntry));
 
-    auto state = reinterpret_cast<CanState*>(&canStates[controllerIndex]);
+    if (queue == nullptr)
+        return TinyCLR_Result::OutOfMemory;
 
-    uint32_t* pDest;
+    auto oldQueue = state->canTxMessagesQueue;
+    auto fits = true;
 
-    int32_t len = 0;
+    {
+        DISABLE_INTERRUPTS_SCOPED(irq);
 
-    uint32_t msgid = 0;
+        // Frames not yet in a mailbox move to the new queue, which keeps their order
+        fits = state->txCount <= (int32_t)size;
 
-    bool extendMode = 0;
-    bool rtrmode = 0;
+        if (fits) {
+            if (state->txCount > 0)
+                memcpy(queue, state->canTxMessagesQueue, state->txCount * sizeof(STM32F7_Can_TxQueueEntry));
 
-    char passed = 0;
+            state->canTxMessagesQueue = queue;
+            state->txBufferSize = size;
+        }
+    }
 
-    CAN_TypeDef* CANx = ((controllerIndex == 0) ? CAN1 : CAN2);
+    if (!fits) {
+        memoryProvider->Free(memoryProvider, queue);
 
-    STM32F7_Can_RxMessage rxMessage;
+        return TinyCLR_Result::InvalidOperation;
+    }
 
-    uint32_t error = CAN_ErrorHandler(controllerIndex);
+    if (oldQueue != nullptr)
+        memoryProvider->Free(memoryProvider, oldQueue);
 
-    uint64_t t;
+    return TinyCLR_Result::Success;
+}
 
-    STM32F7_Can_Message *can_msg;
+// Queue is kept sorted with the next message to send at the end, so the interrupt only pops the tail.
+// Messages of equal priority stay in the order they were written.
+static bool STM32F7_Can_TxEnqueue(CanState* state, const STM32F7_Can_TxQueueEntry& entry) {
+    if (state->canTxMessagesQueue == nullptr || state->txCount >= (int32_t)state->txBufferSize)
+        return false;
+
+    auto queue = state->canTxMessagesQueue;
+    auto index = state->txCount;
+
+    while (index > 0 && queue[index - 1].priority <= entry.priority) {
+        queue[index] = queue[index - 1];
+        index--;
+    }
+
+    queue[index] = entry;
+    state->txCount++;
+
+    return true;
+}
+
+// The identifier bits of a mailbox's TIR, as CAN_Transmit writes them
+static uint32_t STM32F7_Can_TxIdentifier(const STM32F7_Can_TxMessage& message) {
+    return message.IDE == CAN_Id_Standard ? message.StdId << 21 : (message.ExtId << 3) | CAN_Id_Extended;
+}
+
+// With TXFP off the controller sends the lowest identifier first and breaks ties by the lowest mailbox, not by the
+// order the mailboxes were filled in. Only one frame per identifier is put in the mailboxes, so that frames with
+// the same identifier, such as ISO-TP consecutive frames, go out in the order they were written.
+static bool STM32F7_Can_TxIsIdentifierPending(CAN_TypeDef* CANx, uint32_t identifier) {
+    for (auto mailbox = 0; mailbox < 3; mailbox++)
+        if ((CANx->TSR & (CAN_TSR_TME0 << mailbox)) == 0 && (CANx->sTxMailBox[mailbox].TIR & ~(uint32_t)(CAN_Rtr_Frame | TMIDxR_TXRQ)) == identifier)
+            return true;
+
+    return false;
+}
 
-    CAN_Receive(CANx, CAN_FIFO0, &rxMessage);
+// A request that loses arbitration is retried and still ends with TXOK, so ALST is polled while the request is
+// pending rather than read when it completes. Each request is counted once however often it loses. Must be called
+// with interrupts disabled.
+static void STM32F7_Can_TxPollArbitration(CanState* state, CAN_TypeDef* CANx) {
+    auto tsr = CANx->TSR;
+
+    // Mailbox status fields repeat every 8 bits
+    for (auto mailbox = 0; mailbox < 3; mailbox++) {
+        if (((tsr >> (8 * mailbox)) & CAN_TSR_ALST0) != 0 && (state->txArbitrationLost & (1 << mailbox)) == 0) {
+            state->txArbitrationLost |= 1 << mailbox;
+            state->statistics.ArbitrationLost++;
+        }
+    }
+}
+
+// Counts the requests that completed since the last call and clears their RQCP, before CAN_Transmit can reuse
+// the mailbox and clear it unseen. Must be called with interrupts disabled.
+static void STM32F7_Can_TxCollect(CanState* state, CAN_TypeDef* CANx) {
+    STM32F7_Can_TxPollArbitration(state, CANx);
+
+    auto tsr = CANx->TSR;
+    auto completed = tsr & (CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2);
 
-    if (error) {
+    if (completed == 0)
         return;
+
+    auto now = STM32F7_Time_GetSystemTime(nullptr);
+
+    for (auto mailbox = 0; mailbox < 3; mailbox++) {
+        auto status = tsr >> (8 * mailbox);
+
+        if (!(status & CAN_TSR_RQCP0))
+            continue;
+
+        state->txArbitrationLost &= ~(1 << mailbox);
+
+        if (status & CAN_TSR_TXOK0) {
+            auto tir = CANx->sTxMailBox[mailbox].TIR;
+
+            state->statistics.TransmittedFrames++;
+
+            CanStatistics_AddFrame(state->statistics, now, (tir & CAN_Id_Extended) != 0, (tir & CAN_Rtr_Frame) != 0, CANx->sTxMailBox[mailbox].TDTR & 0x0F);
+        }
     }
 
+    // Write one to clear, which also clears TXOK, ALST and TERR of those mailboxes only
+    CANx->TSR = completed;
+}
+
+// Must be called with interrupts disabled.
+static void STM32F7_Can_TxFillMailboxes(int32_t controllerIndex) {
+    auto state = &canStates[controllerIndex];
+
+    CAN_TypeDef* CANx = ((controllerIndex == 0) ? CAN1 : CAN2);
+
+    STM32F7_Can_TxCollect(state, CANx);
+
+    while (state->txCount > 0) {
+        auto message = &state->canTxMessagesQueue[state->txCount - 1].message;
+
+        // The queue is in priority order, so whatever follows a held back frame waits as well
+        if (STM32F7_Can_TxIsIdentifierPending(CANx, STM32F7_Can_TxIdentifier(*message)))
+            break;
+
+        if (CAN_Transmit(CANx, message) == CAN_TxStatus_NoMailBox)
+            break;
+
+        state->txCount--;
+    }
+
+    // TME fires when a request completes, so it stays on until every mailbox has been collected
+    if (state->txCount > 0 || (CANx->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) != (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2))
+        CANx->IER |= CAN_IT_TME;
+    else
+        CANx->IER &= ~CAN_IT_TME;
+}
+
+// Returns true when the frame was stored in the receive buffer.
+static bool STM32F7_Can_RxStoreMessage(CanState* state, const STM32F7_Can_RxMessage& rxMessage, uint64_t t) {
+    int32_t len = 0;
+
+    uint32_t msgid = 0;
+
+    bool extendMode = 0;
+    bool rtrmode = 0;
+
+    char passed = 0;
+
+    STM32F7_Can_Message *can_msg;
+
     len = rxMessage.DLC;
 
     if (rxMessage.IDE == CAN_Id_Standard) {
@@ -1234,8 +1509,12 @@ void STM32F7_Can_RxInterruptHandler(int32_t controllerIndex) {
 
     rtrmode = (((rxMessage.RTR) & CAN_Rtr_Frame) != 0) ? true : false;
 
+    state->statistics.ReceivedFrames++;
+
+    CanStatistics_AddFrame(state->statistics, t, extendMode, rtrmode, len);
+
     // Filter
-    if (state->canDataFilter.groupFiltersSize || state->canDataFilter.matchFiltersSize) {
+    if (!state->canDataFilter.hardwareFiltered && (state->canDataFilter.groupFiltersSize || state->canDataFilter.matchFiltersSize)) {
         if (state->canDataFilter.groupFiltersSize) {
             if (BinarySearch2(state->canDataFilter.lowerBoundFilters, state->canDataFilter.upperBoundFilters, 0, state->canDataFilter.groupFiltersSize - 1, msgid) >= 0)
                 passed = 1;
@@ -1247,18 +1526,37 @@ void STM32F7_Can_RxInterruptHandler(int32_t controllerIndex) {
         }
 
         if (!passed) {
-            return;
+            state->statistics.FilteredFrames++;
+
+            return false;
         }
     }
 
-    // timestamp
-    t = STM32F7_Time_GetSystemTime(nullptr);
-
     if (!state->enable)
-        return; // Not copy to internal buffer if enable if off
+        return false; // Not copy to internal buffer if enable if off
+
+    if (state->frameHandler != nullptr) {
+        TinyCLR_Can_Message message;
+
+        message.ArbitrationId = msgid;
+        message.IsExtendedId = extendMode;
+        message.IsRemoteTransmissionRequest = rtrmode;
+        message.Length = len;
+        message.Timestamp = t;
+
+        memcpy(message.Data, rxMessage.Data, sizeof(rxMessage.Data));
+
+        if (state->frameHandler(message, t, state->frameHandlerContext))
+            return false;
+    }
+
+    if (state->rxCount == state->rxBufferSize) {
+        state->statistics.OverflowFrames++;
 
-    if (state->rxCount == state->rxBufferSize) { // Return if internal buffer is full
         state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::BufferFull;
+
+        // Drop the frame: the next slot is rxOut, which ReadMessage may be copying from
+        return false;
     }
     else if (state->rxCount >= state->rxBufferSize - CAN_MINIMUM_MESSAGES_LEFT) { // Raise full event soon when internal buffer has only 3 availble msg left
         state->errorEvent = 1 << (uint8_t)TinyCLR_Can_Error::BufferFull;
@@ -1266,15 +1564,9 @@ void STM32F7_Can_RxInterruptHandler(int32_t controllerIndex) {
 
     can_msg = &state->canRxMessagesFifo[state->rxIn++];
 
-    can_msg->TimeStampL = t & 0xFFFFFFFF;
-
-    can_msg->TimeStampH = t >> 32;
-
-    can_msg->MsgID = msgid;
+    can_msg->MsgID = msgid | (extendMode ? CAN_MESSAGE_EXTENDED_ID : 0) | (rtrmode ? CAN_MESSAGE_REMOTE_TRANSMISSION_REQUEST : 0);
 
-    can_msg->extendedId = extendMode;
-
-    can_msg->remoteTransmissionRequest = rtrmode;
+    can_msg->TimeStamp = STM32F7_Can_RxTimeStamp(state, t, len);
 
     if (rtrmode) {
         can_msg->DataA = 0x00000000;
@@ -1285,20 +1577,65 @@ void STM32F7_Can_RxInterruptHandler(int32_t controllerIndex) {
         can_msg->DataB = rxMessage.Data[4] | (rxMessage.Data[5] << 8) | (rxMessage.Data[6] << 16) | (rxMessage.Data[7] << 24);
     }
 
-    can_msg->length = len;
-
-    if (state->rxCount < state->rxBufferSize) {
-        state->rxCount++;        
-    }
+    state->rxCount++;
 
     if (state->rxIn == state->rxBufferSize) {
         state->rxIn = 0;
     }
 
-    if (state->messageReceivedEventHandler != nullptr) {
+    return true;
+}
+
+// Serves both FIFO interrupts. The hardware FIFOs are only three deep, so every pending frame is
+// drained before returning instead of taking one interrupt per frame. When both FIFOs hold a frame
+// the one with the older bit time stamp goes first, so the buffer sees frames in bus order. The
+// 16 bit stamp wraps after 65536 bit times, far longer than the six frames the FIFOs can hold.
+void STM32F7_Can_RxInterruptHandler(int32_t controllerIndex) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    auto state = reinterpret_cast<CanState*>(&canStates[controllerIndex]);
+
+    CAN_TypeDef* CANx = ((controllerIndex == 0) ? CAN1 : CAN2);
+
+    STM32F7_Can_RxMessage rxMessage;
+
+    size_t received = 0;
+
+    CAN_ErrorHandler(controllerIndex);
+
+    // A frame that won arbitration against a pending request is being received now
+    STM32F7_Can_TxPollArbitration(state, CANx);
+
+    // Frames drained together share one timestamp
+    auto t = STM32F7_Time_GetSystemTime(nullptr);
+
+    while (true) {
+        auto pending0 = (CANx->RF0R & CAN_RF0R_FMP0) != 0;
+        auto pending1 = (CANx->RF1R & CAN_RF1R_FMP1) != 0;
+
+        if (!pending0 && !pending1)
+            break;
+
+        uint8_t fifo = pending0 ? CAN_FIFO0 : CAN_FIFO1;
+
+        if (pending0 && pending1) {
+            auto time0 = (uint16_t)(CANx->sFIFOMailBox[CAN_FIFO0].RDTR >> 16);
+            auto time1 = (uint16_t)(CANx->sFIFOMailBox[CAN_FIFO1].RDTR >> 16);
+
+            if ((int16_t)(time1 - time0) < 0)
+                fifo = CAN_FIFO1;
+        }
+
+        CAN_Receive(CANx, fifo, &rxMessage);
+
+        if (STM32F7_Can_RxStoreMessage(state, rxMessage, t))
+            received++;
+    }
+
+    if (received > 0 && state->messageReceivedEventHandler != nullptr) {
         auto now = t;
 
-        state->lastEventRxBufferCount++;
+        state->lastEventRxBufferCount += received;
 
         if (now > (state->lastRxTime + CAN_EVENT_POST_DEBOUNCE_TICKS)) {
             state->messageReceivedEventHandler(state->controller, state->lastEventRxBufferCount, now);
@@ -1309,12 +1646,20 @@ void STM32F7_Can_RxInterruptHandler(int32_t controllerIndex) {
     }
 }
 
+void STM32F7_Can_TxInterruptHandler(int32_t controllerIndex) {
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    STM32F7_Can_TxFillMailboxes(controllerIndex);
+
+    CAN_ErrorHandler(controllerIndex);
+}
+
 void STM32F7_Can_TxInterruptHandler0(void *param) {
-    CAN_ErrorHandler(0);
+    STM32F7_Can_TxInterruptHandler(0);
 }
 
 void STM32F7_Can_TxInterruptHandler1(void *param) {
-    CAN_ErrorHandler(1);
+    STM32F7_Can_TxInterruptHandler(1);
 }
 
 void STM32F7_Can_RxInterruptHandler0(void *param) {
@@ -1350,13 +1695,20 @@ TinyCLR_Result STM32F7_Can_Acquire(const TinyCLR_Can_Controller* self) {
         state->enable = false;
 
         state->canRxMessagesFifo = nullptr;
+        state->canTxMessagesQueue = nullptr;
+        state->txCount = 0;
+        state->txArbitrationLost = 0;
 
         STM32F7_Can_SetReadBufferSize(self, canDefaultBuffersSize[controllerIndex]);
+        STM32F7_Can_SetWriteBufferSize(self, STM32F7_CAN_TX_BUFFER_DEFAULT_SIZE);
 
         state->lastRxTime = 0;
         state->errorEvent = 0;
         state->lastEventRxBufferCount = 0;
 
+        CanStatistics_Reset(state->statistics, STM32F7_Time_GetSystemTime(nullptr));
+
+        state->frameHandler = nullptr;
         state->errorEventHandler = nullptr;
         state->messageReceivedEventHandler = nullptr;
 
@@ -1393,6 +1745,12 @@ TinyCLR_Result STM32F7_Can_Release(const TinyCLR_Can_Controller* self) {
             state->canRxMessagesFifo = nullptr;
         }
 
+        if (state->canTxMessagesQueue != nullptr) {
+            memoryProvider->Free(memoryProvider, state->canTxMessagesQueue);
+
+            state->canTxMessagesQueue = nullptr;
+        }
+
         STM32F7_Can_SetMessageReceivedHandler(self, nullptr);
         STM32F7_Can_SetErrorReceivedHandler(self, nullptr);
 
@@ -1406,111 +1764,113 @@ TinyCLR_Result STM32F7_Can_Release(const TinyCLR_Can_Controller* self) {
     return TinyCLR_Result::Success;
 }
 
-TinyCLR_Result STM32F7_Can_WriteMessage(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& len) {
-    if (len != 1) return TinyCLR_Result::NotSupported;
+static void STM32F7_Can_PrepareTxEntry(const TinyCLR_Can_Message& m, STM32F7_Can_TxQueueEntry& entry) {
+    auto& txMessage = entry.message;
+
+    txMessage.RTR = (m.IsRemoteTransmissionRequest == true) ? CAN_Rtr_Frame : 0;
+
+    if (m.IsExtendedId) {
+        txMessage.IDE = CAN_Id_Extended;
+        txMessage.ExtId = m.ArbitrationId & 0x1FFFFFFF;
+        txMessage.StdId = 0;
+
+        entry.priority = (txMessage.ExtId << 1) | 1;
+    }
+    else {
+        txMessage.IDE = CAN_Id_Standard;
+        txMessage.StdId = m.ArbitrationId & 0x7FF;
+        txMessage.ExtId = 0;
+
+        // Base identifier lines up with the top 11 bits of an extended one, standard frame wins a tie
+        entry.priority = txMessage.StdId << 19;
+    }
+
+    txMessage.DLC = m.Length & 0x0F;
 
-    auto& m = messages[0];
-    uint32_t arbitrationId = m.ArbitrationId;
-    bool isExtendedId = m.IsExtendedId;
-    bool isRemoteTransmissionRequest = m.IsRemoteTransmissionRequest;
-    const uint8_t* data = m.Data;
-    size_t length = m.Length;
+    for (auto i = 0; i < 8; i++)
+        txMessage.Data[i] = m.Data[i];
+}
 
+TinyCLR_Result STM32F7_Can_WriteMessage(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& len) {
     auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
 
     if (!state->enable) return TinyCLR_Result::InvalidOperation;
 
     auto controllerIndex = state->controllerIndex;
 
-    uint32_t* data32 = (uint32_t*)data;
+    STM32F7_Can_TxQueueEntry entry;
 
-    CAN_TypeDef* CANx = ((controllerIndex == 0) ? CAN1 : CAN2);
+    size_t queued = 0;
 
-    uint32_t i = 0;
+    for (; queued < len; queued++) {
+        STM32F7_Can_PrepareTxEntry(messages[queued], entry);
 
-    uint8_t txmailbox;
-
-    STM32F7_Can_TxMessage txMessage;
+        DISABLE_INTERRUPTS_SCOPED(irq);
 
-    /* Transmit Structure preparation */
-    txMessage.RTR = (isRemoteTransmissionRequest == true) ? CAN_Rtr_Frame : 0;
+        if (!STM32F7_Can_TxEnqueue(state, entry)) {
+            STM32F7_Can_TxFillMailboxes(controllerIndex);
 
-    if (isExtendedId) {
-        txMessage.IDE = CAN_Id_Extended;
-        txMessage.ExtId = arbitrationId;
-    }
-    else {
-        txMessage.IDE = CAN_Id_Standard;
-        txMessage.StdId = arbitrationId;
+            if (!STM32F7_Can_TxEnqueue(state, entry))
+                break;
+        }
     }
-    txMessage.DLC = length & 0x0F;
 
-    txMessage.Data[0] = ((data32[0] >> 0) & 0xFF);
-    txMessage.Data[1] = ((data32[0] >> 8) & 0xFF);
-    txMessage.Data[2] = ((data32[0] >> 16) & 0xFF);
-    txMessage.Data[3] = ((data32[0] >> 24) & 0xFF);
-    txMessage.Data[4] = ((data32[1] >> 0) & 0xFF);
-    txMessage.Data[5] = ((data32[1] >> 8) & 0xFF);
-    txMessage.Data[6] = ((data32[1] >> 16) & 0xFF);
-    txMessage.Data[7] = ((data32[1] >> 24) & 0xFF);
+    {
+        DISABLE_INTERRUPTS_SCOPED(irq);
 
-    txmailbox = CAN_Transmit(CANx, &txMessage);
+        STM32F7_Can_TxFillMailboxes(controllerIndex);
+    }
 
-    while (CAN_TransmitStatus(CANx, txmailbox) != CAN_TxStatus_Ok && i++ < CAN_GetTransferTimeout())
-        STM32F7_Time_Delay(nullptr, 1);
+    auto requested = len;
 
-    if (txmailbox == CAN_TxStatus_NoMailBox || i == CAN_GetTransferTimeout()) {
+    len = queued;
 
-        CAN_CancelTransmit(CANx, txmailbox);
-        CAN_ErrorHandler(controllerIndex);
-        return TinyCLR_Result::InvalidOperation;
-    }
-
-    return TinyCLR_Result::Success;
+    return (queued > 0 || requested == 0) ? TinyCLR_Result::Success : TinyCLR_Result::Busy;
 }
 
 TinyCLR_Result STM32F7_Can_ReadMessage(const TinyCLR_Can_Controller* self, TinyCLR_Can_Message* messages, size_t& len) {
-    if (len != 1) return TinyCLR_Result::NotSupported;
-
-    auto& m = messages[0];
-    uint32_t& arbitrationId = m.ArbitrationId;
-    bool& isExtendedId = m.IsExtendedId;
-    bool& isRemoteTransmissionRequest = m.IsRemoteTransmissionRequest;
-    uint8_t* data = m.Data;
-    size_t& length = m.Length;
-    uint64_t& timestamp = m.Timestamp;
-
     auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
 
     if (!state->enable) return TinyCLR_Result::InvalidOperation;
 
     STM32F7_Can_Message *can_msg;
 
-    uint32_t* data32 = (uint32_t*)data;
+    // Only the rx interrupt moves rxIn and it drops frames instead of storing into a full buffer, so it
+    // never writes the slots counted here. They can be copied with interrupts enabled and handed back
+    // to the fifo with a single update of rxCount.
+    size_t available = state->rxCount;
+    size_t read = len < available ? len : available;
+
+    for (size_t i = 0; i < read; i++) {
+        auto& m = messages[i];
+
+        uint32_t* data32 = (uint32_t*)m.Data;
 
-    if (state->rxCount) {
         can_msg = &state->canRxMessagesFifo[state->rxOut++];
 
         if (state->rxOut == state->rxBufferSize)
             state->rxOut = 0;
 
-        arbitrationId = can_msg->MsgID;
-        isExtendedId = can_msg->extendedId;
-        isRemoteTransmissionRequest = can_msg->remoteTransmissionRequest;
-        length = can_msg->length;
+        m.ArbitrationId = can_msg->MsgID & CAN_MESSAGE_ID_MASK;
+        m.IsExtendedId = (can_msg->MsgID & CAN_MESSAGE_EXTENDED_ID) != 0;
+        m.IsRemoteTransmissionRequest = (can_msg->MsgID & CAN_MESSAGE_REMOTE_TRANSMISSION_REQUEST) != 0;
+        m.Length = can_msg->TimeStamp >> CAN_MESSAGE_LENGTH_SHIFT;
 
         data32[0] = can_msg->DataA;
         data32[1] = can_msg->DataB;
 
-        timestamp = ((uint64_t)can_msg->TimeStampL) | ((uint64_t)can_msg->TimeStampH << 32);
+        // The epoch only moves when the buffer is empty, so it is stable while these are unread
+        m.Timestamp = state->rxEpoch + ((uint64_t)(can_msg->TimeStamp & CAN_MESSAGE_TIMESTAMP_MASK) << STM32F7_CAN_TIMESTAMP_SHIFT);
+    }
 
-        {
-            DISABLE_INTERRUPTS_SCOPED(irq);
+    if (read > 0) {
+        DISABLE_INTERRUPTS_SCOPED(irq);
 
-            state->rxCount--;                        
-        }
+        state->rxCount -= read;
     }
 
+    len = read;
+
     return TinyCLR_Result::Success;
 }
 
@@ -1524,6 +1884,8 @@ TinyCLR_Result STM32F7_Can_SetBitTiming(const TinyCLR_Can_Controller* self, cons
 
     state->baudrate = (synchronizationJumpWidth << 24) | (phase2 << 20) | (phase1 << 16) | baudratePrescaler;
 
+    CanStatistics_SetBitTiming(state->statistics, STM32F7_Can_GetSourceClock(self), timing);
+
     return TinyCLR_Result::Success;
 }
 
@@ -1534,7 +1896,19 @@ size_t STM32F7_Can_GetMessagesToRead(const TinyCLR_Can_Controller* self) {
 }
 
 size_t STM32F7_Can_GetMessagesToWrite(const TinyCLR_Can_Controller* self) {
-    return 0;
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    if (!state->enable) return 0;
+
+    CAN_TypeDef* CANx = ((state->controllerIndex == 0) ? CAN1 : CAN2);
+
+    size_t pending = state->txCount;
+
+    if ((CANx->TSR & CAN_TSR_TME0) == 0) pending++;
+    if ((CANx->TSR & CAN_TSR_TME1) == 0) pending++;
+    if ((CANx->TSR & CAN_TSR_TME2) == 0) pending++;
+
+    return pending;
 }
 
 TinyCLR_Can_Error STM32F7_Can_GetError(uint32_t error) {
@@ -1656,6 +2030,9 @@ TinyCLR_Result STM32F7_Can_SetExplicitFilters(const TinyCLR_Can_Controller* self
         state->canDataFilter.matchFilters = _matchFilters;
     }
 
+    if (state->enable)
+        STM32F7_Can_ApplyFilters(state->controllerIndex);
+
     return TinyCLR_Result::Success;
 }
 
@@ -1690,16 +2067,19 @@ TinyCLR_Result STM32F7_Can_SetGroupFilters(const TinyCLR_Can_Controller* self, c
         return TinyCLR_Result::ArgumentInvalid;
     }
 
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
     {
         DISABLE_INTERRUPTS_SCOPED(irq);
 
-        auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
-
         state->canDataFilter.groupFiltersSize = count;
         state->canDataFilter.lowerBoundFilters = _lowerBoundFilters;
         state->canDataFilter.upperBoundFilters = _upperBoundFilters;
     }
 
+    if (state->enable)
+        STM32F7_Can_ApplyFilters(state->controllerIndex);
+
     return TinyCLR_Result::Success;
 }
 
@@ -1748,6 +2128,45 @@ size_t STM32F7_Can_GetWriteErrorCount(const TinyCLR_Can_Controller* self) {
     return (size_t)((CANx->ESR & CAN_ESR_REC) >> 16);
 }
 
+TinyCLR_Result STM32F7_Can_GetStatistics(const TinyCLR_Can_Controller* self, CanStatistics& statistics) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    auto now = STM32F7_Time_GetSystemTime(nullptr);
+
+    if (state->enable)
+        CanStatistics_SetErrorState(state->statistics, now, STM32F7_Can_GetErrorState(state->controllerIndex));
+
+    CanStatistics_Update(state->statistics, now);
+
+    statistics = state->statistics;
+
+    return TinyCLR_Result::Success;
+}
+
+TinyCLR_Result STM32F7_Can_ResetStatistics(const TinyCLR_Can_Controller* self) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    CanStatistics_Reset(state->statistics, STM32F7_Time_GetSystemTime(nullptr));
+
+    return TinyCLR_Result::Success;
+}
+
+// Frames the handler accepts are consumed in the receive interrupt and never reach the read buffer
+TinyCLR_Result STM32F7_Can_SetFrameHandler(const TinyCLR_Can_Controller* self, STM32F7_Can_FrameHandler handler, void* context) {
+    auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
+
+    DISABLE_INTERRUPTS_SCOPED(irq);
+
+    state->frameHandler = handler;
+    state->frameHandlerContext = context;
+
+    return TinyCLR_Result::Success;
+}
+
 uint32_t STM32F7_Can_GetSourceClock(const TinyCLR_Can_Controller* self) {
     return STM32F7_APB1_CLOCK_HZ;
 }
@@ -1758,6 +2177,7 @@ void STM32F7_Can_Reset() {
 
         canStates[i].initializeCount = 0;
         canStates[i].canRxMessagesFifo = nullptr;
+        canStates[i].canTxMessagesQueue = nullptr;
     }
 }
 
@@ -1781,12 +2201,12 @@ TinyCLR_Result STM32F7_Can_Enable(const TinyCLR_Can_Controller* self) {
 
         RCC->APB1ENR |= ((controllerIndex == 0) ? RCC_APB1ENR_CAN1EN : (RCC_APB1ENR_CAN1EN | RCC_APB1ENR_CAN2EN));
 
-        state->initTypeDef.CAN_TTCM = DISABLE;
+        state->initTypeDef.CAN_TTCM = ENABLE; // Stamps received frames so the two FIFOs can be merged in bus order
         state->initTypeDef.CAN_ABOM = DISABLE;
         state->initTypeDef.CAN_AWUM = DISABLE;
         state->initTypeDef.CAN_NART = DISABLE;
         state->initTypeDef.CAN_RFLM = DISABLE;
-        state->initTypeDef.CAN_TXFP = DISABLE;
+        state->initTypeDef.CAN_TXFP = DISABLE; // Identifier priority, see STM32F7_Can_TxIsIdentifierPending
         state->initTypeDef.CAN_Mode = CAN_Mode_Normal;
 
         state->initTypeDef.CAN_SJW = ((state->baudrate >> 24) & 0x03);
@@ -1796,29 +2216,20 @@ TinyCLR_Result STM32F7_Can_Enable(const TinyCLR_Can_Controller* self) {
 
         CAN_Initialize(CANx, &state->initTypeDef);
 
-        state->filterInitTypeDef.CAN_FilterNumber = (controllerIndex == 0 ? 0 : 14);
-
-        state->filterInitTypeDef.CAN_FilterMode = CAN_FilterMode_IdMask;
-        state->filterInitTypeDef.CAN_FilterScale = CAN_FilterScale_32bit;
-        state->filterInitTypeDef.CAN_FilterIdHigh = 0x0000;
-        state->filterInitTypeDef.CAN_FilterIdLow = 0x0000;
-        state->filterInitTypeDef.CAN_FilterMaskIdHigh = 0x0000;
-        state->filterInitTypeDef.CAN_FilterMaskIdLow = 0x0000;
-        state->filterInitTypeDef.CAN_FilterFIFOAssignment = 0;
-        state->filterInitTypeDef.CAN_FilterActivation = ENABLE;
-
-        CAN_FilterInit(&state->filterInitTypeDef);
+        STM32F7_Can_ApplyFilters(controllerIndex);
 
         if (controllerIndex == 0) {
             STM32F7_InterruptInternal_Activate(CAN1_TX_IRQn, (uint32_t*)&STM32F7_Can_TxInterruptHandler0, 0);
             STM32F7_InterruptInternal_Activate(CAN1_RX0_IRQn, (uint32_t*)&STM32F7_Can_RxInterruptHandler0, 0);
+            STM32F7_InterruptInternal_Activate(CAN1_RX1_IRQn, (uint32_t*)&STM32F7_Can_RxInterruptHandler0, 0);
         }
         else {
             STM32F7_InterruptInternal_Activate(CAN2_TX_IRQn, (uint32_t*)&STM32F7_Can_TxInterruptHandler1, 0);
             STM32F7_InterruptInternal_Activate(CAN2_RX0_IRQn, (uint32_t*)&STM32F7_Can_RxInterruptHandler1, 0);
+            STM32F7_InterruptInternal_Activate(CAN2_RX1_IRQn, (uint32_t*)&STM32F7_Can_RxInterruptHandler1, 0);
         }
 
-        CANx->IER |= (CAN_IT_FMP0 | CAN_IT_FF0 | CAN_IT_FOV0 | CAN_IT_EWG | CAN_IT_EPV | CAN_IT_BOF | CAN_IT_LEC | CAN_IT_ERR);
+        CANx->IER |= (CAN_IT_FMP0 | CAN_IT_FF0 | CAN_IT_FOV0 | CAN_IT_FMP1 | CAN_IT_FF1 | CAN_IT_FOV1 | CAN_IT_EWG | CAN_IT_EPV | CAN_IT_BOF | CAN_IT_LEC | CAN_IT_ERR);
 
         state->enable = true;
     }
@@ -1833,17 +2244,22 @@ TinyCLR_Result STM32F7_Can_Disable(const TinyCLR_Can_Controller* self) {
 
         CAN_TypeDef* CANx = ((controllerIndex == 0) ? CAN1 : CAN2);
 
-        CANx->IER &= ~(CAN_IT_FMP0 | CAN_IT_FF0 | CAN_IT_FOV0 | CAN_IT_EWG | CAN_IT_EPV | CAN_IT_BOF | CAN_IT_LEC | CAN_IT_ERR);
+        CANx->IER &= ~(CAN_IT_TME | CAN_IT_FMP0 | CAN_IT_FF0 | CAN_IT_FOV0 | CAN_IT_FMP1 | CAN_IT_FF1 | CAN_IT_FOV1 | CAN_IT_EWG | CAN_IT_EPV | CAN_IT_BOF | CAN_IT_LEC | CAN_IT_ERR);
+
+        state->txCount = 0;
+        state->txArbitrationLost = 0;
 
         RCC->APB1ENR &= ((controllerIndex == 0) ? ~RCC_APB1ENR_CAN1EN : ~RCC_APB1ENR_CAN2EN);
 
         if (controllerIndex == 0) {
             STM32F7_InterruptInternal_Deactivate(CAN1_TX_IRQn);
             STM32F7_InterruptInternal_Deactivate(CAN1_RX0_IRQn);
+            STM32F7_InterruptInternal_Deactivate(CAN1_RX1_IRQn);
         }
         else {
             STM32F7_InterruptInternal_Deactivate(CAN2_TX_IRQn);
             STM32F7_InterruptInternal_Deactivate(CAN2_RX0_IRQn);
+            STM32F7_InterruptInternal_Deactivate(CAN2_RX1_IRQn);
         }
 
         state->enable = false;
@@ -1854,10 +2270,8 @@ TinyCLR_Result STM32F7_Can_Disable(const TinyCLR_Can_Controller* self) {
 
 bool STM32F7_Can_CanWriteMessage(const TinyCLR_Can_Controller* self) {
     auto state = reinterpret_cast<CanState*>(self->ApiInfo->State);
-    bool canWrite;
 
-    STM32F7_Can_IsWritingAllowed(self, canWrite);
-    return (state->enable && canWrite);
+    return (state->enable && state->txCount < (int32_t)state->txBufferSize);
 }
 
 bool STM32F7_Can_CanReadMessage(const TinyCLR_Can_Controller* self) {
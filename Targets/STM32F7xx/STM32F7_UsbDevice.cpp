@@ -450,12 +450,12 @@ void STM32F7_UsbDevice_EndpointRxInterrupt(OTG_TypeDef* OTG, UsbClientState* usb
         usbClientState->dataSize = count;
     }
     else { // data endpoint
-        USB_PACKET64* Packet64 = TinyCLR_UsbClient_RxEnqueue(usbClientState, ep, disableRx);
+        USB_PACKET* Packet = TinyCLR_UsbClient_RxEnqueue(usbClientState, ep, disableRx);
 
         if (disableRx) return;
 
-        pd = (uint32_t*)Packet64->Buffer;
-        Packet64->Size = count;
+        pd = (uint32_t*)Packet->Buffer;
+        Packet->Size = count;
     }
 
     // read data
@@ -484,11 +484,11 @@ void STM32F7_UsbDevice_EndpointInInterrupt(OTG_TypeDef* OTG, UsbClientState* usb
         }
         else if (usbClientState->queues[ep] != 0 && usbClientState->isTxQueue[ep]) { // Tx data endpoint
 
-            USB_PACKET64* Packet64 = TinyCLR_UsbClient_TxDequeue(usbClientState, ep);
+            USB_PACKET* Packet = TinyCLR_UsbClient_TxDequeue(usbClientState, ep);
 
-            if (Packet64) {  // data to send
-                ps = (uint32_t*)Packet64->Buffer;
-                count = Packet64->Size;
+            if (Packet) {  // data to send
+                ps = (uint32_t*)Packet->Buffer;
+                count = Packet->Size;
             }
         }
 
@@ -775,6 +775,11 @@ void TinyCLR_UsbClient_InitializeConfiguration(UsbClientState *usbClientState) {
     STM32F7_UsbDevice_InitializeConfiguration(usbClientState);
 }
 
+// Bulk endpoints are limited to 64 bytes as the controller runs at full speed
+#if STM32F7_USB_ENDPOINT_SIZE > 64
+#error "STM32F7_USB_ENDPOINT_SIZE can't be larger than 64 at full speed"
+#endif
+
 uint32_t TinyCLR_UsbClient_GetEndpointSize(int32_t endpoint) {
     return endpoint == 0 ? STM32F7_USB_ENDPOINT0_SIZE : STM32F7_USB_ENDPOINT_SIZE;
 }
\ No newline at end of file
@@ -0,0 +1,223 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <initializer_list>
+#include <stdlib.h>
+#include "HostTest.h"
+#include "CanFilter.h"
+
+// What the bxCAN filter hardware does with the banks: a frame passes when any id/mask pair matches its RIR image
+static bool IsAcceptedByBanks(const CanFilter_Banks& banks, uint32_t id, bool extended, bool remote) {
+    uint32_t image32 = extended ? (id << 3) | (1 << 2) : (id << 21);
+    uint32_t image16 = extended ? (((id >> 18) & 0x7FF) << 5) | (1 << 3) | ((id >> 15) & 0x07) : (id << 5);
+
+    if (remote) {
+        image32 |= 1 << 1;
+        image16 |= 1 << 4;
+    }
+
+    for (size_t i = 0; i < banks.Used; i++) {
+        auto& bank = banks.Bank[i];
+
+        if (bank.Scale == CAN_FILTER_SCALE_32BIT) {
+            if (((image32 ^ bank.Fr1) & bank.Fr2) == 0)
+                return true;
+        }
+        else {
+            for (auto fr : { bank.Fr1, bank.Fr2 })
+                if (((image16 ^ (fr & 0xFFFF)) & (fr >> 16)) == 0)
+                    return true;
+        }
+    }
+
+    return false;
+}
+
+static bool IsAcceptedBySearch(const uint32_t* matchFilters, size_t matchFiltersSize, const uint32_t* lowerBoundFilters, const uint32_t* upperBoundFilters, size_t groupFiltersSize, uint32_t id) {
+    for (size_t i = 0; i < matchFiltersSize; i++)
+        if (matchFilters[i] == id)
+            return true;
+
+    for (size_t i = 0; i < groupFiltersSize; i++)
+        if (id >= lowerBoundFilters[i] && id <= upperBoundFilters[i])
+            return true;
+
+    return false;
+}
+
+// Random sorted filters that fit the banks must accept exactly the identifiers the software search accepts
+static void TestBanksMatchSearch() {
+    size_t compiled = 0;
+
+    srand(1);
+
+    for (auto iteration = 0; iteration < 2000; iteration++) {
+        uint32_t matchFilters[4];
+        uint32_t lowerBoundFilters[3];
+        uint32_t upperBoundFilters[3];
+        size_t matchFiltersSize = rand() % 4;
+        size_t groupFiltersSize = rand() % 3;
+
+        for (size_t i = 0; i < matchFiltersSize; i++)
+            matchFilters[i] = (i > 0 ? matchFilters[i - 1] : 0) + 1 + rand() % (rand() % 2 ? 3 : 3000);
+
+        uint32_t base = rand() % 4096;
+
+        for (size_t i = 0; i < groupFiltersSize; i++) {
+            lowerBoundFilters[i] = base;
+            upperBoundFilters[i] = base + rand() % 300;
+
+            base = upperBoundFilters[i] + 1 + rand() % 100;
+        }
+
+        CanFilter_Banks banks;
+
+        if (!CanFilter_CompileBanks(matchFilters, matchFiltersSize, lowerBoundFilters, upperBoundFilters, groupFiltersSize, banks))
+            continue;
+
+        compiled++;
+
+        for (uint32_t id = 0; id < 5000; id++) {
+            auto expected = IsAcceptedBySearch(matchFilters, matchFiltersSize, lowerBoundFilters, upperBoundFilters, groupFiltersSize, id);
+
+            for (auto remote : { false, true }) {
+                if (id <= CAN_FILTER_STANDARD_ID_MAX)
+                    HOST_CHECK(IsAcceptedByBanks(banks, id, false, remote) == expected);
+
+                HOST_CHECK(IsAcceptedByBanks(banks, id, true, remote) == expected);
+            }
+        }
+    }
+
+    HOST_CHECK(compiled > 1000);
+}
+
+static void TestSharedStandardBank() {
+    uint32_t matchFilters[] = { 0x100, 0x200 };
+    CanFilter_Banks banks;
+
+    // Each identifier needs a 16-bit pair for standard frames, both pairs share a bank, and a 32-bit bank for extended
+    HOST_CHECK(CanFilter_CompileBanks(matchFilters, 2, nullptr, nullptr, 0, banks));
+    HOST_CHECK(banks.Used == 3);
+}
+
+static void TestTooManyFilters() {
+    uint32_t matchFilters[CAN_FILTER_BANKS_PER_CONTROLLER * 2];
+    CanFilter_Banks banks;
+
+    for (size_t i = 0; i < CAN_FILTER_BANKS_PER_CONTROLLER * 2; i++)
+        matchFilters[i] = 0x10 * (i + 1);
+
+    HOST_CHECK(!CanFilter_CompileBanks(matchFilters, CAN_FILTER_BANKS_PER_CONTROLLER * 2, nullptr, nullptr, 0, banks));
+}
+
+static void TestWholeRange() {
+    uint32_t lowerBoundFilters[] = { 0 };
+    uint32_t upperBoundFilters[] = { CAN_FILTER_EXTENDED_ID_MAX };
+    CanFilter_Banks banks;
+
+    HOST_CHECK(CanFilter_CompileBanks(nullptr, 0, lowerBoundFilters, upperBoundFilters, 1, banks));
+    HOST_CHECK(banks.Used == 2);
+    HOST_CHECK(IsAcceptedByBanks(banks, 0x7FF, false, false));
+    HOST_CHECK(IsAcceptedByBanks(banks, CAN_FILTER_EXTENDED_ID_MAX, true, true));
+}
+
+static void* HostAllocate(const TinyCLR_Memory_Manager* self, size_t length) {
+    return malloc(length);
+}
+
+static void HostFree(const TinyCLR_Memory_Manager* self, void* ptr) {
+    free(ptr);
+}
+
+// The bitmap and the extended identifier set, with the group search the targets keep for extended identifiers,
+// must accept exactly what the software search accepts. Explicit identifiers may repeat.
+static void TestBitmapAndSetMatchSearch() {
+    TinyCLR_Memory_Manager memoryManager = { nullptr, &HostAllocate, &HostFree };
+
+    srand(3);
+
+    for (auto iteration = 0; iteration < 300; iteration++) {
+        uint32_t matchFilters[40];
+        uint32_t lowerBoundFilters[6];
+        uint32_t upperBoundFilters[6];
+        size_t matchFiltersSize = rand() % 40;
+        size_t groupFiltersSize = rand() % 6;
+
+        for (size_t i = 0; i < matchFiltersSize; i++)
+            matchFilters[i] = rand() % 3 ? rand() % 3000 : (rand() % 2 ? CAN_FILTER_EXTENDED_ID_MAX - 40 + rand() % 41 : rand() % 100000);
+
+        std::sort(matchFilters, matchFilters + matchFiltersSize);
+
+        uint32_t base = rand() % 2500;
+
+        for (size_t i = 0; i < groupFiltersSize; i++) {
+            lowerBoundFilters[i] = base;
+            upperBoundFilters[i] = base + rand() % (rand() % 2 ? 50 : 5000);
+
+            base = upperBoundFilters[i] + 1 + rand() % 300;
+        }
+
+        uint32_t bitmap[CAN_FILTER_STANDARD_ID_COUNT / 32];
+        uint32_t* extendedIdSet;
+        uint32_t shift;
+
+        CanFilter_BuildStandardIdBitmap(bitmap, matchFilters, matchFiltersSize, lowerBoundFilters, upperBoundFilters, groupFiltersSize);
+
+        HOST_CHECK(CanFilter_BuildExtendedIdSet(&memoryManager, matchFilters, matchFiltersSize, extendedIdSet, shift) == TinyCLR_Result::Success);
+
+        auto check = [&](uint32_t id) {
+            auto expected = IsAcceptedBySearch(matchFilters, matchFiltersSize, lowerBoundFilters, upperBoundFilters, groupFiltersSize, id);
+            bool accepted;
+
+            if (id < CAN_FILTER_STANDARD_ID_COUNT)
+                accepted = CanFilter_IsInStandardIdBitmap(bitmap, id);
+            else
+                accepted = CanFilter_IsInExtendedIdSet(extendedIdSet, shift, id) || IsAcceptedBySearch(nullptr, 0, lowerBoundFilters, upperBoundFilters, groupFiltersSize, id);
+
+            HOST_CHECK(accepted == expected);
+        };
+
+        for (uint32_t id = 0; id < 120000; id++)
+            check(id);
+
+        for (uint32_t id = CAN_FILTER_EXTENDED_ID_MAX - 0xFF; id <= CAN_FILTER_EXTENDED_ID_MAX; id++)
+            check(id);
+
+        free(extendedIdSet);
+    }
+}
+
+static void TestEmptyExtendedIdSet() {
+    TinyCLR_Memory_Manager memoryManager = { nullptr, &HostAllocate, &HostFree };
+    uint32_t matchFilters[] = { 1, 2, 0x7FF };
+    uint32_t* extendedIdSet;
+    uint32_t shift;
+
+    HOST_CHECK(CanFilter_BuildExtendedIdSet(&memoryManager, matchFilters, 3, extendedIdSet, shift) == TinyCLR_Result::Success);
+    HOST_CHECK(extendedIdSet == nullptr);
+    HOST_CHECK(!CanFilter_IsInExtendedIdSet(extendedIdSet, shift, 0x800));
+}
+
+int main() {
+    TestBanksMatchSearch();
+    TestSharedStandardBank();
+    TestTooManyFilters();
+    TestWholeRange();
+    TestBitmapAndSetMatchSearch();
+    TestEmptyExtendedIdSet();
+
+    return HOST_TEST_RESULT("CanFilter");
+}
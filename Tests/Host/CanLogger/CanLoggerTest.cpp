@@ -0,0 +1,215 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "HostTest.h"
+#include "CanLogger.h"
+#include "StorageBenchmark.h"
+
+#define TEST_BLOCK_SIZE 4096
+
+static uint8_t memory[TEST_BLOCK_SIZE * 512];
+// Offset by a few bytes, the logger must not need an aligned buffer
+static uint8_t buffer[2 * TEST_BLOCK_SIZE + 3];
+
+static StorageBenchmark_SimulatedCard card;
+static CanLogger logger;
+static std::vector<TinyCLR_Can_Message> captured;
+static std::vector<TinyCLR_Can_Message> decoded;
+
+static void OnRecord(const TinyCLR_Can_Message& message, void* context) {
+    decoded.push_back(message);
+}
+
+static void Initialize(CanLogger_Configuration& configuration, size_t regionSize) {
+    StorageBenchmark_SimulatedCardTiming timing;
+
+    StorageBenchmark_SimulatedCard_GetDefaultTiming(timing);
+    StorageBenchmark_SimulatedCard_Initialize(card, timing, memory, TEST_BLOCK_SIZE);
+
+    memset(&configuration, 0, sizeof(configuration));
+
+    configuration.Storage = &card.storageController;
+    configuration.RegionAddress = CAN_LOGGER_SECTOR_SIZE * 8;
+    configuration.RegionSize = regionSize;
+    configuration.Buffer = buffer + 3;
+    configuration.BufferSize = sizeof(buffer) - 3;
+
+    HOST_CHECK(CanLogger_Initialize(logger, configuration) == TinyCLR_Result::Success);
+}
+
+static TinyCLR_Can_Message RandomMessage(uint64_t timestamp) {
+    TinyCLR_Can_Message message = {};
+
+    message.IsExtendedId = rand() & 1;
+    message.ArbitrationId = rand() & (message.IsExtendedId ? 0x1FFFFFFF : 0x7FF);
+    message.IsRemoteTransmissionRequest = rand() % 10 == 0;
+    message.Length = rand() % 9;
+    message.Timestamp = timestamp;
+
+    if (!message.IsRemoteTransmissionRequest)
+        for (size_t i = 0; i < message.Length; i++)
+            message.Data[i] = rand();
+
+    return message;
+}
+
+static bool IsSame(const TinyCLR_Can_Message& a, const TinyCLR_Can_Message& b) {
+    return a.ArbitrationId == b.ArbitrationId && a.IsExtendedId == b.IsExtendedId && a.IsRemoteTransmissionRequest == b.IsRemoteTransmissionRequest
+        && a.Length == b.Length && a.Timestamp == b.Timestamp && memcmp(a.Data, b.Data, sizeof(a.Data)) == 0;
+}
+
+// Decodes the region block by block until the first block that is not a log block
+static size_t DecodeRegion(const CanLogger_Configuration& configuration) {
+    CanLogger_BlockHeader header;
+    uint32_t sequence = 0;
+
+    decoded.clear();
+
+    for (auto address = configuration.RegionAddress; address + TEST_BLOCK_SIZE <= configuration.RegionAddress + configuration.RegionSize; address += TEST_BLOCK_SIZE) {
+        if (CanLogger_DecodeBlock(memory + address, TEST_BLOCK_SIZE, header, &OnRecord, nullptr) != TinyCLR_Result::Success)
+            break;
+
+        HOST_CHECK(header.Sequence == sequence);
+
+        sequence++;
+    }
+
+    return sequence;
+}
+
+// Every frame the logger accepted must come back from the blocks unchanged and in order, including time offsets
+// that need a new block base time after long gaps
+static void TestRoundTrip() {
+    CanLogger_Configuration configuration;
+    uint64_t time = 1000;
+
+    Initialize(configuration, TEST_BLOCK_SIZE * 500);
+
+    captured.clear();
+    srand(1);
+
+    HOST_CHECK(CanLogger_Start(logger) == TinyCLR_Result::Success);
+
+    for (auto i = 0; i < 50000; i++) {
+        time += rand() % 100 == 0 ? 5000000000ULL : rand() % 3000;
+
+        auto message = RandomMessage(time);
+
+        if (CanLogger_Capture(logger, message, time))
+            captured.push_back(message);
+
+        if (rand() % 50 == 0)
+            CanLogger_Process(logger);
+    }
+
+    HOST_CHECK(CanLogger_Stop(logger) == TinyCLR_Result::Success);
+
+    CanLogger_Status status;
+
+    CanLogger_GetStatus(logger, status);
+
+    HOST_CHECK(!status.Running);
+    HOST_CHECK(!captured.empty());
+    HOST_CHECK(status.CapturedFrames == captured.size());
+    HOST_CHECK(status.WriteErrors == 0);
+    HOST_CHECK(status.CapturedFrames + status.DroppedFrames == 50000);
+
+    auto blocks = DecodeRegion(configuration);
+
+    HOST_CHECK(blocks == status.WrittenBlocks);
+    HOST_CHECK(decoded.size() == captured.size());
+
+    for (size_t i = 0; i < decoded.size() && i < captured.size(); i++)
+        HOST_CHECK(IsSame(decoded[i], captured[i]));
+}
+
+// Without CanLogger_Process both halves fill up and further frames are counted as dropped, not lost silently
+static void TestDropsWithoutProcess() {
+    CanLogger_Configuration configuration;
+    TinyCLR_Can_Message message = {};
+    size_t accepted = 0;
+
+    Initialize(configuration, TEST_BLOCK_SIZE * 500);
+
+    message.Length = 8;
+
+    HOST_CHECK(CanLogger_Start(logger) == TinyCLR_Result::Success);
+
+    for (auto i = 0; i < 2000; i++)
+        accepted += CanLogger_Capture(logger, message, 10 + i) ? 1 : 0;
+
+    CanLogger_Status status;
+
+    CanLogger_GetStatus(logger, status);
+
+    HOST_CHECK(accepted > 0 && accepted < 2000);
+    HOST_CHECK(status.CapturedFrames == accepted);
+    HOST_CHECK(status.DroppedFrames == 2000 - accepted);
+
+    CanLogger_Stop(logger);
+}
+
+// Without Wrap logging stops at the end of the region and never writes past it
+static void TestRegionFull() {
+    CanLogger_Configuration configuration;
+
+    Initialize(configuration, TEST_BLOCK_SIZE * 4);
+
+    memset(memory, 0x5A, sizeof(memory));
+
+    HOST_CHECK(CanLogger_Start(logger) == TinyCLR_Result::Success);
+
+    for (auto i = 0; i < 20000; i++) {
+        auto message = RandomMessage(10 + i);
+
+        CanLogger_Capture(logger, message, 10 + i);
+        CanLogger_Process(logger);
+    }
+
+    CanLogger_Stop(logger);
+
+    CanLogger_Status status;
+
+    CanLogger_GetStatus(logger, status);
+
+    HOST_CHECK(status.WrittenBlocks == 4);
+    HOST_CHECK(DecodeRegion(configuration) == 4);
+    HOST_CHECK(memory[configuration.RegionAddress + configuration.RegionSize] == 0x5A);
+    HOST_CHECK(memory[configuration.RegionAddress - 1] == 0x5A);
+}
+
+static void TestDecodeInvalid() {
+    CanLogger_BlockHeader header;
+    uint8_t block[TEST_BLOCK_SIZE];
+
+    memset(block, 0xFF, sizeof(block));
+
+    HOST_CHECK(CanLogger_DecodeBlock(block, sizeof(block), header, &OnRecord, nullptr) == TinyCLR_Result::ArgumentInvalid);
+
+    memset(block, 0, sizeof(block));
+
+    HOST_CHECK(CanLogger_DecodeBlock(block, sizeof(block), header, &OnRecord, nullptr) == TinyCLR_Result::ArgumentInvalid);
+}
+
+int main() {
+    TestRoundTrip();
+    TestDropsWithoutProcess();
+    TestRegionFull();
+    TestDecodeInvalid();
+
+    return HOST_TEST_RESULT("CanLogger");
+}
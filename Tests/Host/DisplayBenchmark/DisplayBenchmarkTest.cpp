@@ -0,0 +1,206 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include <vector>
+#include "HostTest.h"
+#include "DisplayBenchmark.h"
+
+#define TEST_ORIENTATION_COUNT 4
+#define TEST_FORMAT_COUNT 4
+#define TEST_SHAPE_COUNT 5
+
+static uint64_t nativeTime;
+
+static uint64_t GetNativeTime(const TinyCLR_NativeTime_Controller* self) {
+    return nativeTime += 1000;
+}
+
+static uint64_t ConvertNativeTimeToSystemTime(const TinyCLR_NativeTime_Controller* self, uint64_t ticks) {
+    return ticks;
+}
+
+static TinyCLR_NativeTime_Controller timeController;
+static std::vector<uint8_t> memory;
+static std::vector<uint8_t> buffer;
+static DisplayBenchmark_Framebuffer framebuffer;
+static DisplayBenchmark_Configuration configuration;
+
+static void Initialize(uint32_t width, uint32_t height) {
+    timeController.GetNativeTime = &GetNativeTime;
+    timeController.ConvertNativeTimeToSystemTime = &ConvertNativeTimeToSystemTime;
+
+    memory.assign(width * height * 4, 0);
+    buffer.assign(width * height * 2, 0);
+
+    HOST_CHECK(DisplayBenchmark_Framebuffer_Initialize(framebuffer, memory.data(), width, height) == TinyCLR_Result::Success);
+
+    memset(&configuration, 0, sizeof(configuration));
+
+    DisplayBenchmark_Framebuffer_Attach(framebuffer, configuration);
+
+    configuration.Time = &timeController;
+    configuration.Buffer = buffer.data();
+    configuration.BufferSize = buffer.size();
+    configuration.Iterations = 2;
+
+    framebuffer.controller.Enable(&framebuffer.controller);
+}
+
+static size_t reportCount;
+static size_t failedCount;
+static std::vector<uint32_t> checksums;
+
+static void OnResult(const DisplayBenchmark_Result& result, void* context) {
+    reportCount++;
+
+    if (!result.Checked || result.Mismatches != 0 || result.Pixels != static_cast<uint64_t>(result.Width) * result.Height * 2)
+        failedCount++;
+
+    checksums.push_back(result.Checksum);
+}
+
+// Every orientation, format and shape must match the golden image, with the same checksums on every run, and the
+// suite must leave the display as it found it
+static void TestSuite() {
+    static const uint32_t sizes[][2] = { { 480, 272 }, { 320, 240 }, { 33, 17 }, { 7, 5 } };
+
+    for (auto& size : sizes) {
+        std::vector<uint32_t> first;
+
+        for (auto run = 0; run < 2; run++) {
+            Initialize(size[0], size[1]);
+
+            reportCount = 0;
+            failedCount = 0;
+            checksums.clear();
+
+            HOST_CHECK(DisplayBenchmark_RunSuite(configuration, &OnResult, nullptr) == TinyCLR_Result::Success);
+            HOST_CHECK(failedCount == 0);
+            HOST_CHECK(framebuffer.orientation == DisplayRotation_Orientation::Normal);
+            HOST_CHECK(framebuffer.format == DisplayFormat_PixelFormat::Rgb565);
+            HOST_CHECK(framebuffer.enabled);
+
+            if (run == 0)
+                first = checksums;
+            else
+                HOST_CHECK(checksums == first);
+        }
+
+        // The unaligned shape only fits the smallest panel when it is turned sideways, otherwise it is left out
+        if (size[0] > 8)
+            HOST_CHECK(reportCount == TEST_ORIENTATION_COUNT * TEST_FORMAT_COUNT * TEST_SHAPE_COUNT);
+        else
+            HOST_CHECK(reportCount == TEST_ORIENTATION_COUNT * TEST_FORMAT_COUNT * TEST_SHAPE_COUNT - 2 * TEST_FORMAT_COUNT);
+    }
+}
+
+// Checks full screen draws against the rotations written out here, independent of the benchmark's own checks
+static void TestOrientations() {
+    const uint32_t width = 40;
+    const uint32_t height = 24;
+
+    for (uint32_t orientation = 0; orientation < TEST_ORIENTATION_COUNT; orientation++) {
+        DisplayBenchmark_Result result;
+
+        Initialize(width, height);
+
+        HOST_CHECK(DisplayBenchmark_Run(configuration, static_cast<DisplayRotation_Orientation>(orientation), DisplayFormat_PixelFormat::Rgb565, DisplayBenchmark_Shape::FullScreen, result) == TinyCLR_Result::Success);
+
+        auto pixels = reinterpret_cast<const uint16_t*>(memory.data());
+        auto correct = true;
+
+        for (uint32_t y = 0; y < result.Height; y++) {
+            for (uint32_t x = 0; x < result.Width; x++) {
+                uint32_t index;
+
+                switch (static_cast<DisplayRotation_Orientation>(orientation)) {
+                case DisplayRotation_Orientation::Clockwise90:
+                    index = x * width + width - 1 - y;
+                    break;
+
+                case DisplayRotation_Orientation::Rotate180:
+                    index = (height - 1 - y) * width + width - 1 - x;
+                    break;
+
+                case DisplayRotation_Orientation::CounterClockwise90:
+                    index = (height - 1 - x) * width + y;
+                    break;
+
+                default:
+                    index = y * width + x;
+                    break;
+                }
+
+                correct &= pixels[index] == DisplayBenchmark_GetPattern(x, y);
+            }
+        }
+
+        HOST_CHECK(correct);
+    }
+}
+
+static TinyCLR_Result(*drawBuffer)(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data);
+
+static TinyCLR_Result DrawBufferWithError(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data) {
+    auto result = drawBuffer(self, x, y, width, height, data);
+
+    // One pixel just outside the rectangle
+    uint32_t physicalX = x + width < framebuffer.width ? x + width : x - 1;
+
+    memory[(y * framebuffer.width + physicalX) * 2] ^= 0xFF;
+
+    return result;
+}
+
+// A pixel drawn outside the rectangle must show up as a mismatch
+static void TestMismatch() {
+    DisplayBenchmark_Result result;
+
+    Initialize(64, 48);
+
+    drawBuffer = framebuffer.controller.DrawBuffer;
+    framebuffer.controller.DrawBuffer = &DrawBufferWithError;
+    configuration.Iterations = 1;
+
+    HOST_CHECK(DisplayBenchmark_Run(configuration, DisplayRotation_Orientation::Normal, DisplayFormat_PixelFormat::Rgb565, DisplayBenchmark_Shape::Half, result) == TinyCLR_Result::Success);
+    HOST_CHECK(result.Checked && result.Mismatches == 1);
+}
+
+static void TestArguments() {
+    DisplayBenchmark_Result result;
+
+    Initialize(64, 48);
+
+    configuration.SetOrientation = nullptr;
+
+    HOST_CHECK(DisplayBenchmark_Run(configuration, DisplayRotation_Orientation::Clockwise90, DisplayFormat_PixelFormat::Rgb565, DisplayBenchmark_Shape::Half, result) == TinyCLR_Result::NotSupported);
+
+    configuration.BufferSize = 64 * 48 * 2 - 1;
+
+    HOST_CHECK(DisplayBenchmark_Run(configuration, DisplayRotation_Orientation::Normal, DisplayFormat_PixelFormat::Rgb565, DisplayBenchmark_Shape::Half, result) == TinyCLR_Result::ArgumentInvalid);
+
+    Initialize(7, 5);
+
+    HOST_CHECK(DisplayBenchmark_Run(configuration, DisplayRotation_Orientation::Normal, DisplayFormat_PixelFormat::Rgb565, DisplayBenchmark_Shape::Unaligned, result) == TinyCLR_Result::ArgumentOutOfRange);
+}
+
+int main() {
+    TestSuite();
+    TestOrientations();
+    TestMismatch();
+    TestArguments();
+
+    return HOST_TEST_RESULT("DisplayBenchmark");
+}
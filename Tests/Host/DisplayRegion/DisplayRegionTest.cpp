@@ -0,0 +1,185 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <vector>
+#include "HostTest.h"
+#include "DisplayRegion.h"
+
+#define TEST_SCREEN_WIDTH 100
+#define TEST_SCREEN_HEIGHT 80
+
+static DisplayRegion region;
+
+static bool HasRectangle(int32_t x, int32_t y, int32_t width, int32_t height) {
+    for (size_t i = 0; i < region.count; i++) {
+        auto& r = region.rectangles[i];
+
+        if (r.X == x && r.Y == y && r.Width == width && r.Height == height)
+            return true;
+    }
+
+    return false;
+}
+
+static bool Covers(int32_t x, int32_t y) {
+    for (size_t i = 0; i < region.count; i++) {
+        auto& r = region.rectangles[i];
+
+        if (x >= r.X && x < r.X + r.Width && y >= r.Y && y < r.Y + r.Height)
+            return true;
+    }
+
+    return false;
+}
+
+// Every rectangle is on the screen and none overlap
+static bool IsConsistent() {
+    for (size_t i = 0; i < region.count; i++) {
+        auto& a = region.rectangles[i];
+
+        if (a.X < 0 || a.Y < 0 || a.Width <= 0 || a.Height <= 0 || a.X + a.Width > region.width || a.Y + a.Height > region.height)
+            return false;
+
+        for (size_t j = i + 1; j < region.count; j++) {
+            auto& b = region.rectangles[j];
+
+            if (a.X < b.X + b.Width && b.X < a.X + a.Width && a.Y < b.Y + b.Height && b.Y < a.Y + a.Height)
+                return false;
+        }
+    }
+
+    return region.count <= DISPLAY_REGION_MAX_RECTANGLES;
+}
+
+static void TestClip() {
+    DisplayRegion_Reset(region, TEST_SCREEN_WIDTH, TEST_SCREEN_HEIGHT);
+
+    DisplayRegion_Add(region, -20, 10, 20, 10);
+    DisplayRegion_Add(region, TEST_SCREEN_WIDTH, 10, 5, 10);
+    DisplayRegion_Add(region, 10, -30, 10, 30);
+    DisplayRegion_Add(region, 10, TEST_SCREEN_HEIGHT, 10, 1);
+    DisplayRegion_Add(region, 10, 10, 0, 10);
+    DisplayRegion_Add(region, 10, 10, 10, -1);
+    HOST_CHECK(region.count == 0 && DisplayRegion_GetArea(region) == 0);
+
+    DisplayRegion_Add(region, -5, -5, 10, 10);
+    HOST_CHECK(region.count == 1 && HasRectangle(0, 0, 5, 5));
+
+    DisplayRegion_Add(region, TEST_SCREEN_WIDTH - 5, TEST_SCREEN_HEIGHT - 5, 10, 10);
+    HOST_CHECK(region.count == 2 && HasRectangle(TEST_SCREEN_WIDTH - 5, TEST_SCREEN_HEIGHT - 5, 5, 5));
+
+    DisplayRegion_Reset(region, TEST_SCREEN_WIDTH, TEST_SCREEN_HEIGHT);
+    DisplayRegion_Add(region, -10, -10, TEST_SCREEN_WIDTH + 20, TEST_SCREEN_HEIGHT + 20);
+    HOST_CHECK(region.count == 1 && HasRectangle(0, 0, TEST_SCREEN_WIDTH, TEST_SCREEN_HEIGHT));
+}
+
+static void TestMerge() {
+    // Overlapping
+    DisplayRegion_Reset(region, TEST_SCREEN_WIDTH, TEST_SCREEN_HEIGHT);
+    DisplayRegion_Add(region, 10, 10, 20, 20);
+    DisplayRegion_Add(region, 20, 20, 20, 20);
+    HOST_CHECK(region.count == 1 && HasRectangle(10, 10, 30, 30));
+
+    // Contained, either way round
+    DisplayRegion_Add(region, 15, 15, 5, 5);
+    HOST_CHECK(region.count == 1 && HasRectangle(10, 10, 30, 30));
+
+    DisplayRegion_Add(region, 5, 5, 50, 50);
+    HOST_CHECK(region.count == 1 && HasRectangle(5, 5, 50, 50));
+
+    // Adjacent edges, the bounds cost nothing extra
+    DisplayRegion_Reset(region, TEST_SCREEN_WIDTH, TEST_SCREEN_HEIGHT);
+    DisplayRegion_Add(region, 0, 0, 10, 10);
+    DisplayRegion_Add(region, 10, 0, 10, 10);
+    DisplayRegion_Add(region, 0, 10, 20, 5);
+    HOST_CHECK(region.count == 1 && HasRectangle(0, 0, 20, 15));
+
+    // Apart, the bounds would copy far more than both
+    DisplayRegion_Reset(region, TEST_SCREEN_WIDTH, TEST_SCREEN_HEIGHT);
+    DisplayRegion_Add(region, 0, 0, 5, 5);
+    DisplayRegion_Add(region, 50, 50, 5, 5);
+    HOST_CHECK(region.count == 2 && DisplayRegion_GetArea(region) == 50);
+
+    // Touching only diagonally, also kept apart
+    DisplayRegion_Add(region, 5, 5, 5, 5);
+    HOST_CHECK(region.count == 3 && DisplayRegion_GetArea(region) == 75);
+
+    // A rectangle bridging the first two merges them, and the result swallows the third
+    DisplayRegion_Add(region, 3, 3, 50, 50);
+    HOST_CHECK(region.count == 1 && HasRectangle(0, 0, 55, 55));
+}
+
+// Single pixels 10 apart never merge on their own, so the seventeenth has to join the one it grows the least
+static void TestFull() {
+    DisplayRegion_Reset(region, TEST_SCREEN_WIDTH, TEST_SCREEN_HEIGHT);
+
+    for (auto i = 0; i < DISPLAY_REGION_MAX_RECTANGLES; i++)
+        DisplayRegion_Add(region, (i % 4) * 10, (i / 4) * 10, 1, 1);
+
+    HOST_CHECK(region.count == DISPLAY_REGION_MAX_RECTANGLES && DisplayRegion_GetArea(region) == DISPLAY_REGION_MAX_RECTANGLES);
+
+    DisplayRegion_Add(region, 32, 31, 1, 1);
+    HOST_CHECK(region.count == DISPLAY_REGION_MAX_RECTANGLES);
+    HOST_CHECK(HasRectangle(30, 30, 3, 2));
+    HOST_CHECK(IsConsistent());
+
+    for (auto i = 0; i < DISPLAY_REGION_MAX_RECTANGLES; i++)
+        HOST_CHECK(Covers((i % 4) * 10, (i / 4) * 10));
+}
+
+// Random rectangles, partly off the screen: every added pixel stays covered, the list stays on screen and apart
+static void TestRandom() {
+    srand(1);
+
+    auto correct = true;
+
+    for (auto iteration = 0; iteration < 500; iteration++) {
+        std::vector<bool> added(TEST_SCREEN_WIDTH * TEST_SCREEN_HEIGHT);
+
+        DisplayRegion_Reset(region, TEST_SCREEN_WIDTH, TEST_SCREEN_HEIGHT);
+
+        for (auto n = 1 + rand() % 40; n > 0; n--) {
+            auto x = rand() % (TEST_SCREEN_WIDTH + 20) - 10;
+            auto y = rand() % (TEST_SCREEN_HEIGHT + 20) - 10;
+            auto width = rand() % 15;
+            auto height = rand() % 15;
+
+            DisplayRegion_Add(region, x, y, width, height);
+
+            for (auto r = y; r < y + height; r++)
+                for (auto c = x; c < x + width; c++)
+                    if (r >= 0 && r < TEST_SCREEN_HEIGHT && c >= 0 && c < TEST_SCREEN_WIDTH)
+                        added[r * TEST_SCREEN_WIDTH + c] = true;
+
+            correct &= IsConsistent();
+        }
+
+        for (auto r = 0; r < TEST_SCREEN_HEIGHT; r++)
+            for (auto c = 0; c < TEST_SCREEN_WIDTH; c++)
+                if (added[r * TEST_SCREEN_WIDTH + c])
+                    correct &= Covers(c, r);
+    }
+
+    HOST_CHECK(correct);
+}
+
+int main() {
+    TestClip();
+    TestMerge();
+    TestFull();
+    TestRandom();
+
+    return HOST_TEST_RESULT("DisplayRegion");
+}
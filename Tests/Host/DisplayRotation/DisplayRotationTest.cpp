@@ -0,0 +1,120 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <vector>
+#include "HostTest.h"
+#include "DisplayRotation.h"
+
+#define TEST_GUARD 0xDEAD
+
+typedef void(*Kernel)(const uint16_t* from, int32_t fromStride, uint16_t* to, int32_t toStride, int32_t width, int32_t height);
+
+// Rotates a random block with random strides and with each pointer on and off word alignment, then checks every
+// destination pixel against the definition and that nothing outside the destination block was written
+static void CheckKernel(Kernel kernel, bool clockwise) {
+    srand(clockwise ? 1 : 2);
+
+    for (auto iteration = 0; iteration < 2000; iteration++) {
+        auto width = 1 + rand() % 50;
+        auto height = 1 + rand() % 50;
+        auto fromStride = width + rand() % 5;
+        auto toStride = height + rand() % 5;
+        auto fromOffset = rand() % 2;
+        auto toOffset = rand() % 2;
+
+        std::vector<uint16_t> source(fromStride * height + 2);
+        std::vector<uint16_t> destination(toStride * width + 2, TEST_GUARD);
+
+        for (auto& pixel : source)
+            pixel = rand();
+
+        auto from = source.data() + fromOffset;
+        auto to = destination.data() + toOffset;
+
+        kernel(from, fromStride, to, toStride, width, height);
+
+        auto correct = true;
+
+        for (auto r = 0; r < width; r++)
+            for (auto c = 0; c < height; c++)
+                correct &= to[r * toStride + c] == (clockwise ? from[(height - 1 - c) * fromStride + r] : from[c * fromStride + width - 1 - r]);
+
+        for (size_t i = 0; i < destination.size(); i++) {
+            auto r = (static_cast<int32_t>(i) - toOffset) / toStride;
+            auto c = (static_cast<int32_t>(i) - toOffset) % toStride;
+            auto inside = static_cast<int32_t>(i) >= toOffset && r < width && c < height;
+
+            if (!inside)
+                correct &= destination[i] == TEST_GUARD;
+        }
+
+        HOST_CHECK(correct);
+    }
+}
+
+static void TestClockwise() {
+    CheckKernel(&DisplayRotation_RotateClockwise, true);
+    CheckKernel(&DisplayRotation_RotateClockwiseSimple, true);
+}
+
+static void TestCounterClockwise() {
+    CheckKernel(&DisplayRotation_RotateCounterClockwise, false);
+    CheckKernel(&DisplayRotation_RotateCounterClockwiseSimple, false);
+}
+
+static uint64_t nativeTime;
+
+static uint64_t GetNativeTime(const TinyCLR_NativeTime_Controller* self) {
+    return nativeTime++;
+}
+
+static uint64_t ConvertNativeTimeToSystemTime(const TinyCLR_NativeTime_Controller* self, uint64_t ticks) {
+    return ticks;
+}
+
+// The benchmark compares the kernels against the simple loops over whole frames of the panel sizes in use
+static void TestBenchmark() {
+    static const int32_t sizes[][2] = { { 320, 240 }, { 480, 272 }, { 800, 480 }, { 33, 17 } };
+
+    TinyCLR_NativeTime_Controller time = {};
+
+    time.GetNativeTime = &GetNativeTime;
+    time.ConvertNativeTimeToSystemTime = &ConvertNativeTimeToSystemTime;
+
+    for (auto& size : sizes) {
+        std::vector<uint16_t> source(size[0] * size[1]);
+        std::vector<uint16_t> destination(size[0] * size[1]);
+        std::vector<uint16_t> reference(size[0] * size[1]);
+        DisplayRotation_BenchmarkResult result;
+
+        HOST_CHECK(DisplayRotation_Benchmark(&time, size[0], size[1], 2, source.data(), destination.data(), reference.data(), result) == TinyCLR_Result::Success);
+        HOST_CHECK(result.Match);
+        HOST_CHECK(result.Iterations == 2);
+    }
+
+    DisplayRotation_BenchmarkResult result;
+    uint16_t buffer[1];
+
+    HOST_CHECK(DisplayRotation_Benchmark(&time, 0, 1, 1, buffer, buffer, buffer, result) == TinyCLR_Result::ArgumentInvalid);
+    HOST_CHECK(DisplayRotation_Benchmark(nullptr, 1, 1, 1, buffer, buffer, buffer, result) == TinyCLR_Result::ArgumentInvalid);
+}
+
+int main() {
+    TestClockwise();
+    TestCounterClockwise();
+    TestBenchmark();
+
+    return HOST_TEST_RESULT("DisplayRotation");
+}
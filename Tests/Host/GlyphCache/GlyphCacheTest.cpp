@@ -0,0 +1,221 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "HostTest.h"
+#include "GlyphCache.h"
+
+#define TEST_GLYPH_SIZE 4
+#define TEST_MISSING_CHARACTER 0
+#define TEST_OVERSIZED_CHARACTER 1
+
+// Every character but the two above is a full size glyph filled with its own low byte
+struct TestFont {
+    size_t rasterized;
+};
+
+static bool TestFont_GetMetrics(void* context, uint32_t character, GlyphCache_Metrics& metrics) {
+    if (character == TEST_MISSING_CHARACTER)
+        return false;
+
+    metrics.Width = character == TEST_OVERSIZED_CHARACTER ? TEST_GLYPH_SIZE + 1 : TEST_GLYPH_SIZE;
+    metrics.Height = TEST_GLYPH_SIZE;
+    metrics.OffsetX = 0;
+    metrics.OffsetY = 0;
+    metrics.Advance = TEST_GLYPH_SIZE;
+
+    return true;
+}
+
+static void TestFont_Rasterize(void* context, uint32_t character, uint8_t* alpha, size_t stride) {
+    reinterpret_cast<TestFont*>(context)->rasterized++;
+
+    for (auto row = 0; row < TEST_GLYPH_SIZE; row++)
+        memset(alpha + row * stride, static_cast<uint8_t>(character), TEST_GLYPH_SIZE);
+}
+
+static GlyphCache cache;
+static TestFont testFont;
+
+static bool InitializeCache(uint8_t* buffer, size_t slots) {
+    GlyphCache_Font font;
+
+    font.Context = &testFont;
+    font.LineHeight = TEST_GLYPH_SIZE;
+    font.MaxWidth = TEST_GLYPH_SIZE;
+    font.MaxHeight = TEST_GLYPH_SIZE;
+    font.GetMetrics = &TestFont_GetMetrics;
+    font.Rasterize = &TestFont_Rasterize;
+
+    testFont.rasterized = 0;
+
+    return GlyphCache_Initialize(cache, font, buffer, slots * TEST_GLYPH_SIZE * TEST_GLYPH_SIZE) == TinyCLR_Result::Success;
+}
+
+static bool IsGlyphOf(const GlyphCache_Glyph* glyph, uint32_t character) {
+    if (glyph == nullptr || glyph->Character != character)
+        return false;
+
+    for (auto i = 0; i < TEST_GLYPH_SIZE * TEST_GLYPH_SIZE; i++)
+        if (glyph->Alpha[i] != static_cast<uint8_t>(character))
+            return false;
+
+    return true;
+}
+
+static void TestInitialize() {
+    uint8_t buffer[2 * TEST_GLYPH_SIZE * TEST_GLYPH_SIZE];
+    GlyphCache_Font font;
+
+    font.GetMetrics = &TestFont_GetMetrics;
+    font.Rasterize = &TestFont_Rasterize;
+    font.MaxWidth = TEST_GLYPH_SIZE;
+    font.MaxHeight = TEST_GLYPH_SIZE;
+
+    HOST_CHECK(GlyphCache_Initialize(cache, font, nullptr, sizeof(buffer)) == TinyCLR_Result::ArgumentNull);
+    HOST_CHECK(GlyphCache_Initialize(cache, font, buffer, sizeof(buffer) - 1) == TinyCLR_Result::OutOfMemory);
+    HOST_CHECK(GlyphCache_Initialize(cache, font, buffer, sizeof(buffer)) == TinyCLR_Result::Success);
+    HOST_CHECK(cache.entryCount == 2);
+}
+
+// Three slots, replaced in least recently used order
+static void TestReplacement() {
+    uint8_t buffer[3 * TEST_GLYPH_SIZE * TEST_GLYPH_SIZE];
+
+    HOST_CHECK(InitializeCache(buffer, 3));
+
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'A'), 'A'));
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'B'), 'B'));
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'C'), 'C'));
+    HOST_CHECK(cache.misses == 3 && cache.hits == 0 && cache.evictions == 0);
+
+    // A becomes the most recently used, so D takes B's slot
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'A'), 'A'));
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'D'), 'D'));
+    HOST_CHECK(cache.misses == 4 && cache.hits == 1 && cache.evictions == 1);
+
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'A'), 'A'));
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'C'), 'C'));
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'D'), 'D'));
+    HOST_CHECK(cache.misses == 4 && cache.hits == 4 && testFont.rasterized == 4);
+
+    // B comes back in A's slot, the least recently used now
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'B'), 'B'));
+    HOST_CHECK(cache.misses == 5 && cache.evictions == 2);
+
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'A'), 'A'));
+    HOST_CHECK(cache.misses == 6 && cache.evictions == 3 && testFont.rasterized == 6);
+
+    // Characters the font can't supply are neither cached nor counted
+    HOST_CHECK(GlyphCache_Get(cache, TEST_MISSING_CHARACTER) == nullptr);
+    HOST_CHECK(GlyphCache_Get(cache, TEST_OVERSIZED_CHARACTER) == nullptr);
+    HOST_CHECK(cache.misses == 6 && cache.hits == 4 && cache.evictions == 3);
+
+    GlyphCache_Clear(cache);
+
+    HOST_CHECK(IsGlyphOf(GlyphCache_Get(cache, 'A'), 'A'));
+    HOST_CHECK(cache.misses == 7 && cache.evictions == 3);
+}
+
+// With only two slots every miss replaces a glyph, which must never be the one the previous call returned
+static void TestLastGlyphKept() {
+    uint8_t buffer[2 * TEST_GLYPH_SIZE * TEST_GLYPH_SIZE];
+
+    HOST_CHECK(InitializeCache(buffer, 2));
+
+    srand(1);
+
+    auto previous = GlyphCache_Get(cache, 'a');
+    auto previousCharacter = static_cast<uint32_t>('a');
+    auto correct = true;
+
+    for (auto i = 0; i < 5000; i++) {
+        auto character = static_cast<uint32_t>('a' + rand() % 5);
+        auto glyph = GlyphCache_Get(cache, character);
+
+        correct &= IsGlyphOf(glyph, character);
+        correct &= IsGlyphOf(previous, previousCharacter);
+
+        previous = glyph;
+        previousCharacter = character;
+    }
+
+    HOST_CHECK(correct);
+    HOST_CHECK(cache.hits + cache.misses == 5001);
+    HOST_CHECK(cache.evictions == cache.misses - 2);
+}
+
+// More characters than buckets so most share a chain, checked against a plain LRU list. Evictions unlink entries
+// from the start, middle and end of chains.
+static void TestAgainstModel() {
+    const size_t slots = 100;
+    static uint8_t buffer[slots * TEST_GLYPH_SIZE * TEST_GLYPH_SIZE];
+
+    HOST_CHECK(InitializeCache(buffer, slots));
+
+    srand(2);
+
+    std::vector<uint32_t> model;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    auto correct = true;
+
+    for (auto i = 0; i < 50000; i++) {
+        auto character = static_cast<uint32_t>(2 + rand() % 300);
+        auto found = std::find(model.begin(), model.end(), character);
+
+        if (found != model.end()) {
+            model.erase(found);
+            hits++;
+        }
+        else {
+            if (model.size() == slots) {
+                model.pop_back();
+                evictions++;
+            }
+
+            misses++;
+        }
+
+        model.insert(model.begin(), character);
+
+        correct &= IsGlyphOf(GlyphCache_Get(cache, character), character);
+    }
+
+    HOST_CHECK(correct);
+    HOST_CHECK(cache.hits == hits && cache.misses == misses && cache.evictions == evictions);
+    HOST_CHECK(testFont.rasterized == misses);
+
+    // Everything the model still holds is a hit, in any order
+    auto before = cache.misses;
+
+    for (auto character : model)
+        correct &= IsGlyphOf(GlyphCache_Get(cache, character), character);
+
+    HOST_CHECK(correct);
+    HOST_CHECK(cache.misses == before);
+}
+
+int main() {
+    TestInitialize();
+    TestReplacement();
+    TestLastGlyphKept();
+    TestAgainstModel();
+
+    return HOST_TEST_RESULT("GlyphCache");
+}
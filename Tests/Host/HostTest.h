@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdio.h>
+
+// Each check prints the failed condition and counts it, the test's main returns HOST_TEST_RESULT.
+static int hostTestFailures;
+
+#define HOST_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            hostTestFailures++; \
+        } \
+    } while (0)
+
+#define HOST_TEST_RESULT(name) (printf("%s: %s\n", name, hostTestFailures == 0 ? "OK" : "FAILED"), hostTestFailures == 0 ? 0 : 1)
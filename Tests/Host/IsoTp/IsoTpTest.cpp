@@ -0,0 +1,229 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <string.h>
+#include "HostTest.h"
+#include "IsoTp.h"
+
+// Ticks of the loopback's virtual clock, 100ns each
+#define TEST_SECOND (1000 * 10000ULL)
+
+static IsoTp_Loopback loopback;
+static IsoTp_Channel sender;
+static IsoTp_Channel receiver;
+
+static size_t transmittedCount;
+static TinyCLR_Result transmittedResult;
+static size_t receivedCount;
+static size_t receivedLength;
+
+static uint8_t data[ISOTP_MAX_MESSAGE_SIZE];
+static uint8_t readBack[ISOTP_MAX_MESSAGE_SIZE];
+
+static void OnTransmitted(IsoTp_Channel& channel, TinyCLR_Result result, void* context) {
+    transmittedCount++;
+    transmittedResult = result;
+}
+
+static void OnReceived(IsoTp_Channel& channel, size_t length, void* context) {
+    receivedCount++;
+    receivedLength = length;
+}
+
+static void Connect(IsoTp_Configuration& senderConfiguration, IsoTp_Configuration& receiverConfiguration) {
+    IsoTp_Loopback_Initialize(loopback, 500000);
+
+    senderConfiguration.Can = &loopback.canController[0];
+    senderConfiguration.Time = &loopback.timeController;
+    senderConfiguration.TransmitId = 0x7E0;
+    senderConfiguration.ReceiveId = 0x7E8;
+
+    receiverConfiguration.Can = &loopback.canController[1];
+    receiverConfiguration.Time = &loopback.timeController;
+    receiverConfiguration.TransmitId = 0x7E8;
+    receiverConfiguration.ReceiveId = 0x7E0;
+    receiverConfiguration.ExtendedId = senderConfiguration.ExtendedId;
+
+    IsoTp_Initialize(sender, senderConfiguration);
+    IsoTp_Initialize(receiver, receiverConfiguration);
+    IsoTp_SetTransmittedHandler(sender, &OnTransmitted, nullptr);
+    IsoTp_SetReceivedHandler(receiver, &OnReceived, nullptr);
+    IsoTp_Loopback_Attach(loopback, 0, &sender);
+    IsoTp_Loopback_Attach(loopback, 1, &receiver);
+
+    transmittedCount = 0;
+    receivedCount = 0;
+}
+
+static bool IsDelivered(size_t length) {
+    auto readLength = sizeof(readBack);
+
+    return transmittedCount == 1 && transmittedResult == TinyCLR_Result::Success && receivedCount == 1 && receivedLength == length
+        && IsoTp_Read(receiver, readBack, readLength) == TinyCLR_Result::Success && readLength == length && memcmp(readBack, data, length) == 0;
+}
+
+// Single and multi frame messages of every size class, with random block sizes, separation times, padding and
+// identifier formats. The consecutive frames must also keep the separation time the receiver asked for.
+static void TestTransfers() {
+    static const uint8_t separationTimes[] = { 0, 0, 1, 5, 0xF1, 0xF5 };
+
+    srand(1);
+
+    for (auto iteration = 0; iteration < 1000; iteration++) {
+        IsoTp_Configuration senderConfiguration = {};
+        IsoTp_Configuration receiverConfiguration = {};
+
+        senderConfiguration.ExtendedId = rand() & 1;
+        senderConfiguration.Padding = rand() & 1;
+        senderConfiguration.PaddingValue = 0xCC;
+        receiverConfiguration.BlockSize = rand() % 10;
+        receiverConfiguration.SeparationTime = separationTimes[rand() % 6];
+
+        Connect(senderConfiguration, receiverConfiguration);
+
+        size_t length = iteration < 20 ? iteration + 1 : (iteration == 20 ? ISOTP_MAX_MESSAGE_SIZE : 1 + rand() % ISOTP_MAX_MESSAGE_SIZE);
+
+        for (size_t i = 0; i < length; i++)
+            data[i] = rand();
+
+        auto start = loopback.clock;
+
+        HOST_CHECK(IsoTp_Send(sender, data, length) == TinyCLR_Result::Success);
+
+        IsoTp_Loopback_Run(loopback, 60 * TEST_SECOND);
+
+        HOST_CHECK(IsDelivered(length));
+
+        // First frame holds 6 bytes, each consecutive frame 7
+        size_t consecutiveFrames = length <= 7 ? 0 : (length - 6 + 6) / 7;
+        uint64_t separationTime = receiverConfiguration.SeparationTime <= 0x7F ? receiverConfiguration.SeparationTime * 10000ULL : (receiverConfiguration.SeparationTime - 0xF0) * 1000ULL;
+
+        if (consecutiveFrames > 1)
+            HOST_CHECK(loopback.clock - start >= (consecutiveFrames - 1) * separationTime);
+    }
+}
+
+static TinyCLR_Result(*loopbackWriteMessage)(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& length);
+static size_t rejectedWrites;
+
+static TinyCLR_Result WriteMessageSometimesBusy(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& length) {
+    if (rand() % 3 == 0) {
+        rejectedWrites++;
+        length = 0;
+
+        return TinyCLR_Result::Busy;
+    }
+
+    return loopbackWriteMessage(self, messages, length);
+}
+
+// A controller without a free transmit buffer must delay frames, flow control frames sent from the receive path
+// included, never lose them
+static void TestBusyController() {
+    srand(2);
+
+    for (auto iteration = 0; iteration < 300; iteration++) {
+        IsoTp_Configuration senderConfiguration = {};
+        IsoTp_Configuration receiverConfiguration = {};
+
+        receiverConfiguration.BlockSize = rand() % 4;
+
+        Connect(senderConfiguration, receiverConfiguration);
+
+        loopbackWriteMessage = loopback.canController[0].WriteMessage;
+        loopback.canController[0].WriteMessage = &WriteMessageSometimesBusy;
+        loopback.canController[1].WriteMessage = &WriteMessageSometimesBusy;
+
+        size_t length = 8 + rand() % 4000;
+
+        for (size_t i = 0; i < length; i++)
+            data[i] = rand();
+
+        while (IsoTp_Send(sender, data, length) != TinyCLR_Result::Success)
+            ;
+
+        IsoTp_Loopback_Run(loopback, 60 * TEST_SECOND);
+
+        HOST_CHECK(IsDelivered(length));
+    }
+
+    HOST_CHECK(rejectedWrites > 0);
+}
+
+// The receiver still holds an unread message, so a second one is refused with an overflow flow control
+static void TestOverflow() {
+    IsoTp_Configuration senderConfiguration = {};
+    IsoTp_Configuration receiverConfiguration = {};
+
+    Connect(senderConfiguration, receiverConfiguration);
+
+    memset(data, 0, 100);
+
+    HOST_CHECK(IsoTp_Send(sender, data, 100) == TinyCLR_Result::Success);
+
+    IsoTp_Loopback_Run(loopback, TEST_SECOND);
+
+    HOST_CHECK(transmittedResult == TinyCLR_Result::Success);
+    HOST_CHECK(IsoTp_Send(sender, data, 100) == TinyCLR_Result::Success);
+
+    IsoTp_Loopback_Run(loopback, TEST_SECOND);
+
+    HOST_CHECK(transmittedCount == 2);
+    HOST_CHECK(transmittedResult == TinyCLR_Result::OutOfMemory);
+}
+
+// Without a peer no flow control comes back and the send times out after N_Bs
+static void TestTimeout() {
+    IsoTp_Configuration senderConfiguration = {};
+    IsoTp_Configuration receiverConfiguration = {};
+
+    Connect(senderConfiguration, receiverConfiguration);
+
+    IsoTp_Loopback_Attach(loopback, 1, nullptr);
+
+    auto start = loopback.clock;
+
+    HOST_CHECK(IsoTp_Send(sender, data, 100) == TinyCLR_Result::Success);
+
+    IsoTp_Loopback_Run(loopback, 5 * TEST_SECOND);
+
+    HOST_CHECK(transmittedCount == 1);
+    HOST_CHECK(transmittedResult == TinyCLR_Result::TimedOut);
+    HOST_CHECK(loopback.clock - start >= ISOTP_DEFAULT_TIMEOUT);
+}
+
+static void TestArguments() {
+    IsoTp_Configuration senderConfiguration = {};
+    IsoTp_Configuration receiverConfiguration = {};
+
+    Connect(senderConfiguration, receiverConfiguration);
+
+    HOST_CHECK(IsoTp_Send(sender, data, 0) != TinyCLR_Result::Success);
+    HOST_CHECK(IsoTp_Send(sender, data, ISOTP_MAX_MESSAGE_SIZE + 1) != TinyCLR_Result::Success);
+
+    auto readLength = sizeof(readBack);
+
+    HOST_CHECK(IsoTp_Read(receiver, readBack, readLength) != TinyCLR_Result::Success);
+}
+
+int main() {
+    TestTransfers();
+    TestBusyController();
+    TestOverflow();
+    TestTimeout();
+    TestArguments();
+
+    return HOST_TEST_RESULT("IsoTp");
+}
@@ -0,0 +1,149 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <string.h>
+#include "SpiDisplaySimulator.h"
+
+static SpiDisplay_Simulator* SpiDisplay_Simulator_Get(void* context) {
+    return reinterpret_cast<SpiDisplay_Simulator*>(context);
+}
+
+static uint32_t SpiDisplay_Simulator_GetAddress(const uint8_t* parameters, size_t index) {
+    return (static_cast<uint32_t>(parameters[index]) << 8) | parameters[index + 1];
+}
+
+static TinyCLR_Result SpiDisplay_Simulator_WriteCommand(void* context, uint8_t command, const uint8_t* parameters, size_t length) {
+    auto simulator = SpiDisplay_Simulator_Get(context);
+
+    if (simulator->logCount < SPI_DISPLAY_SIMULATOR_LOG_SIZE) {
+        auto& entry = simulator->log[simulator->logCount++];
+
+        entry.Command = command;
+        entry.Length = static_cast<uint8_t>(length);
+
+        if (length > 0)
+            memcpy(entry.Parameters, parameters, length < sizeof(entry.Parameters) ? length : sizeof(entry.Parameters));
+    }
+
+    simulator->byteCount += 1 + length;
+    simulator->writing = false;
+
+    switch (command) {
+    case SPI_DISPLAY_COMMAND_COLUMN_ADDRESS_SET:
+    case SPI_DISPLAY_COMMAND_ROW_ADDRESS_SET: {
+        if (length != 4)
+            return TinyCLR_Result::ArgumentInvalid;
+
+        auto start = SpiDisplay_Simulator_GetAddress(parameters, 0);
+        auto end = SpiDisplay_Simulator_GetAddress(parameters, 2);
+        auto limit = command == SPI_DISPLAY_COMMAND_COLUMN_ADDRESS_SET ? simulator->width : simulator->height;
+
+        if (start > end || end >= limit)
+            return TinyCLR_Result::ArgumentOutOfRange;
+
+        if (command == SPI_DISPLAY_COMMAND_COLUMN_ADDRESS_SET) {
+            simulator->columnStart = start;
+            simulator->columnEnd = end;
+        }
+        else {
+            simulator->rowStart = start;
+            simulator->rowEnd = end;
+        }
+
+        break;
+    }
+
+    case SPI_DISPLAY_COMMAND_MEMORY_WRITE:
+        simulator->column = simulator->columnStart;
+        simulator->row = simulator->rowStart;
+        simulator->writing = true;
+
+        break;
+    }
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result SpiDisplay_Simulator_WritePixels(void* context, const uint16_t* pixels, size_t count, SpiDisplay_DoneHandler done, void* doneContext) {
+    auto simulator = SpiDisplay_Simulator_Get(context);
+
+    if (!simulator->writing)
+        return TinyCLR_Result::InvalidOperation;
+
+    if (simulator->pendingDone != nullptr)
+        return TinyCLR_Result::Busy;
+
+    for (size_t i = 0; i < count; i++) {
+        simulator->memory[simulator->row * simulator->width + simulator->column] = pixels[i];
+
+        if (simulator->column++ == simulator->columnEnd) {
+            simulator->column = simulator->columnStart;
+
+            if (simulator->row++ == simulator->rowEnd)
+                simulator->row = simulator->rowStart;
+        }
+    }
+
+    simulator->pixelCount += count;
+    simulator->byteCount += count * 2;
+
+    if (simulator->deferCompletion) {
+        simulator->pendingDone = done;
+        simulator->pendingContext = doneContext;
+    }
+    else {
+        done(doneContext, TinyCLR_Result::Success);
+    }
+
+    return TinyCLR_Result::Success;
+}
+
+static void SpiDisplay_Simulator_Delay(void* context, uint64_t microseconds) {
+    SpiDisplay_Simulator_Get(context)->delayTime += microseconds;
+}
+
+TinyCLR_Result SpiDisplay_Simulator_Initialize(SpiDisplay_Simulator& simulator, uint16_t* memory, uint32_t width, uint32_t height, SpiDisplay_Transport& transport) {
+    if (memory == nullptr)
+        return TinyCLR_Result::ArgumentNull;
+
+    if (width == 0 || height == 0)
+        return TinyCLR_Result::ArgumentInvalid;
+
+    memset(&simulator, 0, sizeof(simulator));
+
+    simulator.memory = memory;
+    simulator.width = width;
+    simulator.height = height;
+    simulator.columnEnd = width - 1;
+    simulator.rowEnd = height - 1;
+
+    transport.Context = &simulator;
+    transport.WriteCommand = &SpiDisplay_Simulator_WriteCommand;
+    transport.WritePixels = &SpiDisplay_Simulator_WritePixels;
+    transport.Delay = &SpiDisplay_Simulator_Delay;
+
+    return TinyCLR_Result::Success;
+}
+
+void SpiDisplay_Simulator_Complete(SpiDisplay_Simulator& simulator, TinyCLR_Result result) {
+    auto done = simulator.pendingDone;
+
+    if (done == nullptr)
+        return;
+
+    simulator.pendingDone = nullptr;
+
+    done(simulator.pendingContext, result);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "SpiDisplay.h"
+
+#define SPI_DISPLAY_SIMULATOR_LOG_SIZE 64
+
+struct SpiDisplay_Simulator_Command {
+    uint8_t Command;
+    uint8_t Length;
+    uint8_t Parameters[4];
+};
+
+// A panel on the host. It keeps the window set by CASET/RASET and writes the pixels of RAMWR into memory, which
+// is width * height pixels in panel coordinates, and logs the commands it gets. With deferCompletion set
+// WritePixels does not call done until SpiDisplay_Simulator_Complete, like a transfer still in flight, which can
+// also report a failed transfer.
+struct SpiDisplay_Simulator {
+    uint16_t* memory;
+    uint32_t width;
+    uint32_t height;
+
+    uint32_t columnStart;
+    uint32_t columnEnd;
+    uint32_t rowStart;
+    uint32_t rowEnd;
+    uint32_t column;
+    uint32_t row;
+    bool writing;
+
+    SpiDisplay_Simulator_Command log[SPI_DISPLAY_SIMULATOR_LOG_SIZE];
+    size_t logCount;
+
+    uint64_t pixelCount;
+    uint64_t byteCount;
+    uint64_t delayTime;
+
+    bool deferCompletion;
+    SpiDisplay_DoneHandler pendingDone;
+    void* pendingContext;
+};
+
+TinyCLR_Result SpiDisplay_Simulator_Initialize(SpiDisplay_Simulator& simulator, uint16_t* memory, uint32_t width, uint32_t height, SpiDisplay_Transport& transport);
+void SpiDisplay_Simulator_Complete(SpiDisplay_Simulator& simulator, TinyCLR_Result result);
@@ -0,0 +1,257 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include <vector>
+#include "HostTest.h"
+#include "SpiDisplay.h"
+#include "SpiDisplaySimulator.h"
+
+#define TEST_PANEL_WIDTH 20
+#define TEST_PANEL_HEIGHT 10
+
+static uint16_t panel[TEST_PANEL_WIDTH * TEST_PANEL_HEIGHT];
+static uint16_t pixels[] = { 1, 2, 3, 4, 5, 6 };
+
+// A 16x8 area two columns and one row into the panel memory
+static const SpiDisplay_Configuration configuration = { 16, 8, 2, 1, 0x48 };
+
+static SpiDisplay_Simulator simulator;
+static SpiDisplay display;
+
+static const TinyCLR_Display_Controller* Initialize() {
+    SpiDisplay_Transport transport;
+
+    memset(panel, 0, sizeof(panel));
+
+    HOST_CHECK(SpiDisplay_Simulator_Initialize(simulator, panel, TEST_PANEL_WIDTH, TEST_PANEL_HEIGHT, transport) == TinyCLR_Result::Success);
+    HOST_CHECK(SpiDisplay_Initialize(display, configuration, transport) == TinyCLR_Result::Success);
+
+    return &display.controller;
+}
+
+static bool IsCommand(size_t index, uint8_t command) {
+    return index < simulator.logCount && simulator.log[index].Command == command;
+}
+
+// Enable resets and wakes the panel, then sets the pixel format and scan direction before turning it on
+static void TestEnable() {
+    auto controller = Initialize();
+
+    HOST_CHECK(controller->DrawBuffer(controller, 0, 0, 2, 3, reinterpret_cast<uint8_t*>(pixels)) == TinyCLR_Result::InvalidOperation);
+    HOST_CHECK(controller->Enable(controller) == TinyCLR_Result::Success);
+
+    HOST_CHECK(simulator.logCount == 5);
+    HOST_CHECK(IsCommand(0, SPI_DISPLAY_COMMAND_SOFTWARE_RESET));
+    HOST_CHECK(IsCommand(1, SPI_DISPLAY_COMMAND_SLEEP_OUT));
+    HOST_CHECK(IsCommand(2, SPI_DISPLAY_COMMAND_PIXEL_FORMAT_SET) && simulator.log[2].Parameters[0] == SPI_DISPLAY_PIXEL_FORMAT_16BIT);
+    HOST_CHECK(IsCommand(3, SPI_DISPLAY_COMMAND_MEMORY_ACCESS_CONTROL) && simulator.log[3].Parameters[0] == configuration.MemoryAccessControl);
+    HOST_CHECK(IsCommand(4, SPI_DISPLAY_COMMAND_DISPLAY_ON));
+    HOST_CHECK(simulator.delayTime == 2 * SPI_DISPLAY_RESET_DELAY);
+
+    HOST_CHECK(controller->Disable(controller) == TinyCLR_Result::Success);
+    HOST_CHECK(IsCommand(simulator.logCount - 1, SPI_DISPLAY_COMMAND_DISPLAY_OFF));
+}
+
+// The window is moved by the panel offsets and the pixels land in it, clipped regions are refused
+static void TestDrawBuffer() {
+    auto controller = Initialize();
+
+    HOST_CHECK(controller->Enable(controller) == TinyCLR_Result::Success);
+    HOST_CHECK(controller->DrawBuffer(controller, 3, 4, 3, 2, reinterpret_cast<uint8_t*>(pixels)) == TinyCLR_Result::Success);
+
+    HOST_CHECK(IsCommand(5, SPI_DISPLAY_COMMAND_COLUMN_ADDRESS_SET) && simulator.log[5].Parameters[1] == 5 && simulator.log[5].Parameters[3] == 7);
+    HOST_CHECK(IsCommand(6, SPI_DISPLAY_COMMAND_ROW_ADDRESS_SET) && simulator.log[6].Parameters[1] == 5 && simulator.log[6].Parameters[3] == 6);
+    HOST_CHECK(IsCommand(7, SPI_DISPLAY_COMMAND_MEMORY_WRITE));
+
+    for (auto i = 0; i < 6; i++)
+        HOST_CHECK(panel[(5 + i / 3) * TEST_PANEL_WIDTH + 5 + i % 3] == pixels[i]);
+
+    HOST_CHECK(!display.busy);
+    HOST_CHECK(controller->DrawBuffer(controller, 14, 0, 3, 1, reinterpret_cast<uint8_t*>(pixels)) == TinyCLR_Result::ArgumentOutOfRange);
+    HOST_CHECK(controller->DrawBuffer(controller, 0, 7, 1, 2, reinterpret_cast<uint8_t*>(pixels)) == TinyCLR_Result::ArgumentOutOfRange);
+}
+
+// A transfer still in flight keeps the controller busy, its failure is reported by the next call only and a
+// transfer that never ends times out instead of hanging the caller
+static void TestTransferCompletion() {
+    auto controller = Initialize();
+
+    HOST_CHECK(controller->Enable(controller) == TinyCLR_Result::Success);
+
+    simulator.deferCompletion = true;
+
+    HOST_CHECK(controller->DrawPixel(controller, 15, 7, 0xABCD) == TinyCLR_Result::Success);
+    HOST_CHECK(display.busy && panel[8 * TEST_PANEL_WIDTH + 17] == 0xABCD);
+
+    SpiDisplay_Simulator_Complete(simulator, TinyCLR_Result::Success);
+
+    HOST_CHECK(!display.busy);
+    HOST_CHECK(controller->DrawPixel(controller, 1, 1, 1) == TinyCLR_Result::Success && display.busy);
+
+    SpiDisplay_Simulator_Complete(simulator, TinyCLR_Result::InvalidOperation);
+
+    HOST_CHECK(controller->DrawPixel(controller, 1, 1, 2) == TinyCLR_Result::InvalidOperation && !display.busy);
+    HOST_CHECK(controller->DrawPixel(controller, 1, 1, 3) == TinyCLR_Result::Success && display.busy);
+
+    auto start = simulator.delayTime;
+
+    HOST_CHECK(SpiDisplay_WaitForCompletion(display) == TinyCLR_Result::TimedOut && !display.busy);
+    HOST_CHECK(simulator.delayTime - start >= SPI_DISPLAY_TRANSFER_TIMEOUT);
+
+    // The abandoned transfer never completes
+    simulator.pendingDone = nullptr;
+
+    HOST_CHECK(SpiDisplay_WaitForCompletion(display) == TinyCLR_Result::Success);
+
+    simulator.deferCompletion = false;
+
+    HOST_CHECK(controller->DrawPixel(controller, 1, 1, 4) == TinyCLR_Result::Success && !display.busy);
+}
+
+// DrawBuffer must be done with the caller's data when it returns: regions that fit the controller's buffer are
+// copied and sent from there, others are waited for
+static void TestDrawBufferOwnership() {
+    uint16_t buffer[4];
+    auto controller = Initialize();
+
+    display.configuration.Buffer = buffer;
+    display.configuration.BufferSize = 4;
+
+    HOST_CHECK(controller->Enable(controller) == TinyCLR_Result::Success);
+
+    simulator.deferCompletion = true;
+
+    HOST_CHECK(controller->DrawBuffer(controller, 0, 0, 2, 2, reinterpret_cast<uint8_t*>(pixels)) == TinyCLR_Result::Success);
+    HOST_CHECK(display.busy);
+    HOST_CHECK(memcmp(buffer, pixels, sizeof(buffer)) == 0);
+
+    SpiDisplay_Simulator_Complete(simulator, TinyCLR_Result::Success);
+
+    auto start = simulator.delayTime;
+
+    // Six pixels don't fit, nothing completes the transfer and DrawBuffer gives up on it before returning
+    HOST_CHECK(controller->DrawBuffer(controller, 0, 0, 3, 2, reinterpret_cast<uint8_t*>(pixels)) == TinyCLR_Result::TimedOut);
+    HOST_CHECK(!display.busy);
+    HOST_CHECK(simulator.delayTime - start >= SPI_DISPLAY_TRANSFER_TIMEOUT);
+
+    simulator.pendingDone = nullptr;
+    simulator.deferCompletion = false;
+
+    HOST_CHECK(controller->DrawBuffer(controller, 0, 0, 3, 2, reinterpret_cast<uint8_t*>(pixels)) == TinyCLR_Result::Success);
+    HOST_CHECK(!display.busy);
+    HOST_CHECK(panel[1 * TEST_PANEL_WIDTH + 2 + 2] == pixels[2] && panel[2 * TEST_PANEL_WIDTH + 2] == pixels[3]);
+}
+
+static std::vector<uint8_t> wire;
+static std::vector<bool> wireData;
+static bool dataCommandHigh;
+static uint64_t nativeTime;
+
+static TinyCLR_Result WriteRead(const TinyCLR_Spi_Controller* self, const uint8_t* writeBuffer, size_t& writeLength, uint8_t* readBuffer, size_t& readLength, bool deselectAfter) {
+    for (size_t i = 0; i < writeLength; i++) {
+        wire.push_back(writeBuffer[i]);
+        wireData.push_back(dataCommandHigh);
+    }
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result OpenPin(const TinyCLR_Gpio_Controller* self, uint32_t pin) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result ClosePin(const TinyCLR_Gpio_Controller* self, uint32_t pin) {
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result Write(const TinyCLR_Gpio_Controller* self, uint32_t pin, TinyCLR_Gpio_PinValue value) {
+    dataCommandHigh = value == TinyCLR_Gpio_PinValue::High;
+
+    return TinyCLR_Result::Success;
+}
+
+static TinyCLR_Result SetDriveMode(const TinyCLR_Gpio_Controller* self, uint32_t pin, TinyCLR_Gpio_PinDriveMode mode) {
+    return TinyCLR_Result::Success;
+}
+
+static uint64_t GetNativeTime(const TinyCLR_NativeTime_Controller* self) {
+    return nativeTime += 5;
+}
+
+static uint64_t ConvertNativeTimeToSystemTime(const TinyCLR_NativeTime_Controller* self, uint64_t ticks) {
+    return ticks;
+}
+
+// Over SPI, commands go out with D/C low, parameters and pixels with D/C high and pixels high byte first
+static void TestSpiTransport() {
+    TinyCLR_Api_Info api = {};
+    TinyCLR_Spi_Controller spi = { &api, &WriteRead };
+    TinyCLR_Gpio_Controller gpio = { &api, &OpenPin, &ClosePin, &Write, &SetDriveMode };
+    TinyCLR_NativeTime_Controller time = {};
+    SpiDisplay_SpiTransport spiTransport = {};
+    SpiDisplay_Transport transport;
+
+    time.GetNativeTime = &GetNativeTime;
+    time.ConvertNativeTimeToSystemTime = &ConvertNativeTimeToSystemTime;
+
+    spiTransport.spi = &spi;
+    spiTransport.gpio = &gpio;
+    spiTransport.time = &time;
+    spiTransport.dataCommandPin = 3;
+
+    HOST_CHECK(SpiDisplay_SpiTransport_Initialize(spiTransport, transport) == TinyCLR_Result::Success);
+    HOST_CHECK(SpiDisplay_Initialize(display, configuration, transport) == TinyCLR_Result::Success);
+
+    auto controller = &display.controller;
+
+    HOST_CHECK(controller->Enable(controller) == TinyCLR_Result::Success);
+
+    uint16_t frame[80];
+
+    for (auto i = 0; i < 80; i++)
+        frame[i] = 0x1200 + i;
+
+    wire.clear();
+    wireData.clear();
+
+    HOST_CHECK(controller->DrawBuffer(controller, 0, 0, 10, 8, reinterpret_cast<uint8_t*>(frame)) == TinyCLR_Result::Success);
+
+    // Column and row address sets with four parameters each, the memory write and two bytes a pixel
+    HOST_CHECK(wire.size() == 5 + 5 + 1 + 2 * 80);
+
+    if (wire.size() != 5 + 5 + 1 + 2 * 80)
+        return;
+
+    HOST_CHECK(wire[0] == SPI_DISPLAY_COMMAND_COLUMN_ADDRESS_SET && !wireData[0] && wireData[1]);
+    HOST_CHECK(wire[2] == 2 && wire[4] == 11);
+    HOST_CHECK(wire[5] == SPI_DISPLAY_COMMAND_ROW_ADDRESS_SET && !wireData[5]);
+    HOST_CHECK(wire[7] == 1 && wire[9] == 8);
+    HOST_CHECK(wire[10] == SPI_DISPLAY_COMMAND_MEMORY_WRITE && !wireData[10]);
+
+    for (auto i = 0; i < 80; i++)
+        HOST_CHECK(wire[11 + 2 * i] == 0x12 && wire[12 + 2 * i] == i && wireData[11 + 2 * i] && wireData[12 + 2 * i]);
+
+    HOST_CHECK(!display.busy);
+}
+
+int main() {
+    TestEnable();
+    TestDrawBuffer();
+    TestTransferCompletion();
+    TestDrawBufferOwnership();
+    TestSpiTransport();
+
+    return HOST_TEST_RESULT("SpiDisplay");
+}
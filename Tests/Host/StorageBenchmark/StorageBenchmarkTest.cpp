@@ -0,0 +1,126 @@
+// Copyright GHI Electronics, LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include "HostTest.h"
+#include "StorageBenchmark.h"
+
+#define TEST_SECTOR_COUNT 2048
+
+static uint8_t memory[TEST_SECTOR_COUNT * 512];
+static uint8_t buffer[STORAGE_BENCHMARK_MAX_BLOCK_SIZE];
+
+static size_t reportCount;
+
+static void CheckResult(const StorageBenchmark_Result& result, void* context) {
+    HOST_CHECK(result.Failures == 0);
+    HOST_CHECK(result.Operations > 0);
+    HOST_CHECK(result.KiloBytesPerSecond > 0);
+    HOST_CHECK(result.LatencyMin <= result.LatencyP50);
+    HOST_CHECK(result.LatencyP50 <= result.LatencyP95);
+    HOST_CHECK(result.LatencyP95 <= result.LatencyP99);
+    HOST_CHECK(result.LatencyP99 <= result.LatencyMax);
+
+    reportCount++;
+}
+
+static void TestCardStoresData(StorageBenchmark_SimulatedCard& card) {
+    auto storage = &card.storageController;
+    uint8_t data[1024];
+    uint8_t readBack[1024];
+
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = static_cast<uint8_t>(i * 7);
+
+    size_t count = sizeof(data);
+
+    HOST_CHECK(storage->Write(storage, 512 * 10, count, data, 0) == TinyCLR_Result::Success);
+
+    count = sizeof(readBack);
+
+    HOST_CHECK(storage->Read(storage, 512 * 10, count, readBack, 0) == TinyCLR_Result::Success);
+    HOST_CHECK(memcmp(data, readBack, sizeof(data)) == 0);
+
+    count = 100;
+
+    HOST_CHECK(storage->Read(storage, 512 * 10, count, readBack, 0) == TinyCLR_Result::ArgumentInvalid);
+
+    count = 1024;
+
+    HOST_CHECK(storage->Read(storage, 512 * (TEST_SECTOR_COUNT - 1), count, readBack, 0) == TinyCLR_Result::ArgumentOutOfRange);
+}
+
+static void TestRandomAccessIsSlower(const StorageBenchmark_Configuration& configuration) {
+    StorageBenchmark_Result sequential;
+    StorageBenchmark_Result random;
+
+    HOST_CHECK(StorageBenchmark_Run(configuration, StorageBenchmark_Pattern::SequentialRead, 512, sequential) == TinyCLR_Result::Success);
+    HOST_CHECK(StorageBenchmark_Run(configuration, StorageBenchmark_Pattern::RandomRead, 512, random) == TinyCLR_Result::Success);
+    HOST_CHECK(sequential.KiloBytesPerSecond > random.KiloBytesPerSecond);
+}
+
+static void TestRunIsReproducible(const StorageBenchmark_Configuration& configuration) {
+    StorageBenchmark_Result first;
+    StorageBenchmark_Result second;
+
+    StorageBenchmark_Run(configuration, StorageBenchmark_Pattern::RandomWrite, 4096, first);
+    StorageBenchmark_Run(configuration, StorageBenchmark_Pattern::RandomWrite, 4096, second);
+
+    HOST_CHECK(first.ElapsedTime == second.ElapsedTime);
+    HOST_CHECK(first.LatencyP99 == second.LatencyP99);
+}
+
+static void TestArguments(const StorageBenchmark_Configuration& configuration) {
+    StorageBenchmark_Result result;
+
+    HOST_CHECK(StorageBenchmark_Run(configuration, StorageBenchmark_Pattern::SequentialRead, 500, result) == TinyCLR_Result::ArgumentOutOfRange);
+    HOST_CHECK(StorageBenchmark_Run(configuration, StorageBenchmark_Pattern::SequentialRead, 2 * STORAGE_BENCHMARK_MAX_BLOCK_SIZE, result) == TinyCLR_Result::ArgumentOutOfRange);
+
+    auto withoutBuffer = configuration;
+
+    withoutBuffer.Buffer = nullptr;
+
+    HOST_CHECK(StorageBenchmark_Run(withoutBuffer, StorageBenchmark_Pattern::SequentialRead, 512, result) == TinyCLR_Result::ArgumentNull);
+}
+
+int main() {
+    StorageBenchmark_SimulatedCardTiming timing;
+    StorageBenchmark_SimulatedCard card;
+
+    StorageBenchmark_SimulatedCard_GetDefaultTiming(timing);
+
+    HOST_CHECK(StorageBenchmark_SimulatedCard_Initialize(card, timing, memory, TEST_SECTOR_COUNT) == TinyCLR_Result::Success);
+
+    TestCardStoresData(card);
+
+    StorageBenchmark_Configuration configuration = {};
+
+    configuration.Storage = &card.storageController;
+    configuration.Time = &card.timeController;
+    configuration.RegionAddress = 0;
+    configuration.RegionSize = sizeof(memory);
+    configuration.Buffer = buffer;
+    configuration.BufferSize = sizeof(buffer);
+    configuration.Operations = 32;
+
+    TestRandomAccessIsSlower(configuration);
+    TestRunIsReproducible(configuration);
+    TestArguments(configuration);
+
+    // 512 bytes to 64KB is eight block sizes of four patterns, then one erase run
+    HOST_CHECK(StorageBenchmark_RunSuite(configuration, &CheckResult, nullptr) == TinyCLR_Result::Success);
+    HOST_CHECK(reportCount == 8 * 4 + 1);
+
+    return HOST_TEST_RESULT("StorageBenchmark");
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+// The host checks run on one thread without interrupts, so the scoped interrupt masks do nothing.
+struct HostInterruptScope {
+    HostInterruptScope() {}
+    ~HostInterruptScope() {}
+
+    bool IsDisabled() const { return false; }
+};
+
+#define DISABLE_INTERRUPTS_SCOPED(name) HostInterruptScope name
+#define INTERRUPT_STARTED_SCOPED(name) HostInterruptScope name
@@ -0,0 +1,185 @@
+#pragma once
+
+// The parts of the TinyCLR porting API the host checks use, with the same layout as the firmware SDK's TinyCLR.h.
+// Add declarations here as drivers under test need them.
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum class TinyCLR_Result : uint32_t {
+    Success,
+    InvalidOperation,
+    ArgumentNull,
+    ArgumentInvalid,
+    ArgumentOutOfRange,
+    Busy,
+    NotSupported,
+    NotAvailable,
+    OutOfMemory,
+    SharingViolation,
+    TimedOut,
+    IndexOutOfRange,
+    NotImplemented,
+    WrongType,
+};
+
+enum class TinyCLR_Api_Type : uint32_t {
+    StorageController,
+    NativeTimeController,
+    TaskManager,
+    CanController,
+    DisplayController,
+    InteropManager,
+    MemoryManager,
+};
+
+struct TinyCLR_Api_Info {
+    const char* Author;
+    const char* Name;
+    TinyCLR_Api_Type Type;
+    uint64_t Version;
+    const void* Implementation;
+    void* State;
+};
+
+struct TinyCLR_Api_Manager {
+    void* ApiInfo;
+
+    TinyCLR_Result(*Add)(const TinyCLR_Api_Manager* self, const TinyCLR_Api_Info* api);
+    const void*(*FindDefault)(const TinyCLR_Api_Manager* self, TinyCLR_Api_Type type);
+    TinyCLR_Result(*SetDefaultName)(const TinyCLR_Api_Manager* self, TinyCLR_Api_Type type, const char* name);
+};
+
+struct TinyCLR_Memory_Manager {
+    const TinyCLR_Api_Info* ApiInfo;
+
+    void*(*Allocate)(const TinyCLR_Memory_Manager* self, size_t length);
+    void(*Free)(const TinyCLR_Memory_Manager* self, void* ptr);
+};
+
+struct TinyCLR_Storage_Descriptor {
+    bool CanReadDirect;
+    bool CanWriteDirect;
+    bool CanExecuteDirect;
+    bool EraseBeforeWrite;
+    bool Removable;
+    bool RegionsContiguous;
+    bool RegionsEqualSized;
+
+    size_t RegionCount;
+    const uint64_t* RegionAddresses;
+    const size_t* RegionSizes;
+};
+
+struct TinyCLR_Storage_Controller {
+    const TinyCLR_Api_Info* ApiInfo;
+
+    TinyCLR_Result(*Acquire)(const TinyCLR_Storage_Controller* self);
+    TinyCLR_Result(*Release)(const TinyCLR_Storage_Controller* self);
+    TinyCLR_Result(*Open)(const TinyCLR_Storage_Controller* self);
+    TinyCLR_Result(*Close)(const TinyCLR_Storage_Controller* self);
+    TinyCLR_Result(*Read)(const TinyCLR_Storage_Controller* self, uint64_t address, size_t& count, uint8_t* data, uint64_t timeout);
+    TinyCLR_Result(*Write)(const TinyCLR_Storage_Controller* self, uint64_t address, size_t& count, const uint8_t* data, uint64_t timeout);
+    TinyCLR_Result(*Erase)(const TinyCLR_Storage_Controller* self, uint64_t address, size_t& count, uint64_t timeout);
+    TinyCLR_Result(*IsErased)(const TinyCLR_Storage_Controller* self, uint64_t address, size_t count, bool& erased);
+    TinyCLR_Result(*GetDescriptor)(const TinyCLR_Storage_Controller* self, const TinyCLR_Storage_Descriptor*& descriptor);
+};
+
+typedef void(*TinyCLR_NativeTime_Callback)();
+
+struct TinyCLR_NativeTime_Controller {
+    const TinyCLR_Api_Info* ApiInfo;
+
+    TinyCLR_Result(*Initialize)(const TinyCLR_NativeTime_Controller* self);
+    TinyCLR_Result(*Uninitialize)(const TinyCLR_NativeTime_Controller* self);
+    uint64_t(*GetNativeTime)(const TinyCLR_NativeTime_Controller* self);
+    uint64_t(*ConvertNativeTimeToSystemTime)(const TinyCLR_NativeTime_Controller* self, uint64_t nativeTime);
+    uint64_t(*ConvertSystemTimeToNativeTime)(const TinyCLR_NativeTime_Controller* self, uint64_t systemTime);
+    TinyCLR_Result(*SetCallback)(const TinyCLR_NativeTime_Controller* self, TinyCLR_NativeTime_Callback callback);
+    TinyCLR_Result(*ScheduleCallback)(const TinyCLR_NativeTime_Controller* self, uint64_t nativeTime);
+    void(*Wait)(const TinyCLR_NativeTime_Controller* self, uint64_t nativeTime);
+};
+
+struct TinyCLR_Can_BitTiming {
+    uint32_t Propagation;
+    uint32_t Phase1;
+    uint32_t Phase2;
+    uint32_t BaudratePrescaler;
+    uint32_t SynchronizationJumpWidth;
+    bool UseMultiBitSampling;
+};
+
+struct TinyCLR_Can_Message {
+    uint32_t ArbitrationId;
+    bool IsExtendedId;
+    bool IsRemoteTransmissionRequest;
+    size_t Length;
+    uint8_t Data[8];
+    uint64_t Timestamp;
+};
+
+struct TinyCLR_Can_Controller;
+
+typedef void(*TinyCLR_Can_MessageReceivedHandler)(const TinyCLR_Can_Controller* self, size_t count, uint64_t timestamp);
+
+struct TinyCLR_Can_Controller {
+    const TinyCLR_Api_Info* ApiInfo;
+
+    TinyCLR_Result(*Acquire)(const TinyCLR_Can_Controller* self);
+    TinyCLR_Result(*Release)(const TinyCLR_Can_Controller* self);
+    TinyCLR_Result(*Enable)(const TinyCLR_Can_Controller* self);
+    TinyCLR_Result(*Disable)(const TinyCLR_Can_Controller* self);
+    bool(*CanWriteMessage)(const TinyCLR_Can_Controller* self);
+    bool(*CanReadMessage)(const TinyCLR_Can_Controller* self);
+    TinyCLR_Result(*WriteMessage)(const TinyCLR_Can_Controller* self, const TinyCLR_Can_Message* messages, size_t& length);
+    TinyCLR_Result(*ReadMessage)(const TinyCLR_Can_Controller* self, TinyCLR_Can_Message* messages, size_t& length);
+};
+
+enum class TinyCLR_Display_DataFormat : uint32_t {
+    Rgb565 = 0,
+};
+
+enum class TinyCLR_Display_InterfaceType : uint32_t {
+    Parallel = 0,
+    Spi = 1,
+};
+
+struct TinyCLR_Display_Controller {
+    const TinyCLR_Api_Info* ApiInfo;
+
+    TinyCLR_Result(*Acquire)(const TinyCLR_Display_Controller* self);
+    TinyCLR_Result(*Release)(const TinyCLR_Display_Controller* self);
+    TinyCLR_Result(*Enable)(const TinyCLR_Display_Controller* self);
+    TinyCLR_Result(*Disable)(const TinyCLR_Display_Controller* self);
+    TinyCLR_Result(*SetConfiguration)(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat dataFormat, uint32_t width, uint32_t height, const void* configuration);
+    TinyCLR_Result(*GetConfiguration)(const TinyCLR_Display_Controller* self, TinyCLR_Display_DataFormat& dataFormat, uint32_t& width, uint32_t& height, void* configuration);
+    TinyCLR_Result(*GetCapabilities)(const TinyCLR_Display_Controller* self, TinyCLR_Display_InterfaceType& type, const TinyCLR_Display_DataFormat*& supportedDataFormats, size_t& supportedDataFormatCount);
+    TinyCLR_Result(*DrawBuffer)(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data);
+    TinyCLR_Result(*DrawPixel)(const TinyCLR_Display_Controller* self, uint32_t x, uint32_t y, uint64_t color);
+    TinyCLR_Result(*DrawString)(const TinyCLR_Display_Controller* self, const char* data, size_t length);
+};
+
+struct TinyCLR_Spi_Controller {
+    const TinyCLR_Api_Info* ApiInfo;
+
+    TinyCLR_Result(*WriteRead)(const TinyCLR_Spi_Controller* self, const uint8_t* writeBuffer, size_t& writeLength, uint8_t* readBuffer, size_t& readLength, bool deselectAfter);
+};
+
+enum class TinyCLR_Gpio_PinValue : uint32_t {
+    Low = 0,
+    High = 1,
+};
+
+enum class TinyCLR_Gpio_PinDriveMode : uint32_t {
+    Input = 0,
+    Output = 1,
+};
+
+struct TinyCLR_Gpio_Controller {
+    const TinyCLR_Api_Info* ApiInfo;
+
+    TinyCLR_Result(*OpenPin)(const TinyCLR_Gpio_Controller* self, uint32_t pin);
+    TinyCLR_Result(*ClosePin)(const TinyCLR_Gpio_Controller* self, uint32_t pin);
+    TinyCLR_Result(*Write)(const TinyCLR_Gpio_Controller* self, uint32_t pin, TinyCLR_Gpio_PinValue value);
+    TinyCLR_Result(*SetDriveMode)(const TinyCLR_Gpio_Controller* self, uint32_t pin, TinyCLR_Gpio_PinDriveMode mode);
+};
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Builds the host checks of the shared drivers against the stubs in Stubs and runs them. Needs a C++11 compiler,
+# CXX picks another one. Exits with the number of programs that failed.
+
+root=$(cd "$(dirname "$0")/../.." && pwd)
+tests="$root/Tests/Host"
+drivers="$root/Drivers"
+out=${OUT:-${TMPDIR:-/tmp}/tinyclr-host-tests}
+cxx=${CXX:-g++}
+failed=0
+
+mkdir -p "$out"
+
+# check <name> <sources and include directories...>
+check() {
+    name=$1
+    shift
+
+    if $cxx -std=c++11 -O2 -Wall -Wno-unused-parameter -I"$tests/Stubs" -I"$tests" "$@" -o "$out/$name" && "$out/$name"; then
+        :
+    else
+        echo "$name: FAILED"
+        failed=$((failed + 1))
+    fi
+}
+
+check StorageBenchmark -I"$drivers/StorageBenchmark" "$tests/StorageBenchmark/StorageBenchmarkTest.cpp" "$drivers/StorageBenchmark/StorageBenchmark.cpp"
+check CanFilter -I"$drivers/CanFilter" "$tests/CanFilter/CanFilterTest.cpp" "$drivers/CanFilter/CanFilter.cpp"
+check IsoTp -I"$drivers/IsoTp" "$tests/IsoTp/IsoTpTest.cpp" "$drivers/IsoTp/IsoTp.cpp"
+check CanLogger -I"$drivers/CanLogger" -I"$drivers/StorageBenchmark" "$tests/CanLogger/CanLoggerTest.cpp" "$drivers/CanLogger/CanLogger.cpp" "$drivers/StorageBenchmark/StorageBenchmark.cpp"
+check DisplayRotation -I"$drivers/DisplayRotation" "$tests/DisplayRotation/DisplayRotationTest.cpp" "$drivers/DisplayRotation/DisplayRotation.cpp"
+check SpiDisplay -I"$drivers/SpiDisplay" -I"$tests/SpiDisplay" "$tests/SpiDisplay/SpiDisplayTest.cpp" "$tests/SpiDisplay/SpiDisplaySimulator.cpp" "$drivers/SpiDisplay/SpiDisplay.cpp"
+check DisplayBenchmark -I"$drivers/DisplayBenchmark" "$tests/DisplayBenchmark/DisplayBenchmarkTest.cpp" "$drivers/DisplayBenchmark/DisplayBenchmark.cpp" "$drivers/DisplayFormat/DisplayFormat.cpp" "$drivers/DisplayRotation/DisplayRotation.cpp"
+check GlyphCache -I"$drivers/GlyphCache" "$tests/GlyphCache/GlyphCacheTest.cpp" "$drivers/GlyphCache/GlyphCache.cpp"
+check DisplayRegion -I"$drivers/DisplayRegion" "$tests/DisplayRegion/DisplayRegionTest.cpp" "$drivers/DisplayRegion/DisplayRegion.cpp"
+
+exit $failed